@@ -70,6 +70,28 @@ RES _ResourceLoader::load(const String &p_path, const String &p_type_hint, bool
 	return ret;
 }
 
+Error _ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint) {
+
+	return ResourceLoader::load_threaded_request(p_path, p_type_hint);
+}
+
+_ResourceLoader::ThreadLoadStatus _ResourceLoader::load_threaded_get_status(const String &p_path) {
+
+	return (ThreadLoadStatus)ResourceLoader::load_threaded_get_status(p_path);
+}
+
+float _ResourceLoader::load_threaded_get_progress(const String &p_path) {
+
+	float progress;
+	ResourceLoader::load_threaded_get_status(p_path, &progress);
+	return progress;
+}
+
+RES _ResourceLoader::load_threaded_get(const String &p_path) {
+
+	return ResourceLoader::load_threaded_get(p_path);
+}
+
 PoolVector<String> _ResourceLoader::get_recognized_extensions_for_type(const String &p_type) {
 
 	List<String> exts;
@@ -111,10 +133,19 @@ void _ResourceLoader::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("load_interactive:ResourceInteractiveLoader", "path", "type_hint"), &_ResourceLoader::load_interactive, DEFVAL(""));
 	ClassDB::bind_method(D_METHOD("load:Resource", "path", "type_hint", "p_no_cache"), &_ResourceLoader::load, DEFVAL(""), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("load_threaded_request", "path", "type_hint"), &_ResourceLoader::load_threaded_request, DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("load_threaded_get_status", "path"), &_ResourceLoader::load_threaded_get_status);
+	ClassDB::bind_method(D_METHOD("load_threaded_get_progress", "path"), &_ResourceLoader::load_threaded_get_progress);
+	ClassDB::bind_method(D_METHOD("load_threaded_get:Resource", "path"), &_ResourceLoader::load_threaded_get);
 	ClassDB::bind_method(D_METHOD("get_recognized_extensions_for_type", "type"), &_ResourceLoader::get_recognized_extensions_for_type);
 	ClassDB::bind_method(D_METHOD("set_abort_on_missing_resources", "abort"), &_ResourceLoader::set_abort_on_missing_resources);
 	ClassDB::bind_method(D_METHOD("get_dependencies", "path"), &_ResourceLoader::get_dependencies);
 	ClassDB::bind_method(D_METHOD("has", "path"), &_ResourceLoader::has);
+
+	BIND_CONSTANT(THREAD_LOAD_INVALID_RESOURCE);
+	BIND_CONSTANT(THREAD_LOAD_IN_PROGRESS);
+	BIND_CONSTANT(THREAD_LOAD_FAILED);
+	BIND_CONSTANT(THREAD_LOAD_LOADED);
 }
 
 _ResourceLoader::_ResourceLoader() {
@@ -463,6 +463,23 @@ Object *ClassDB::instance(const StringName &p_class) {
 
 	return ti->creation_func();
 }
+ClassDB::CreationFunc ClassDB::get_creation_func(const StringName &p_class) {
+
+	OBJTYPE_RLOCK;
+
+	ClassInfo *ti = classes.getptr(p_class);
+	if (!ti || ti->disabled || !ti->creation_func) {
+		if (compat_classes.has(p_class)) {
+			ti = classes.getptr(compat_classes[p_class]);
+		}
+	}
+
+	if (!ti || ti->disabled)
+		return NULL;
+
+	return ti->creation_func;
+}
+
 bool ClassDB::can_instance(const StringName &p_class) {
 
 	OBJTYPE_RLOCK;
@@ -773,7 +790,7 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 	MethodBind *mb_get = NULL;
 	if (p_getter) {
 
-		MethodBind *mb_get = get_method(p_class, p_getter);
+		mb_get = get_method(p_class, p_getter);
 #ifdef DEBUG_METHODS_ENABLED
 
 		if (!mb_get) {
@@ -982,6 +999,43 @@ StringName ClassDB::get_property_getter(StringName p_class, const StringName p_p
 	return StringName();
 }
 
+MethodBind *ClassDB::get_property_setter_method(const StringName &p_class, const StringName &p_property) {
+
+	ClassInfo *type = classes.getptr(p_class);
+	ClassInfo *check = type;
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			return psg->index < 0 ? psg->_setptr : NULL;
+		}
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
+MethodBind *ClassDB::get_property_getter_method(const StringName &p_class, const StringName &p_property) {
+
+	ClassInfo *type = classes.getptr(p_class);
+	ClassInfo *check = type;
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			return psg->index < 0 && psg->getter ? psg->_getptr : NULL;
+		}
+
+		if (check->constant_map.has(p_property))
+			return NULL;
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 bool ClassDB::has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance) {
 
 	ClassInfo *type = classes.getptr(p_class);
@@ -132,9 +132,9 @@ public:
 
 		APIType api;
 		ClassInfo *inherits_ptr;
-		HashMap<StringName, MethodBind *, StringNameHasher> method_map;
-		HashMap<StringName, int, StringNameHasher> constant_map;
-		HashMap<StringName, MethodInfo, StringNameHasher> signal_map;
+		OAHashMap<StringName, MethodBind *, StringNameHasher> method_map;
+		OAHashMap<StringName, int, StringNameHasher> constant_map;
+		OAHashMap<StringName, MethodInfo, StringNameHasher> signal_map;
 		List<PropertyInfo> property_list;
 #ifdef DEBUG_METHODS_ENABLED
 		List<StringName> constant_order;
@@ -142,7 +142,7 @@ public:
 		List<MethodInfo> virtual_methods;
 		StringName category;
 #endif
-		HashMap<StringName, PropertySetGet, StringNameHasher> property_setget;
+		OAHashMap<StringName, PropertySetGet, StringNameHasher> property_setget;
 
 		StringName inherits;
 		StringName name;
@@ -245,6 +245,9 @@ public:
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
+	//function instance() would create the object with, NULL when the class can't be instanced
+	typedef Object *(*CreationFunc)();
+	static CreationFunc get_creation_func(const StringName &p_class);
 	static APIType get_api_type(const StringName &p_class);
 
 	static uint64_t get_api_hash(APIType p_api);
@@ -482,6 +485,9 @@ public:
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
 	static StringName get_property_setter(StringName p_class, const StringName p_property);
 	static StringName get_property_getter(StringName p_class, const StringName p_property);
+	//setter/getter that set_property()/get_property() would call directly with the value, NULL when they do anything else
+	static MethodBind *get_property_setter_method(const StringName &p_class, const StringName &p_property);
+	static MethodBind *get_property_getter_method(const StringName &p_class, const StringName &p_property);
 
 	static bool has_method(StringName p_class, StringName p_method, bool p_no_inheritance = false);
 	static void set_method_flags(StringName p_class, StringName p_method, int p_flags);
@@ -29,8 +29,6 @@
 /*************************************************************************/
 #include "command_queue_mt.h"
 
-#include "os/os.h"
-
 void CommandQueueMT::lock() {
 
 	if (mutex)
@@ -43,48 +41,143 @@ void CommandQueueMT::unlock() {
 		mutex->unlock();
 }
 
-void CommandQueueMT::wait_for_flush() {
+CommandQueueMT::Block *CommandQueueMT::_alloc_block(uint32_t p_capacity) {
 
-	// wait one millisecond for a flush to happen
-	OS::get_singleton()->delay_usec(1000);
+	Block *block = (Block *)memalloc(sizeof(Block) + p_capacity);
+	block->next = NULL;
+	block->capacity = p_capacity;
+	block->write_pos = 0;
+	block->pad = 0;
+	return block;
 }
 
-CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
+/* Each thread remembers its lanes in a small table indexed by queue id. A
+ * queue whose slot is taken by another one just hands the old lane back and
+ * takes a lane again, commands already pushed keep their order through their
+ * sequence numbers. */
 
-	int idx = -1;
+#if defined(NO_THREADS)
+#define COMMAND_QUEUE_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define COMMAND_QUEUE_THREAD_LOCAL __declspec(thread)
+#else
+#define COMMAND_QUEUE_THREAD_LOCAL __thread
+#endif
 
-	while (true) {
+#define COMMAND_QUEUE_LOCAL_LANES 8
 
-		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
+struct CommandQueueLocalLane {
 
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
-			}
-		}
+	uint32_t queue_id;
+	void *producer;
+};
+
+static COMMAND_QUEUE_THREAD_LOCAL CommandQueueLocalLane _local_lanes[COMMAND_QUEUE_LOCAL_LANES];
+static uint32_t _last_queue_id = 0;
+
+CommandQueueMT::Producer *CommandQueueMT::_get_producer() {
+
+	CommandQueueLocalLane &local = _local_lanes[id % COMMAND_QUEUE_LOCAL_LANES];
+
+	if (local.queue_id == id)
+		return (Producer *)local.producer;
+
+	if (local.producer)
+		_release_producer((Producer *)local.producer);
+
+	Producer *producer = _acquire_producer();
+	local.queue_id = id;
+	local.producer = producer;
+	return producer;
+}
+
+CommandQueueMT::Producer *CommandQueueMT::_acquire_producer() {
+
+	lock();
+
+	ProducerTable *table = producer_table;
 
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
+	for (uint32_t i = 0; i < table->count; i++) {
+
+		Producer *producer = table->producers[i];
+		if (static_cast<uint32_t const volatile &>(producer->released) && atomic_compare_exchange(&producer->released, 1, 0) == 1) {
+			// the last owner is gone, carry on writing after its commands
+			atomic_increment(&producer->refcount);
+			unlock();
+			return producer;
 		}
 	}
 
-	return &sync_sems[idx];
+	Producer *producer = memnew(Producer);
+	producer->refcount = 2;
+	producer->released = 0;
+	producer->sync_sem = Semaphore::create();
+	producer->write_block = _alloc_block(BLOCK_MIN_SIZE);
+	producer->pending = NULL;
+	producer->read_block = producer->write_block;
+	producer->read_pos = 0;
+
+	// tables are copied on write, the consumer may still be scanning the old one
+	ProducerTable *new_table = (ProducerTable *)memalloc(sizeof(ProducerTable) + sizeof(Producer *) * table->count);
+	for (uint32_t i = 0; i < table->count; i++) {
+		new_table->producers[i] = table->producers[i];
+	}
+	new_table->producers[table->count] = producer;
+	new_table->count = table->count + 1;
+
+	atomic_memory_barrier();
+	producer_table = new_table;
+	retired_tables.push_back(table);
+
+	unlock();
+
+	return producer;
 }
 
-CommandQueueMT::CommandQueueMT(bool p_sync) {
+void CommandQueueMT::_release_producer(Producer *p_producer) {
 
-	read_ptr = 0;
-	write_ptr = 0;
-	mutex = Mutex::create();
+	// the queue may be gone already, only the lane itself can be touched
+	atomic_memory_barrier();
+	p_producer->released = 1;
+	_unref_producer(p_producer);
+}
+
+void CommandQueueMT::_unref_producer(Producer *p_producer) {
+
+	if (atomic_decrement(&p_producer->refcount) == 0)
+		memdelete(p_producer);
+}
 
-	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
+void CommandQueueMT::thread_exit() {
 
-		sync_sems[i].sem = Semaphore::create();
-		sync_sems[i].in_use = false;
+	for (int i = 0; i < COMMAND_QUEUE_LOCAL_LANES; i++) {
+
+		CommandQueueLocalLane &local = _local_lanes[i];
+		if (local.producer)
+			_release_producer((Producer *)local.producer);
+		local.queue_id = 0;
+		local.producer = NULL;
 	}
+}
+
+void CommandQueueMT::_wake_consumer() {
+
+	if (atomic_compare_exchange(&sleeping, 1, 0) == 1)
+		sync->post();
+}
+
+CommandQueueMT::CommandQueueMT(bool p_sync) {
+
+	producer_table = (ProducerTable *)memalloc(sizeof(ProducerTable));
+	producer_table->count = 0;
+	id = atomic_increment(&_last_queue_id);
+	issued_seq = 0;
+	read_seq = 0;
+	skipped = 0;
+	sleeping = 0;
+	read_hint = NULL;
+	mutex = Mutex::create();
+
 	if (p_sync)
 		sync = Semaphore::create();
 	else
@@ -93,11 +186,40 @@ CommandQueueMT::CommandQueueMT(bool p_sync) {
 
 CommandQueueMT::~CommandQueueMT() {
 
-	if (sync)
-		memdelete(sync);
-	memdelete(mutex);
-	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
+	ProducerTable *table = producer_table;
+
+	for (uint32_t i = 0; i < table->count; i++) {
+
+		Producer *producer = table->producers[i];
+		Block *block = producer->read_block;
+		while (block) {
+			Block *next = block->next;
+			memfree(block);
+			block = next;
+		}
+		if (producer->sync_sem)
+			memdelete(producer->sync_sem);
+		producer->sync_sem = NULL;
+		producer->read_block = NULL;
+		producer->write_block = NULL;
+		_unref_producer(producer); // threads still holding the lane free it when they exit
+	}
 
-		memdelete(sync_sems[i].sem);
+	// the calling thread won't push here again
+	CommandQueueLocalLane &local = _local_lanes[id % COMMAND_QUEUE_LOCAL_LANES];
+	if (local.queue_id == id) {
+		_unref_producer((Producer *)local.producer);
+		local.queue_id = 0;
+		local.producer = NULL;
 	}
+
+	memfree(table);
+	for (int i = 0; i < retired_tables.size(); i++) {
+		memfree(retired_tables[i]);
+	}
+
+	if (sync)
+		memdelete(sync);
+	if (mutex)
+		memdelete(mutex);
 }
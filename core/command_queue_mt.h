@@ -33,20 +33,17 @@
 #include "os/memory.h"
 #include "os/mutex.h"
 #include "os/semaphore.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
 #include "simple_type.h"
 #include "typedefs.h"
+#include "vector.h"
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
 
 class CommandQueueMT {
 
-	struct SyncSemaphore {
-
-		Semaphore *sem;
-		bool in_use;
-	};
-
 	struct CommandBase {
 
 		virtual void call() = 0;
@@ -178,12 +175,11 @@ class CommandQueueMT {
 		T *instance;
 		M method;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)();
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -194,12 +190,11 @@ class CommandQueueMT {
 		M method;
 		typename GetSimpleTypeT<P1>::type_t p1;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -211,12 +206,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P1>::type_t p1;
 		typename GetSimpleTypeT<P2>::type_t p2;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -229,12 +223,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P2>::type_t p2;
 		typename GetSimpleTypeT<P3>::type_t p3;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -248,12 +241,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P3>::type_t p3;
 		typename GetSimpleTypeT<P4>::type_t p4;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3, p4);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -268,12 +260,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P4>::type_t p4;
 		typename GetSimpleTypeT<P5>::type_t p5;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3, p4, p5);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -289,12 +280,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P5>::type_t p5;
 		typename GetSimpleTypeT<P6>::type_t p6;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3, p4, p5, p6);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -311,12 +301,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P6>::type_t p6;
 		typename GetSimpleTypeT<P7>::type_t p7;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3, p4, p5, p6, p7);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -334,12 +323,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P7>::type_t p7;
 		typename GetSimpleTypeT<P8>::type_t p8;
 		R *ret;
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			*ret = (instance->*method)(p1, p2, p3, p4, p5, p6, p7, p8);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -353,12 +341,11 @@ class CommandQueueMT {
 		T *instance;
 		M method;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)();
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -369,12 +356,11 @@ class CommandQueueMT {
 		M method;
 		typename GetSimpleTypeT<P1>::type_t p1;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -386,12 +372,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P1>::type_t p1;
 		typename GetSimpleTypeT<P2>::type_t p2;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -404,12 +389,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P2>::type_t p2;
 		typename GetSimpleTypeT<P3>::type_t p3;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -423,12 +407,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P3>::type_t p3;
 		typename GetSimpleTypeT<P4>::type_t p4;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3, p4);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -443,12 +426,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P4>::type_t p4;
 		typename GetSimpleTypeT<P5>::type_t p5;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3, p4, p5);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -464,12 +446,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P5>::type_t p5;
 		typename GetSimpleTypeT<P6>::type_t p6;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3, p4, p5, p6);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -486,12 +467,11 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P6>::type_t p6;
 		typename GetSimpleTypeT<P7>::type_t p7;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3, p4, p5, p6, p7);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
@@ -509,120 +489,218 @@ class CommandQueueMT {
 		typename GetSimpleTypeT<P7>::type_t p7;
 		typename GetSimpleTypeT<P8>::type_t p8;
 
-		SyncSemaphore *sync;
+		Semaphore *sync;
 
 		virtual void call() {
 			(instance->*method)(p1, p2, p3, p4, p5, p6, p7, p8);
-			sync->sem->post();
-			sync->in_use = false;
+			sync->post();
 		}
 	};
 
 	/***** BASE *******/
 
+	/* Every producer thread gets its own lane, a chain of blocks only that
+	   thread writes to, so pushing never takes a lock. Threads find their lane
+	   through a thread local table and hand it back in thread_exit(), so the
+	   next new thread reuses it. Commands are stamped with a global sequence
+	   number and the consumer runs the lowest one published so far. A command
+	   whose sequence was taken but not published yet is skipped rather than
+	   waited for: its push has not returned, so it is not ordered against the
+	   others yet. Lanes and blocks are only ever touched by their producer and
+	   the single consumer thread. */
+
 	enum {
-		COMMAND_MEM_SIZE_KB = 256,
-		COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
-		SYNC_SEMAPHORES = 8
+		BLOCK_MIN_SIZE = 4 * 1024,
+		BLOCK_MAX_SIZE = 1024 * 1024,
+		COMMAND_ALIGN = 8
+	};
+
+	struct CommandHeader {
+
+		uint32_t size; // header included
+		uint32_t seq;
+	};
+
+	struct Block {
+
+		Block *volatile next; // set by the producer once the block is full, after its last command
+		uint32_t capacity;
+		volatile uint32_t write_pos; // published by the producer
+		uint32_t pad;
+
+		_FORCE_INLINE_ uint8_t *get_data() { return reinterpret_cast<uint8_t *>(this + 1); }
+	};
+
+	struct Producer {
+
+		uint32_t refcount; // held by the queue and by the thread owning the lane
+		uint32_t released; // owner gave the lane back, the next new thread takes it over
+		Semaphore *sync_sem; // one is enough, a thread can only wait on a single command
+
+		// producer side
+		Block *write_block;
+		CommandHeader *pending;
+
+		// consumer side
+		Block *read_block;
+		uint32_t read_pos;
+	};
+
+	struct ProducerTable {
+
+		uint32_t count;
+		Producer *producers[1]; // count entries, never modified once published
 	};
 
-	uint8_t command_mem[COMMAND_MEM_SIZE];
-	uint32_t read_ptr;
-	uint32_t write_ptr;
-	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
+	ProducerTable *volatile producer_table;
+	Vector<ProducerTable *> retired_tables; // still visible to the consumer scanning them, freed on exit
+	uint32_t id; // identifies the queue in the thread local lane tables
+	uint32_t issued_seq; // next sequence handed to a producer
+	uint32_t read_seq; // one past the highest sequence the consumer ran
+	uint32_t skipped; // sequences below read_seq not run yet
+	uint32_t sleeping; // consumer is waiting on sync
+	Producer *read_hint;
 	Mutex *mutex;
 	Semaphore *sync;
 
+	Block *_alloc_block(uint32_t p_capacity);
+	Producer *_acquire_producer();
+	static void _release_producer(Producer *p_producer);
+	static void _unref_producer(Producer *p_producer);
+	void _wake_consumer();
+
+	Producer *_get_producer();
+
 	template <class T>
-	T *allocate() {
+	T *allocate(Producer *p_producer) {
 
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = sizeof(T) + sizeof(uint32_t);
+		uint32_t alloc_size = (sizeof(CommandHeader) + sizeof(T) + COMMAND_ALIGN - 1) & ~uint32_t(COMMAND_ALIGN - 1);
 
-	tryagain:
+		Block *block = p_producer->write_block;
 
-		if (write_ptr < read_ptr) {
-			// behind read_ptr, check that there is room
-			if ((read_ptr - write_ptr) <= alloc_size)
-				return NULL;
-		} else if (write_ptr >= read_ptr) {
-			// ahead of read_ptr, check that there is room
+		if (block->capacity - block->write_pos < alloc_size) {
+			// full, chain a bigger block; the consumer frees this one once drained
+			Block *new_block = _alloc_block(MAX(MIN(block->capacity * 2, (uint32_t)BLOCK_MAX_SIZE), alloc_size));
+			atomic_memory_barrier();
+			block->next = new_block;
+			p_producer->write_block = new_block;
+			block = new_block;
+		}
+
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(block->get_data() + block->write_pos);
+		header->size = alloc_size;
+		p_producer->pending = header;
 
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + 4) {
-				// no room at the end, wrap down;
+		return memnew_placement(header + 1, T);
+	}
 
-				if (read_ptr == 0) // don't want write_ptr to become read_ptr
-					return NULL;
+	_FORCE_INLINE_ void commit(Producer *p_producer) {
 
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < sizeof(uint32_t), NULL);
-				// zero means, wrap to beginning
+		Block *block = p_producer->write_block;
 
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 0;
-				write_ptr = 0;
-				goto tryagain;
-			}
+		p_producer->pending->seq = atomic_increment(&issued_seq) - 1;
+		atomic_memory_barrier();
+		block->write_pos = block->write_pos + p_producer->pending->size;
+
+		if (sync) {
+			// only the push that finds the consumer asleep pays for a wakeup
+			atomic_memory_barrier();
+			if (static_cast<uint32_t const volatile &>(sleeping))
+				_wake_consumer();
 		}
-		// allocate the size
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = sizeof(T);
-		write_ptr += sizeof(uint32_t);
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += sizeof(T);
-		return cmd;
 	}
 
-	template <class T>
-	T *allocate_and_lock() {
+	_FORCE_INLINE_ CommandHeader *_peek(Producer *p_producer) {
+
+		while (true) {
+
+			Block *block = p_producer->read_block;
+			uint32_t write_pos = block->write_pos;
+
+			if (p_producer->read_pos != write_pos) {
+				atomic_memory_barrier();
+				return reinterpret_cast<CommandHeader *>(block->get_data() + p_producer->read_pos);
+			}
+
+			Block *next = block->next;
+			if (!next)
+				return NULL;
+
+			atomic_memory_barrier();
+			if (p_producer->read_pos != block->write_pos)
+				continue; // published right before the block was sealed
+
+			p_producer->read_block = next;
+			p_producer->read_pos = 0;
+			memfree(block);
+		}
+	}
 
-		lock();
-		T *ret;
+	_FORCE_INLINE_ void _run(Producer *p_producer, CommandHeader *p_header) {
 
-		while ((ret = allocate<T>()) == NULL) {
+		CommandBase *cmd = reinterpret_cast<CommandBase *>(p_header + 1);
 
-			unlock();
-			// sleep a little until fetch happened and some room is made
-			wait_for_flush();
-			lock();
+		int32_t ahead = int32_t(p_header->seq - read_seq);
+		if (ahead >= 0) {
+			skipped += ahead;
+			read_seq = p_header->seq + 1;
+		} else {
+			skipped--; // a skipped one was published meanwhile
 		}
+		read_hint = p_producer;
+		p_producer->read_pos += p_header->size;
 
-		return ret;
+		cmd->call();
+		cmd->~CommandBase();
 	}
 
 	bool flush_one() {
 
-	tryagain:
+		// nothing skipped, so the next sequence is the lowest one possible
+		if (read_hint && !skipped) {
+			CommandHeader *header = _peek(read_hint);
+			if (header && header->seq == read_seq) {
+				_run(read_hint, header);
+				return true;
+			}
+		}
 
-		// tried to read an empty queue
-		if (read_ptr == write_ptr)
-			return false;
+		Producer *lowest = NULL;
+		CommandHeader *lowest_header = NULL;
 
-		uint32_t size = *(uint32_t *)(&command_mem[read_ptr]);
+		while (true) {
 
-		if (size == 0) {
-			//end of ringbuffer, wrap
-			read_ptr = 0;
-			goto tryagain;
-		}
+			bool lowered = false;
+			ProducerTable *table = producer_table;
 
-		read_ptr += sizeof(uint32_t);
+			for (uint32_t i = 0; i < table->count; i++) {
 
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
+				Producer *producer = table->producers[i];
+				CommandHeader *header = _peek(producer);
+				if (header && (!lowest_header || int32_t(header->seq - lowest_header->seq) < 0)) {
+					lowest = producer;
+					lowest_header = header;
+					lowered = true;
+				}
+			}
 
-		cmd->call();
-		cmd->~CommandBase();
+			if (!lowest)
+				return false; // tried to read an empty queue
+
+			if (!lowered || (lowest_header->seq == read_seq && !skipped))
+				break;
 
-		read_ptr += size;
+			// a lane read before the lowest command showed up may have missed one pushed
+			// before it, which is published by now, so scan again until nothing lower appears
+			atomic_memory_barrier();
+		}
 
+		_run(lowest, lowest_header);
 		return true;
 	}
 
 	void lock();
 	void unlock();
-	void wait_for_flush();
-	SyncSemaphore *_alloc_sync_sem();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -630,49 +708,47 @@ public:
 	template <class T, class M>
 	void push(T *p_instance, M p_method) {
 
-		Command0<T, M> *cmd = allocate_and_lock<Command0<T, M> >();
+		Producer *producer = _get_producer();
+		Command0<T, M> *cmd = allocate<Command0<T, M> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1>
 	void push(T *p_instance, M p_method, P1 p1) {
 
-		Command1<T, M, P1> *cmd = allocate_and_lock<Command1<T, M, P1> >();
+		Producer *producer = _get_producer();
+		Command1<T, M, P1> *cmd = allocate<Command1<T, M, P1> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2) {
 
-		Command2<T, M, P1, P2> *cmd = allocate_and_lock<Command2<T, M, P1, P2> >();
+		Producer *producer = _get_producer();
+		Command2<T, M, P1, P2> *cmd = allocate<Command2<T, M, P1, P2> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 		cmd->p2 = p2;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3) {
 
-		Command3<T, M, P1, P2, P3> *cmd = allocate_and_lock<Command3<T, M, P1, P2, P3> >();
+		Producer *producer = _get_producer();
+		Command3<T, M, P1, P2, P3> *cmd = allocate<Command3<T, M, P1, P2, P3> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -680,15 +756,14 @@ public:
 		cmd->p2 = p2;
 		cmd->p3 = p3;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4) {
 
-		Command4<T, M, P1, P2, P3, P4> *cmd = allocate_and_lock<Command4<T, M, P1, P2, P3, P4> >();
+		Producer *producer = _get_producer();
+		Command4<T, M, P1, P2, P3, P4> *cmd = allocate<Command4<T, M, P1, P2, P3, P4> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -697,15 +772,14 @@ public:
 		cmd->p3 = p3;
 		cmd->p4 = p4;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5) {
 
-		Command5<T, M, P1, P2, P3, P4, P5> *cmd = allocate_and_lock<Command5<T, M, P1, P2, P3, P4, P5> >();
+		Producer *producer = _get_producer();
+		Command5<T, M, P1, P2, P3, P4, P5> *cmd = allocate<Command5<T, M, P1, P2, P3, P4, P5> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -715,15 +789,14 @@ public:
 		cmd->p4 = p4;
 		cmd->p5 = p5;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6) {
 
-		Command6<T, M, P1, P2, P3, P4, P5, P6> *cmd = allocate_and_lock<Command6<T, M, P1, P2, P3, P4, P5, P6> >();
+		Producer *producer = _get_producer();
+		Command6<T, M, P1, P2, P3, P4, P5, P6> *cmd = allocate<Command6<T, M, P1, P2, P3, P4, P5, P6> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -734,15 +807,14 @@ public:
 		cmd->p5 = p5;
 		cmd->p6 = p6;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7) {
 
-		Command7<T, M, P1, P2, P3, P4, P5, P6, P7> *cmd = allocate_and_lock<Command7<T, M, P1, P2, P3, P4, P5, P6, P7> >();
+		Producer *producer = _get_producer();
+		Command7<T, M, P1, P2, P3, P4, P5, P6, P7> *cmd = allocate<Command7<T, M, P1, P2, P3, P4, P5, P6, P7> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -754,15 +826,14 @@ public:
 		cmd->p6 = p6;
 		cmd->p7 = p7;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7, class P8>
 	void push(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7, P8 p8) {
 
-		Command8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> *cmd = allocate_and_lock<Command8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> >();
+		Producer *producer = _get_producer();
+		Command8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> *cmd = allocate<Command8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -775,70 +846,66 @@ public:
 		cmd->p7 = p7;
 		cmd->p8 = p8;
 
-		unlock();
-
-		if (sync) sync->post();
+		commit(producer);
 	}
 	/*** PUSH AND RET COMMANDS ***/
 
 	template <class T, class M, class R>
 	void push_and_ret(T *p_instance, M p_method, R *r_ret) {
 
-		CommandRet0<T, M, R> *cmd = allocate_and_lock<CommandRet0<T, M, R> >();
+		Producer *producer = _get_producer();
+		CommandRet0<T, M, R> *cmd = allocate<CommandRet0<T, M, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, R *r_ret) {
 
-		CommandRet1<T, M, P1, R> *cmd = allocate_and_lock<CommandRet1<T, M, P1, R> >();
+		Producer *producer = _get_producer();
+		CommandRet1<T, M, P1, R> *cmd = allocate<CommandRet1<T, M, P1, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, R *r_ret) {
 
-		CommandRet2<T, M, P1, P2, R> *cmd = allocate_and_lock<CommandRet2<T, M, P1, P2, R> >();
+		Producer *producer = _get_producer();
+		CommandRet2<T, M, P1, P2, R> *cmd = allocate<CommandRet2<T, M, P1, P2, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 		cmd->p2 = p2;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, R *r_ret) {
 
-		CommandRet3<T, M, P1, P2, P3, R> *cmd = allocate_and_lock<CommandRet3<T, M, P1, P2, P3, R> >();
+		Producer *producer = _get_producer();
+		CommandRet3<T, M, P1, P2, P3, R> *cmd = allocate<CommandRet3<T, M, P1, P2, P3, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -846,19 +913,18 @@ public:
 		cmd->p2 = p2;
 		cmd->p3 = p3;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, R *r_ret) {
 
-		CommandRet4<T, M, P1, P2, P3, P4, R> *cmd = allocate_and_lock<CommandRet4<T, M, P1, P2, P3, P4, R> >();
+		Producer *producer = _get_producer();
+		CommandRet4<T, M, P1, P2, P3, P4, R> *cmd = allocate<CommandRet4<T, M, P1, P2, P3, P4, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -867,19 +933,18 @@ public:
 		cmd->p3 = p3;
 		cmd->p4 = p4;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, R *r_ret) {
 
-		CommandRet5<T, M, P1, P2, P3, P4, P5, R> *cmd = allocate_and_lock<CommandRet5<T, M, P1, P2, P3, P4, P5, R> >();
+		Producer *producer = _get_producer();
+		CommandRet5<T, M, P1, P2, P3, P4, P5, R> *cmd = allocate<CommandRet5<T, M, P1, P2, P3, P4, P5, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -889,19 +954,18 @@ public:
 		cmd->p4 = p4;
 		cmd->p5 = p5;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, R *r_ret) {
 
-		CommandRet6<T, M, P1, P2, P3, P4, P5, P6, R> *cmd = allocate_and_lock<CommandRet6<T, M, P1, P2, P3, P4, P5, P6, R> >();
+		Producer *producer = _get_producer();
+		CommandRet6<T, M, P1, P2, P3, P4, P5, P6, R> *cmd = allocate<CommandRet6<T, M, P1, P2, P3, P4, P5, P6, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -912,19 +976,18 @@ public:
 		cmd->p5 = p5;
 		cmd->p6 = p6;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7, R *r_ret) {
 
-		CommandRet7<T, M, P1, P2, P3, P4, P5, P6, P7, R> *cmd = allocate_and_lock<CommandRet7<T, M, P1, P2, P3, P4, P5, P6, P7, R> >();
+		Producer *producer = _get_producer();
+		CommandRet7<T, M, P1, P2, P3, P4, P5, P6, P7, R> *cmd = allocate<CommandRet7<T, M, P1, P2, P3, P4, P5, P6, P7, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -936,19 +999,18 @@ public:
 		cmd->p6 = p6;
 		cmd->p7 = p7;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7, class P8, class R>
 	void push_and_ret(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7, P8 p8, R *r_ret) {
 
-		CommandRet8<T, M, P1, P2, P3, P4, P5, P6, P7, P8, R> *cmd = allocate_and_lock<CommandRet8<T, M, P1, P2, P3, P4, P5, P6, P7, P8, R> >();
+		Producer *producer = _get_producer();
+		CommandRet8<T, M, P1, P2, P3, P4, P5, P6, P7, P8, R> *cmd = allocate<CommandRet8<T, M, P1, P2, P3, P4, P5, P6, P7, P8, R> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -961,73 +1023,69 @@ public:
 		cmd->p7 = p7;
 		cmd->p8 = p8;
 		cmd->ret = r_ret;
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M>
 	void push_and_sync(T *p_instance, M p_method) {
 
-		CommandSync0<T, M> *cmd = allocate_and_lock<CommandSync0<T, M> >();
+		Producer *producer = _get_producer();
+		CommandSync0<T, M> *cmd = allocate<CommandSync0<T, M> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1>
 	void push_and_sync(T *p_instance, M p_method, P1 p1) {
 
-		CommandSync1<T, M, P1> *cmd = allocate_and_lock<CommandSync1<T, M, P1> >();
+		Producer *producer = _get_producer();
+		CommandSync1<T, M, P1> *cmd = allocate<CommandSync1<T, M, P1> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2) {
 
-		CommandSync2<T, M, P1, P2> *cmd = allocate_and_lock<CommandSync2<T, M, P1, P2> >();
+		Producer *producer = _get_producer();
+		CommandSync2<T, M, P1, P2> *cmd = allocate<CommandSync2<T, M, P1, P2> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
 		cmd->p1 = p1;
 		cmd->p2 = p2;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3) {
 
-		CommandSync3<T, M, P1, P2, P3> *cmd = allocate_and_lock<CommandSync3<T, M, P1, P2, P3> >();
+		Producer *producer = _get_producer();
+		CommandSync3<T, M, P1, P2, P3> *cmd = allocate<CommandSync3<T, M, P1, P2, P3> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1035,19 +1093,18 @@ public:
 		cmd->p2 = p2;
 		cmd->p3 = p3;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4) {
 
-		CommandSync4<T, M, P1, P2, P3, P4> *cmd = allocate_and_lock<CommandSync4<T, M, P1, P2, P3, P4> >();
+		Producer *producer = _get_producer();
+		CommandSync4<T, M, P1, P2, P3, P4> *cmd = allocate<CommandSync4<T, M, P1, P2, P3, P4> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1056,19 +1113,18 @@ public:
 		cmd->p3 = p3;
 		cmd->p4 = p4;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5) {
 
-		CommandSync5<T, M, P1, P2, P3, P4, P5> *cmd = allocate_and_lock<CommandSync5<T, M, P1, P2, P3, P4, P5> >();
+		Producer *producer = _get_producer();
+		CommandSync5<T, M, P1, P2, P3, P4, P5> *cmd = allocate<CommandSync5<T, M, P1, P2, P3, P4, P5> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1078,19 +1134,18 @@ public:
 		cmd->p4 = p4;
 		cmd->p5 = p5;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6) {
 
-		CommandSync6<T, M, P1, P2, P3, P4, P5, P6> *cmd = allocate_and_lock<CommandSync6<T, M, P1, P2, P3, P4, P5, P6> >();
+		Producer *producer = _get_producer();
+		CommandSync6<T, M, P1, P2, P3, P4, P5, P6> *cmd = allocate<CommandSync6<T, M, P1, P2, P3, P4, P5, P6> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1101,19 +1156,18 @@ public:
 		cmd->p5 = p5;
 		cmd->p6 = p6;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7) {
 
-		CommandSync7<T, M, P1, P2, P3, P4, P5, P6, P7> *cmd = allocate_and_lock<CommandSync7<T, M, P1, P2, P3, P4, P5, P6, P7> >();
+		Producer *producer = _get_producer();
+		CommandSync7<T, M, P1, P2, P3, P4, P5, P6, P7> *cmd = allocate<CommandSync7<T, M, P1, P2, P3, P4, P5, P6, P7> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1125,19 +1179,18 @@ public:
 		cmd->p6 = p6;
 		cmd->p7 = p7;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
 	template <class T, class M, class P1, class P2, class P3, class P4, class P5, class P6, class P7, class P8>
 	void push_and_sync(T *p_instance, M p_method, P1 p1, P2 p2, P3 p3, P4 p4, P5 p5, P6 p6, P7 p7, P8 p8) {
 
-		CommandSync8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> *cmd = allocate_and_lock<CommandSync8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> >();
+		Producer *producer = _get_producer();
+		CommandSync8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> *cmd = allocate<CommandSync8<T, M, P1, P2, P3, P4, P5, P6, P7, P8> >(producer);
 
 		cmd->instance = p_instance;
 		cmd->method = p_method;
@@ -1150,35 +1203,45 @@ public:
 		cmd->p7 = p7;
 		cmd->p8 = p8;
 
-		SyncSemaphore *ss = _alloc_sync_sem();
-		cmd->sync = ss;
+		cmd->sync = producer->sync_sem;
 
-		unlock();
+		commit(producer);
 
-		if (sync) sync->post();
-		ss->sem->wait();
+		producer->sync_sem->wait();
 	}
 
+	/* FLUSHING, only ever from a single consumer thread */
+
 	void wait_and_flush_one() {
 		ERR_FAIL_COND(!sync);
-		sync->wait();
-		lock();
-		flush_one();
-		unlock();
+
+		while (!flush_one()) {
+
+			atomic_compare_exchange(&sleeping, 0, 1);
+
+			if (flush_one()) {
+				// something arrived meanwhile, if a producer already claimed the wakeup, eat its post
+				if (atomic_compare_exchange(&sleeping, 1, 0) == 0)
+					sync->wait();
+				return;
+			}
+
+			sync->wait();
+		}
 	}
 
 	void flush_all() {
 
-		//ERR_FAIL_COND(sync);
-		lock();
 		while (true) {
 			bool exit = !flush_one();
 			if (exit)
 				break;
 		}
-		unlock();
 	}
 
+	int get_lane_count() const { return producer_table->count; } ///< lanes ever registered, for tests and stats
+	static void thread_exit(); ///< call before a thread ends, hands its lanes over to the next new threads
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
@@ -44,4 +44,9 @@ CoreStringNames::CoreStringNames() {
 	_iter_next = StaticCString::create("_iter_next");
 	_iter_get = StaticCString::create("_iter_get");
 	get_rid = StaticCString::create("get_rid");
+	resource_changed = StaticCString::create("resource_changed");
+	_input_text = StaticCString::create("_input_text");
+	_input_event = StaticCString::create("_input_event");
+	_iteration = StaticCString::create("_iteration");
+	_idle = StaticCString::create("_idle");
 }
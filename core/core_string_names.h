@@ -61,6 +61,11 @@ public:
 	StringName _iter_next;
 	StringName _iter_get;
 	StringName get_rid;
+	StringName resource_changed;
+	StringName _input_text;
+	StringName _input_event;
+	StringName _iteration;
+	StringName _idle;
 };
 
 #endif // SCENE_STRING_NAMES_H
@@ -35,35 +35,177 @@ PoolAllocator *MemoryPool::memory_pool = NULL;
 uint8_t *MemoryPool::pool_memory = NULL;
 size_t *MemoryPool::pool_size = NULL;
 
-MemoryPool::Alloc *MemoryPool::allocs = NULL;
+MemoryPool::Alloc **MemoryPool::alloc_chunks = NULL;
+uint32_t MemoryPool::alloc_chunk_count = 0;
+uint32_t MemoryPool::alloc_chunk_size = 0;
 MemoryPool::Alloc *MemoryPool::free_list = NULL;
 uint32_t MemoryPool::alloc_count = 0;
 uint32_t MemoryPool::allocs_used = 0;
 Mutex *MemoryPool::alloc_mutex = NULL;
 
-size_t MemoryPool::total_memory = 0;
-size_t MemoryPool::max_memory = 0;
+uint64_t MemoryPool::total_memory = 0;
+uint64_t MemoryPool::max_memory = 0;
 
-void MemoryPool::setup(uint32_t p_max_allocs) {
+/* Each thread keeps a few free allocs of its own, so taking and releasing one
+ * does not touch the shared list. They move in batches between the thread
+ * and the shared list, which grows by a whole chunk when it runs dry. */
 
-	allocs = memnew_arr(Alloc, p_max_allocs);
-	alloc_count = p_max_allocs;
-	allocs_used = 0;
+#if defined(NO_THREADS)
+#define MEMORY_POOL_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define MEMORY_POOL_THREAD_LOCAL __declspec(thread)
+#else
+#define MEMORY_POOL_THREAD_LOCAL __thread
+#endif
+
+static MEMORY_POOL_THREAD_LOCAL MemoryPool::Alloc *_thread_free_list = NULL;
+static MEMORY_POOL_THREAD_LOCAL uint32_t _thread_free_count = 0;
+
+static void _add_chunk() {
+
+	MemoryPool::Alloc *chunk = memnew_arr(MemoryPool::Alloc, MemoryPool::alloc_chunk_size);
+	ERR_FAIL_COND(!chunk);
+
+	MemoryPool::alloc_chunks = (MemoryPool::Alloc **)memrealloc(MemoryPool::alloc_chunks, sizeof(MemoryPool::Alloc *) * (MemoryPool::alloc_chunk_count + 1));
+	MemoryPool::alloc_chunks[MemoryPool::alloc_chunk_count++] = chunk;
+
+	for (uint32_t i = 0; i < MemoryPool::alloc_chunk_size - 1; i++) {
+
+		chunk[i].free_list = &chunk[i + 1];
+	}
+
+	chunk[MemoryPool::alloc_chunk_size - 1].free_list = MemoryPool::free_list;
+	MemoryPool::free_list = &chunk[0];
+	MemoryPool::alloc_count += MemoryPool::alloc_chunk_size;
+}
+
+MemoryPool::Alloc *MemoryPool::alloc_take() {
+
+	if (!_thread_free_list) {
+
+		alloc_mutex->lock();
+
+		for (int i = 0; i < THREAD_CACHE_BATCH; i++) {
+
+			if (!free_list) {
+				_add_chunk();
+				if (!free_list)
+					break;
+			}
+
+			Alloc *a = free_list;
+			free_list = a->free_list;
+			a->free_list = _thread_free_list;
+			_thread_free_list = a;
+			_thread_free_count++;
+		}
+
+		alloc_mutex->unlock();
+
+		ERR_FAIL_COND_V(!_thread_free_list, NULL);
+	}
+
+	Alloc *a = _thread_free_list;
+	_thread_free_list = a->free_list;
+	_thread_free_count--;
+
+	atomic_increment(&allocs_used);
+
+	a->refcount.init();
+	a->lock = 0;
+	a->mem = NULL;
+	a->pool_id = POOL_ALLOCATOR_INVALID_ID;
+	a->size = 0;
+	a->parent = NULL;
+	a->free_list = NULL;
+
+	return a;
+}
+
+static void _give_back(uint32_t p_count) {
+
+	MemoryPool::alloc_mutex->lock();
 
-	for (uint32_t i = 0; i < alloc_count - 1; i++) {
+	for (uint32_t i = 0; i < p_count && _thread_free_list; i++) {
 
-		allocs[i].free_list = &allocs[i + 1];
+		MemoryPool::Alloc *a = _thread_free_list;
+		_thread_free_list = a->free_list;
+		_thread_free_count--;
+		a->free_list = MemoryPool::free_list;
+		MemoryPool::free_list = a;
 	}
 
-	free_list = &allocs[0];
+	MemoryPool::alloc_mutex->unlock();
+}
+
+void MemoryPool::alloc_release(Alloc *p_alloc) {
+
+	p_alloc->mem = NULL;
+	p_alloc->size = 0;
+	p_alloc->parent = NULL;
+
+	p_alloc->free_list = _thread_free_list;
+	_thread_free_list = p_alloc;
+	_thread_free_count++;
+
+	atomic_decrement(&allocs_used);
+
+	if (_thread_free_count > THREAD_CACHE_MAX) {
+		//keep some around for this thread, hand the rest to others
+		_give_back(_thread_free_count - THREAD_CACHE_BATCH);
+	}
+}
+
+#ifdef DEBUG_ENABLED
+void MemoryPool::memory_changed(size_t p_old_size, size_t p_new_size) {
+
+	if (p_new_size > p_old_size) {
+		uint64_t total = atomic_add(&total_memory, p_new_size - p_old_size);
+		atomic_exchange_if_greater(&max_memory, total);
+	} else if (p_old_size > p_new_size) {
+		atomic_sub(&total_memory, p_old_size - p_new_size);
+	}
+}
+#endif
+
+void MemoryPool::setup(uint32_t p_chunk_size) {
+
+	alloc_chunk_size = MAX(p_chunk_size, (uint32_t)THREAD_CACHE_BATCH);
+	alloc_count = 0;
+	allocs_used = 0;
 
 	alloc_mutex = Mutex::create();
+
+	_add_chunk();
+}
+
+void MemoryPool::thread_exit() {
+
+	if (alloc_mutex && _thread_free_list) {
+		_give_back(_thread_free_count);
+	}
 }
 
 void MemoryPool::cleanup() {
 
-	memdelete_arr(allocs);
+	_thread_free_list = NULL;
+	_thread_free_count = 0;
+
+	for (uint32_t i = 0; i < alloc_chunk_count; i++) {
+		memdelete_arr(alloc_chunks[i]);
+	}
+
+	if (alloc_chunks) {
+		memfree(alloc_chunks);
+	}
+
+	alloc_chunks = NULL;
+	alloc_chunk_count = 0;
+	free_list = NULL;
+	alloc_count = 0;
+
 	memdelete(alloc_mutex);
+	alloc_mutex = NULL;
 
 	ERR_EXPLAINC("There are still MemoryPool allocs in use at exit!");
 	ERR_FAIL_COND(allocs_used > 0);
@@ -53,6 +53,7 @@ struct MemoryPool {
 		PoolAllocator::ID pool_id;
 		size_t size;
 
+		Alloc *parent; //set for slices, which borrow the memory of another alloc
 		Alloc *free_list;
 
 		Alloc() {
@@ -60,19 +61,34 @@ struct MemoryPool {
 			lock = 0;
 			pool_id = POOL_ALLOCATOR_INVALID_ID;
 			size = 0;
+			parent = NULL;
 			free_list = NULL;
 		}
 	};
 
-	static Alloc *allocs;
+	enum {
+		THREAD_CACHE_BATCH = 64, //allocs moved at once between a thread and the shared list
+		THREAD_CACHE_MAX = THREAD_CACHE_BATCH * 4
+	};
+
+	static Alloc **alloc_chunks;
+	static uint32_t alloc_chunk_count;
+	static uint32_t alloc_chunk_size;
 	static Alloc *free_list;
 	static uint32_t alloc_count;
 	static uint32_t allocs_used;
 	static Mutex *alloc_mutex;
-	static size_t total_memory;
-	static size_t max_memory;
+	static uint64_t total_memory;
+	static uint64_t max_memory;
+
+	static Alloc *alloc_take(); ///< returns a cleared alloc with a refcount of 1, NULL only when out of memory
+	static void alloc_release(Alloc *p_alloc);
+#ifdef DEBUG_ENABLED
+	static void memory_changed(size_t p_old_size, size_t p_new_size);
+#endif
 
-	static void setup(uint32_t p_max_allocs = (1 << 16));
+	static void setup(uint32_t p_chunk_size = (1 << 12));
+	static void thread_exit();
 	static void cleanup();
 };
 
@@ -85,6 +101,46 @@ class PoolVector {
 
 	MemoryPool::Alloc *alloc;
 
+	static void _dispose(MemoryPool::Alloc *p_alloc) {
+
+		if (p_alloc->parent) {
+			//slices do not own their elements, only drop the reference to the owner
+			MemoryPool::Alloc *parent = p_alloc->parent;
+			MemoryPool::alloc_release(p_alloc);
+
+			if (parent->refcount.unref() == true) {
+				_dispose(parent);
+			}
+			return;
+		}
+
+		{
+			int cur_elements = p_alloc->size / sizeof(T);
+			T *elems = (T *)p_alloc->mem;
+
+			for (int i = 0; i < cur_elements; i++) {
+
+				elems[i].~T();
+			}
+		}
+
+#ifdef DEBUG_ENABLED
+		MemoryPool::memory_changed(p_alloc->size, 0);
+#endif
+
+		if (MemoryPool::memory_pool) {
+			//resize memory pool
+			//if none, create
+			//if some resize
+		} else {
+
+			if (p_alloc->mem) {
+				memfree(p_alloc->mem);
+			}
+			MemoryPool::alloc_release(p_alloc);
+		}
+	}
+
 	void _copy_on_write() {
 
 		if (!alloc)
@@ -92,41 +148,27 @@ class PoolVector {
 
 		//		ERR_FAIL_COND(alloc->lock>0); should not be illegal to lock this for copy on write, as it's a copy on write after all
 
-		if (alloc->refcount.get() == 1)
-			return; //nothing to do
+		if (alloc->refcount.get() == 1 && !alloc->parent)
+			return; //nothing to do, slices are always copied before writing since they share memory
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_EXPLAINC("All memory pool allocations are in use, can't COW.");
-			ERR_FAIL();
-		}
-
 		MemoryPool::Alloc *old_alloc = alloc;
 
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = MemoryPool::alloc_take();
+		if (!alloc) {
+			alloc = old_alloc;
+			ERR_EXPLAINC("Out of memory for pool allocations, can't COW.");
+			ERR_FAIL();
+		}
 
 		//copy the alloc data
 		alloc->size = old_alloc->size;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		alloc->lock = 0;
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
+		MemoryPool::memory_changed(0, alloc->size);
 #endif
 
-		MemoryPool::alloc_mutex->unlock();
-
 		if (MemoryPool::memory_pool) {
 
 		} else {
@@ -148,41 +190,8 @@ class PoolVector {
 		}
 
 		if (old_alloc->refcount.unref() == true) {
-//this should never happen but..
-
-#ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex->lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex->unlock();
-#endif
-
-			{
-				Write w;
-				w._ref(old_alloc);
-
-				int cur_elements = old_alloc->size / sizeof(T);
-				T *elems = (T *)w.ptr();
-				for (int i = 0; i < cur_elements; i++) {
-					elems[i].~T();
-				}
-			}
-
-			if (MemoryPool::memory_pool) {
-				//resize memory pool
-				//if none, create
-				//if some resize
-			} else {
-
-				memfree(old_alloc->mem);
-				old_alloc->mem = NULL;
-				old_alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
-			}
+			//this should never happen but..
+			_dispose(old_alloc);
 		}
 	}
 
@@ -207,44 +216,9 @@ class PoolVector {
 		if (!alloc)
 			return;
 
-		if (alloc->refcount.unref() == false) {
-			alloc = NULL;
-			return;
-		}
-
-		//must be disposed!
-
-		{
-			int cur_elements = alloc->size / sizeof(T);
-			Write w = write();
-
-			for (int i = 0; i < cur_elements; i++) {
-
-				w[i].~T();
-			}
-		}
-
-#ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex->lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex->unlock();
-#endif
-
-		if (MemoryPool::memory_pool) {
-			//resize memory pool
-			//if none, create
-			//if some resize
-		} else {
-
-			memfree(alloc->mem);
-			alloc->mem = NULL;
-			alloc->size = 0;
-
-			MemoryPool::alloc_mutex->lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex->unlock();
+		if (alloc->refcount.unref() == true) {
+			//must be disposed!
+			_dispose(alloc);
 		}
 
 		alloc = NULL;
@@ -412,18 +386,42 @@ public:
 			ERR_FAIL_COND_V(p_to < 0 || p_to >= size(), aux)
 		}
 
-		PoolVector<T> slice;
-		int span = 1 + p_to - p_from;
-		slice.resize(span);
-		Read r = read();
-		Write w = slice.write();
-		for (int i = 0; i < span; ++i) {
-			w[i] = r[p_from + i];
+		return slice(p_from, 1 + p_to - p_from);
+	}
+
+	/**
+	 * Returns a view of p_count elements starting at p_from, sharing memory with this array.
+	 * Nothing is copied unless the slice is written to; writing to this array
+	 * afterwards copies it instead, so the slice keeps seeing the old contents.
+	 */
+	PoolVector<T> slice(int p_from, int p_count) const {
+
+		PoolVector<T> view;
+		ERR_FAIL_COND_V(p_from < 0 || p_count < 0 || p_from + p_count > size(), view);
+
+		if (p_count == 0)
+			return view;
+
+		if (p_count == size()) {
+			view._reference(*this);
+			return view;
 		}
 
-		return slice;
+		MemoryPool::Alloc *owner = alloc->parent ? alloc->parent : alloc;
+
+		view.alloc = MemoryPool::alloc_take();
+		ERR_FAIL_COND_V(!view.alloc, view);
+
+		owner->refcount.ref();
+		view.alloc->parent = owner;
+		view.alloc->mem = (T *)alloc->mem + p_from;
+		view.alloc->size = sizeof(T) * p_count;
+
+		return view;
 	}
 
+	bool is_slice() const { return alloc && alloc->parent; }
+
 	Error insert(int p_pos, const T &p_val) {
 
 		int s = size();
@@ -519,25 +517,12 @@ Error PoolVector<T>::resize(int p_size) {
 			return OK; //nothing to do here
 
 		//must allocate something
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
-			ERR_EXPLAINC("All memory pool allocations are in use.");
+		alloc = MemoryPool::alloc_take();
+		if (!alloc) {
+			ERR_EXPLAINC("Out of memory for pool allocations.");
 			ERR_FAIL_V(ERR_OUT_OF_MEMORY);
 		}
 
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
-
-		//cleanup the alloc
-		alloc->size = 0;
-		alloc->refcount.init();
-		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex->unlock();
-
 	} else {
 
 		ERR_FAIL_COND_V(alloc->lock > 0, ERR_LOCKED); //can't resize if locked!
@@ -556,13 +541,7 @@ Error PoolVector<T>::resize(int p_size) {
 	_copy_on_write(); // make it unique
 
 #ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex->lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
-	}
-	MemoryPool::alloc_mutex->unlock();
+	MemoryPool::memory_changed(alloc->size, new_size);
 #endif
 
 	int cur_elements = alloc->size / sizeof(T);
@@ -607,21 +586,8 @@ Error PoolVector<T>::resize(int p_size) {
 			//if some resize
 		} else {
 
-			if (new_size == 0) {
-				memfree(alloc->mem);
-				alloc->mem = NULL;
-				alloc->size = 0;
-
-				MemoryPool::alloc_mutex->lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
-
-			} else {
-				alloc->mem = memrealloc(alloc->mem, new_size);
-				alloc->size = new_size;
-			}
+			alloc->mem = memrealloc(alloc->mem, new_size);
+			alloc->size = new_size;
 		}
 	}
 
@@ -29,7 +29,7 @@
 /*************************************************************************/
 #include "event_queue.h"
 
-Error EventQueue::push_call(uint32_t p_instance_ID, const StringName &p_method, VARIANT_ARG_DECLARE) {
+Error EventQueue::push_call(ObjectID p_instance_ID, const StringName &p_method, VARIANT_ARG_DECLARE) {
 
 	uint8_t room_needed = sizeof(Event);
 	int args = 0;
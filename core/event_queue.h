@@ -43,7 +43,7 @@ class EventQueue {
 
 	struct Event {
 
-		uint32_t instance_ID;
+		ObjectID instance_ID;
 		StringName method;
 		int args;
 	};
@@ -54,7 +54,7 @@ class EventQueue {
 	uint32_t buffer_size;
 
 public:
-	Error push_call(uint32_t p_instance_ID, const StringName &p_method, VARIANT_ARG_LIST);
+	Error push_call(ObjectID p_instance_ID, const StringName &p_method, VARIANT_ARG_LIST);
 	void flush_events();
 
 	EventQueue(uint32_t p_buffer_size = DEFAULT_EVENT_QUEUE_SIZE_KB * 1024);
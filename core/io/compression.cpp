@@ -34,6 +34,194 @@
 #include "fastlz.h"
 #include "zip_io.h"
 
+/* LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+ * Only raw blocks are produced and consumed, the size of the decompressed data
+ * must be known by the caller (as with the other modes). */
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+int Compression::lz4_acceleration = 1;
+
+static _FORCE_INLINE_ uint32_t _lz4_read32(const uint8_t *p_ptr) {
+
+	uint32_t v;
+	copymem(&v, p_ptr, 4);
+	return v;
+}
+
+static _FORCE_INLINE_ uint32_t _lz4_hash(uint32_t p_seq) {
+
+	return (p_seq * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static _FORCE_INLINE_ uint8_t *_lz4_write_length(uint8_t *p_dst, int p_len) {
+
+	while (p_len >= 255) {
+		*p_dst++ = 255;
+		p_len -= 255;
+	}
+	*p_dst++ = p_len;
+	return p_dst;
+}
+
+static uint8_t *_lz4_write_literals(uint8_t *p_dst, uint8_t *p_token, const uint8_t *p_src, int p_len) {
+
+	if (p_len >= 15) {
+		*p_token = 15 << 4;
+		p_dst = _lz4_write_length(p_dst, p_len - 15);
+	} else {
+		*p_token = p_len << 4;
+	}
+	copymem(p_dst, p_src, p_len);
+	return p_dst + p_len;
+}
+
+static int _lz4_compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, int p_acceleration) {
+
+	const uint8_t *ip = p_src;
+	const uint8_t *anchor = p_src;
+	const uint8_t *iend = p_src + p_src_size;
+	const uint8_t *mflimit = iend - LZ4_MF_LIMIT;
+	const uint8_t *matchlimit = iend - LZ4_LAST_LITERALS;
+	uint8_t *op = p_dst;
+
+	if (p_src_size > LZ4_MF_LIMIT) {
+
+		uint32_t table[1 << LZ4_HASH_BITS];
+		zeromem(table, sizeof(table));
+		uint32_t skip_trigger = MAX(p_acceleration, 1) << 6;
+
+		ip++;
+
+		while (true) {
+
+			//search for a match, stepping faster the longer nothing is found
+			const uint8_t *ref;
+			uint32_t attempts = skip_trigger;
+			while (true) {
+
+				uint32_t h = _lz4_hash(_lz4_read32(ip));
+				ref = p_src + table[h];
+				table[h] = ip - p_src;
+				if (ref < ip && ip - ref <= LZ4_MAX_OFFSET && _lz4_read32(ref) == _lz4_read32(ip))
+					break;
+
+				ip += attempts++ >> 6;
+				if (ip > mflimit)
+					goto last_literals;
+			}
+
+			while (ip > anchor && ref > p_src && ip[-1] == ref[-1]) {
+				ip--;
+				ref--;
+			}
+
+			uint8_t *token = op++;
+			op = _lz4_write_literals(op, token, anchor, ip - anchor);
+
+			*op++ = (ip - ref) & 0xFF;
+			*op++ = (ip - ref) >> 8;
+
+			const uint8_t *match_start = ip;
+			ip += LZ4_MIN_MATCH;
+			ref += LZ4_MIN_MATCH;
+			while (ip < matchlimit && *ip == *ref) {
+				ip++;
+				ref++;
+			}
+
+			int match_len = ip - match_start - LZ4_MIN_MATCH;
+			if (match_len >= 15) {
+				*token |= 15;
+				op = _lz4_write_length(op, match_len - 15);
+			} else {
+				*token |= match_len;
+			}
+
+			anchor = ip;
+			if (ip > mflimit)
+				break;
+
+			table[_lz4_hash(_lz4_read32(ip - 2))] = ip - 2 - p_src;
+		}
+	}
+
+last_literals:
+
+	uint8_t *token = op++;
+	op = _lz4_write_literals(op, token, anchor, iend - anchor);
+
+	return op - p_dst;
+}
+
+static int _lz4_decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size) {
+
+	const uint8_t *ip = p_src;
+	const uint8_t *iend = p_src + p_src_size;
+	uint8_t *op = p_dst;
+	uint8_t *oend = p_dst + p_dst_max_size;
+
+	while (ip < iend) {
+
+		uint8_t token = *ip++;
+
+		int len = token >> 4;
+		if (len == 15) {
+			uint8_t b;
+			do {
+				ERR_FAIL_COND_V(ip >= iend, -1);
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+		}
+
+		ERR_FAIL_COND_V(len > iend - ip || len > oend - op, -1);
+		copymem(op, ip, len);
+		ip += len;
+		op += len;
+
+		if (ip == iend)
+			break; //last sequence has no match
+
+		ERR_FAIL_COND_V(iend - ip < 2, -1);
+		int offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		ERR_FAIL_COND_V(offset == 0 || offset > op - p_dst, -1);
+
+		len = token & 15;
+		if (len == 15) {
+			uint8_t b;
+			do {
+				ERR_FAIL_COND_V(ip >= iend, -1);
+				b = *ip++;
+				len += b;
+			} while (b == 255);
+		}
+		len += LZ4_MIN_MATCH;
+		ERR_FAIL_COND_V(len > oend - op, -1);
+
+		//matches may overlap the bytes being written, so copy forward
+		const uint8_t *ref = op - offset;
+		if (offset >= 8) {
+			while (len >= 8) {
+				copymem(op, ref, 8);
+				op += 8;
+				ref += 8;
+				len -= 8;
+			}
+		}
+		while (len--) {
+			*op++ = *ref++;
+		}
+	}
+
+	return op - p_dst;
+}
+
 int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
 
 	switch (p_mode) {
@@ -74,6 +262,10 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,
 			return aout;
 
 		} break;
+		case MODE_LZ4: {
+
+			return _lz4_compress(p_dst, p_src, p_src_size, lz4_acceleration);
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
@@ -103,6 +295,10 @@ int Compression::get_max_compressed_buffer_size(int p_src_size, Mode p_mode) {
 			deflateEnd(&strm);
 			return aout;
 		} break;
+		case MODE_LZ4: {
+
+			return p_src_size + p_src_size / 255 + 16;
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
@@ -146,6 +342,10 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 			ERR_FAIL_COND_V(err != Z_STREAM_END, -1);
 			return total;
 		} break;
+		case MODE_LZ4: {
+
+			return _lz4_decompress(p_dst, p_dst_max_size, p_src, p_src_size);
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
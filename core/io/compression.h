@@ -36,9 +36,12 @@ class Compression {
 public:
 	enum Mode {
 		MODE_FASTLZ,
-		MODE_DEFLATE
+		MODE_DEFLATE,
+		MODE_LZ4
 	};
 
+	static int lz4_acceleration; // 1 gives the best ratio, higher values trade ratio for speed
+
 	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_FASTLZ);
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_FASTLZ);
 	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_FASTLZ);
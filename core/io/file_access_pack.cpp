@@ -28,11 +28,13 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "file_access_pack.h"
+#include "io/file_access_compressed.h"
+#include "os/copymem.h"
 #include "version.h"
 
 #include <stdio.h>
 
-#define PACK_VERSION 1
+#define PACK_VERSION 2
 
 Error PackedData::add_pack(const String &p_path) {
 
@@ -47,7 +49,7 @@ Error PackedData::add_pack(const String &p_path) {
 	return ERR_FILE_UNRECOGNIZED;
 };
 
-void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src) {
+void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_compressed) {
 
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -60,6 +62,7 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 	pf.size = size;
 	for (int i = 0; i < 16; i++)
 		pf.md5[i] = p_md5[i];
+	pf.compressed = p_compressed;
 	pf.src = p_src;
 
 	files[pmd5] = pf;
@@ -106,6 +109,11 @@ PackedData::PackedData() {
 	root = memnew(PackedDir);
 	root->parent = NULL;
 	disabled = false;
+#ifdef UNIX_ENABLED
+	use_mmap = true;
+#else
+	use_mmap = false;
+#endif
 
 	add_pack_source(memnew(PackedSourcePCK));
 }
@@ -165,10 +173,20 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 	uint32_t ver_minor = f->get_32();
 	uint32_t ver_rev = f->get_32();
 
-	ERR_EXPLAIN("Pack version unsupported: " + itos(version));
-	ERR_FAIL_COND_V(version != PACK_VERSION, ERR_INVALID_DATA);
-	ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor) + "." + itos(ver_rev));
-	ERR_FAIL_COND_V(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), ERR_INVALID_DATA);
+	if (version < 1 || version > PACK_VERSION) {
+
+		f->close();
+		memdelete(f);
+		ERR_EXPLAIN("Pack version unsupported: " + itos(version));
+		ERR_FAIL_V(false);
+	}
+	if (ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR)) {
+
+		f->close();
+		memdelete(f);
+		ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor) + "." + itos(ver_rev));
+		ERR_FAIL_V(false);
+	}
 
 	for (int i = 0; i < 16; i++) {
 		//reserved
@@ -192,17 +210,68 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		uint64_t size = f->get_64();
 		uint8_t md5[16];
 		f->get_buffer(md5, 16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
+		uint32_t flags = version >= 2 ? f->get_32() : 0;
+		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, flags & PACK_FILE_COMPRESSED);
 	};
 
+	//files opened from a previous load of this pack keep its mapping until they are closed
+	Map<String, MappedPack *>::Element *E = mapped_packs.find(p_path);
+	if (E) {
+		unref_mapped_pack(E->get());
+		mapped_packs.erase(E);
+	}
+
+	if (PackedData::get_singleton()->is_using_mmap() && f->map_memory()) {
+
+		MappedPack *mp = memnew(MappedPack);
+		mp->f = f;
+		mp->refcount.init();
+		mapped_packs[p_path] = mp;
+	} else {
+
+		memdelete(f);
+	}
+
 	return true;
 };
 
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
 
-	return memnew(FileAccessPack(p_path, *p_file));
+	Map<String, MappedPack *>::Element *E = mapped_packs.find(p_file->pack);
+
+	FileAccess *pack = memnew(FileAccessPack(p_path, *p_file, E ? E->get() : NULL));
+
+	if (!p_file->compressed)
+		return pack;
+
+	uint8_t magic[4];
+	if (pack->get_buffer(magic, 4) != 4 || memcmp(magic, "GCPF", 4) != 0) {
+
+		memdelete(pack);
+		ERR_EXPLAIN("Compressed file in pack has no compressed block header: " + p_path);
+		ERR_FAIL_V(NULL);
+	}
+
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->open_after_magic(pack); //takes ownership of pack
+	return fac;
 };
 
+void PackedSourcePCK::unref_mapped_pack(MappedPack *p_pack) {
+
+	if (p_pack->refcount.unref()) {
+		memdelete(p_pack->f);
+		memdelete(p_pack);
+	}
+}
+
+PackedSourcePCK::~PackedSourcePCK() {
+
+	for (Map<String, MappedPack *>::Element *E = mapped_packs.front(); E; E = E->next()) {
+		unref_mapped_pack(E->get());
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -213,12 +282,20 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 
 void FileAccessPack::close() {
 
-	f->close();
+	if (f)
+		f->close();
+	else if (mapped_pack) {
+		PackedSourcePCK::unref_mapped_pack(mapped_pack);
+		mapped_pack = NULL;
+		mapped = NULL;
+	}
 }
 
 bool FileAccessPack::is_open() const {
 
-	return f->is_open();
+	if (f)
+		return f->is_open();
+	return mapped != NULL;
 }
 
 void FileAccessPack::seek(size_t p_position) {
@@ -229,7 +306,8 @@ void FileAccessPack::seek(size_t p_position) {
 		eof = false;
 	}
 
-	f->seek(pf.offset + p_position);
+	if (f)
+		f->seek(pf.offset + p_position);
 	pos = p_position;
 }
 void FileAccessPack::seek_end(int64_t p_position) {
@@ -257,6 +335,9 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (mapped)
+		return mapped[pos++];
+
 	pos++;
 	return f->get_8();
 }
@@ -272,18 +353,25 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 		to_read = int64_t(pf.size) - int64_t(pos);
 	}
 
-	pos += p_length;
-
-	if (to_read <= 0)
+	if (to_read <= 0) {
+		pos += p_length;
 		return 0;
-	f->get_buffer(p_dst, to_read);
+	}
+
+	if (mapped)
+		copymem(p_dst, mapped + pos, to_read);
+	else
+		f->get_buffer(p_dst, to_read);
+
+	pos += p_length;
 
 	return to_read;
 }
 
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
-	f->set_endian_swap(p_swap);
+	if (f)
+		f->set_endian_swap(p_swap);
 }
 
 Error FileAccessPack::get_error() const {
@@ -308,22 +396,36 @@ bool FileAccessPack::file_exists(const String &p_name) {
 	return false;
 }
 
-FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) {
+FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, PackedSourcePCK::MappedPack *p_mapped_pack) {
 
 	pf = p_file;
+	pos = 0;
+	eof = false;
+
+	if (p_mapped_pack) {
+		//zero copy, the mapping stays alive until this file is closed, even if the pack is loaded again
+		p_mapped_pack->refcount.ref();
+		f = NULL;
+		mapped_pack = p_mapped_pack;
+		mapped = p_mapped_pack->f->get_mapped_data() + pf.offset;
+		return;
+	}
+
+	mapped_pack = NULL;
+	mapped = NULL;
 	f = FileAccess::open(pf.pack, FileAccess::READ);
 	if (!f) {
 		ERR_EXPLAIN("Can't open pack-referenced file: " + String(pf.pack));
 		ERR_FAIL_COND(!f);
 	}
 	f->seek(pf.offset);
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
 	if (f)
 		memdelete(f);
+	if (mapped_pack)
+		PackedSourcePCK::unref_mapped_pack(mapped_pack);
 }
 
 //////////////////////////////////////////////////////////////////////////////////
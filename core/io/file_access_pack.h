@@ -35,6 +35,7 @@
 #include "os/dir_access.h"
 #include "os/file_access.h"
 #include "print_string.h"
+#include "safe_refcount.h"
 
 class PackSource;
 
@@ -50,6 +51,7 @@ public:
 		uint64_t offset; //if offset is ZERO, the file was ERASED
 		uint64_t size;
 		uint8_t md5[16];
+		bool compressed; //stored as a FileAccessCompressed stream
 		PackSource *src;
 	};
 
@@ -96,16 +98,20 @@ private:
 
 	static PackedData *singleton;
 	bool disabled;
+	bool use_mmap;
 
 	void _free_packed_dirs(PackedDir *p_dir);
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src); // for PackSource
+	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_compressed = false); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
 
+	void set_use_mmap(bool p_enable) { use_mmap = p_enable; } ///< applies to packs added afterwards
+	_FORCE_INLINE_ bool is_using_mmap() const { return use_mmap; }
+
 	static PackedData *get_singleton() { return singleton; }
 	Error add_pack(const String &p_path);
 
@@ -119,16 +125,34 @@ public:
 class PackSource {
 
 public:
+	enum {
+		PACK_FILE_COMPRESSED = 1
+	};
+
+
 	virtual bool try_open_pack(const String &p_path) = 0;
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file) = 0;
 	virtual ~PackSource() {}
 };
 
 class PackedSourcePCK : public PackSource {
+public:
+	struct MappedPack {
+
+		FileAccess *f;
+		SafeRefCount refcount; // the source holds one, each FileAccessPack reading from it another
+	};
+
+	static void unref_mapped_pack(MappedPack *p_pack);
+
+private:
+	Map<String, MappedPack *> mapped_packs; // kept open, their files are read straight from memory
 
 public:
 	virtual bool try_open_pack(const String &p_path);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	virtual ~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -139,6 +163,8 @@ class FileAccessPack : public FileAccess {
 	mutable bool eof;
 
 	FileAccess *f;
+	PackedSourcePCK::MappedPack *mapped_pack;
+	const uint8_t *mapped; // start of this file inside a mapped pack, f is not used then
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 
@@ -157,6 +183,8 @@ public:
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
 
+	virtual const uint8_t *get_mapped_data() const { return mapped; }
+
 	virtual void set_endian_swap(bool p_swap);
 
 	virtual Error get_error() const;
@@ -167,7 +195,7 @@ public:
 
 	virtual bool file_exists(const String &p_name);
 
-	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file);
+	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, PackedSourcePCK::MappedPack *p_mapped_pack = NULL);
 	~FileAccessPack();
 };
 
@@ -29,7 +29,11 @@
 /*************************************************************************/
 #include "pck_packer.h"
 
+#include "core/io/file_access_compressed.h"
+#include "core/io/file_access_pack.h"
+#include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "version.h"
 
 static uint64_t _align(uint64_t p_n, int p_alignment) {
 
@@ -54,7 +58,9 @@ static void _pad(FileAccess *p_file, int p_bytes) {
 void PCKPacker::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment"), &PCKPacker::pck_start);
-	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path"), &PCKPacker::add_file);
+	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "compress"), &PCKPacker::add_file, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("set_compression_mode", "mode"), &PCKPacker::set_compression_mode);
+	ClassDB::bind_method(D_METHOD("get_compression_mode"), &PCKPacker::get_compression_mode);
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush);
 };
 
@@ -66,12 +72,13 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 		return ERR_CANT_CREATE;
 	};
 
+	pck_path = p_file;
 	alignment = p_alignment;
 
 	file->store_32(0x43504447); // MAGIC
-	file->store_32(0); // # version
-	file->store_32(0); // # major
-	file->store_32(0); // # minor
+	file->store_32(2); // # version
+	file->store_32(VERSION_MAJOR); // # major
+	file->store_32(VERSION_MINOR); // # minor
 	file->store_32(0); // # revision
 
 	for (int i = 0; i < 16; i++) {
@@ -84,7 +91,7 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 	return OK;
 };
 
-Error PCKPacker::add_file(const String &p_file, const String &p_src) {
+Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_compress) {
 
 	FileAccess *f = FileAccess::open(p_src, FileAccess::READ);
 	if (!f) {
@@ -96,6 +103,37 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src) {
 	pf.src_path = p_src;
 	pf.size = f->get_len();
 	pf.offset_offset = 0;
+	pf.compressed = false;
+
+	if (p_compress) {
+
+		Vector<uint8_t> data;
+		data.resize(pf.size);
+		f->get_buffer(data.ptr(), pf.size);
+
+		String tmp_path = pck_path + "." + itos(files.size()) + ".tmp";
+		FileAccessCompressed *fac = memnew(FileAccessCompressed);
+		fac->configure("GCPF", compression_mode, 65536);
+		Error err = fac->_open(tmp_path, FileAccess::WRITE);
+		if (err != OK) {
+			memdelete(fac);
+			memdelete(f);
+			ERR_FAIL_V(err);
+		}
+		fac->store_buffer(data.ptr(), data.size());
+		fac->close();
+		memdelete(fac);
+
+		FileAccess *tmp = FileAccess::open(tmp_path, FileAccess::READ);
+		if (!tmp) {
+			memdelete(f);
+			ERR_FAIL_V(ERR_FILE_CANT_OPEN);
+		}
+		pf.src_path = tmp_path;
+		pf.size = tmp->get_len();
+		pf.compressed = true;
+		memdelete(tmp);
+	}
 
 	files.push_back(pf);
 
@@ -105,6 +143,17 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src) {
 	return OK;
 };
 
+void PCKPacker::set_compression_mode(int p_mode) {
+
+	ERR_FAIL_INDEX(p_mode, Compression::MODE_LZ4 + 1);
+	compression_mode = Compression::Mode(p_mode);
+}
+
+int PCKPacker::get_compression_mode() const {
+
+	return compression_mode;
+}
+
 Error PCKPacker::flush(bool p_verbose) {
 
 	if (!file) {
@@ -128,6 +177,8 @@ Error PCKPacker::flush(bool p_verbose) {
 		file->store_32(0);
 		file->store_32(0);
 		file->store_32(0);
+
+		file->store_32(files[i].compressed ? PackSource::PACK_FILE_COMPRESSED : 0); // flags
 	};
 
 	uint64_t ofs = file->get_pos();
@@ -160,6 +211,11 @@ Error PCKPacker::flush(bool p_verbose) {
 
 		src->close();
 		memdelete(src);
+		if (files[i].compressed) {
+			DirAccess *da = DirAccess::create_for_path(files[i].src_path);
+			da->remove(files[i].src_path);
+			memdelete(da);
+		}
 		count += 1;
 		if (p_verbose) {
 			if (count % 100 == 0) {
@@ -181,6 +237,8 @@ Error PCKPacker::flush(bool p_verbose) {
 PCKPacker::PCKPacker() {
 
 	file = NULL;
+	alignment = 0;
+	compression_mode = Compression::MODE_LZ4;
 };
 
 PCKPacker::~PCKPacker() {
@@ -27,6 +27,7 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
+#include "core/io/compression.h"
 #include "core/reference.h"
 
 class FileAccess;
@@ -36,7 +37,9 @@ class PCKPacker : public Reference {
 	GDCLASS(PCKPacker, Reference);
 
 	FileAccess *file;
+	String pck_path;
 	int alignment;
+	Compression::Mode compression_mode;
 
 	static void _bind_methods();
 
@@ -46,12 +49,15 @@ class PCKPacker : public Reference {
 		String src_path;
 		int size;
 		uint64_t offset_offset;
+		bool compressed; //src_path is then a temporary file holding the compressed stream
 	};
 	Vector<File> files;
 
 public:
 	Error pck_start(const String &p_file, int p_alignment);
-	Error add_file(const String &p_file, const String &p_src);
+	Error add_file(const String &p_file, const String &p_src, bool p_compress = false);
+	void set_compression_mode(int p_mode);
+	int get_compression_mode() const;
 	Error flush(bool p_verbose = false);
 
 	PCKPacker();
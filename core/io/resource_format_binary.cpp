@@ -368,6 +368,11 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
 				case OBJECT_INTERNAL_RESOURCE: {
 					uint32_t index = f->get_32();
 					String path = res_path + "::" + itos(index);
+					const Map<String, RES>::Element *P = placeholder_paths.find(path);
+					if (P) {
+						r_v = P->get(); //parsing ahead, replaced once built
+						break;
+					}
 					RES res = ResourceLoader::load(path);
 					if (res.is_null()) {
 						WARN_PRINT(String("Couldn't load resource: " + path).utf8().get_data());
@@ -682,15 +687,74 @@ Error ResourceInteractiveLoaderBinary::poll() {
 		ERR_FAIL_COND_V(s >= internal_resources.size(), error);
 	}
 
+	if (parsed_resources.size()) {
+		//parsed ahead, only building is left
+		return _build_resource(s, parsed_resources[s]);
+	}
+
 	bool main = s == (internal_resources.size() - 1);
 
+	if (!main && ResourceCache::has(_get_internal_path(s))) {
+		//already loaded, don't do anything
+		stage++;
+		error = OK;
+		return error;
+	}
+
+	ParsedResource parsed;
+	error = _parse_resource(s, parsed);
+	if (error)
+		return error;
+
+	return _build_resource(s, parsed);
+}
+
+String ResourceInteractiveLoaderBinary::_get_internal_path(int p_index) const {
+
+	String path = internal_resources[p_index].path;
+	if (path.begins_with("local://")) {
+		path = res_path + "::" + path.replace_first("local://", "");
+	}
+	return path;
+}
+
+Error ResourceInteractiveLoaderBinary::_parse_resource(int p_index, ParsedResource &r_parsed) {
+
+	f->seek(internal_resources[p_index].offset);
+
+	r_parsed.type = get_unicode_string();
+
+	int pc = f->get_32();
+	r_parsed.properties.resize(pc);
+
+	for (int i = 0; i < pc; i++) {
+
+		ParsedProperty &property = r_parsed.properties[i];
+		property.name = _get_string();
+		if (property.name == StringName()) {
+			error = ERR_FILE_CORRUPT;
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
+
+		error = parse_variant(property.value);
+		if (error)
+			return error;
+	}
+
+	return OK;
+}
+
+Error ResourceInteractiveLoaderBinary::_build_resource(int p_index, ParsedResource &p_parsed) {
+
+	bool main = p_index == (internal_resources.size() - 1);
+
 	//maybe it is loaded already
 	String path;
 	int subindex = 0;
 
 	if (!main) {
 
-		path = internal_resources[s].path;
+		path = internal_resources[p_index].path;
 		if (path.begins_with("local://")) {
 			path = path.replace_first("local://", "");
 			subindex = path.to_int();
@@ -698,7 +762,10 @@ Error ResourceInteractiveLoaderBinary::poll() {
 		}
 
 		if (ResourceCache::has(path)) {
-			//already loaded, don't do anything
+			//loaded meanwhile, values parsed ahead get the cached one
+			if (p_parsed.placeholder.is_valid())
+				_set_placeholder_resource(p_parsed.placeholder, RES(ResourceCache::get(path)));
+			p_parsed.properties.clear();
 			stage++;
 			error = OK;
 			return error;
@@ -709,11 +776,7 @@ Error ResourceInteractiveLoaderBinary::poll() {
 			path = res_path;
 	}
 
-	uint64_t offset = internal_resources[s].offset;
-
-	f->seek(offset);
-
-	String t = get_unicode_string();
+	String t = p_parsed.type;
 
 	//	print_line("loading resource of type "+t+" path is "+path);
 
@@ -737,26 +800,21 @@ Error ResourceInteractiveLoaderBinary::poll() {
 	r->set_path(path);
 	r->set_subindex(subindex);
 
-	int pc = f->get_32();
+	if (p_parsed.placeholder.is_valid())
+		_set_placeholder_resource(p_parsed.placeholder, res);
 
 	//set properties
 
-	for (int i = 0; i < pc; i++) {
-
-		StringName name = _get_string();
-		if (name == StringName()) {
-			error = ERR_FILE_CORRUPT;
-			ERR_FAIL_V(ERR_FILE_CORRUPT);
-		}
-
-		Variant value;
+	for (int i = 0; i < p_parsed.properties.size(); i++) {
 
-		error = parse_variant(value);
-		if (error)
-			return error;
-
-		res->set(name, value);
+		const ParsedProperty &property = p_parsed.properties[i];
+		if (p_parsed.placeholder.is_valid())
+			res->set(property.name, _replace_placeholders(property.value));
+		else
+			res->set(property.name, property.value);
 	}
+	p_parsed.properties.clear();
+
 #ifdef TOOLS_ENABLED
 	res->set_edited(false);
 #endif
@@ -766,7 +824,8 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	if (main) {
 
-		f->close();
+		if (f)
+			f->close();
 		resource = res;
 		error = ERR_FILE_EOF;
 
@@ -776,6 +835,41 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
 	return OK;
 }
+
+Error ResourceInteractiveLoaderBinary::parse_ahead() {
+
+	while (error == OK && stage < external_resources.size()) {
+		poll();
+	}
+
+	if (error != OK)
+		return error;
+
+	//built-in resources are only referenced by the ones after them, give each a placeholder first
+	parsed_resources.resize(internal_resources.size());
+	for (int i = 0; i < internal_resources.size(); i++) {
+		parsed_resources[i].placeholder.instance();
+		placeholder_paths[_get_internal_path(i)] = parsed_resources[i].placeholder;
+	}
+
+	for (int i = 0; i < internal_resources.size(); i++) {
+
+		error = _parse_resource(i, parsed_resources[i]);
+		if (error) {
+			parsed_resources.clear();
+			placeholder_paths.clear();
+			return error;
+		}
+	}
+
+	placeholder_paths.clear();
+	f->close();
+	memdelete(f);
+	f = NULL;
+
+	return OK;
+}
+
 int ResourceInteractiveLoaderBinary::get_stage() const {
 
 	return stage;
@@ -806,11 +900,21 @@ static String get_ustring(FileAccess *f) {
 String ResourceInteractiveLoaderBinary::get_unicode_string() {
 
 	int len = f->get_32();
+	if (len == 0)
+		return String();
+
+	const uint8_t *mapped = f->get_mapped_data();
+	if (mapped && f->get_pos() + len <= f->get_len()) {
+		//parse in place, stored length includes the terminating zero
+		String s;
+		s.parse_utf8((const char *)mapped + f->get_pos(), len - 1);
+		f->seek(f->get_pos() + len);
+		return s;
+	}
+
 	if (len > str_buf.size()) {
 		str_buf.resize(len);
 	}
-	if (len == 0)
-		return String();
 	f->get_buffer((uint8_t *)&str_buf[0], len);
 	String s;
 	s.parse_utf8(&str_buf[0]);
@@ -1858,8 +1962,12 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path, const RES &p
 
 	Error err;
 	if (p_flags & ResourceSaver::FLAG_COMPRESS) {
+		Compression::Mode mode = Compression::MODE_FASTLZ;
+		if (GlobalConfig::get_singleton() && GlobalConfig::get_singleton()->has("compression/formats/binary_resource_mode"))
+			mode = Compression::Mode(int(GLOBAL_GET("compression/formats/binary_resource_mode")));
+
 		FileAccessCompressed *fac = memnew(FileAccessCompressed);
-		fac->configure("RSCC");
+		fac->configure("RSCC", mode);
 		f = fac;
 		err = fac->_open(p_path, FileAccess::WRITE);
 		if (err)
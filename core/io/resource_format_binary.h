@@ -77,16 +77,35 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
 
 	int stage;
 
+	struct ParsedProperty {
+		StringName name;
+		Variant value;
+	};
+
+	struct ParsedResource {
+		String type;
+		Vector<ParsedProperty> properties;
+		RES placeholder; // stands in for it in values parsed ahead
+	};
+
+	Vector<ParsedResource> parsed_resources; // filled by parse_ahead()
+	Map<String, RES> placeholder_paths; // while parsing ahead
+
 	friend class ResourceFormatLoaderBinary;
 
 	Error parse_variant(Variant &r_v);
 
+	String _get_internal_path(int p_index) const;
+	Error _parse_resource(int p_index, ParsedResource &r_parsed);
+	Error _build_resource(int p_index, ParsedResource &p_parsed);
+
 public:
 	virtual void set_local_path(const String &p_local_path);
 	virtual Ref<Resource> get_resource();
 	virtual Error poll();
 	virtual int get_stage() const;
 	virtual int get_stage_count() const;
+	virtual Error parse_ahead();
 
 	void set_remaps(const Map<String, String> &p_remaps) { remaps = p_remaps; }
 	void open(FileAccess *p_f);
@@ -100,6 +119,7 @@ public:
 class ResourceFormatLoaderBinary : public ResourceFormatLoader {
 public:
 	virtual Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, Error *r_error = NULL);
+	virtual bool can_parse_ahead() const { return true; }
 	virtual void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions) const;
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
 	virtual bool handles_type(const String &p_type) const;
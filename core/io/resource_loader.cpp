@@ -106,6 +106,46 @@ public:
 	ResourceInteractiveLoaderDefault() {}
 };
 
+void ResourceInteractiveLoader::_set_placeholder_resource(const RES &p_placeholder, const RES &p_resource) {
+
+	placeholder_resources[p_placeholder.ptr()] = p_resource;
+}
+
+Variant ResourceInteractiveLoader::_replace_placeholders(const Variant &p_value) const {
+
+	switch (p_value.get_type()) {
+
+		case Variant::OBJECT: {
+
+			const Map<const Object *, RES>::Element *E = placeholder_resources.find(p_value.operator Object *());
+			return E ? Variant(E->get()) : p_value;
+		}
+		case Variant::ARRAY: {
+
+			Array array = p_value;
+			for (int i = 0; i < array.size(); i++) {
+				array[i] = _replace_placeholders(array[i]);
+			}
+			return array;
+		}
+		case Variant::DICTIONARY: {
+
+			Dictionary dictionary = p_value;
+			Dictionary replaced;
+			List<Variant> keys;
+			dictionary.get_key_list(&keys);
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				replaced[_replace_placeholders(E->get())] = _replace_placeholders(dictionary[E->get()]);
+			}
+			return replaced;
+		}
+		default: {
+		}
+	}
+
+	return p_value;
+}
+
 Ref<ResourceInteractiveLoader> ResourceFormatLoader::load_interactive(const String &p_path, Error *r_error) {
 
 	//either this
@@ -175,6 +215,20 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 		return RES(ResourceCache::get(local_path));
 	}
 
+	if (!p_no_cache && thread_load_mutex) {
+
+		RES res;
+		if (_thread_load_intercept(local_path, p_type_hint, r_error, &res))
+			return res;
+	}
+
+	return _load(local_path, p_type_hint, p_no_cache, r_error);
+}
+
+RES ResourceLoader::_load(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
+
+	String local_path = p_path;
+
 	if (OS::get_singleton()->is_stdout_verbose())
 		print_line("load resource: " + local_path);
 	bool found = false;
@@ -190,18 +244,8 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 		if (res.is_null()) {
 			continue;
 		}
-		if (!p_no_cache)
-			res->set_path(local_path);
-#ifdef TOOLS_ENABLED
-
-		res->set_edited(false);
-		if (timestamp_on_load) {
-			uint64_t mt = FileAccess::get_modified_time(local_path);
-			//printf("mt %s: %lli\n",remapped_path.utf8().get_data(),mt);
-			res->set_last_modified_time(mt);
-		}
-#endif
 
+		_load_finished(res, local_path, p_no_cache);
 		return res;
 	}
 
@@ -214,6 +258,21 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 	return RES();
 }
 
+void ResourceLoader::_load_finished(RES &p_res, const String &p_path, bool p_no_cache) {
+
+	if (!p_no_cache)
+		p_res->set_path(p_path);
+#ifdef TOOLS_ENABLED
+
+	p_res->set_edited(false);
+	if (timestamp_on_load) {
+		uint64_t mt = FileAccess::get_modified_time(p_path);
+		//printf("mt %s: %lli\n",remapped_path.utf8().get_data(),mt);
+		p_res->set_last_modified_time(mt);
+	}
+#endif
+}
+
 Ref<ResourceInteractiveLoader> ResourceLoader::load_interactive(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error) {
 
 	if (r_error)
@@ -267,6 +326,590 @@ Ref<ResourceInteractiveLoader> ResourceLoader::load_interactive(const String &p_
 	return Ref<ResourceInteractiveLoader>();
 }
 
+/* THREADED LOADING */
+
+/*
+ * Requests are queued as tasks, keyed by local path, and picked up by a small
+ * pool of worker threads. When a task starts, its external dependencies are
+ * requested as tasks of their own so independent ones load in parallel, and
+ * any thread that calls load() on a path with a pending task waits for (or
+ * takes over) that task instead of loading it a second time. Resource types
+ * that talk to the servers are read and decoded by the workers, through
+ * ResourceInteractiveLoader::parse_ahead(), and only built on the main thread
+ * while it polls or waits for results. Loaders that can't parse ahead just
+ * have the file prefetched, the main thread then loads it all.
+ */
+
+void ResourceLoader::_thread_load_function(void *p_userdata) {
+
+	while (true) {
+
+		thread_load_semaphore->wait();
+
+		thread_load_mutex->lock();
+		if (thread_load_exit) {
+			thread_load_mutex->unlock();
+			break;
+		}
+
+		if (thread_load_queue.empty()) {
+			//taken over by a thread that needed it right away
+			thread_load_mutex->unlock();
+			continue;
+		}
+
+		String path = thread_load_queue.front()->get();
+		thread_load_queue.pop_front();
+		Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(path);
+		if (E)
+			E->get().started = true;
+		thread_load_mutex->unlock();
+
+		if (!E)
+			continue;
+
+		_thread_load_run(path);
+	}
+}
+
+void ResourceLoader::_thread_load_start() {
+
+	if (thread_load_threads.size() || thread_load_exit)
+		return;
+
+	int thread_count = GLOBAL_GET("application/resource_loader/thread_count");
+	if (thread_count <= 0) {
+		//leave a core for the main thread
+		thread_count = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+
+		Thread *thread = Thread::create(_thread_load_function, NULL);
+		ERR_CONTINUE(!thread);
+		thread_load_threads.push_back(thread);
+		thread_load_thread_ids.push_back(thread->get_ID());
+	}
+}
+
+ResourceLoader::ThreadLoadTask *ResourceLoader::_thread_load_request(const String &p_path, const String &p_type_hint) {
+
+	Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(p_path);
+	if (E)
+		return &E->get();
+
+	ThreadLoadTask task;
+	task.type_hint = p_type_hint;
+
+	if (ResourceCache::has(p_path)) {
+		task.resource = RES(ResourceCache::get(p_path));
+		task.status = THREAD_LOAD_LOADED;
+		task.started = true;
+		task.prepared = true;
+	} else {
+		thread_load_queue.push_back(p_path);
+		thread_load_semaphore->post();
+	}
+
+	return &thread_load_tasks.insert(p_path, task)->get();
+}
+
+void ResourceLoader::_thread_load_release(const String &p_path) {
+
+	Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(p_path);
+	ERR_FAIL_COND(!E);
+
+	ThreadLoadTask &task = E->get();
+	task.waiters--;
+
+	if (task.status != THREAD_LOAD_IN_PROGRESS && task.waiters == 0 && !task.user_requested)
+		thread_load_tasks.erase(E);
+}
+
+static void _thread_load_prefetch(const String &p_path) {
+
+	//pull the file into the OS cache while the main thread is busy elsewhere
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f)
+		return;
+
+	uint8_t buffer[16384];
+	while (f->get_buffer(buffer, sizeof(buffer)) == sizeof(buffer)) {
+	}
+
+	memdelete(f);
+}
+
+void ResourceLoader::_thread_load_run(const String &p_path) {
+
+	thread_load_mutex->lock();
+	Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(p_path);
+	if (!E) {
+		thread_load_mutex->unlock();
+		ERR_FAIL();
+	}
+	String type_hint = E->get().type_hint;
+	bool prepared = E->get().prepared;
+	thread_load_mutex->unlock();
+
+	if (!prepared) {
+
+		String type = type_hint != "" ? type_hint : get_resource_type(p_path);
+		bool main_thread = false;
+		for (int i = 0; i < main_thread_load_types.size(); i++) {
+			if (ClassDB::is_parent_class(type, main_thread_load_types[i])) {
+				main_thread = true;
+				break;
+			}
+		}
+
+		List<String> dependencies;
+		get_dependencies(p_path, &dependencies, true);
+
+		thread_load_mutex->lock();
+
+		Vector<String> dependency_paths;
+
+		for (List<String>::Element *D = dependencies.front(); D; D = D->next()) {
+
+			String path = D->get();
+			String type;
+			int sep = path.find("::");
+			if (sep != -1) {
+				type = path.substr(sep + 2, path.length());
+				path = path.substr(0, sep);
+			}
+
+			if (path.find("://") == -1 && path.is_rel_path()) {
+				// path is relative to file being loaded, so convert to a resource path
+				path = GlobalConfig::get_singleton()->localize_path(p_path.get_base_dir().plus_file(path));
+			}
+
+			if (path == p_path || dependency_paths.find(path) != -1)
+				continue;
+
+			_thread_load_request(path, type)->waiters++;
+			dependency_paths.push_back(path);
+		}
+
+		// tasks are only erased once finished, and this one is still running
+		ThreadLoadTask &task = thread_load_tasks.find(p_path)->get();
+		task.dependencies = dependency_paths;
+		task.main_thread = main_thread;
+		task.prepared = true;
+
+		thread_load_mutex->unlock();
+	}
+
+	thread_load_mutex->lock();
+	bool main_thread = thread_load_tasks.find(p_path)->get().main_thread;
+	thread_load_mutex->unlock();
+
+	if (main_thread && Thread::get_caller_ID() != Thread::get_main_ID()) {
+
+		Error err = OK;
+		Ref<ResourceInteractiveLoader> parsed = _thread_load_parse_ahead(p_path, type_hint, &err);
+
+		if (parsed.is_valid() || err == ERR_UNAVAILABLE) {
+
+			if (parsed.is_null())
+				_thread_load_prefetch(p_path); //can't be parsed ahead, the main thread loads it all
+
+			thread_load_mutex->lock();
+			thread_load_tasks.find(p_path)->get().parsed = parsed;
+			thread_load_main_queue.push_back(p_path);
+			_thread_load_wake_waiting();
+			thread_load_mutex->unlock();
+			return;
+		}
+
+		_thread_load_finish(p_path, RES(), err);
+		return;
+	}
+
+	thread_load_mutex->lock();
+	Ref<ResourceInteractiveLoader> parsed = thread_load_tasks.find(p_path)->get().parsed;
+	thread_load_tasks.find(p_path)->get().parsed = Ref<ResourceInteractiveLoader>();
+	thread_load_mutex->unlock();
+
+	Error err = OK;
+	RES res;
+
+	if (parsed.is_valid()) {
+
+		//only building is left, the file was read and decoded by a worker
+		while (true) {
+
+			err = parsed->poll();
+			if (err == ERR_FILE_EOF) {
+				err = OK;
+				res = parsed->get_resource();
+				break;
+			}
+			if (err != OK)
+				break;
+		}
+
+		if (res.is_valid())
+			_load_finished(res, p_path, false);
+	} else {
+		res = _load(p_path, type_hint, false, &err);
+	}
+
+	_thread_load_finish(p_path, res, err);
+}
+
+Ref<ResourceInteractiveLoader> ResourceLoader::_thread_load_parse_ahead(const String &p_path, const String &p_type_hint, Error *r_error) {
+
+	*r_error = ERR_UNAVAILABLE;
+
+	for (int i = 0; i < loader_count; i++) {
+
+		if (!loader[i]->recognize_path(p_path, p_type_hint))
+			continue;
+
+		if (!loader[i]->can_parse_ahead())
+			break;
+
+		Ref<ResourceInteractiveLoader> ril = loader[i]->load_interactive(p_path);
+		if (ril.is_null())
+			break; //let the main thread try the other loaders
+
+		ril->set_local_path(p_path);
+		*r_error = ril->parse_ahead();
+		if (*r_error != OK)
+			return Ref<ResourceInteractiveLoader>();
+
+		return ril;
+	}
+
+	return Ref<ResourceInteractiveLoader>();
+}
+
+void ResourceLoader::_thread_load_finish(const String &p_path, const RES &p_res, Error p_error) {
+
+	thread_load_mutex->lock();
+
+	ThreadLoadTask &task = thread_load_tasks.find(p_path)->get();
+	task.resource = p_res;
+	task.error = p_res.is_valid() ? OK : (p_error != OK ? p_error : ERR_CANT_OPEN);
+	task.status = p_res.is_valid() ? THREAD_LOAD_LOADED : THREAD_LOAD_FAILED;
+
+	Vector<String> dependencies = task.dependencies;
+	task.dependencies.clear();
+
+	if (task.waiters == 0 && !task.user_requested)
+		thread_load_tasks.erase(p_path);
+
+	for (int i = 0; i < dependencies.size(); i++) {
+		_thread_load_release(dependencies[i]);
+	}
+
+	_thread_load_wake_waiting();
+
+	thread_load_mutex->unlock();
+}
+
+bool ResourceLoader::_thread_load_flush_main() {
+
+	thread_load_mutex->lock();
+
+	if (thread_load_main_queue.empty()) {
+		thread_load_mutex->unlock();
+		return false;
+	}
+
+	String path = thread_load_main_queue.front()->get();
+	thread_load_main_queue.pop_front();
+
+	thread_load_mutex->unlock();
+
+	_thread_load_run(path);
+	return true;
+}
+
+void ResourceLoader::_thread_load_wake_waiting() {
+
+	//called with thread_load_mutex locked, each waiting thread checks again what it waits for
+	for (List<Semaphore *>::Element *E = thread_load_waiting.front(); E; E = E->next()) {
+		E->get()->post();
+	}
+	thread_load_waiting.clear();
+}
+
+RES ResourceLoader::_thread_load_wait(const String &p_path, Error *r_error) {
+
+	bool main = Thread::get_caller_ID() == Thread::get_main_ID();
+	Semaphore *semaphore = NULL;
+	RES res;
+
+	thread_load_mutex->lock();
+
+	while (true) {
+
+		Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(p_path);
+		if (!E) {
+			//callers hold a waiter on the task, so it can't be gone
+			if (r_error)
+				*r_error = ERR_BUG;
+			break;
+		}
+
+		const ThreadLoadTask &task = E->get();
+		if (task.status != THREAD_LOAD_IN_PROGRESS) {
+
+			res = task.resource;
+			if (r_error)
+				*r_error = task.error;
+			break;
+		}
+
+		if (thread_load_exit) {
+			//shutting down, the main thread will not finish anything else
+			if (r_error)
+				*r_error = ERR_UNAVAILABLE;
+			break;
+		}
+
+		//the main thread keeps finishing what workers prepared for it, it may be what is being waited on
+		if (main && !thread_load_main_queue.empty()) {
+			thread_load_mutex->unlock();
+			_thread_load_flush_main();
+			thread_load_mutex->lock();
+			continue;
+		}
+
+		if (!semaphore) {
+			semaphore = Semaphore::create();
+		}
+
+		//registered and posted with the mutex locked, so no wake up is lost
+		thread_load_waiting.push_back(semaphore);
+		thread_load_mutex->unlock();
+		semaphore->wait();
+		thread_load_mutex->lock();
+	}
+
+	thread_load_mutex->unlock();
+
+	if (semaphore) {
+		memdelete(semaphore);
+	}
+
+	return res;
+}
+
+bool ResourceLoader::_thread_load_intercept(const String &p_path, const String &p_type_hint, Error *r_error, RES *r_res) {
+
+	thread_load_mutex->lock();
+
+	if (!thread_load_tasks.has(p_path)) {
+
+		//loads issued from inside a worker become tasks, so they are shared and finalized on the right thread
+		if (thread_load_thread_ids.find(Thread::get_caller_ID()) == -1) {
+			thread_load_mutex->unlock();
+			return false;
+		}
+
+		_thread_load_request(p_path, p_type_hint);
+	}
+
+	ThreadLoadTask &task = thread_load_tasks.find(p_path)->get();
+	task.waiters++;
+
+	bool take_over = !task.started;
+	if (take_over) {
+		task.started = true;
+		thread_load_queue.erase(p_path);
+	}
+
+	thread_load_mutex->unlock();
+
+	if (take_over)
+		_thread_load_run(p_path);
+
+	*r_res = _thread_load_wait(p_path, r_error);
+
+	thread_load_mutex->lock();
+	_thread_load_release(p_path);
+	thread_load_mutex->unlock();
+
+	return true;
+}
+
+float ResourceLoader::_thread_load_get_progress(const ThreadLoadTask &p_task) {
+
+	if (p_task.status != THREAD_LOAD_IN_PROGRESS)
+		return 1.0;
+
+	if (!p_task.prepared)
+		return 0.0;
+
+	float done = 0;
+	for (int i = 0; i < p_task.dependencies.size(); i++) {
+
+		Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(p_task.dependencies[i]);
+		if (!E || E->get().status != THREAD_LOAD_IN_PROGRESS)
+			done += 1.0;
+	}
+
+	return done / (p_task.dependencies.size() + 1);
+}
+
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint) {
+
+	ERR_FAIL_COND_V(!thread_load_mutex, ERR_UNAVAILABLE);
+
+	String local_path;
+	if (p_path.is_rel_path())
+		local_path = "res://" + p_path;
+	else
+		local_path = GlobalConfig::get_singleton()->localize_path(p_path);
+
+	ERR_FAIL_COND_V(local_path == "", ERR_INVALID_PARAMETER);
+
+	thread_load_mutex->lock();
+	_thread_load_start();
+	_thread_load_request(local_path, p_type_hint)->user_requested = true;
+	thread_load_mutex->unlock();
+
+	return OK;
+}
+
+ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
+
+	if (r_progress)
+		*r_progress = 0;
+
+	ERR_FAIL_COND_V(!thread_load_mutex, THREAD_LOAD_INVALID_RESOURCE);
+
+	String local_path;
+	if (p_path.is_rel_path())
+		local_path = "res://" + p_path;
+	else
+		local_path = GlobalConfig::get_singleton()->localize_path(p_path);
+
+	//polling happens once per frame, a good moment to finish one main thread task
+	if (Thread::get_caller_ID() == Thread::get_main_ID())
+		_thread_load_flush_main();
+
+	thread_load_mutex->lock();
+
+	Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(local_path);
+	if (!E || !E->get().user_requested) {
+		thread_load_mutex->unlock();
+		return THREAD_LOAD_INVALID_RESOURCE;
+	}
+
+	ThreadLoadStatus status = E->get().status;
+	if (r_progress)
+		*r_progress = _thread_load_get_progress(E->get());
+
+	thread_load_mutex->unlock();
+
+	return status;
+}
+
+RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
+
+	if (r_error)
+		*r_error = ERR_INVALID_PARAMETER;
+
+	ERR_FAIL_COND_V(!thread_load_mutex, RES());
+
+	String local_path;
+	if (p_path.is_rel_path())
+		local_path = "res://" + p_path;
+	else
+		local_path = GlobalConfig::get_singleton()->localize_path(p_path);
+
+	thread_load_mutex->lock();
+
+	Map<String, ThreadLoadTask>::Element *E = thread_load_tasks.find(local_path);
+	if (!E || !E->get().user_requested) {
+		thread_load_mutex->unlock();
+		ERR_EXPLAIN("Resource was not requested for threaded loading: " + p_path);
+		ERR_FAIL_V(RES());
+	}
+
+	ThreadLoadTask &task = E->get();
+	task.user_requested = false;
+	task.waiters++;
+
+	bool take_over = !task.started;
+	if (take_over) {
+		task.started = true;
+		thread_load_queue.erase(local_path);
+	}
+
+	thread_load_mutex->unlock();
+
+	if (take_over)
+		_thread_load_run(local_path);
+
+	RES res = _thread_load_wait(local_path, r_error);
+
+	thread_load_mutex->lock();
+	_thread_load_release(local_path);
+	thread_load_mutex->unlock();
+
+	return res;
+}
+
+void ResourceLoader::add_main_thread_load_type(const StringName &p_type) {
+
+	main_thread_load_types.push_back(p_type);
+}
+
+void ResourceLoader::initialize_threaded_loading() {
+
+	thread_load_mutex = Mutex::create();
+	thread_load_semaphore = Semaphore::create();
+	thread_load_exit = false;
+
+	if (!thread_load_mutex || !thread_load_semaphore) {
+		//no threads on this platform
+		if (thread_load_mutex)
+			memdelete(thread_load_mutex);
+		if (thread_load_semaphore)
+			memdelete(thread_load_semaphore);
+		thread_load_mutex = NULL;
+		thread_load_semaphore = NULL;
+	}
+}
+
+void ResourceLoader::finalize_threaded_loading() {
+
+	if (!thread_load_mutex)
+		return;
+
+	thread_load_mutex->lock();
+	thread_load_exit = true;
+	thread_load_queue.clear();
+	_thread_load_wake_waiting();
+	thread_load_mutex->unlock();
+
+	for (int i = 0; i < thread_load_threads.size(); i++) {
+		thread_load_semaphore->post();
+	}
+
+	for (int i = 0; i < thread_load_threads.size(); i++) {
+		Thread::wait_to_finish(thread_load_threads[i]);
+		memdelete(thread_load_threads[i]);
+	}
+
+	thread_load_threads.clear();
+	thread_load_thread_ids.clear();
+	thread_load_tasks.clear();
+	thread_load_main_queue.clear();
+	main_thread_load_types.clear();
+
+	memdelete(thread_load_mutex);
+	memdelete(thread_load_semaphore);
+	thread_load_mutex = NULL;
+	thread_load_semaphore = NULL;
+}
+
 void ResourceLoader::add_resource_format_loader(ResourceFormatLoader *p_format_loader, bool p_at_front) {
 
 	ERR_FAIL_COND(loader_count >= MAX_LOADERS);
@@ -350,3 +993,14 @@ void *ResourceLoader::dep_err_notify_ud = NULL;
 
 bool ResourceLoader::abort_on_missing_resource = true;
 bool ResourceLoader::timestamp_on_load = false;
+
+Mutex *ResourceLoader::thread_load_mutex = NULL;
+Semaphore *ResourceLoader::thread_load_semaphore = NULL;
+Map<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
+List<String> ResourceLoader::thread_load_queue;
+List<String> ResourceLoader::thread_load_main_queue;
+List<Semaphore *> ResourceLoader::thread_load_waiting;
+Vector<Thread *> ResourceLoader::thread_load_threads;
+Vector<Thread::ID> ResourceLoader::thread_load_thread_ids;
+bool ResourceLoader::thread_load_exit = false;
+Vector<StringName> ResourceLoader::main_thread_load_types;
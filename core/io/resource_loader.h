@@ -30,6 +30,11 @@
 #ifndef RESOURCE_LOADER_H
 #define RESOURCE_LOADER_H
 
+#include "list.h"
+#include "map.h"
+#include "os/mutex.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
 #include "resource.h"
 
 /**
@@ -40,9 +45,14 @@ class ResourceInteractiveLoader : public Reference {
 
 	GDCLASS(ResourceInteractiveLoader, Reference);
 
+	Map<const Object *, RES> placeholder_resources;
+
 protected:
 	static void _bind_methods();
 
+	void _set_placeholder_resource(const RES &p_placeholder, const RES &p_resource);
+	Variant _replace_placeholders(const Variant &p_value) const;
+
 public:
 	virtual void set_local_path(const String &p_local_path) = 0;
 	virtual Ref<Resource> get_resource() = 0;
@@ -50,6 +60,7 @@ public:
 	virtual int get_stage() const = 0;
 	virtual int get_stage_count() const = 0;
 	virtual Error wait();
+	virtual Error parse_ahead() { return ERR_UNAVAILABLE; } ///< reads and decodes the rest of the file, so polling afterwards only builds resources
 
 	ResourceInteractiveLoader() {}
 };
@@ -57,6 +68,7 @@ public:
 class ResourceFormatLoader {
 public:
 	virtual Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, Error *r_error = NULL);
+	virtual bool can_parse_ahead() const { return false; } ///< load_interactive() returns loaders implementing parse_ahead()
 	virtual RES load(const String &p_path, const String &p_original_path = "", Error *r_error = NULL);
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
 	virtual void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions) const;
@@ -73,7 +85,15 @@ typedef void (*ResourceLoadErrorNotify)(void *p_ud, const String &p_text);
 typedef void (*DependencyErrorNotify)(void *p_ud, const String &p_loading, const String &p_which, const String &p_type);
 
 class ResourceLoader {
+public:
+	enum ThreadLoadStatus {
+		THREAD_LOAD_INVALID_RESOURCE,
+		THREAD_LOAD_IN_PROGRESS,
+		THREAD_LOAD_FAILED,
+		THREAD_LOAD_LOADED
+	};
 
+private:
 	enum {
 		MAX_LOADERS = 64
 	};
@@ -88,10 +108,72 @@ class ResourceLoader {
 	static DependencyErrorNotify dep_err_notify;
 	static bool abort_on_missing_resource;
 
+	static RES _load(const String &p_path, const String &p_type_hint, bool p_no_cache, Error *r_error);
+	static void _load_finished(RES &p_res, const String &p_path, bool p_no_cache);
+
+	/* threaded loading */
+
+	struct ThreadLoadTask {
+
+		String type_hint;
+		ThreadLoadStatus status;
+		RES resource;
+		Error error;
+		bool started; // taken by a worker, or by a thread that needed it right away
+		bool prepared; // dependencies requested, main thread need known
+		bool main_thread; // must be finalized on the main thread, see add_main_thread_load_type()
+		Ref<ResourceInteractiveLoader> parsed; // read and decoded by a worker, the main thread only builds it
+		bool user_requested; // until load_threaded_get() picks it up
+		int waiters; // threads waiting on it, plus tasks depending on it
+		Vector<String> dependencies;
+
+		ThreadLoadTask() {
+			status = THREAD_LOAD_IN_PROGRESS;
+			error = OK;
+			started = false;
+			prepared = false;
+			main_thread = false;
+			user_requested = false;
+			waiters = 0;
+		}
+	};
+
+	static Mutex *thread_load_mutex;
+	static Semaphore *thread_load_semaphore;
+	static Map<String, ThreadLoadTask> thread_load_tasks;
+	static List<String> thread_load_queue;
+	static List<String> thread_load_main_queue;
+	static List<Semaphore *> thread_load_waiting; // posted when a task finishes or the main queue grows
+	static Vector<Thread *> thread_load_threads;
+	static Vector<Thread::ID> thread_load_thread_ids;
+	static bool thread_load_exit;
+	static Vector<StringName> main_thread_load_types;
+
+	static void _thread_load_function(void *p_userdata);
+	static void _thread_load_start();
+	static ThreadLoadTask *_thread_load_request(const String &p_path, const String &p_type_hint);
+	static void _thread_load_release(const String &p_path);
+	static void _thread_load_run(const String &p_path);
+	static Ref<ResourceInteractiveLoader> _thread_load_parse_ahead(const String &p_path, const String &p_type_hint, Error *r_error);
+	static void _thread_load_finish(const String &p_path, const RES &p_res, Error p_error);
+	static bool _thread_load_flush_main();
+	static void _thread_load_wake_waiting();
+	static RES _thread_load_wait(const String &p_path, Error *r_error);
+	static bool _thread_load_intercept(const String &p_path, const String &p_type_hint, Error *r_error, RES *r_res);
+	static float _thread_load_get_progress(const ThreadLoadTask &p_task);
+
 public:
 	static Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 	static RES load(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 
+	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "");
+	static ThreadLoadStatus load_threaded_get_status(const String &p_path, float *r_progress = NULL);
+	static RES load_threaded_get(const String &p_path, Error *r_error = NULL);
+	static void add_main_thread_load_type(const StringName &p_type);
+
+	static void initialize_threaded_loading();
+	static void finalize_threaded_loading();
+
 	static void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions);
 	static void add_resource_format_loader(ResourceFormatLoader *p_format_loader, bool p_at_front = false);
 	static String get_resource_type(const String &p_path);
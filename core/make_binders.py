@@ -16,6 +16,14 @@ public:
 		$
 		return Variant::NIL;
 	}
+#endif
+#ifdef PTRCALL_ENABLED
+	virtual PtrCallArg _gen_ptrcall_arg(int p_arg) const {
+		$ifret if (p_arg==-1) return make_ptrcall_arg<R>(true);$
+		$arg if (p_arg==(@-1)) return make_ptrcall_arg<P@>(false);
+		$
+		return MethodBind::_gen_ptrcall_arg(p_arg);
+	}
 #endif
 	virtual String get_instance_class() const {
 		return T::get_class_static();
@@ -62,6 +70,9 @@ public:
 #else
 		set_argument_count($argc$);
 #endif
+#ifdef PTRCALL_ENABLED
+		_generate_ptrcall_args($argc$);
+#endif
 
 		$ifret _set_returns(true); $
 	};
@@ -96,6 +107,14 @@ public:
 		$
 		return Variant::NIL;
 	}
+#endif
+#ifdef PTRCALL_ENABLED
+	virtual PtrCallArg _gen_ptrcall_arg(int p_arg) const {
+		$ifret if (p_arg==-1) return make_ptrcall_arg<R>(true);$
+		$arg if (p_arg==(@-1)) return make_ptrcall_arg<P@>(false);
+		$
+		return MethodBind::_gen_ptrcall_arg(p_arg);
+	}
 #endif
 	virtual String get_instance_class() const {
 		return type_name;
@@ -141,6 +160,9 @@ public:
 		_generate_argument_types($argc$);
 #else
 		set_argument_count($argc$);
+#endif
+#ifdef PTRCALL_ENABLED
+		_generate_ptrcall_args($argc$);
 #endif
 		$ifret _set_returns(true); $
 
@@ -0,0 +1,848 @@
+/*************************************************************************/
+/*  dynamic_bvh.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef DYNAMIC_BVH_H
+#define DYNAMIC_BVH_H
+
+#include "octree.h"
+#include "rect3.h"
+#include "vector.h"
+
+/**
+ * Dynamic bounding volume hierarchy, a drop-in alternative to Octree.
+ *
+ * Leaves store a "fat" AABB (the element AABB grown by a margin), so small
+ * moves don't touch the tree at all. When an element leaves its fat AABB it
+ * is removed and reinserted, and the path to the root is refit and balanced
+ * with tree rotations. Nodes and elements live in flat arrays and are
+ * referenced by index.
+ *
+ * The public API and the pair/unpair callback contract are the same as
+ * Octree: only pairs where at least one element is pairable and the
+ * type/mask test passes are reported, and only while the AABBs intersect.
+ */
+
+template <class T, bool use_pairs = false>
+class DynamicBVH {
+public:
+	typedef typename Octree<T, use_pairs>::PairCallback PairCallback;
+	typedef typename Octree<T, use_pairs>::UnpairCallback UnpairCallback;
+
+private:
+	enum {
+		INVALID_INDEX = -1,
+		MAX_STACK = 256 // balanced tree, depth is logarithmic
+	};
+
+	struct Node {
+
+		Rect3 aabb; // fat AABB for leaves
+		int parent; // also next in free list
+		int children[2];
+		int height; // 0 for leaves, -1 when free
+		int element;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == INVALID_INDEX; }
+	};
+
+	struct PairEntry {
+
+		OctreeElementID other;
+		int mirror; // index of the matching entry in the other element
+		void *ud;
+	};
+
+	struct Element {
+
+		T *userdata;
+		int subindex;
+		bool pairable;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+		Rect3 aabb;
+		int leaf;
+		bool used;
+		int next_free;
+
+		Vector<PairEntry> pairs;
+	};
+
+	Vector<Node> nodes;
+	int root;
+	int free_node;
+
+	Vector<Element> elements;
+	int free_element;
+	int element_count;
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	int pair_count;
+	real_t fat_margin;
+
+	_FORCE_INLINE_ static real_t _surface(const Rect3 &p_aabb) {
+
+		return (p_aabb.size.x * p_aabb.size.y + p_aabb.size.y * p_aabb.size.z + p_aabb.size.z * p_aabb.size.x) * 2.0;
+	}
+
+	_FORCE_INLINE_ Element *_get_element(OctreeElementID p_id) {
+
+		int idx = int(p_id) - 1;
+		ERR_FAIL_INDEX_V(idx, elements.size(), NULL);
+		Element *e = &elements[idx];
+		ERR_FAIL_COND_V(!e->used, NULL);
+		return e;
+	}
+
+	_FORCE_INLINE_ const Element *_get_element(OctreeElementID p_id) const {
+
+		int idx = int(p_id) - 1;
+		ERR_FAIL_INDEX_V(idx, elements.size(), NULL);
+		const Element *e = &elements[idx];
+		ERR_FAIL_COND_V(!e->used, NULL);
+		return e;
+	}
+
+	_FORCE_INLINE_ bool _can_pair(const Element *p_A, const Element *p_B) const {
+
+		if (p_A == p_B || (p_A->userdata == p_B->userdata && p_A->userdata))
+			return false;
+
+		if (!p_A->pairable && !p_B->pairable)
+			return false; // non pairable elements are only tested against pairable ones
+
+		if (!(p_A->pairable_type & p_B->pairable_mask) &&
+				!(p_B->pairable_type & p_A->pairable_mask))
+			return false; // none can pair with none
+
+		return true;
+	}
+
+	int _alloc_node();
+	void _free_node(int p_node);
+	int _balance(int p_node);
+	void _refit_from(int p_node);
+	void _insert_leaf(int p_leaf);
+	void _remove_leaf(int p_leaf);
+
+	int _find_pair(OctreeElementID p_A, OctreeElementID p_B);
+	void _add_pair(OctreeElementID p_A, OctreeElementID p_B);
+	void _remove_pair(OctreeElementID p_A, int p_pair);
+	void _update_pairs(OctreeElementID p_id);
+
+public:
+	OctreeElementID create(T *p_userdata, const Rect3 &p_aabb = Rect3(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void move(OctreeElementID p_id, const Rect3 &p_aabb);
+	void set_pairable(OctreeElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void erase(OctreeElementID p_id);
+
+	bool is_pairable(OctreeElementID p_id) const;
+	T *get(OctreeElementID p_id) const;
+	int get_subindex(OctreeElementID p_id) const;
+
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_AABB(const Rect3 &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata);
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+
+	int get_node_count() const { return nodes.size(); }
+	int get_element_count() const { return element_count; }
+	int get_pair_count() const { return pair_count; }
+	int get_height() const { return root == INVALID_INDEX ? 0 : nodes[root].height; }
+
+	DynamicBVH(real_t p_fat_margin = 0.1);
+};
+
+/* NODES */
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::_alloc_node() {
+
+	int idx;
+	if (free_node != INVALID_INDEX) {
+		idx = free_node;
+		free_node = nodes[idx].parent;
+	} else {
+		idx = nodes.size();
+		nodes.resize(idx + 1);
+	}
+
+	Node &n = nodes[idx];
+	n.parent = INVALID_INDEX;
+	n.children[0] = INVALID_INDEX;
+	n.children[1] = INVALID_INDEX;
+	n.height = 0;
+	n.element = INVALID_INDEX;
+	return idx;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_free_node(int p_node) {
+
+	Node &n = nodes[p_node];
+	n.parent = free_node;
+	n.height = -1;
+	free_node = p_node;
+}
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::_balance(int p_node) {
+
+	Node *n = nodes.ptr();
+	Node *A = &n[p_node];
+
+	if (A->is_leaf() || A->height < 2)
+		return p_node;
+
+	int iB = A->children[0];
+	int iC = A->children[1];
+	Node *B = &n[iB];
+	Node *C = &n[iC];
+
+	int balance = C->height - B->height;
+
+	if (balance > 1) {
+		// rotate C up
+		int iF = C->children[0];
+		int iG = C->children[1];
+		Node *F = &n[iF];
+		Node *G = &n[iG];
+
+		C->children[0] = p_node;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if (C->parent != INVALID_INDEX) {
+			Node *P = &n[C->parent];
+			P->children[P->children[0] == p_node ? 0 : 1] = iC;
+		} else {
+			root = iC;
+		}
+
+		if (F->height > G->height) {
+			C->children[1] = iF;
+			A->children[1] = iG;
+			G->parent = p_node;
+			A->aabb = B->aabb.merge(G->aabb);
+			C->aabb = A->aabb.merge(F->aabb);
+			A->height = 1 + MAX(B->height, G->height);
+			C->height = 1 + MAX(A->height, F->height);
+		} else {
+			C->children[1] = iG;
+			A->children[1] = iF;
+			F->parent = p_node;
+			A->aabb = B->aabb.merge(F->aabb);
+			C->aabb = A->aabb.merge(G->aabb);
+			A->height = 1 + MAX(B->height, F->height);
+			C->height = 1 + MAX(A->height, G->height);
+		}
+
+		return iC;
+	}
+
+	if (balance < -1) {
+		// rotate B up
+		int iD = B->children[0];
+		int iE = B->children[1];
+		Node *D = &n[iD];
+		Node *E = &n[iE];
+
+		B->children[0] = p_node;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if (B->parent != INVALID_INDEX) {
+			Node *P = &n[B->parent];
+			P->children[P->children[0] == p_node ? 0 : 1] = iB;
+		} else {
+			root = iB;
+		}
+
+		if (D->height > E->height) {
+			B->children[1] = iD;
+			A->children[0] = iE;
+			E->parent = p_node;
+			A->aabb = C->aabb.merge(E->aabb);
+			B->aabb = A->aabb.merge(D->aabb);
+			A->height = 1 + MAX(C->height, E->height);
+			B->height = 1 + MAX(A->height, D->height);
+		} else {
+			B->children[1] = iE;
+			A->children[0] = iD;
+			D->parent = p_node;
+			A->aabb = C->aabb.merge(D->aabb);
+			B->aabb = A->aabb.merge(E->aabb);
+			A->height = 1 + MAX(C->height, D->height);
+			B->height = 1 + MAX(A->height, E->height);
+		}
+
+		return iB;
+	}
+
+	return p_node;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_refit_from(int p_node) {
+
+	int idx = p_node;
+	while (idx != INVALID_INDEX) {
+
+		idx = _balance(idx);
+
+		Node *n = nodes.ptr();
+		Node &node = n[idx];
+		const Node &c0 = n[node.children[0]];
+		const Node &c1 = n[node.children[1]];
+
+		node.height = 1 + MAX(c0.height, c1.height);
+		node.aabb = c0.aabb.merge(c1.aabb);
+
+		idx = node.parent;
+	}
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_insert_leaf(int p_leaf) {
+
+	if (root == INVALID_INDEX) {
+		root = p_leaf;
+		nodes[root].parent = INVALID_INDEX;
+		return;
+	}
+
+	// find the best sibling, descending by surface area cost
+	Rect3 leaf_aabb = nodes[p_leaf].aabb;
+	int sibling = root;
+
+	{
+		const Node *n = nodes.ptr();
+
+		while (!n[sibling].is_leaf()) {
+
+			const Node &node = n[sibling];
+
+			real_t area = _surface(node.aabb);
+			real_t combined_area = _surface(node.aabb.merge(leaf_aabb));
+
+			// cost of creating a new parent for this node and the leaf
+			real_t cost = 2.0 * combined_area;
+			// minimum cost of pushing the leaf further down the tree
+			real_t inheritance_cost = 2.0 * (combined_area - area);
+
+			real_t child_cost[2];
+			for (int i = 0; i < 2; i++) {
+
+				const Node &child = n[node.children[i]];
+				real_t merged_area = _surface(child.aabb.merge(leaf_aabb));
+				if (child.is_leaf()) {
+					child_cost[i] = merged_area + inheritance_cost;
+				} else {
+					child_cost[i] = merged_area - _surface(child.aabb) + inheritance_cost;
+				}
+			}
+
+			if (cost < child_cost[0] && cost < child_cost[1])
+				break;
+
+			sibling = child_cost[0] < child_cost[1] ? node.children[0] : node.children[1];
+		}
+	}
+
+	int new_parent = _alloc_node(); // may reallocate, don't hold pointers across this
+
+	Node *n = nodes.ptr();
+	int old_parent = n[sibling].parent;
+
+	n[new_parent].parent = old_parent;
+	n[new_parent].aabb = leaf_aabb.merge(n[sibling].aabb);
+	n[new_parent].height = n[sibling].height + 1;
+	n[new_parent].children[0] = sibling;
+	n[new_parent].children[1] = p_leaf;
+	n[sibling].parent = new_parent;
+	n[p_leaf].parent = new_parent;
+
+	if (old_parent != INVALID_INDEX) {
+		Node &op = n[old_parent];
+		op.children[op.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		root = new_parent;
+	}
+
+	_refit_from(old_parent);
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_remove_leaf(int p_leaf) {
+
+	if (p_leaf == root) {
+		root = INVALID_INDEX;
+		return;
+	}
+
+	Node *n = nodes.ptr();
+	int parent = n[p_leaf].parent;
+	int grand_parent = n[parent].parent;
+	int sibling = n[parent].children[0] == p_leaf ? n[parent].children[1] : n[parent].children[0];
+
+	if (grand_parent != INVALID_INDEX) {
+		Node &gp = n[grand_parent];
+		gp.children[gp.children[0] == parent ? 0 : 1] = sibling;
+		n[sibling].parent = grand_parent;
+		_free_node(parent);
+		_refit_from(grand_parent);
+	} else {
+		root = sibling;
+		n[sibling].parent = INVALID_INDEX;
+		_free_node(parent);
+	}
+}
+
+/* PAIRS */
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::_find_pair(OctreeElementID p_A, OctreeElementID p_B) {
+
+	const Element &A = elements[p_A - 1];
+	const Element &B = elements[p_B - 1];
+
+	// search the shorter list, static elements may have a lot of pairs
+	if (B.pairs.size() < A.pairs.size()) {
+		const PairEntry *pairs = B.pairs.ptr();
+		for (int i = 0; i < B.pairs.size(); i++) {
+			if (pairs[i].other == p_A)
+				return pairs[i].mirror;
+		}
+	} else {
+		const PairEntry *pairs = A.pairs.ptr();
+		for (int i = 0; i < A.pairs.size(); i++) {
+			if (pairs[i].other == p_B)
+				return i;
+		}
+	}
+
+	return -1;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_add_pair(OctreeElementID p_A, OctreeElementID p_B) {
+
+	Element &A = elements[p_A - 1];
+	Element &B = elements[p_B - 1];
+
+	void *ud = NULL;
+	if (pair_callback) {
+		ud = pair_callback(pair_callback_userdata, p_A, A.userdata, A.subindex, p_B, B.userdata, B.subindex);
+	}
+
+	PairEntry pa;
+	pa.other = p_B;
+	pa.mirror = B.pairs.size();
+	pa.ud = ud;
+
+	PairEntry pb;
+	pb.other = p_A;
+	pb.mirror = A.pairs.size();
+	pb.ud = ud;
+
+	A.pairs.push_back(pa);
+	B.pairs.push_back(pb);
+
+	pair_count++;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_remove_pair(OctreeElementID p_A, int p_pair) {
+
+	Element &A = elements[p_A - 1];
+	PairEntry pa = A.pairs[p_pair];
+	OctreeElementID id_B = pa.other;
+	Element &B = elements[id_B - 1];
+
+	if (unpair_callback) {
+		unpair_callback(unpair_callback_userdata, p_A, A.userdata, A.subindex, id_B, B.userdata, B.subindex, pa.ud);
+	}
+
+	// swap-remove on both sides, fixing the mirror of the entry that moved
+	{
+		int last = A.pairs.size() - 1;
+		if (p_pair != last) {
+			PairEntry moved = A.pairs[last];
+			A.pairs[p_pair] = moved;
+			elements[moved.other - 1].pairs[moved.mirror].mirror = p_pair;
+		}
+		A.pairs.resize(last);
+	}
+
+	{
+		int idx = pa.mirror;
+		int last = B.pairs.size() - 1;
+		if (idx != last) {
+			PairEntry moved = B.pairs[last];
+			B.pairs[idx] = moved;
+			elements[moved.other - 1].pairs[moved.mirror].mirror = idx;
+		}
+		B.pairs.resize(last);
+	}
+
+	pair_count--;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::_update_pairs(OctreeElementID p_id) {
+
+	// drop pairs that stopped intersecting
+	for (int i = 0; i < elements[p_id - 1].pairs.size(); i++) {
+
+		const Element &e = elements[p_id - 1];
+		const Element &other = elements[e.pairs[i].other - 1];
+
+		if (!_can_pair(&e, &other) || !e.aabb.intersects_inclusive(other.aabb) || e.leaf == INVALID_INDEX || other.leaf == INVALID_INDEX) {
+			_remove_pair(p_id, i);
+			i--;
+		}
+	}
+
+	if (elements[p_id - 1].leaf == INVALID_INDEX || root == INVALID_INDEX)
+		return;
+
+	// and add the new ones
+	int stack[MAX_STACK];
+	int stack_size = 0;
+	stack[stack_size++] = root;
+
+	while (stack_size) {
+
+		const Node &node = nodes[stack[--stack_size]];
+		const Element &e = elements[p_id - 1];
+
+		if (!node.aabb.intersects_inclusive(e.aabb))
+			continue;
+
+		if (node.is_leaf()) {
+
+			OctreeElementID other_id = node.element + 1;
+			const Element &other = elements[node.element];
+
+			if (other_id != p_id && _can_pair(&e, &other) && e.aabb.intersects_inclusive(other.aabb) && _find_pair(p_id, other_id) == -1) {
+				_add_pair(p_id, other_id);
+			}
+		} else {
+			ERR_FAIL_COND(stack_size + 2 > MAX_STACK);
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+}
+
+/* PUBLIC API */
+
+template <class T, bool use_pairs>
+OctreeElementID DynamicBVH<T, use_pairs>::create(T *p_userdata, const Rect3 &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+#ifdef DEBUG_ENABLED
+	// check for AABB validity
+	ERR_FAIL_COND_V(p_aabb.pos.x > 1e15 || p_aabb.pos.x < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.pos.y > 1e15 || p_aabb.pos.y < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.pos.z > 1e15 || p_aabb.pos.z < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.size.x > 1e15 || p_aabb.size.x < 0.0, 0);
+	ERR_FAIL_COND_V(p_aabb.size.y > 1e15 || p_aabb.size.y < 0.0, 0);
+	ERR_FAIL_COND_V(p_aabb.size.z > 1e15 || p_aabb.size.z < 0.0, 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.x), 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.y), 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.z), 0);
+#endif
+
+	int idx;
+	if (free_element != INVALID_INDEX) {
+		idx = free_element;
+		free_element = elements[idx].next_free;
+	} else {
+		idx = elements.size();
+		elements.resize(idx + 1);
+	}
+
+	Element &e = elements[idx];
+	e.userdata = p_userdata;
+	e.subindex = p_subindex;
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+	e.aabb = p_aabb;
+	e.leaf = INVALID_INDEX;
+	e.used = true;
+	e.next_free = INVALID_INDEX;
+	e.pairs.clear();
+
+	element_count++;
+
+	OctreeElementID id = idx + 1;
+
+	if (!p_aabb.has_no_surface()) {
+
+		int leaf = _alloc_node();
+		nodes[leaf].aabb = p_aabb.grow(MAX(p_aabb.get_longest_axis_size() * 0.1, fat_margin));
+		nodes[leaf].element = idx;
+		elements[idx].leaf = leaf;
+		_insert_leaf(leaf);
+
+		if (use_pairs)
+			_update_pairs(id);
+	}
+
+	return id;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::move(OctreeElementID p_id, const Rect3 &p_aabb) {
+
+#ifdef DEBUG_ENABLED
+	// check for AABB validity
+	ERR_FAIL_COND(p_aabb.pos.x > 1e15 || p_aabb.pos.x < -1e15);
+	ERR_FAIL_COND(p_aabb.pos.y > 1e15 || p_aabb.pos.y < -1e15);
+	ERR_FAIL_COND(p_aabb.pos.z > 1e15 || p_aabb.pos.z < -1e15);
+	ERR_FAIL_COND(p_aabb.size.x > 1e15 || p_aabb.size.x < 0.0);
+	ERR_FAIL_COND(p_aabb.size.y > 1e15 || p_aabb.size.y < 0.0);
+	ERR_FAIL_COND(p_aabb.size.z > 1e15 || p_aabb.size.z < 0.0);
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.x));
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.y));
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.z));
+#endif
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	if (e->aabb == p_aabb && e->leaf != INVALID_INDEX)
+		return;
+
+	e->aabb = p_aabb;
+	int idx = p_id - 1;
+
+	if (p_aabb.has_no_surface()) {
+
+		if (e->leaf != INVALID_INDEX) {
+			_remove_leaf(e->leaf);
+			_free_node(e->leaf);
+			e->leaf = INVALID_INDEX;
+		}
+
+	} else if (e->leaf == INVALID_INDEX) {
+
+		int leaf = _alloc_node();
+		nodes[leaf].aabb = p_aabb.grow(MAX(p_aabb.get_longest_axis_size() * 0.1, fat_margin));
+		nodes[leaf].element = idx;
+		elements[idx].leaf = leaf;
+		_insert_leaf(leaf);
+
+	} else if (!nodes[e->leaf].aabb.encloses(p_aabb)) {
+
+		// left the fat AABB, reinsert
+		int leaf = e->leaf;
+		_remove_leaf(leaf);
+		nodes[leaf].aabb = p_aabb.grow(MAX(p_aabb.get_longest_axis_size() * 0.1, fat_margin));
+		_insert_leaf(leaf);
+	}
+
+	if (use_pairs)
+		_update_pairs(p_id);
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::set_pairable(OctreeElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	if (p_pairable == e->pairable && e->pairable_type == p_pairable_type && e->pairable_mask == p_pairable_mask)
+		return; // no changes, return
+
+	e->pairable = p_pairable;
+	e->pairable_type = p_pairable_type;
+	e->pairable_mask = p_pairable_mask;
+
+	if (use_pairs)
+		_update_pairs(p_id);
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::erase(OctreeElementID p_id) {
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	if (use_pairs) {
+		while (elements[p_id - 1].pairs.size()) {
+			_remove_pair(p_id, elements[p_id - 1].pairs.size() - 1);
+		}
+	}
+
+	int idx = p_id - 1;
+	Element &el = elements[idx];
+
+	if (el.leaf != INVALID_INDEX) {
+		_remove_leaf(el.leaf);
+		_free_node(el.leaf);
+		el.leaf = INVALID_INDEX;
+	}
+
+	el.used = false;
+	el.userdata = NULL;
+	el.pairs.clear();
+	el.next_free = free_element;
+	free_element = idx;
+	element_count--;
+}
+
+template <class T, bool use_pairs>
+bool DynamicBVH<T, use_pairs>::is_pairable(OctreeElementID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, false);
+	return e->pairable;
+}
+
+template <class T, bool use_pairs>
+T *DynamicBVH<T, use_pairs>::get(OctreeElementID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, NULL);
+	return e->userdata;
+}
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::get_subindex(OctreeElementID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, -1);
+	return e->subindex;
+}
+
+// walks the tree with an explicit stack, m_node_test decides whether to
+// descend into a node, m_leaf_test whether a leaf element is a result
+#define DYNAMIC_BVH_CULL(m_node_test, m_leaf_test)                                      \
+	if (root == INVALID_INDEX)                                                          \
+		return 0;                                                                       \
+	int result_count = 0;                                                               \
+	int stack[MAX_STACK];                                                               \
+	int stack_size = 0;                                                                 \
+	const Node *n = nodes.ptr();                                                        \
+	const Element *elems = elements.ptr();                                              \
+	stack[stack_size++] = root;                                                         \
+	while (stack_size) {                                                                \
+		const Node &node = n[stack[--stack_size]];                                      \
+		const Rect3 &aabb = node.aabb;                                                  \
+		if (!(m_node_test))                                                             \
+			continue;                                                                   \
+		if (node.is_leaf()) {                                                           \
+			const Element &e = elems[node.element];                                     \
+			if (use_pairs && !(e.pairable_type & p_mask))                               \
+				continue;                                                               \
+			const Rect3 &e_aabb = e.aabb;                                               \
+			if (!(m_leaf_test))                                                         \
+				continue;                                                               \
+			if (result_count >= p_result_max)                                           \
+				return result_count;                                                    \
+			p_result_array[result_count] = e.userdata;                                  \
+			if (p_subindex_array)                                                       \
+				p_subindex_array[result_count] = e.subindex;                            \
+			result_count++;                                                             \
+		} else {                                                                        \
+			ERR_FAIL_COND_V(stack_size + 2 > MAX_STACK, result_count);                  \
+			stack[stack_size++] = node.children[0];                                     \
+			stack[stack_size++] = node.children[1];                                     \
+		}                                                                               \
+	}                                                                                   \
+	return result_count;
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) {
+
+	const Plane *planes = p_convex.ptr();
+	int plane_count = p_convex.size();
+	int *p_subindex_array = NULL;
+
+	DYNAMIC_BVH_CULL(aabb.intersects_convex_shape(planes, plane_count), e_aabb.intersects_convex_shape(planes, plane_count))
+}
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::cull_AABB(const Rect3 &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	DYNAMIC_BVH_CULL(p_aabb.intersects_inclusive(aabb), p_aabb.intersects_inclusive(e_aabb))
+}
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	DYNAMIC_BVH_CULL(aabb.intersects_segment(p_from, p_to), e_aabb.intersects_segment(p_from, p_to))
+}
+
+template <class T, bool use_pairs>
+int DynamicBVH<T, use_pairs>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) {
+
+	DYNAMIC_BVH_CULL(aabb.has_point(p_point), e_aabb.has_point(p_point))
+}
+
+#undef DYNAMIC_BVH_CULL
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	pair_callback = p_callback;
+	pair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+void DynamicBVH<T, use_pairs>::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	unpair_callback = p_callback;
+	unpair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+DynamicBVH<T, use_pairs>::DynamicBVH(real_t p_fat_margin) {
+
+	root = INVALID_INDEX;
+	free_node = INVALID_INDEX;
+	free_element = INVALID_INDEX;
+	element_count = 0;
+	pair_callback = NULL;
+	unpair_callback = NULL;
+	pair_callback_userdata = NULL;
+	unpair_callback_userdata = NULL;
+	pair_count = 0;
+	fat_margin = p_fat_margin;
+}
+
+#endif // DYNAMIC_BVH_H
@@ -0,0 +1,871 @@
+/*************************************************************************/
+/*  math_batch.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "math_batch.h"
+
+#include "error_macros.h"
+
+#ifndef REAL_T_IS_DOUBLE
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_BATCH_SSE2
+#include <emmintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_BATCH_AVX2
+#define MATH_BATCH_AVX2_TARGET __attribute__((target("avx2,fma")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define MATH_BATCH_AVX2
+#define MATH_BATCH_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_BATCH_NEON
+#include <arm_neon.h>
+#endif
+
+#endif // REAL_T_IS_DOUBLE
+
+/* SCALAR */
+
+static void _xform_points_scalar(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_xform.xform(p_src[i]);
+	}
+}
+
+static void _xform_normals_scalar(const Basis &p_normal_basis, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_normal_basis.xform(p_src[i]).normalized();
+	}
+}
+
+static void _xform_aabbs_scalar(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_xform.xform(p_src[i]);
+	}
+}
+
+static void _xform_aabbs_each_scalar(const Transform *p_xforms, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_xforms[i].xform(p_src[i]);
+	}
+}
+
+static void _multiply_scalar(const Transform &p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_a * p_b[i];
+	}
+}
+
+static void _multiply_each_scalar(const Transform *p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_dst[i] = p_a[i] * p_b[i];
+	}
+}
+
+static Rect3 _merge_xformed_aabb_scalar(const Rect3 &p_aabb, const float *p_matrices, int p_stride, int p_count) {
+
+	Rect3 aabb;
+
+	for (int i = 0; i < p_count; i++) {
+
+		const float *m = &p_matrices[i * p_stride];
+		Transform xform;
+		xform.basis.elements[0][0] = m[0];
+		xform.basis.elements[0][1] = m[1];
+		xform.basis.elements[0][2] = m[2];
+		xform.origin.x = m[3];
+		xform.basis.elements[1][0] = m[4];
+		xform.basis.elements[1][1] = m[5];
+		xform.basis.elements[1][2] = m[6];
+		xform.origin.y = m[7];
+		xform.basis.elements[2][0] = m[8];
+		xform.basis.elements[2][1] = m[9];
+		xform.basis.elements[2][2] = m[10];
+		xform.origin.z = m[11];
+
+		Rect3 laabb = xform.xform(p_aabb);
+		if (i == 0)
+			aabb = laabb;
+		else
+			aabb.merge_with(laabb);
+	}
+
+	return aabb;
+}
+
+/* SSE2 */
+
+// All loads and stores touch exactly three floats, so the kernels never read
+// or write past the end of an array and work in place. Transforms are stored
+// as three basis rows followed by the origin.
+
+#ifdef MATH_BATCH_SSE2
+
+static _FORCE_INLINE_ __m128 _sse_load3(const float *p) {
+
+	return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)p)), _mm_load_ss(p + 2));
+}
+
+static _FORCE_INLINE_ void _sse_store3(float *p, __m128 v) {
+
+	_mm_storel_pi((__m64 *)p, v);
+	_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+
+#define SSE_SPLAT(m_v, m_i) _mm_shuffle_ps(m_v, m_v, _MM_SHUFFLE(m_i, m_i, m_i, m_i))
+
+struct SSEColumns {
+
+	__m128 c0, c1, c2, o;
+
+	_FORCE_INLINE_ void load(const Transform &p_xform) {
+
+		const float *e = &p_xform.basis.elements[0][0];
+		__m128 r0 = _sse_load3(e);
+		__m128 r1 = _sse_load3(e + 3);
+		__m128 r2 = _sse_load3(e + 6);
+		__m128 r3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		c0 = r0;
+		c1 = r1;
+		c2 = r2;
+		o = _sse_load3(&p_xform.origin.x);
+	}
+
+	_FORCE_INLINE_ __m128 xform(__m128 v) const {
+
+		__m128 r = _mm_add_ps(o, _mm_mul_ps(c0, SSE_SPLAT(v, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, SSE_SPLAT(v, 1)));
+		return _mm_add_ps(r, _mm_mul_ps(c2, SSE_SPLAT(v, 2)));
+	}
+
+	_FORCE_INLINE_ __m128 basis_xform(__m128 v) const {
+
+		__m128 r = _mm_mul_ps(c0, SSE_SPLAT(v, 0));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, SSE_SPLAT(v, 1)));
+		return _mm_add_ps(r, _mm_mul_ps(c2, SSE_SPLAT(v, 2)));
+	}
+};
+
+static _FORCE_INLINE_ __m128 _sse_abs(__m128 v) {
+
+	return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+}
+
+static _FORCE_INLINE_ __m128 _sse_normalize(__m128 v) {
+
+	__m128 sq = _mm_mul_ps(v, v);
+	__m128 len2 = _mm_add_ss(_mm_add_ss(sq, SSE_SPLAT(sq, 1)), SSE_SPLAT(sq, 2));
+	__m128 len = _mm_sqrt_ps(SSE_SPLAT(len2, 0));
+	// zero length vectors stay zero, like Vector3::normalized()
+	__m128 nonzero = _mm_cmpneq_ps(len, _mm_setzero_ps());
+	return _mm_and_ps(_mm_div_ps(v, len), nonzero);
+}
+
+// transforms an AABB given as center/extents, returns min and max
+static _FORCE_INLINE_ void _sse_xform_aabb(const SSEColumns &p_cols, const Rect3 &p_aabb, __m128 &r_min, __m128 &r_max) {
+
+	__m128 half = _mm_set1_ps(0.5);
+	__m128 size = _sse_load3(&p_aabb.size.x);
+	__m128 extents = _mm_mul_ps(size, half);
+	__m128 center = _mm_add_ps(_sse_load3(&p_aabb.pos.x), extents);
+
+	__m128 new_center = p_cols.xform(center);
+	__m128 new_extents = _mm_mul_ps(_sse_abs(p_cols.c0), SSE_SPLAT(extents, 0));
+	new_extents = _mm_add_ps(new_extents, _mm_mul_ps(_sse_abs(p_cols.c1), SSE_SPLAT(extents, 1)));
+	new_extents = _mm_add_ps(new_extents, _mm_mul_ps(_sse_abs(p_cols.c2), SSE_SPLAT(extents, 2)));
+
+	r_min = _mm_sub_ps(new_center, new_extents);
+	r_max = _mm_add_ps(new_center, new_extents);
+}
+
+static _FORCE_INLINE_ void _sse_store_aabb(Rect3 &r_aabb, __m128 p_min, __m128 p_max) {
+
+	_sse_store3(&r_aabb.pos.x, p_min);
+	_sse_store3(&r_aabb.size.x, _mm_sub_ps(p_max, p_min));
+}
+
+static _FORCE_INLINE_ void _sse_multiply(const float *p_a, const float *p_b, float *p_dst) {
+
+	__m128 a0 = _sse_load3(p_a);
+	__m128 a1 = _sse_load3(p_a + 3);
+	__m128 a2 = _sse_load3(p_a + 6);
+	__m128 ao = _sse_load3(p_a + 9);
+
+	__m128 b0 = _sse_load3(p_b);
+	__m128 b1 = _sse_load3(p_b + 3);
+	__m128 b2 = _sse_load3(p_b + 6);
+	__m128 bo = _sse_load3(p_b + 9);
+
+	// rows of the product basis are combinations of the rows of B
+	__m128 r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(SSE_SPLAT(a0, 0), b0), _mm_mul_ps(SSE_SPLAT(a0, 1), b1)), _mm_mul_ps(SSE_SPLAT(a0, 2), b2));
+	__m128 r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(SSE_SPLAT(a1, 0), b0), _mm_mul_ps(SSE_SPLAT(a1, 1), b1)), _mm_mul_ps(SSE_SPLAT(a1, 2), b2));
+	__m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(SSE_SPLAT(a2, 0), b0), _mm_mul_ps(SSE_SPLAT(a2, 1), b1)), _mm_mul_ps(SSE_SPLAT(a2, 2), b2));
+
+	// origin is A.xform(B.origin), which needs the columns of A
+	__m128 a3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+	__m128 o = _mm_add_ps(ao, _mm_mul_ps(a0, SSE_SPLAT(bo, 0)));
+	o = _mm_add_ps(o, _mm_mul_ps(a1, SSE_SPLAT(bo, 1)));
+	o = _mm_add_ps(o, _mm_mul_ps(a2, SSE_SPLAT(bo, 2)));
+
+	_sse_store3(p_dst, r0);
+	_sse_store3(p_dst + 3, r1);
+	_sse_store3(p_dst + 6, r2);
+	_sse_store3(p_dst + 9, o);
+}
+
+static void _xform_points_sse2(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(p_xform);
+
+	for (int i = 0; i < p_count; i++) {
+		_sse_store3(&p_dst[i].x, cols.xform(_sse_load3(&p_src[i].x)));
+	}
+}
+
+static void _xform_normals_sse2(const Basis &p_normal_basis, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(Transform(p_normal_basis, Vector3()));
+
+	for (int i = 0; i < p_count; i++) {
+		_sse_store3(&p_dst[i].x, _sse_normalize(cols.basis_xform(_sse_load3(&p_src[i].x))));
+	}
+}
+
+static void _xform_aabbs_sse2(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(p_xform);
+
+	for (int i = 0; i < p_count; i++) {
+
+		__m128 min, max;
+		_sse_xform_aabb(cols, p_src[i], min, max);
+		_sse_store_aabb(p_dst[i], min, max);
+	}
+}
+
+static void _xform_aabbs_each_sse2(const Transform *p_xforms, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		SSEColumns cols;
+		cols.load(p_xforms[i]);
+
+		__m128 min, max;
+		_sse_xform_aabb(cols, p_src[i], min, max);
+		_sse_store_aabb(p_dst[i], min, max);
+	}
+}
+
+static void _multiply_sse2(const Transform &p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	const float *a = &p_a.basis.elements[0][0];
+
+	for (int i = 0; i < p_count; i++) {
+		_sse_multiply(a, &p_b[i].basis.elements[0][0], &p_dst[i].basis.elements[0][0]);
+	}
+}
+
+static void _multiply_each_sse2(const Transform *p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		_sse_multiply(&p_a[i].basis.elements[0][0], &p_b[i].basis.elements[0][0], &p_dst[i].basis.elements[0][0]);
+	}
+}
+
+static Rect3 _merge_xformed_aabb_sse2(const Rect3 &p_aabb, const float *p_matrices, int p_stride, int p_count) {
+
+	if (p_count <= 0)
+		return Rect3();
+
+	__m128 half = _mm_set1_ps(0.5);
+	__m128 size = _sse_load3(&p_aabb.size.x);
+	__m128 extents = _mm_mul_ps(size, half);
+	__m128 center = _mm_add_ps(_sse_load3(&p_aabb.pos.x), extents);
+
+	__m128 ex = SSE_SPLAT(extents, 0);
+	__m128 ey = SSE_SPLAT(extents, 1);
+	__m128 ez = SSE_SPLAT(extents, 2);
+	__m128 cx = SSE_SPLAT(center, 0);
+	__m128 cy = SSE_SPLAT(center, 1);
+	__m128 cz = SSE_SPLAT(center, 2);
+
+	__m128 min = _mm_set1_ps(1e30);
+	__m128 max = _mm_set1_ps(-1e30);
+
+	for (int i = 0; i < p_count; i++) {
+
+		// rows are (basis row, origin component), transposing gives the
+		// basis columns and the origin
+		const float *m = &p_matrices[i * p_stride];
+		__m128 c0 = _mm_loadu_ps(m);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 o = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(c0, c1, c2, o);
+
+		__m128 new_center = _mm_add_ps(o, _mm_mul_ps(c0, cx));
+		new_center = _mm_add_ps(new_center, _mm_mul_ps(c1, cy));
+		new_center = _mm_add_ps(new_center, _mm_mul_ps(c2, cz));
+
+		__m128 new_extents = _mm_mul_ps(_sse_abs(c0), ex);
+		new_extents = _mm_add_ps(new_extents, _mm_mul_ps(_sse_abs(c1), ey));
+		new_extents = _mm_add_ps(new_extents, _mm_mul_ps(_sse_abs(c2), ez));
+
+		min = _mm_min_ps(min, _mm_sub_ps(new_center, new_extents));
+		max = _mm_max_ps(max, _mm_add_ps(new_center, new_extents));
+	}
+
+	Rect3 aabb;
+	_sse_store_aabb(aabb, min, max);
+	return aabb;
+}
+
+#endif // MATH_BATCH_SSE2
+
+/* AVX2 */
+
+// Processes two elements per iteration, one in each 128 bit lane, and falls
+// back to the SSE2 kernels for what does not benefit from it.
+
+#ifdef MATH_BATCH_AVX2
+
+static MATH_BATCH_AVX2_TARGET _FORCE_INLINE_ __m256 _avx_splat2(__m128 v) {
+
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+}
+
+static MATH_BATCH_AVX2_TARGET _FORCE_INLINE_ __m256 _avx_load3x2(const float *p_a, const float *p_b) {
+
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_sse_load3(p_a)), _sse_load3(p_b), 1);
+}
+
+static MATH_BATCH_AVX2_TARGET _FORCE_INLINE_ void _avx_store3x2(float *p_a, float *p_b, __m256 v) {
+
+	_sse_store3(p_a, _mm256_castps256_ps128(v));
+	_sse_store3(p_b, _mm256_extractf128_ps(v, 1));
+}
+
+static MATH_BATCH_AVX2_TARGET void _xform_points_avx2(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(p_xform);
+
+	__m256 c0 = _avx_splat2(cols.c0);
+	__m256 c1 = _avx_splat2(cols.c1);
+	__m256 c2 = _avx_splat2(cols.c2);
+	__m256 o = _avx_splat2(cols.o);
+
+	int i = 0;
+	for (; i + 2 <= p_count; i += 2) {
+
+		__m256 v = _avx_load3x2(&p_src[i].x, &p_src[i + 1].x);
+		__m256 r = _mm256_fmadd_ps(c0, _mm256_permute_ps(v, 0x00), o);
+		r = _mm256_fmadd_ps(c1, _mm256_permute_ps(v, 0x55), r);
+		r = _mm256_fmadd_ps(c2, _mm256_permute_ps(v, 0xAA), r);
+		_avx_store3x2(&p_dst[i].x, &p_dst[i + 1].x, r);
+	}
+
+	for (; i < p_count; i++) {
+		_sse_store3(&p_dst[i].x, cols.xform(_sse_load3(&p_src[i].x)));
+	}
+}
+
+static MATH_BATCH_AVX2_TARGET void _xform_normals_avx2(const Basis &p_normal_basis, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(Transform(p_normal_basis, Vector3()));
+
+	__m256 c0 = _avx_splat2(cols.c0);
+	__m256 c1 = _avx_splat2(cols.c1);
+	__m256 c2 = _avx_splat2(cols.c2);
+	__m256 zero = _mm256_setzero_ps();
+
+	int i = 0;
+	for (; i + 2 <= p_count; i += 2) {
+
+		__m256 v = _avx_load3x2(&p_src[i].x, &p_src[i + 1].x);
+		__m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+		r = _mm256_fmadd_ps(c1, _mm256_permute_ps(v, 0x55), r);
+		r = _mm256_fmadd_ps(c2, _mm256_permute_ps(v, 0xAA), r);
+
+		__m256 sq = _mm256_mul_ps(r, r);
+		__m256 len = _mm256_add_ps(_mm256_add_ps(_mm256_permute_ps(sq, 0x00), _mm256_permute_ps(sq, 0x55)), _mm256_permute_ps(sq, 0xAA));
+		len = _mm256_sqrt_ps(len);
+		__m256 nonzero = _mm256_cmp_ps(len, zero, _CMP_NEQ_OQ);
+		r = _mm256_and_ps(_mm256_div_ps(r, len), nonzero);
+
+		_avx_store3x2(&p_dst[i].x, &p_dst[i + 1].x, r);
+	}
+
+	for (; i < p_count; i++) {
+		_sse_store3(&p_dst[i].x, _sse_normalize(cols.basis_xform(_sse_load3(&p_src[i].x))));
+	}
+}
+
+static MATH_BATCH_AVX2_TARGET void _xform_aabbs_avx2(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	SSEColumns cols;
+	cols.load(p_xform);
+
+	__m256 c0 = _avx_splat2(cols.c0);
+	__m256 c1 = _avx_splat2(cols.c1);
+	__m256 c2 = _avx_splat2(cols.c2);
+	__m256 o = _avx_splat2(cols.o);
+	__m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+	__m256 a0 = _mm256_and_ps(c0, abs_mask);
+	__m256 a1 = _mm256_and_ps(c1, abs_mask);
+	__m256 a2 = _mm256_and_ps(c2, abs_mask);
+	__m256 half = _mm256_set1_ps(0.5);
+
+	int i = 0;
+	for (; i + 2 <= p_count; i += 2) {
+
+		__m256 extents = _mm256_mul_ps(_avx_load3x2(&p_src[i].size.x, &p_src[i + 1].size.x), half);
+		__m256 center = _mm256_add_ps(_avx_load3x2(&p_src[i].pos.x, &p_src[i + 1].pos.x), extents);
+
+		__m256 new_center = _mm256_fmadd_ps(c0, _mm256_permute_ps(center, 0x00), o);
+		new_center = _mm256_fmadd_ps(c1, _mm256_permute_ps(center, 0x55), new_center);
+		new_center = _mm256_fmadd_ps(c2, _mm256_permute_ps(center, 0xAA), new_center);
+
+		__m256 new_extents = _mm256_mul_ps(a0, _mm256_permute_ps(extents, 0x00));
+		new_extents = _mm256_fmadd_ps(a1, _mm256_permute_ps(extents, 0x55), new_extents);
+		new_extents = _mm256_fmadd_ps(a2, _mm256_permute_ps(extents, 0xAA), new_extents);
+
+		_avx_store3x2(&p_dst[i].pos.x, &p_dst[i + 1].pos.x, _mm256_sub_ps(new_center, new_extents));
+		_avx_store3x2(&p_dst[i].size.x, &p_dst[i + 1].size.x, _mm256_add_ps(new_extents, new_extents));
+	}
+
+	for (; i < p_count; i++) {
+
+		__m128 min, max;
+		_sse_xform_aabb(cols, p_src[i], min, max);
+		_sse_store_aabb(p_dst[i], min, max);
+	}
+}
+
+static bool _cpu_has_avx2() {
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !fma || (_xgetbv(0) & 6) != 6) // OS saves YMM registers
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0, NULL) < 7)
+		return false;
+
+	__cpuid(1, eax, ebx, ecx, edx);
+	bool osxsave = (ecx & (1 << 27)) != 0;
+	bool fma = (ecx & (1 << 12)) != 0;
+	if (!osxsave || !fma)
+		return false;
+
+	unsigned int xcr0_lo, xcr0_hi;
+	__asm__("xgetbv"
+			: "=a"(xcr0_lo), "=d"(xcr0_hi)
+			: "c"(0));
+	if ((xcr0_lo & 6) != 6) // OS saves YMM registers
+		return false;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & (1 << 5)) != 0;
+#endif
+}
+
+#endif // MATH_BATCH_AVX2
+
+/* NEON */
+
+#ifdef MATH_BATCH_NEON
+
+static _FORCE_INLINE_ float32x4_t _neon_load3(const float *p) {
+
+	return vcombine_f32(vld1_f32(p), vset_lane_f32(p[2], vdup_n_f32(0), 0));
+}
+
+static _FORCE_INLINE_ void _neon_store3(float *p, float32x4_t v) {
+
+	vst1_f32(p, vget_low_f32(v));
+	vst1q_lane_f32(p + 2, v, 2);
+}
+
+static _FORCE_INLINE_ float32x4_t _neon_column(const Basis &p_basis, int p_axis) {
+
+	float col[4] = { (float)p_basis.elements[0][p_axis], (float)p_basis.elements[1][p_axis], (float)p_basis.elements[2][p_axis], 0 };
+	return vld1q_f32(col);
+}
+
+struct NEONColumns {
+
+	float32x4_t c0, c1, c2, o;
+
+	_FORCE_INLINE_ void load(const Transform &p_xform) {
+
+		c0 = _neon_column(p_xform.basis, 0);
+		c1 = _neon_column(p_xform.basis, 1);
+		c2 = _neon_column(p_xform.basis, 2);
+		o = _neon_load3(&p_xform.origin.x);
+	}
+
+	_FORCE_INLINE_ float32x4_t basis_xform(float32x4_t v) const {
+
+		float32x2_t lo = vget_low_f32(v);
+		float32x4_t r = vmulq_lane_f32(c0, lo, 0);
+		r = vmlaq_lane_f32(r, c1, lo, 1);
+		return vmlaq_lane_f32(r, c2, vget_high_f32(v), 0);
+	}
+
+	_FORCE_INLINE_ float32x4_t xform(float32x4_t v) const {
+
+		return vaddq_f32(o, basis_xform(v));
+	}
+};
+
+static _FORCE_INLINE_ float32x4_t _neon_normalize(float32x4_t v) {
+
+	float32x4_t sq = vmulq_f32(v, v);
+	float len = Math::sqrt(vgetq_lane_f32(sq, 0) + vgetq_lane_f32(sq, 1) + vgetq_lane_f32(sq, 2));
+	if (len == 0)
+		return vdupq_n_f32(0);
+	return vmulq_n_f32(v, 1.0 / len);
+}
+
+static _FORCE_INLINE_ void _neon_xform_aabb(const NEONColumns &p_cols, const Rect3 &p_aabb, float32x4_t &r_min, float32x4_t &r_max) {
+
+	float32x4_t extents = vmulq_n_f32(_neon_load3(&p_aabb.size.x), 0.5);
+	float32x4_t center = vaddq_f32(_neon_load3(&p_aabb.pos.x), extents);
+
+	float32x4_t new_center = p_cols.xform(center);
+
+	float32x2_t lo = vget_low_f32(extents);
+	float32x4_t new_extents = vmulq_lane_f32(vabsq_f32(p_cols.c0), lo, 0);
+	new_extents = vmlaq_lane_f32(new_extents, vabsq_f32(p_cols.c1), lo, 1);
+	new_extents = vmlaq_lane_f32(new_extents, vabsq_f32(p_cols.c2), vget_high_f32(extents), 0);
+
+	r_min = vsubq_f32(new_center, new_extents);
+	r_max = vaddq_f32(new_center, new_extents);
+}
+
+static _FORCE_INLINE_ void _neon_store_aabb(Rect3 &r_aabb, float32x4_t p_min, float32x4_t p_max) {
+
+	_neon_store3(&r_aabb.pos.x, p_min);
+	_neon_store3(&r_aabb.size.x, vsubq_f32(p_max, p_min));
+}
+
+static _FORCE_INLINE_ void _neon_multiply(const Transform &p_a, const Transform &p_b, Transform &r_dst) {
+
+	NEONColumns a;
+	a.load(p_a);
+
+	// the basis of the product is A applied to the columns of B, rebuilt
+	// from the rows of B so the result can be stored row by row
+	float32x4_t b0 = _neon_load3(&p_b.basis.elements[0][0]);
+	float32x4_t b1 = _neon_load3(&p_b.basis.elements[1][0]);
+	float32x4_t b2 = _neon_load3(&p_b.basis.elements[2][0]);
+
+	float32x4_t r[3];
+	for (int i = 0; i < 3; i++) {
+		r[i] = vmulq_n_f32(b0, p_a.basis.elements[i][0]);
+		r[i] = vmlaq_n_f32(r[i], b1, p_a.basis.elements[i][1]);
+		r[i] = vmlaq_n_f32(r[i], b2, p_a.basis.elements[i][2]);
+	}
+
+	float32x4_t o = a.xform(_neon_load3(&p_b.origin.x));
+
+	_neon_store3(&r_dst.basis.elements[0][0], r[0]);
+	_neon_store3(&r_dst.basis.elements[1][0], r[1]);
+	_neon_store3(&r_dst.basis.elements[2][0], r[2]);
+	_neon_store3(&r_dst.origin.x, o);
+}
+
+static void _xform_points_neon(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	NEONColumns cols;
+	cols.load(p_xform);
+
+	for (int i = 0; i < p_count; i++) {
+		_neon_store3(&p_dst[i].x, cols.xform(_neon_load3(&p_src[i].x)));
+	}
+}
+
+static void _xform_normals_neon(const Basis &p_normal_basis, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	NEONColumns cols;
+	cols.load(Transform(p_normal_basis, Vector3()));
+
+	for (int i = 0; i < p_count; i++) {
+		_neon_store3(&p_dst[i].x, _neon_normalize(cols.basis_xform(_neon_load3(&p_src[i].x))));
+	}
+}
+
+static void _xform_aabbs_neon(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	NEONColumns cols;
+	cols.load(p_xform);
+
+	for (int i = 0; i < p_count; i++) {
+
+		float32x4_t min, max;
+		_neon_xform_aabb(cols, p_src[i], min, max);
+		_neon_store_aabb(p_dst[i], min, max);
+	}
+}
+
+static void _xform_aabbs_each_neon(const Transform *p_xforms, const Rect3 *p_src, Rect3 *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		NEONColumns cols;
+		cols.load(p_xforms[i]);
+
+		float32x4_t min, max;
+		_neon_xform_aabb(cols, p_src[i], min, max);
+		_neon_store_aabb(p_dst[i], min, max);
+	}
+}
+
+static void _multiply_neon(const Transform &p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		_neon_multiply(p_a, p_b[i], p_dst[i]);
+	}
+}
+
+static void _multiply_each_neon(const Transform *p_a, const Transform *p_b, Transform *p_dst, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		_neon_multiply(p_a[i], p_b[i], p_dst[i]);
+	}
+}
+
+static Rect3 _merge_xformed_aabb_neon(const Rect3 &p_aabb, const float *p_matrices, int p_stride, int p_count) {
+
+	if (p_count <= 0)
+		return Rect3();
+
+	float32x4_t extents = vmulq_n_f32(_neon_load3(&p_aabb.size.x), 0.5);
+	float32x4_t center = vaddq_f32(_neon_load3(&p_aabb.pos.x), extents);
+
+	float32x4_t min = vdupq_n_f32(1e30);
+	float32x4_t max = vdupq_n_f32(-1e30);
+
+	for (int i = 0; i < p_count; i++) {
+
+		// rows are (basis row, origin component)
+		const float *m = &p_matrices[i * p_stride];
+		float32x4_t r0 = vld1q_f32(m);
+		float32x4_t r1 = vld1q_f32(m + 4);
+		float32x4_t r2 = vld1q_f32(m + 8);
+
+		float32x4_t new_center = vmulq_f32(r0, center);
+		float32x4_t cy = vmulq_f32(r1, center);
+		float32x4_t cz = vmulq_f32(r2, center);
+
+		float32x4_t new_extents = vmulq_f32(vabsq_f32(r0), extents);
+		float32x4_t ey = vmulq_f32(vabsq_f32(r1), extents);
+		float32x4_t ez = vmulq_f32(vabsq_f32(r2), extents);
+
+		float c[4] = {
+			vgetq_lane_f32(new_center, 0) + vgetq_lane_f32(new_center, 1) + vgetq_lane_f32(new_center, 2) + m[3],
+			vgetq_lane_f32(cy, 0) + vgetq_lane_f32(cy, 1) + vgetq_lane_f32(cy, 2) + m[7],
+			vgetq_lane_f32(cz, 0) + vgetq_lane_f32(cz, 1) + vgetq_lane_f32(cz, 2) + m[11],
+			0
+		};
+		float e[4] = {
+			vgetq_lane_f32(new_extents, 0) + vgetq_lane_f32(new_extents, 1) + vgetq_lane_f32(new_extents, 2),
+			vgetq_lane_f32(ey, 0) + vgetq_lane_f32(ey, 1) + vgetq_lane_f32(ey, 2),
+			vgetq_lane_f32(ez, 0) + vgetq_lane_f32(ez, 1) + vgetq_lane_f32(ez, 2),
+			0
+		};
+
+		float32x4_t vc = vld1q_f32(c);
+		float32x4_t ve = vld1q_f32(e);
+		min = vminq_f32(min, vsubq_f32(vc, ve));
+		max = vmaxq_f32(max, vaddq_f32(vc, ve));
+	}
+
+	Rect3 aabb;
+	_neon_store_aabb(aabb, min, max);
+	return aabb;
+}
+
+#endif // MATH_BATCH_NEON
+
+/* DISPATCH */
+
+MathBatch::Backend MathBatch::backend = MathBatch::BACKEND_SCALAR;
+
+MathBatch::Kernels MathBatch::kernels = {
+	_xform_points_scalar,
+	_xform_normals_scalar,
+	_xform_aabbs_scalar,
+	_xform_aabbs_each_scalar,
+	_multiply_scalar,
+	_multiply_each_scalar,
+	_merge_xformed_aabb_scalar
+};
+
+void MathBatch::init() {
+
+	if (is_backend_supported(BACKEND_AVX2)) {
+		set_backend(BACKEND_AVX2);
+	} else if (is_backend_supported(BACKEND_SSE2)) {
+		set_backend(BACKEND_SSE2);
+	} else if (is_backend_supported(BACKEND_NEON)) {
+		set_backend(BACKEND_NEON);
+	} else {
+		set_backend(BACKEND_SCALAR);
+	}
+}
+
+bool MathBatch::is_backend_supported(Backend p_backend) {
+
+	switch (p_backend) {
+		case BACKEND_SCALAR: return true;
+#ifdef MATH_BATCH_SSE2
+		case BACKEND_SSE2: return true;
+#endif
+#ifdef MATH_BATCH_AVX2
+		case BACKEND_AVX2: {
+			static int supported = -1;
+			if (supported == -1) {
+				supported = _cpu_has_avx2() ? 1 : 0;
+			}
+			return supported == 1;
+		}
+#endif
+#ifdef MATH_BATCH_NEON
+		case BACKEND_NEON: return true;
+#endif
+		default: return false;
+	}
+}
+
+void MathBatch::set_backend(Backend p_backend) {
+
+	ERR_FAIL_INDEX(p_backend, BACKEND_MAX);
+	ERR_FAIL_COND(!is_backend_supported(p_backend));
+
+	backend = p_backend;
+
+	switch (p_backend) {
+		case BACKEND_SCALAR: {
+			kernels.xform_points = _xform_points_scalar;
+			kernels.xform_normals = _xform_normals_scalar;
+			kernels.xform_aabbs = _xform_aabbs_scalar;
+			kernels.xform_aabbs_each = _xform_aabbs_each_scalar;
+			kernels.multiply = _multiply_scalar;
+			kernels.multiply_each = _multiply_each_scalar;
+			kernels.merge_xformed_aabb = _merge_xformed_aabb_scalar;
+		} break;
+#ifdef MATH_BATCH_SSE2
+		case BACKEND_SSE2: {
+			kernels.xform_points = _xform_points_sse2;
+			kernels.xform_normals = _xform_normals_sse2;
+			kernels.xform_aabbs = _xform_aabbs_sse2;
+			kernels.xform_aabbs_each = _xform_aabbs_each_sse2;
+			kernels.multiply = _multiply_sse2;
+			kernels.multiply_each = _multiply_each_sse2;
+			kernels.merge_xformed_aabb = _merge_xformed_aabb_sse2;
+		} break;
+#endif
+#ifdef MATH_BATCH_AVX2
+		case BACKEND_AVX2: {
+			kernels.xform_points = _xform_points_avx2;
+			kernels.xform_normals = _xform_normals_avx2;
+			kernels.xform_aabbs = _xform_aabbs_avx2;
+			kernels.xform_aabbs_each = _xform_aabbs_each_sse2;
+			kernels.multiply = _multiply_sse2;
+			kernels.multiply_each = _multiply_each_sse2;
+			kernels.merge_xformed_aabb = _merge_xformed_aabb_sse2;
+		} break;
+#endif
+#ifdef MATH_BATCH_NEON
+		case BACKEND_NEON: {
+			kernels.xform_points = _xform_points_neon;
+			kernels.xform_normals = _xform_normals_neon;
+			kernels.xform_aabbs = _xform_aabbs_neon;
+			kernels.xform_aabbs_each = _xform_aabbs_each_neon;
+			kernels.multiply = _multiply_neon;
+			kernels.multiply_each = _multiply_each_neon;
+			kernels.merge_xformed_aabb = _merge_xformed_aabb_neon;
+		} break;
+#endif
+		default: {}
+	}
+}
+
+const char *MathBatch::get_backend_name(Backend p_backend) {
+
+	static const char *names[BACKEND_MAX] = {
+		"Scalar",
+		"SSE2",
+		"AVX2",
+		"NEON"
+	};
+
+	ERR_FAIL_INDEX_V(p_backend, BACKEND_MAX, "");
+	return names[p_backend];
+}
+
+void MathBatch::xform_normals(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) {
+
+	if (p_count <= 0)
+		return;
+
+	kernels.xform_normals(p_xform.basis.inverse().transposed(), p_src, p_dst, p_count);
+}
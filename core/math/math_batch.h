@@ -0,0 +1,100 @@
+/*************************************************************************/
+/*  math_batch.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef MATH_BATCH_H
+#define MATH_BATCH_H
+
+#include "rect3.h"
+#include "transform.h"
+
+/**
+ * Batch versions of the most common Transform operations, for hot loops
+ * that process many elements at once (skeletons, multimeshes, arrays of
+ * vertices).
+ *
+ * The implementation is picked at runtime by init() from what the CPU
+ * supports (SSE2, AVX2+FMA or NEON), with a scalar fallback that is just a
+ * loop over the regular Transform methods. SIMD backends are only used when
+ * real_t is float. Results may differ from the scalar path by rounding.
+ *
+ * Source and destination arrays may be the same, but must not otherwise
+ * overlap.
+ */
+
+class MathBatch {
+public:
+	enum Backend {
+		BACKEND_SCALAR,
+		BACKEND_SSE2,
+		BACKEND_AVX2,
+		BACKEND_NEON,
+		BACKEND_MAX
+	};
+
+private:
+	struct Kernels {
+
+		void (*xform_points)(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count);
+		void (*xform_normals)(const Basis &p_normal_basis, const Vector3 *p_src, Vector3 *p_dst, int p_count);
+		void (*xform_aabbs)(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count);
+		void (*xform_aabbs_each)(const Transform *p_xforms, const Rect3 *p_src, Rect3 *p_dst, int p_count);
+		void (*multiply)(const Transform &p_a, const Transform *p_b, Transform *p_dst, int p_count);
+		void (*multiply_each)(const Transform *p_a, const Transform *p_b, Transform *p_dst, int p_count);
+		Rect3 (*merge_xformed_aabb)(const Rect3 &p_aabb, const float *p_matrices, int p_stride, int p_count);
+	};
+
+	static Backend backend;
+	static Kernels kernels;
+
+public:
+	static void init(); // select the best backend for this CPU
+
+	static bool is_backend_supported(Backend p_backend);
+	static void set_backend(Backend p_backend);
+	static Backend get_backend() { return backend; }
+	static const char *get_backend_name(Backend p_backend);
+
+	// p_dst[i] = p_xform.xform(p_src[i])
+	static _FORCE_INLINE_ void xform_points(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count) { kernels.xform_points(p_xform, p_src, p_dst, p_count); }
+	// normals are transformed by the inverse transpose of the basis and normalized
+	static void xform_normals(const Transform &p_xform, const Vector3 *p_src, Vector3 *p_dst, int p_count);
+	// p_dst[i] = p_xform.xform(p_src[i])
+	static _FORCE_INLINE_ void xform_aabbs(const Transform &p_xform, const Rect3 *p_src, Rect3 *p_dst, int p_count) { kernels.xform_aabbs(p_xform, p_src, p_dst, p_count); }
+	// p_dst[i] = p_xforms[i].xform(p_src[i]), world AABBs from local AABBs
+	static _FORCE_INLINE_ void xform_aabbs(const Transform *p_xforms, const Rect3 *p_src, Rect3 *p_dst, int p_count) { kernels.xform_aabbs_each(p_xforms, p_src, p_dst, p_count); }
+	// p_dst[i] = p_a * p_b[i]
+	static _FORCE_INLINE_ void multiply(const Transform &p_a, const Transform *p_b, Transform *p_dst, int p_count) { kernels.multiply(p_a, p_b, p_dst, p_count); }
+	// p_dst[i] = p_a[i] * p_b[i]
+	static _FORCE_INLINE_ void multiply(const Transform *p_a, const Transform *p_b, Transform *p_dst, int p_count) { kernels.multiply_each(p_a, p_b, p_dst, p_count); }
+	// merges p_aabb transformed by p_count row-major 3x4 float matrices (the
+	// layout used by multimesh buffers), p_stride floats apart
+	static _FORCE_INLINE_ Rect3 merge_xformed_aabb(const Rect3 &p_aabb, const float *p_matrices, int p_stride, int p_count) { return kernels.merge_xformed_aabb(p_aabb, p_matrices, p_stride, p_count); }
+};
+
+#endif // MATH_BATCH_H
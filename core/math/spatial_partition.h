@@ -0,0 +1,147 @@
+/*************************************************************************/
+/*  spatial_partition.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef SPATIAL_PARTITION_H
+#define SPATIAL_PARTITION_H
+
+#include "dynamic_bvh.h"
+#include "octree.h"
+
+/**
+ * Forwards to either an Octree or a DynamicBVH, so users of the octree API
+ * can pick the structure at runtime. The mode can only be changed while
+ * empty, callers are expected to erase and recreate their elements.
+ */
+
+template <class T, bool use_pairs = false>
+class SpatialPartition {
+public:
+	enum Mode {
+		MODE_OCTREE,
+		MODE_DYNAMIC_BVH,
+	};
+
+	typedef typename Octree<T, use_pairs>::PairCallback PairCallback;
+	typedef typename Octree<T, use_pairs>::UnpairCallback UnpairCallback;
+
+private:
+	Mode mode;
+	int element_count;
+
+	Octree<T, use_pairs> octree;
+	DynamicBVH<T, use_pairs> bvh;
+
+public:
+	void set_mode(Mode p_mode) {
+
+		ERR_FAIL_COND(element_count > 0);
+		mode = p_mode;
+	}
+	Mode get_mode() const { return mode; }
+
+	_FORCE_INLINE_ OctreeElementID create(T *p_userdata, const Rect3 &p_aabb = Rect3(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) {
+
+		OctreeElementID id = mode == MODE_OCTREE ? octree.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask) : bvh.create(p_userdata, p_aabb, p_subindex, p_pairable, p_pairable_type, p_pairable_mask);
+		if (id)
+			element_count++;
+		return id;
+	}
+
+	_FORCE_INLINE_ void move(OctreeElementID p_id, const Rect3 &p_aabb) {
+
+		if (mode == MODE_OCTREE)
+			octree.move(p_id, p_aabb);
+		else
+			bvh.move(p_id, p_aabb);
+	}
+
+	_FORCE_INLINE_ void set_pairable(OctreeElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) {
+
+		if (mode == MODE_OCTREE)
+			octree.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+		else
+			bvh.set_pairable(p_id, p_pairable, p_pairable_type, p_pairable_mask);
+	}
+
+	_FORCE_INLINE_ void erase(OctreeElementID p_id) {
+
+		if (mode == MODE_OCTREE)
+			octree.erase(p_id);
+		else
+			bvh.erase(p_id);
+		element_count--;
+	}
+
+	_FORCE_INLINE_ bool is_pairable(OctreeElementID p_id) const { return mode == MODE_OCTREE ? octree.is_pairable(p_id) : bvh.is_pairable(p_id); }
+	_FORCE_INLINE_ T *get(OctreeElementID p_id) const { return mode == MODE_OCTREE ? octree.get(p_id) : bvh.get(p_id); }
+	_FORCE_INLINE_ int get_subindex(OctreeElementID p_id) const { return mode == MODE_OCTREE ? octree.get_subindex(p_id) : bvh.get_subindex(p_id); }
+
+	_FORCE_INLINE_ int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) {
+
+		return mode == MODE_OCTREE ? octree.cull_convex(p_convex, p_result_array, p_result_max, p_mask) : bvh.cull_convex(p_convex, p_result_array, p_result_max, p_mask);
+	}
+
+	_FORCE_INLINE_ int cull_AABB(const Rect3 &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) {
+
+		return mode == MODE_OCTREE ? octree.cull_AABB(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask) : bvh.cull_AABB(p_aabb, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	_FORCE_INLINE_ int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) {
+
+		return mode == MODE_OCTREE ? octree.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask) : bvh.cull_segment(p_from, p_to, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	_FORCE_INLINE_ int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) {
+
+		return mode == MODE_OCTREE ? octree.cull_point(p_point, p_result_array, p_result_max, p_subindex_array, p_mask) : bvh.cull_point(p_point, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+		octree.set_pair_callback(p_callback, p_userdata);
+		bvh.set_pair_callback(p_callback, p_userdata);
+	}
+
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+		octree.set_unpair_callback(p_callback, p_userdata);
+		bvh.set_unpair_callback(p_callback, p_userdata);
+	}
+
+	int get_element_count() const { return element_count; }
+	int get_pair_count() const { return mode == MODE_OCTREE ? octree.get_pair_count() : bvh.get_pair_count(); }
+
+	SpatialPartition(Mode p_mode = MODE_OCTREE) {
+
+		mode = p_mode;
+		element_count = 0;
+	}
+};
+
+#endif // SPATIAL_PARTITION_H
@@ -108,6 +108,199 @@ void MethodBind::_generate_argument_types(int p_count) {
 
 #endif
 
+#ifdef PTRCALL_ENABLED
+
+PtrCallArg MethodBind::_gen_ptrcall_arg(int p_arg) const {
+
+	PtrCallArg arg;
+	arg.type = Variant::NIL;
+	arg.encoding = p_arg == -1 ? PTRCALL_VOID : PTRCALL_UNSUPPORTED;
+	return arg;
+}
+
+void MethodBind::_generate_ptrcall_args(int p_count) {
+
+	if (ptrcall_args) {
+		memdelete_arr(ptrcall_args);
+		ptrcall_args = NULL;
+	}
+
+	if (p_count > VARIANT_PTRCALL_MAX_ARGS)
+		return;
+
+	PtrCallArg *args = memnew_arr(PtrCallArg, p_count + 1);
+	for (int i = 0; i < p_count + 1; i++) {
+
+		args[i] = _gen_ptrcall_arg(i - 1);
+		if (args[i].encoding == PTRCALL_UNSUPPORTED) {
+			memdelete_arr(args);
+			return;
+		}
+	}
+
+	ptrcall_args = args;
+}
+
+static _FORCE_INLINE_ bool _variant_aliases(const Variant *p_variant, const Variant **p_args, int p_arg_count) {
+
+	for (int i = 0; i < p_arg_count; i++) {
+		if (p_args[i] == p_variant)
+			return true;
+	}
+	return false;
+}
+
+bool MethodBind::variant_ptrcall(Object *p_object, const Variant **p_args, int p_arg_count, Variant *r_ret) {
+
+	if (!ptrcall_args || p_arg_count > argument_count || p_arg_count < argument_count - default_argument_count)
+		return false;
+
+	union Scalar {
+		bool _bool;
+		int32_t _int;
+		int64_t _int64;
+		float _float;
+		double _double;
+		Object *_object;
+	};
+
+	Scalar scalars[VARIANT_PTRCALL_MAX_ARGS];
+	const void *argptrs[VARIANT_PTRCALL_MAX_ARGS];
+	NodePath path; //string to path is the only non scalar conversion done here, and only once per call
+	bool path_used = false;
+
+	for (int i = 0; i < argument_count; i++) {
+
+		const Variant *arg = i < p_arg_count ? p_args[i] : &default_arguments.ptr()[argument_count - i - 1];
+		const PtrCallArg &pa = ptrcall_args[i + 1];
+		Variant::Type type = arg->type;
+
+		//same conversions call() accepts between these types, anything else goes through it
+		switch (pa.encoding) {
+
+			case PTRCALL_BOOL: {
+				if (type == Variant::BOOL)
+					argptrs[i] = &arg->_data._bool;
+				else if (type == Variant::INT) {
+					scalars[i]._bool = arg->_data._int != 0;
+					argptrs[i] = &scalars[i];
+				} else
+					return false;
+			} break;
+			case PTRCALL_INT: {
+				if (type == Variant::INT)
+					scalars[i]._int = arg->_data._int;
+				else if (type == Variant::REAL)
+					scalars[i]._int = arg->_data._real;
+				else
+					return false;
+				argptrs[i] = &scalars[i];
+			} break;
+			case PTRCALL_INT64: {
+				if (type == Variant::INT)
+					argptrs[i] = &arg->_data._int;
+				else if (type == Variant::REAL) {
+					scalars[i]._int64 = arg->_data._real;
+					argptrs[i] = &scalars[i];
+				} else
+					return false;
+			} break;
+			case PTRCALL_FLOAT: {
+				if (type == Variant::REAL)
+					scalars[i]._float = arg->_data._real;
+				else if (type == Variant::INT)
+					scalars[i]._float = arg->_data._int;
+				else
+					return false;
+				argptrs[i] = &scalars[i];
+			} break;
+			case PTRCALL_DOUBLE: {
+				if (type == Variant::REAL)
+					argptrs[i] = &arg->_data._real;
+				else if (type == Variant::INT) {
+					scalars[i]._double = arg->_data._int;
+					argptrs[i] = &scalars[i];
+				} else
+					return false;
+			} break;
+			case PTRCALL_NATIVE: {
+				if (type == pa.type) {
+					argptrs[i] = arg->_get_native_ptr();
+				} else if (pa.type == Variant::NODE_PATH && type == Variant::STRING && !path_used) {
+					path = *reinterpret_cast<const String *>(arg->_data._mem);
+					path_used = true;
+					argptrs[i] = &path;
+				} else
+					return false;
+			} break;
+			case PTRCALL_VARIANT: {
+				argptrs[i] = arg;
+			} break;
+			default: {
+				return false;
+			}
+		}
+	}
+
+	const PtrCallArg &pr = ptrcall_args[0];
+
+	switch (pr.encoding) {
+
+		case PTRCALL_VOID: {
+			ptrcall(p_object, argptrs, NULL);
+			if (r_ret)
+				*r_ret = Variant();
+		} break;
+		case PTRCALL_BOOL: {
+			Scalar ret;
+			ptrcall(p_object, argptrs, &ret);
+			if (r_ret)
+				*r_ret = ret._bool;
+		} break;
+		case PTRCALL_INT: {
+			Scalar ret;
+			ptrcall(p_object, argptrs, &ret);
+			if (r_ret)
+				*r_ret = ret._int;
+		} break;
+		case PTRCALL_FLOAT: {
+			Scalar ret;
+			ptrcall(p_object, argptrs, &ret);
+			if (r_ret)
+				*r_ret = ret._float;
+		} break;
+		case PTRCALL_OBJECT: {
+			Scalar ret;
+			ptrcall(p_object, argptrs, &ret);
+			if (r_ret)
+				*r_ret = ret._object;
+		} break;
+		case PTRCALL_NATIVE:
+		case PTRCALL_VARIANT: {
+			//the value is encoded into an existing instance, build one unless the destination already holds that type
+			//(the destination can also be one of the arguments, those must stay untouched until the call is done)
+			bool in_place = r_ret && (pr.encoding == PTRCALL_VARIANT || r_ret->type == pr.type) && !_variant_aliases(r_ret, p_args, p_arg_count);
+
+			if (in_place) {
+				ptrcall(p_object, argptrs, pr.encoding == PTRCALL_VARIANT ? (void *)r_ret : r_ret->_get_native_ptr());
+			} else {
+				Variant::CallError ce;
+				Variant ret = pr.encoding == PTRCALL_VARIANT ? Variant() : Variant::construct(Variant::Type(pr.type), NULL, 0, ce);
+				ptrcall(p_object, argptrs, pr.encoding == PTRCALL_VARIANT ? (void *)&ret : ret._get_native_ptr());
+				if (r_ret)
+					*r_ret = ret;
+			}
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#endif
+
 MethodBind::MethodBind() {
 	static int last_id = 0;
 	method_id = last_id++;
@@ -119,6 +312,9 @@ MethodBind::MethodBind() {
 #endif
 	_const = false;
 	_returns = false;
+#ifdef PTRCALL_ENABLED
+	ptrcall_args = NULL;
+#endif
 }
 
 MethodBind::~MethodBind() {
@@ -126,4 +322,8 @@ MethodBind::~MethodBind() {
 	if (argument_types)
 		memdelete_arr(argument_types);
 #endif
+#ifdef PTRCALL_ENABLED
+	if (ptrcall_args)
+		memdelete_arr(ptrcall_args);
+#endif
 }
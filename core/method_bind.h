@@ -108,6 +108,14 @@ struct VariantCaster<const T &> {
 		_FORCE_INLINE_ static void encode(m_enum p_val, const void *p_ptr) { \
 			*(int *)p_ptr = p_val;                                           \
 		}                                                                    \
+	};                                                                       \
+	template <>                                                              \
+	struct PtrCallInfo<m_enum> {                                             \
+		enum {                                                               \
+			TYPE = Variant::INT,                                             \
+			ARG = PTRCALL_INT,                                               \
+			RET = PTRCALL_INT                                                \
+		};                                                                   \
 	};
 
 #else
@@ -171,6 +179,9 @@ class MethodBind {
 #endif
 	bool _const;
 	bool _returns;
+#ifdef PTRCALL_ENABLED
+	PtrCallArg *ptrcall_args; //return value first, NULL when some argument can't be passed from a Variant
+#endif
 
 protected:
 	void _set_const(bool p_const);
@@ -179,6 +190,10 @@ protected:
 	virtual Variant::Type _gen_argument_type(int p_arg) const = 0;
 	void _generate_argument_types(int p_count);
 	void set_argument_types(Variant::Type *p_types) { argument_types = p_types; }
+#endif
+#ifdef PTRCALL_ENABLED
+	virtual PtrCallArg _gen_ptrcall_arg(int p_arg) const;
+	void _generate_ptrcall_args(int p_count);
 #endif
 	void set_argument_count(int p_count) { argument_count = p_count; }
 
@@ -254,6 +269,13 @@ public:
 
 #ifdef PTRCALL_ENABLED
 	virtual void ptrcall(Object *p_object, const void **p_args, void *r_ret) = 0;
+
+	enum {
+		VARIANT_PTRCALL_MAX_ARGS = 16
+	};
+
+	//calls ptrcall() with the values held by the Variants, returns false without calling when an argument needs the full call() conversion
+	bool variant_ptrcall(Object *p_object, const Variant **p_args, int p_arg_count, Variant *r_ret);
 #endif
 
 	StringName get_name() const;
@@ -370,5 +370,120 @@ struct PtrToArg<const PoolVector<Face3> &> {
 	}
 };
 
+/* Describes how ptrcall() reads an argument or writes a return value of a given type, so callers
+ * holding Variants (like the script VMs) can use ptrcall() instead of the Variant call() path.
+ * PtrToArg narrows some types when encoding (int64 and double return values are written as int
+ * and float), those can only be used as arguments. */
+
+enum PtrCallEncoding {
+	PTRCALL_UNSUPPORTED, //must go through call()
+	PTRCALL_VOID, //no return value
+	PTRCALL_BOOL,
+	PTRCALL_INT, //32 bits, also used by enums
+	PTRCALL_INT64,
+	PTRCALL_FLOAT,
+	PTRCALL_DOUBLE,
+	PTRCALL_NATIVE, //pointer to the value stored inside the Variant
+	PTRCALL_VARIANT, //pointer to the Variant itself
+	PTRCALL_OBJECT, //Object pointer, return values only
+};
+
+struct PtrCallArg {
+
+	uint8_t type; //Variant::Type
+	uint8_t encoding;
+};
+
+template <class T>
+struct PtrCallInfo {
+	enum {
+		TYPE = Variant::NIL,
+		ARG = PTRCALL_UNSUPPORTED,
+		RET = PTRCALL_UNSUPPORTED
+	};
+};
+
+#define MAKE_PTRCALL_INFO(m_type, m_variant_type, m_arg, m_ret) \
+	template <>                                                 \
+	struct PtrCallInfo<m_type> {                                \
+		enum {                                                  \
+			TYPE = m_variant_type,                              \
+			ARG = m_arg,                                        \
+			RET = m_ret                                         \
+		};                                                      \
+	};                                                          \
+	template <>                                                 \
+	struct PtrCallInfo<const m_type &> {                        \
+		enum {                                                  \
+			TYPE = m_variant_type,                              \
+			ARG = m_arg,                                        \
+			RET = m_ret                                         \
+		};                                                      \
+	}
+
+MAKE_PTRCALL_INFO(bool, Variant::BOOL, PTRCALL_BOOL, PTRCALL_BOOL);
+MAKE_PTRCALL_INFO(int32_t, Variant::INT, PTRCALL_INT, PTRCALL_INT);
+MAKE_PTRCALL_INFO(uint32_t, Variant::INT, PTRCALL_INT, PTRCALL_UNSUPPORTED);
+MAKE_PTRCALL_INFO(int64_t, Variant::INT, PTRCALL_INT64, PTRCALL_UNSUPPORTED);
+MAKE_PTRCALL_INFO(uint64_t, Variant::INT, PTRCALL_INT64, PTRCALL_UNSUPPORTED);
+MAKE_PTRCALL_INFO(float, Variant::REAL, PTRCALL_FLOAT, PTRCALL_FLOAT);
+MAKE_PTRCALL_INFO(double, Variant::REAL, PTRCALL_DOUBLE, PTRCALL_UNSUPPORTED);
+MAKE_PTRCALL_INFO(String, Variant::STRING, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(StringName, Variant::STRING, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Vector2, Variant::VECTOR2, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Rect2, Variant::RECT2, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Vector3, Variant::VECTOR3, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Transform2D, Variant::TRANSFORM2D, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Plane, Variant::PLANE, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Quat, Variant::QUAT, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Rect3, Variant::RECT3, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Basis, Variant::BASIS, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Transform, Variant::TRANSFORM, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Color, Variant::COLOR, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Image, Variant::IMAGE, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(NodePath, Variant::NODE_PATH, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(RID, Variant::_RID, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(InputEvent, Variant::INPUT_EVENT, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Dictionary, Variant::DICTIONARY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Array, Variant::ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolByteArray, Variant::POOL_BYTE_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolIntArray, Variant::POOL_INT_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolRealArray, Variant::POOL_REAL_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolStringArray, Variant::POOL_STRING_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolVector2Array, Variant::POOL_VECTOR2_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolVector3Array, Variant::POOL_VECTOR3_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(PoolColorArray, Variant::POOL_COLOR_ARRAY, PTRCALL_NATIVE, PTRCALL_NATIVE);
+MAKE_PTRCALL_INFO(Variant, Variant::NIL, PTRCALL_VARIANT, PTRCALL_VARIANT);
+
+//object arguments need a class check that only call() does, returning them is fine
+//since Object is always the first base of engine classes
+
+template <class T>
+struct PtrCallInfo<T *> {
+	enum {
+		TYPE = Variant::OBJECT,
+		ARG = PTRCALL_UNSUPPORTED,
+		RET = PTRCALL_OBJECT
+	};
+};
+
+template <class T>
+struct PtrCallInfo<const T *> {
+	enum {
+		TYPE = Variant::OBJECT,
+		ARG = PTRCALL_UNSUPPORTED,
+		RET = PTRCALL_OBJECT
+	};
+};
+
+template <class T>
+_FORCE_INLINE_ PtrCallArg make_ptrcall_arg(bool p_return) {
+
+	PtrCallArg arg;
+	arg.type = PtrCallInfo<T>::TYPE;
+	arg.encoding = p_return ? PtrCallInfo<T>::RET : PtrCallInfo<T>::ARG;
+	return arg;
+}
+
 #endif // METHOD_PTRCALL_H
 #endif
@@ -0,0 +1,545 @@
+/*************************************************************************/
+/*  oa_hash_map.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef OA_HASH_MAP_H
+#define OA_HASH_MAP_H
+
+#include "hash_map.h"
+#include "os/copymem.h"
+
+/**
+ * @class OAHashMap
+ *
+ * Open addressing variant of HashMap, with the same interface.
+ * Pairs are stored in one flat array next to an array of control bytes, one per slot,
+ * which hold whether the slot is empty, deleted or full and seven bits of the key hash.
+ * Lookups test a group of eight control bytes at once (inside a 64 bits word) and only
+ * compare keys whose hash bits match, so inserting does not allocate and finding a key
+ * rarely touches more than one cache line of control bytes.
+ *
+ * Differences with HashMap:
+ * - Inserting may move pairs around, do not keep pointers to data across insertions.
+ * - Erasing never moves pairs or shrinks the table, so it is safe to erase the current
+ *   key (or any other) while iterating with next().
+ * - reserve() sizes the table up front for a known amount of elements.
+ */
+
+template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey> >
+class OAHashMap {
+public:
+	struct Pair {
+
+		TKey key;
+		TData data;
+
+		Pair() {}
+		Pair(const TKey &p_key, const TData &p_data) {
+			key = p_key;
+			data = p_data;
+		}
+	};
+
+private:
+	enum {
+		GROUP_WIDTH = 8,
+		MIN_CAPACITY = GROUP_WIDTH,
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE, //full slots store the low 7 bits of the hash instead, their high bit is always clear
+	};
+
+	uint8_t *ctrl; //capacity + GROUP_WIDTH bytes, the last group mirrors the first so groups can be read past the end
+	Pair *pairs;
+	uint32_t capacity;
+	uint32_t elements;
+	uint32_t growth_left; //empty slots that can still be filled before rehashing
+
+	static _FORCE_INLINE_ uint32_t _hash(uint32_t p_hash) {
+
+		//spread the bits, many hashers return the key itself
+		p_hash ^= p_hash >> 16;
+		p_hash *= 0x85ebca6b;
+		p_hash ^= p_hash >> 13;
+		p_hash *= 0xc2b2ae35;
+		p_hash ^= p_hash >> 16;
+		return p_hash;
+	}
+
+	static _FORCE_INLINE_ uint32_t _capacity_to_growth(uint32_t p_capacity) {
+
+		return p_capacity - p_capacity / 8; //at most 7/8 full
+	}
+
+	static _FORCE_INLINE_ uint64_t _load_group(const uint8_t *p_ctrl) {
+
+		uint64_t group;
+		copymem(&group, p_ctrl, sizeof(uint64_t));
+#ifdef BIG_ENDIAN_ENABLED
+		group = BSWAP64(group);
+#endif
+		return group;
+	}
+
+	/* each function below returns a mask with the high bit of every matching byte set */
+
+	static _FORCE_INLINE_ uint64_t _match_byte(uint64_t p_group, uint8_t p_byte) {
+
+		//may give a false positive next to a real match, keys are always compared afterwards
+		uint64_t x = p_group ^ (0x0101010101010101ULL * p_byte);
+		return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ uint64_t _match_empty(uint64_t p_group) {
+
+		return p_group & (~p_group << 6) & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ uint64_t _match_empty_or_deleted(uint64_t p_group) {
+
+		return p_group & (~p_group << 7) & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ uint32_t _first_match(uint64_t p_mask) {
+
+#if defined(__GNUC__)
+		return __builtin_ctzll(p_mask) >> 3;
+#else
+		uint32_t i = 0;
+		while (!(p_mask & 0x80)) {
+			p_mask >>= 8;
+			i++;
+		}
+		return i;
+#endif
+	}
+
+	static _FORCE_INLINE_ uint32_t _bytes_after_last_match(uint64_t p_mask) {
+
+#if defined(__GNUC__)
+		return __builtin_clzll(p_mask) >> 3;
+#else
+		uint32_t i = 0;
+		while (!(p_mask & 0x8000000000000000ULL)) {
+			p_mask <<= 8;
+			i++;
+		}
+		return i;
+#endif
+	}
+
+	_FORCE_INLINE_ void _set_ctrl(uint32_t p_index, uint8_t p_value) {
+
+		ctrl[p_index] = p_value;
+		if (p_index < GROUP_WIDTH) {
+			ctrl[capacity + p_index] = p_value;
+		}
+	}
+
+	template <class C>
+	_FORCE_INLINE_ int32_t _find_slot(const C &p_key, uint32_t p_hash) const {
+
+		if (!elements)
+			return -1;
+
+		uint32_t mask = capacity - 1;
+		uint32_t pos = (p_hash >> 7) & mask;
+		uint8_t h2 = p_hash & 0x7F;
+		uint32_t step = 0;
+
+		while (true) {
+
+			uint64_t group = _load_group(&ctrl[pos]);
+
+			for (uint64_t m = _match_byte(group, h2); m; m &= m - 1) {
+
+				uint32_t index = (pos + _first_match(m)) & mask;
+				if (Comparator::compare(pairs[index].key, p_key)) {
+					return index;
+				}
+			}
+
+			if (_match_empty(group))
+				return -1;
+
+			//triangular probing over groups visits every group once, as capacity is a power of two
+			step += GROUP_WIDTH;
+			if (step > capacity)
+				return -1;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	uint32_t _find_free_slot(uint32_t p_hash) const {
+
+		uint32_t mask = capacity - 1;
+		uint32_t pos = (p_hash >> 7) & mask;
+		uint32_t step = 0;
+
+		while (true) {
+
+			uint64_t m = _match_empty_or_deleted(_load_group(&ctrl[pos]));
+			if (m) {
+				return (pos + _first_match(m)) & mask;
+			}
+
+			step += GROUP_WIDTH;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	void _rehash(uint32_t p_capacity) {
+
+		uint8_t *old_ctrl = ctrl;
+		Pair *old_pairs = pairs;
+		uint32_t old_capacity = capacity;
+
+		capacity = p_capacity;
+		ctrl = (uint8_t *)memalloc(capacity + GROUP_WIDTH);
+		pairs = (Pair *)memalloc(sizeof(Pair) * capacity);
+		memset(ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+		growth_left = _capacity_to_growth(capacity) - elements;
+
+		for (uint32_t i = 0; i < old_capacity; i++) {
+
+			if (old_ctrl[i] & 0x80)
+				continue; //empty or deleted
+
+			uint32_t hash = _hash(Hasher::hash(old_pairs[i].key));
+			uint32_t index = _find_free_slot(hash);
+			_set_ctrl(index, hash & 0x7F);
+			memnew_placement(&pairs[index], Pair(old_pairs[i]));
+			old_pairs[i].~Pair();
+		}
+
+		if (old_ctrl) {
+			memfree(old_ctrl);
+			memfree(old_pairs);
+		}
+	}
+
+	Pair *_insert(const TKey &p_key) {
+
+		uint32_t hash = _hash(Hasher::hash(p_key));
+
+		int32_t found = _find_slot(p_key, hash);
+		if (found >= 0) {
+			return &pairs[found];
+		}
+
+		if (!capacity) {
+			_rehash(MIN_CAPACITY);
+		}
+
+		uint32_t index = _find_free_slot(hash);
+
+		if (growth_left == 0 && ctrl[index] == CTRL_EMPTY) {
+			//full, or full of deleted slots; grow only when most slots are actually used
+			_rehash(elements * 2 >= capacity ? capacity * 2 : capacity);
+			index = _find_free_slot(hash);
+		}
+
+		if (ctrl[index] == CTRL_EMPTY) {
+			growth_left--;
+		}
+
+		_set_ctrl(index, hash & 0x7F);
+		memnew_placement(&pairs[index], Pair);
+		pairs[index].key = p_key;
+		elements++;
+
+		return &pairs[index];
+	}
+
+	void _copy_from(const OAHashMap &p_map) {
+
+		if (&p_map == this)
+			return;
+
+		clear();
+
+		if (!p_map.elements)
+			return;
+
+		capacity = p_map.capacity;
+		elements = p_map.elements;
+		growth_left = p_map.growth_left;
+		ctrl = (uint8_t *)memalloc(capacity + GROUP_WIDTH);
+		pairs = (Pair *)memalloc(sizeof(Pair) * capacity);
+		copymem(ctrl, p_map.ctrl, capacity + GROUP_WIDTH);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+
+			if (!(ctrl[i] & 0x80)) {
+				memnew_placement(&pairs[i], Pair(p_map.pairs[i]));
+			}
+		}
+	}
+
+	uint32_t _key_to_slot(const TKey *p_key) const {
+
+		//keys passed to next() always point inside the pair array
+		return ((const uint8_t *)p_key - (const uint8_t *)pairs) / sizeof(Pair);
+	}
+
+public:
+	void set(const TKey &p_key, const TData &p_data) {
+
+		_insert(p_key)->data = p_data;
+	}
+
+	void set(const Pair &p_pair) {
+
+		_insert(p_pair.key)->data = p_pair.data;
+	}
+
+	bool has(const TKey &p_key) const {
+
+		return getptr(p_key) != NULL;
+	}
+
+	/**
+	 * Get a key from data, return a const reference.
+	 * WARNING: this doesn't check errors, use either getptr and check NULL, or check
+	 * first with has(key)
+	 */
+
+	const TData &get(const TKey &p_key) const {
+
+		const TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	TData &get(const TKey &p_key) {
+
+		TData *res = getptr(p_key);
+		ERR_FAIL_COND_V(!res, *res);
+		return *res;
+	}
+
+	_FORCE_INLINE_ TData *getptr(const TKey &p_key) {
+
+		int32_t index = _find_slot(p_key, _hash(Hasher::hash(p_key)));
+		return index >= 0 ? &pairs[index].data : NULL;
+	}
+
+	_FORCE_INLINE_ const TData *getptr(const TKey &p_key) const {
+
+		int32_t index = _find_slot(p_key, _hash(Hasher::hash(p_key)));
+		return index >= 0 ? &pairs[index].data : NULL;
+	}
+
+	/**
+	 * Same as getptr, with a custom key (that should support operator==()) and the hash
+	 * Hasher would give for it.
+	 */
+
+	template <class C>
+	_FORCE_INLINE_ TData *custom_getptr(C p_custom_key, uint32_t p_custom_hash) {
+
+		int32_t index = _find_slot(p_custom_key, _hash(p_custom_hash));
+		return index >= 0 ? &pairs[index].data : NULL;
+	}
+
+	template <class C>
+	_FORCE_INLINE_ const TData *custom_getptr(C p_custom_key, uint32_t p_custom_hash) const {
+
+		int32_t index = _find_slot(p_custom_key, _hash(p_custom_hash));
+		return index >= 0 ? &pairs[index].data : NULL;
+	}
+
+	/**
+	 * Erase an item, return true if erasing was successful.
+	 * Other pairs are not moved, so iteration can continue from the erased key.
+	 */
+
+	bool erase(const TKey &p_key) {
+
+		int32_t index = _find_slot(p_key, _hash(Hasher::hash(p_key)));
+		if (index < 0)
+			return false;
+
+		pairs[index].~Pair();
+		elements--;
+
+		//if no probe window covering this slot was ever full, no probe went past it,
+		//so the slot can become empty again instead of leaving a tombstone
+		uint64_t empty_after = _match_empty(_load_group(&ctrl[index]));
+		uint64_t empty_before = _match_empty(_load_group(&ctrl[(index - GROUP_WIDTH) & (capacity - 1)]));
+		bool was_never_full = capacity > GROUP_WIDTH && empty_after && empty_before && (_first_match(empty_after) + _bytes_after_last_match(empty_before)) < GROUP_WIDTH;
+		if (was_never_full) {
+			_set_ctrl(index, CTRL_EMPTY);
+			growth_left++;
+		} else {
+			_set_ctrl(index, CTRL_DELETED);
+		}
+
+		return true;
+	}
+
+	inline const TData &operator[](const TKey &p_key) const { //constref
+
+		return get(p_key);
+	}
+	inline TData &operator[](const TKey &p_key) { //assignment
+
+		return _insert(p_key)->data;
+	}
+
+	/**
+	 * Get the next key to p_key, and the first key if p_key is null.
+	 * Returns a pointer to the next key if found, NULL otherwise.
+	 * Erasing while iterating is fine (including p_key itself), adding elements is not.
+	 *
+	 * Example:
+	 *
+	 * 	const TKey *k=NULL;
+	 *
+	 * 	while( (k=table.next(k)) ) {
+	 *
+	 * 		print( *k );
+	 * 	}
+	 *
+	*/
+	const TKey *next(const TKey *p_key) const {
+
+		if (!capacity)
+			return NULL;
+
+		uint32_t from = p_key ? _key_to_slot(p_key) + 1 : 0;
+		ERR_FAIL_COND_V(from > capacity, NULL); /* invalid key supplied */
+
+		for (uint32_t i = from; i < capacity; i++) {
+
+			if (!(ctrl[i] & 0x80)) {
+				return &pairs[i].key;
+			}
+		}
+
+		return NULL; /* nothing found, was at end */
+	}
+
+	inline unsigned int size() const {
+
+		return elements;
+	}
+
+	inline bool empty() const {
+
+		return elements == 0;
+	}
+
+	/**
+	 * Make room for p_elements without rehashing again.
+	 */
+
+	void reserve(uint32_t p_elements) {
+
+		uint32_t new_capacity = MIN_CAPACITY;
+		while (_capacity_to_growth(new_capacity) < p_elements) {
+			new_capacity <<= 1;
+		}
+
+		if (new_capacity > capacity) {
+			_rehash(new_capacity);
+		}
+	}
+
+	void clear() {
+
+		if (ctrl) {
+
+			for (uint32_t i = 0; i < capacity; i++) {
+
+				if (!(ctrl[i] & 0x80)) {
+					pairs[i].~Pair();
+				}
+			}
+
+			memfree(ctrl);
+			memfree(pairs);
+		}
+
+		ctrl = NULL;
+		pairs = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+
+	void get_key_value_ptr_array(const Pair **p_pairs) const {
+
+		for (uint32_t i = 0; i < capacity; i++) {
+
+			if (!(ctrl[i] & 0x80)) {
+				*p_pairs = &pairs[i];
+				p_pairs++;
+			}
+		}
+	}
+
+	void get_key_list(List<TKey> *p_keys) const {
+
+		for (uint32_t i = 0; i < capacity; i++) {
+
+			if (!(ctrl[i] & 0x80)) {
+				p_keys->push_back(pairs[i].key);
+			}
+		}
+	}
+
+	void operator=(const OAHashMap &p_map) {
+
+		_copy_from(p_map);
+	}
+
+	OAHashMap() {
+		ctrl = NULL;
+		pairs = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+
+	OAHashMap(const OAHashMap &p_map) {
+		ctrl = NULL;
+		pairs = NULL;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+
+		_copy_from(p_map);
+	}
+
+	~OAHashMap() {
+
+		clear();
+	}
+};
+
+#endif
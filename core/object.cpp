@@ -33,6 +33,7 @@
 #include "core_string_names.h"
 #include "message_queue.h"
 #include "os/os.h"
+#include "os/thread.h"
 #include "print_string.h"
 #include "resource.h"
 #include "script_language.h"
@@ -936,6 +937,33 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
 	return ret;
 }
 
+void Object::call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error) {
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	Variant ret;
+#ifdef DEBUG_ENABLED
+	//the debug lock touches this object after the call, r_ret may hold its last reference so it's replaced afterwards
+	Variant *dst = r_ret ? &ret : NULL;
+#else
+	Variant *dst = r_ret;
+#endif
+
+	{
+		OBJ_DEBUG_LOCK
+#ifdef PTRCALL_ENABLED
+		if (!p_method->variant_ptrcall(this, p_args, p_argcount, dst))
+#endif
+		{
+			ret = p_method->call(this, p_args, p_argcount, r_error);
+			dst = &ret;
+		}
+	}
+
+	if (r_error.error == Variant::CallError::CALL_OK && r_ret && dst == &ret)
+		*r_ret = ret;
+}
+
 void Object::notification(int p_notification, bool p_reversed) {
 
 	_notificationv(p_notification, p_reversed);
@@ -965,7 +993,7 @@ void Object::property_list_changed_notify() {
 
 void Object::cancel_delete() {
 
-	_predelete_ok = true;
+	_predelete_ok = 0;
 }
 
 void Object::set_script(const RefPtr &p_script) {
@@ -1083,25 +1111,17 @@ void Object::add_user_signal(const MethodInfo &p_signal) {
 	ERR_FAIL_COND(p_signal.name == "");
 	ERR_FAIL_COND(ClassDB::has_signal(get_class_name(), p_signal.name));
 	ERR_FAIL_COND(signal_map.has(p_signal.name));
-	Signal s;
-	s.user = p_signal;
+	Signal *s = memnew(Signal);
+	s->user = p_signal;
 	signal_map[p_signal.name] = s;
 }
 
 bool Object::_has_user_signal(const StringName &p_name) const {
 
-	if (!signal_map.has(p_name))
-		return false;
-	return signal_map[p_name].user.name.length() > 0;
+	const Signal *s = _get_signal(p_name);
+	return s && s->user.name.length() > 0;
 }
 
-struct _ObjectSignalDisconnectData {
-
-	StringName signal;
-	Object *target;
-	StringName method;
-};
-
 #if 0
 void Object::_emit_signal(const StringName& p_name,const Array& p_pargs){
 
@@ -1151,7 +1171,7 @@ void Object::emit_signal(const StringName &p_name, const Variant **p_args, int p
 	if (_block_signals)
 		return; //no emit, signals blocked
 
-	Signal *s = signal_map.getptr(p_name);
+	Signal *s = _get_signal(p_name);
 	if (!s) {
 #ifdef DEBUG_ENABLED
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_name);
@@ -1165,26 +1185,29 @@ void Object::emit_signal(const StringName &p_name, const Variant **p_args, int p
 		return;
 	}
 
-	List<_ObjectSignalDisconnectData> disconnect_data;
-
-	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	//slots are called in place, so while any emission of this signal is running, connecting only queues the
+	//new slot and disconnecting only flags the old one. the last emission to finish applies the changes.
+	//the signal is allocated apart from the object, so even deleting the object from a slot is safe and
+	//it doesn't need the debug lock.
+	s->lock++;
 
-	int ssize = slot_map.size();
-
-	OBJ_DEBUG_LOCK
+	const VMap<Signal::Target, Signal::Slot> &slots = s->slot_map;
+	int ssize = slots.size();
 
+	const Variant *bind_stack[VARIANT_ARG_MAX * 2];
 	Vector<const Variant *> bind_mem;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slots.getv(i);
+		if (slot.removed)
+			continue;
+
+		const Connection &c = slot.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
-		target = ObjectDB::get_instance(slot_map.getk(i)._id);
+		target = ObjectDB::get_instance(slots.getk(i)._id);
 		ERR_CONTINUE(!target);
 #else
 		target = c.target;
@@ -1195,24 +1218,31 @@ void Object::emit_signal(const StringName &p_name, const Variant **p_args, int p
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			argc = p_argcount + c.binds.size();
+			if (argc <= VARIANT_ARG_MAX * 2) {
+				args = bind_stack;
+			} else {
+				bind_mem.resize(argc);
+				args = bind_mem.ptr();
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem[j] = p_args[j];
+				args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem[p_argcount + j] = &c.binds[j];
+				args[p_argcount + j] = &c.binds[j];
 			}
-
-			args = bind_mem.ptr();
-			argc = bind_mem.size();
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_ID(), c.method, args, argc, true);
 		} else {
 			Variant::CallError ce;
-			target->call(c.method, args, argc, ce);
+			if (slot.method && !target->get_script_instance()) {
+				target->call_method_bind(slot.method, args, argc, NULL, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 			if (ce.error != Variant::CallError::CALL_OK) {
 
 				if (ce.error == Variant::CallError::CALL_ERROR_INVALID_METHOD && !ClassDB::class_exists(target->get_class_name())) {
@@ -1223,20 +1253,78 @@ void Object::emit_signal(const StringName &p_name, const Variant **p_args, int p
 			}
 		}
 
-		if (c.flags & CONNECT_ONESHOT) {
-			_ObjectSignalDisconnectData dd;
-			dd.signal = p_name;
-			dd.target = target;
-			dd.method = c.method;
-			disconnect_data.push_back(dd);
+		if ((c.flags & CONNECT_ONESHOT) && !slot.removed) {
+			_disconnect_slot(p_name, s, slots.getk(i));
+		}
+	}
+
+	s->lock--;
+	if (s->lock == 0) {
+		if (s->orphaned) {
+			memdelete(s); //the object is gone, don't touch it
+			return;
+		}
+		if (s->removed_count || s->pending_slots.size())
+			_flush_signal_changes(p_name, s);
+	}
+}
+
+void Object::_flush_signal_changes(const StringName &p_name, Signal *p_signal) {
+
+	if (p_signal->removed_count) {
+
+		for (int i = p_signal->slot_map.size() - 1; i >= 0; i--) {
+
+			if (p_signal->slot_map.getv(i).removed) {
+				Signal::Target target = p_signal->slot_map.getk(i);
+				p_signal->slot_map.erase(target);
+			}
 		}
+		p_signal->removed_count = 0;
 	}
 
-	while (!disconnect_data.empty()) {
+	for (int i = 0; i < p_signal->pending_slots.size(); i++) {
+		p_signal->slot_map.insert(p_signal->pending_slots.getk(i), p_signal->pending_slots.getv(i));
+	}
+	p_signal->pending_slots = VMap<Signal::Target, Signal::Slot>();
 
-		const _ObjectSignalDisconnectData &dd = disconnect_data.front()->get();
-		disconnect(dd.signal, dd.target, dd.method);
-		disconnect_data.pop_front();
+	if (p_signal->slot_map.empty() && ClassDB::has_signal(get_class_name(), p_name)) {
+		//not user signal, delete
+		signal_map.erase(p_name);
+		memdelete(p_signal);
+	}
+}
+
+void Object::_disconnect_slot(const StringName &p_name, Signal *p_signal, const Signal::Target &p_target) {
+
+	int idx = p_signal->pending_slots.find(p_target);
+	if (idx >= 0) {
+		//connected and disconnected within the same emission
+		Signal::Slot &slot = p_signal->pending_slots.getv(idx);
+		slot.conn.target->connections.erase(slot.cE);
+		p_signal->pending_slots.erase(p_target);
+		return;
+	}
+
+	idx = p_signal->slot_map.find(p_target);
+	ERR_FAIL_COND(idx < 0);
+
+	Signal::Slot &slot = p_signal->slot_map.getv(idx);
+	slot.conn.target->connections.erase(slot.cE);
+
+	if (p_signal->lock > 0) {
+		slot.removed = true;
+		p_signal->removed_count++;
+		return;
+	}
+
+	Signal::Target target = p_target; //may point into the map
+	p_signal->slot_map.erase(target);
+
+	if (p_signal->slot_map.empty() && ClassDB::has_signal(get_class_name(), p_name)) {
+		//not user signal, delete
+		signal_map.erase(p_name);
+		memdelete(p_signal);
 	}
 }
 
@@ -1344,9 +1432,9 @@ void Object::get_signal_list(List<MethodInfo> *p_signals) const {
 
 	while ((S = signal_map.next(S))) {
 
-		if (signal_map[*S].user.name != "") {
+		if (signal_map[*S]->user.name != "") {
 			//user signal
-			p_signals->push_back(signal_map[*S].user);
+			p_signals->push_back(signal_map[*S]->user);
 		}
 	}
 }
@@ -1357,23 +1445,17 @@ void Object::get_all_signal_connections(List<Connection> *p_connections) const {
 
 	while ((S = signal_map.next(S))) {
 
-		const Signal *s = &signal_map[*S];
-
-		for (int i = 0; i < s->slot_map.size(); i++) {
-
-			p_connections->push_back(s->slot_map.getv(i).conn);
-		}
+		signal_map[*S]->get_connections(p_connections);
 	}
 }
 
 void Object::get_signal_connection_list(const StringName &p_signal, List<Connection> *p_connections) const {
 
-	const Signal *s = signal_map.getptr(p_signal);
+	const Signal *s = _get_signal(p_signal);
 	if (!s)
 		return; //nothing
 
-	for (int i = 0; i < s->slot_map.size(); i++)
-		p_connections->push_back(s->slot_map.getv(i).conn);
+	s->get_connections(p_connections);
 }
 
 bool Object::has_persistent_signal_connections() const {
@@ -1382,11 +1464,12 @@ bool Object::has_persistent_signal_connections() const {
 
 	while ((S = signal_map.next(S))) {
 
-		const Signal *s = &signal_map[*S];
+		List<Connection> conns;
+		signal_map[*S]->get_connections(&conns);
 
-		for (int i = 0; i < s->slot_map.size(); i++) {
+		for (List<Connection>::Element *E = conns.front(); E; E = E->next()) {
 
-			if (s->slot_map.getv(i).conn.flags & CONNECT_PERSIST)
+			if (E->get().flags & CONNECT_PERSIST)
 				return true;
 		}
 	}
@@ -1405,7 +1488,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 
 	ERR_FAIL_NULL_V(p_to_object, ERR_INVALID_PARAMETER);
 
-	Signal *s = signal_map.getptr(p_signal);
+	Signal *s = _get_signal(p_signal);
 	if (!s) {
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_signal);
 		//check in script
@@ -1416,14 +1499,14 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 			ERR_EXPLAIN("In Object of type '" + String(get_class()) + "': Attempt to connect nonexistent signal '" + p_signal + "' to method '" + p_to_object->get_class() + "." + p_to_method + "'");
 			ERR_FAIL_COND_V(!signal_is_valid, ERR_INVALID_PARAMETER);
 		}
-		signal_map[p_signal] = Signal();
-		s = &signal_map[p_signal];
+		s = memnew(Signal);
+		signal_map[p_signal] = s;
 	}
 
 	Signal::Target target(p_to_object->get_instance_ID(), p_to_method);
-	if (s->slot_map.has(target)) {
+	if (s->has_slot(target)) {
 		ERR_EXPLAIN("Signal '" + p_signal + "'' already connected to given method '" + p_to_method + "' in that object.");
-		ERR_FAIL_COND_V(s->slot_map.has(target), ERR_INVALID_PARAMETER);
+		ERR_FAIL_COND_V(s->has_slot(target), ERR_INVALID_PARAMETER);
 	}
 
 	Signal::Slot slot;
@@ -1437,7 +1520,13 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	conn.binds = p_binds;
 	slot.conn = conn;
 	slot.cE = p_to_object->connections.push_back(conn);
-	s->slot_map[target] = slot;
+	slot.method = ClassDB::get_method(p_to_object->get_class_name(), p_to_method);
+
+	if (s->lock > 0) {
+		s->pending_slots.insert(target, slot); //being emitted, added once that ends
+	} else {
+		s->slot_map.insert(target, slot);
+	}
 
 	return OK;
 }
@@ -1445,7 +1534,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 bool Object::is_connected(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method) const {
 
 	ERR_FAIL_NULL_V(p_to_object, false);
-	const Signal *s = signal_map.getptr(p_signal);
+	const Signal *s = _get_signal(p_signal);
 	if (!s) {
 		bool signal_is_valid = ClassDB::has_signal(get_class_name(), p_signal);
 		if (signal_is_valid)
@@ -1460,38 +1549,26 @@ bool Object::is_connected(const StringName &p_signal, Object *p_to_object, const
 
 	Signal::Target target(p_to_object->get_instance_ID(), p_to_method);
 
-	return s->slot_map.has(target);
-	//const Map<Signal::Target,Signal::Slot>::Element *E = s->slot_map.find(target);
-	//return (E!=NULL);
+	return s->has_slot(target);
 }
 
 void Object::disconnect(const StringName &p_signal, Object *p_to_object, const StringName &p_to_method) {
 
 	ERR_FAIL_NULL(p_to_object);
-	Signal *s = signal_map.getptr(p_signal);
+	Signal *s = _get_signal(p_signal);
 	if (!s) {
 		ERR_EXPLAIN("Nonexistent signal: " + p_signal);
 		ERR_FAIL_COND(!s);
 	}
-	if (s->lock > 0) {
-		ERR_EXPLAIN("Attempt to disconnect signal '" + p_signal + "' while emitting (locks: " + itos(s->lock) + ")");
-		ERR_FAIL_COND(s->lock > 0);
-	}
 
 	Signal::Target target(p_to_object->get_instance_ID(), p_to_method);
 
-	if (!s->slot_map.has(target)) {
+	if (!s->has_slot(target)) {
 		ERR_EXPLAIN("Disconnecting nonexistent signal '" + p_signal + "', slot: " + itos(target._id) + ":" + target.method);
 		ERR_FAIL();
 	}
 
-	p_to_object->connections.erase(s->slot_map[target].cE);
-	s->slot_map.erase(target);
-
-	if (s->slot_map.empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
-		//not user signal, delete
-		signal_map.erase(p_signal);
-	}
+	_disconnect_slot(p_signal, s, target);
 }
 
 void Object::_set_bind(const String &p_set, const Variant &p_value) {
@@ -1791,15 +1868,7 @@ Object::~Object() {
 
 	while ((S = signal_map.next(S))) {
 
-		Signal *s = &signal_map[*S];
-
-		ERR_EXPLAIN("Attempt to delete an object in the middle of a signal emission from it");
-		ERR_CONTINUE(s->lock > 0);
-
-		for (int i = 0; i < s->slot_map.size(); i++) {
-
-			sconnections.push_back(s->slot_map.getv(i).conn);
-		}
+		signal_map[*S]->get_connections(&sconnections);
 	}
 
 	for (List<Connection>::Element *E = sconnections.front(); E; E = E->next()) {
@@ -1816,6 +1885,17 @@ Object::~Object() {
 		c.source->disconnect(c.signal, c.target, c.method);
 	}
 
+	S = NULL;
+	while ((S = signal_map.next(S))) {
+
+		Signal *s = signal_map[*S];
+		if (s->lock > 0) {
+			s->orphaned = true; //deleted from one of its slots, the emission frees it
+		} else {
+			memdelete(s);
+		}
+	}
+
 	ObjectDB::remove_instance(this);
 	_instance_ID = 0;
 	_predelete_ok = 2;
@@ -1831,56 +1911,173 @@ void postinitialize_handler(Object *p_object) {
 	p_object->_postinitialize();
 }
 
-HashMap<uint32_t, Object *> ObjectDB::instances;
-uint32_t ObjectDB::instance_counter = 1;
-HashMap<Object *, ObjectID, ObjectDB::ObjectPtrHash> ObjectDB::instance_checks;
-uint32_t ObjectDB::add_instance(Object *p_object) {
+ObjectDB::Slot *ObjectDB::pages[ObjectDB::MAX_PAGES] = { NULL };
+uint32_t ObjectDB::page_count = 0;
+ObjectDB::Shard ObjectDB::shards[ObjectDB::SHARD_COUNT];
+uint32_t ObjectDB::object_count = 0;
+#ifdef DEBUG_ENABLED
+ObjectDB::CheckShard ObjectDB::check_shards[ObjectDB::SHARD_COUNT];
+#endif
+
+ObjectDB::Shard &ObjectDB::_get_shard() {
+
+	return shards[HashMapHasherDefault::hash((uint64_t)Thread::get_caller_ID()) % SHARD_COUNT];
+}
+
+void ObjectDB::_add_page(Shard &p_shard) {
+
+	//pages are numbered globally but filled by the shard that created them
+	uint32_t page_index = atomic_increment(&page_count) - 1;
+	if (page_index >= MAX_PAGES) {
+		atomic_decrement(&page_count);
+		ERR_EXPLAIN("Too many objects, all instance ID slots are in use.");
+		ERR_FAIL();
+	}
+
+	Slot *page = memnew_arr(Slot, PAGE_SIZE);
+
+	//slot 0 is never used, so no ID is ever 0
+	uint32_t first = page_index == 0 ? 1 : 0;
+	uint32_t base = page_index << PAGE_BITS;
+
+	for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+
+		page[i].object = NULL;
+		page[i].id = 0;
+		page[i].generation = 1;
+		page[i].next_free = (i + 1 < PAGE_SIZE) ? base + i + 1 : 0;
+	}
+
+	atomic_memory_barrier();
+	pages[page_index] = page;
+
+	if (p_shard.free_tail) {
+		pages[p_shard.free_tail >> PAGE_BITS][p_shard.free_tail & (PAGE_SIZE - 1)].next_free = base + first;
+	} else {
+		p_shard.free_head = base + first;
+	}
+	p_shard.free_tail = base + PAGE_SIZE - 1;
+}
+
+ObjectID ObjectDB::add_instance(Object *p_object) {
 
 	ERR_FAIL_COND_V(p_object->get_instance_ID() != 0, 0);
 
-	rw_lock->write_lock();
-	instances[++instance_counter] = p_object;
+	Shard &shard = _get_shard();
+
+	shard.mutex->lock();
+
+	if (!shard.free_head) {
+		_add_page(shard);
+		if (!shard.free_head) {
+			shard.mutex->unlock();
+			return 0;
+		}
+	}
+
+	uint32_t index = shard.free_head;
+	Slot &slot = pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)];
+
+	shard.free_head = slot.next_free;
+	if (!shard.free_head) {
+		shard.free_tail = 0;
+	}
+
+	ObjectID id = (slot.generation << SLOT_BITS) | index;
+
+	slot.object = p_object;
+	atomic_memory_barrier(); //the object must be visible before the ID is
+	slot.id = id;
+
+	shard.mutex->unlock();
+
+	atomic_increment(&object_count);
+
 #ifdef DEBUG_ENABLED
-	instance_checks[p_object] = instance_counter;
+	CheckShard &check = check_shards[ObjectPtrHash::hash(p_object) % SHARD_COUNT];
+	check.mutex->lock();
+	check.instances[p_object] = id;
+	check.mutex->unlock();
 #endif
-	rw_lock->write_unlock();
 
-	return instance_counter;
+	return id;
 }
 
 void ObjectDB::remove_instance(Object *p_object) {
 
-	rw_lock->write_lock();
+	ObjectID id = p_object->get_instance_ID();
+	uint32_t index = id & SLOT_MASK;
+
+	ERR_FAIL_COND(!index || !pages[index >> PAGE_BITS]);
+
+	Slot &slot = pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)];
+	ERR_FAIL_COND(slot.id != id);
 
-	instances.erase(p_object->get_instance_ID());
 #ifdef DEBUG_ENABLED
-	instance_checks.erase(p_object);
+	CheckShard &check = check_shards[ObjectPtrHash::hash(p_object) % SHARD_COUNT];
+	check.mutex->lock();
+	check.instances.erase(p_object);
+	check.mutex->unlock();
 #endif
 
-	rw_lock->write_unlock();
+	//any shard can take the slot back, the one of the current thread is the least contended
+	Shard &shard = _get_shard();
+
+	shard.mutex->lock();
+
+	slot.id = 0;
+	atomic_memory_barrier();
+	slot.object = NULL;
+	slot.generation = (slot.generation + 1) & ((uint64_t(1) << GENERATION_BITS) - 1);
+	if (slot.generation == 0) {
+		slot.generation = 1; //IDs are never 0
+	}
+	slot.next_free = 0;
+
+	if (shard.free_tail) {
+		pages[shard.free_tail >> PAGE_BITS][shard.free_tail & (PAGE_SIZE - 1)].next_free = index;
+	} else {
+		shard.free_head = index;
+	}
+	shard.free_tail = index;
+
+	shard.mutex->unlock();
+
+	atomic_decrement(&object_count);
 }
-Object *ObjectDB::get_instance(uint32_t p_instance_ID) {
 
-	rw_lock->read_lock();
-	Object **obj = instances.getptr(p_instance_ID);
-	rw_lock->read_unlock();
+#ifdef DEBUG_ENABLED
+bool ObjectDB::_instance_validate(Object *p_ptr) {
+
+	CheckShard &check = check_shards[ObjectPtrHash::hash(p_ptr) % SHARD_COUNT];
+	check.mutex->lock();
+	bool valid = check.instances.has(p_ptr);
+	check.mutex->unlock();
 
-	if (!obj)
-		return NULL;
-	return *obj;
+	return valid;
 }
+#endif
 
 void ObjectDB::debug_objects(DebugFunc p_func) {
 
-	rw_lock->read_lock();
+	//keep objects from being removed while they are visited
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].mutex->lock();
+	}
 
-	const uint32_t *K = NULL;
-	while ((K = instances.next(K))) {
+	for (uint32_t i = 0; i < page_count && i < MAX_PAGES; i++) {
 
-		p_func(instances[*K]);
+		for (uint32_t j = 0; j < PAGE_SIZE; j++) {
+
+			if (pages[i][j].id) {
+				p_func(pages[i][j].object);
+			}
+		}
 	}
 
-	rw_lock->read_unlock();
+	for (int i = SHARD_COUNT - 1; i >= 0; i--) {
+		shards[i].mutex->unlock();
+	}
 }
 
 void Object::get_argument_options(const StringName &p_function, int p_idx, List<String> *r_options) const {
@@ -1888,42 +2085,66 @@ void Object::get_argument_options(const StringName &p_function, int p_idx, List<
 
 int ObjectDB::get_object_count() {
 
-	rw_lock->read_lock();
-	int count = instances.size();
-	rw_lock->read_unlock();
-
-	return count;
+	return object_count;
 }
 
-RWLock *ObjectDB::rw_lock = NULL;
-
 void ObjectDB::setup() {
 
-	rw_lock = RWLock::create();
+	for (int i = 0; i < SHARD_COUNT; i++) {
+
+		shards[i].mutex = Mutex::create();
+		shards[i].free_head = 0;
+		shards[i].free_tail = 0;
+#ifdef DEBUG_ENABLED
+		check_shards[i].mutex = Mutex::create();
+#endif
+	}
 }
 
 void ObjectDB::cleanup() {
 
-	rw_lock->write_lock();
-	if (instances.size()) {
+	if (object_count) {
 
 		WARN_PRINT("ObjectDB Instances still exist!");
 		if (OS::get_singleton()->is_stdout_verbose()) {
-			const uint32_t *K = NULL;
-			while ((K = instances.next(K))) {
-
-				String node_name;
-				if (instances[*K]->is_class("Node"))
-					node_name = " - Node Name: " + String(instances[*K]->call("get_name"));
-				if (instances[*K]->is_class("Resoucre"))
-					node_name = " - Resource Name: " + String(instances[*K]->call("get_name")) + " Path: " + String(instances[*K]->call("get_path"));
-				print_line("Leaked Instance: " + String(instances[*K]->get_class()) + ":" + itos(*K) + node_name);
+
+			for (uint32_t i = 0; i < page_count && i < MAX_PAGES; i++) {
+
+				for (uint32_t j = 0; j < PAGE_SIZE; j++) {
+
+					if (!pages[i][j].id)
+						continue;
+
+					Object *obj = pages[i][j].object;
+					String node_name;
+					if (obj->is_class("Node"))
+						node_name = " - Node Name: " + String(obj->call("get_name"));
+					if (obj->is_class("Resoucre"))
+						node_name = " - Resource Name: " + String(obj->call("get_name")) + " Path: " + String(obj->call("get_path"));
+					print_line("Leaked Instance: " + String(obj->get_class()) + ":" + itos(pages[i][j].id) + node_name);
+				}
 			}
 		}
 	}
-	instances.clear();
-	instance_checks.clear();
-	rw_lock->write_unlock();
 
-	memdelete(rw_lock);
+	for (uint32_t i = 0; i < page_count && i < MAX_PAGES; i++) {
+
+		memdelete_arr(pages[i]);
+		pages[i] = NULL;
+	}
+	page_count = 0;
+	object_count = 0;
+
+	for (int i = 0; i < SHARD_COUNT; i++) {
+
+		memdelete(shards[i].mutex);
+		shards[i].mutex = NULL;
+		shards[i].free_head = 0;
+		shards[i].free_tail = 0;
+#ifdef DEBUG_ENABLED
+		check_shards[i].instances.clear();
+		memdelete(check_shards[i].mutex);
+		check_shards[i].mutex = NULL;
+#endif
+	}
 }
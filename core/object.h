@@ -32,7 +32,10 @@
 
 #include "list.h"
 #include "map.h"
+#include "oa_hash_map.h"
+#include "os/mutex.h"
 #include "os/rw_lock.h"
+#include "safe_refcount.h"
 #include "set.h"
 #include "variant.h"
 #include "vmap.h"
@@ -350,7 +353,8 @@ public:                                                        \
 private:
 
 class ScriptInstance;
-typedef uint32_t ObjectID;
+class MethodBind;
+typedef uint64_t ObjectID;
 
 class Object {
 public:
@@ -407,15 +411,53 @@ private:
 
 			Connection conn;
 			List<Connection>::Element *cE;
+			MethodBind *method; //resolved on connect, called directly while the target has no script
+			bool removed; //disconnected during an emission, erased when it ends
+			Slot() {
+				cE = NULL;
+				method = NULL;
+				removed = false;
+			}
 		};
 
 		MethodInfo user;
 		VMap<Target, Slot> slot_map;
-		int lock;
-		Signal() { lock = 0; }
+		VMap<Target, Slot> pending_slots; //connected during an emission, added to slot_map when it ends
+		int lock; //emissions in progress, slot_map keeps its layout while non zero
+		int removed_count;
+		bool orphaned; //the object was deleted while emitting, the last emission frees this
+		bool has_slot(const Target &p_target) const {
+			if (pending_slots.has(p_target))
+				return true;
+			int idx = slot_map.find(p_target);
+			return idx >= 0 && !slot_map.getv(idx).removed;
+		}
+
+		void get_connections(List<Connection> *p_connections) const {
+			for (int i = 0; i < slot_map.size(); i++) {
+				if (!slot_map.getv(i).removed)
+					p_connections->push_back(slot_map.getv(i).conn);
+			}
+			for (int i = 0; i < pending_slots.size(); i++) {
+				p_connections->push_back(pending_slots.getv(i).conn);
+			}
+		}
+
+		Signal() {
+			lock = 0;
+			removed_count = 0;
+			orphaned = false;
+		}
 	};
 
-	HashMap<StringName, Signal, StringNameHasher> signal_map;
+	//signals are allocated separately so emission can keep using one while the map changes or the object goes away
+	OAHashMap<StringName, Signal *, StringNameHasher> signal_map;
+	_FORCE_INLINE_ Signal *_get_signal(const StringName &p_name) const {
+		Signal *const *s = signal_map.getptr(p_name);
+		return s ? *s : NULL;
+	}
+	void _flush_signal_changes(const StringName &p_name, Signal *p_signal);
+	void _disconnect_slot(const StringName &p_name, Signal *p_signal, const Signal::Target &p_target);
 	List<Connection> connections;
 #ifdef DEBUG_ENABLED
 	SafeRefCount _lock_index;
@@ -423,7 +465,7 @@ private:
 	bool _block_signals;
 	int _predelete_ok;
 	Set<Object *> change_receptors;
-	uint32_t _instance_ID;
+	ObjectID _instance_ID;
 	bool _predelete();
 	void _postinitialize();
 	bool _can_translate;
@@ -515,6 +557,7 @@ public:
 		for (Set<Object *>::Element *E = change_receptors.front(); E; E = E->next())
 			((Object *)(E->get()))->_changed_callback(this, p_property);
 	}
+	_FORCE_INLINE_ void _mark_edited() { _edited = true; } //what set() does, for callers that bypass it
 #else
 	_FORCE_INLINE_ void _change_notify(const char *p_what = "") {}
 #endif
@@ -604,6 +647,7 @@ public:
 	virtual void call_multilevel(const StringName &p_method, const Variant **p_args, int p_argcount);
 	virtual void call_multilevel_reversed(const StringName &p_method, const Variant **p_args, int p_argcount);
 	Variant call(const StringName &p_name, VARIANT_ARG_LIST); // C++ helper
+	void call_method_bind(MethodBind *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, Variant::CallError &r_error); // call an already resolved method, skipping script and name lookup
 	void call_multilevel(const StringName &p_name, VARIANT_ARG_LIST); // C++ helper
 
 	void notification(int p_notification, bool p_reversed = false);
@@ -675,8 +719,41 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+/* Objects are kept in a table of slots indexed by the low bits of their instance ID,
+ * the high bits hold a 40 bit generation that changes every time a slot is reused, so
+ * a stale ID would need a trillion reuses of its slot to match again. Looking up
+ * an ID is a page access and a compare, without locks. Registration is spread over a few
+ * shards picked by thread, each with its own lock and free slots. */
+
 class ObjectDB {
 
+	enum {
+		SLOT_BITS = 23, //up to 8M objects, the rest of the ID is the generation
+		SLOT_MASK = (1 << SLOT_BITS) - 1,
+		GENERATION_BITS = 40, //IDs stay below 2^63, so they are positive in a Variant
+		PAGE_BITS = 12,
+		PAGE_SIZE = 1 << PAGE_BITS,
+		MAX_PAGES = 1 << (SLOT_BITS - PAGE_BITS),
+		SHARD_COUNT = 8
+	};
+
+	struct Slot {
+
+		Object *volatile object;
+		volatile ObjectID id; //0 while free
+		uint64_t generation;
+		uint32_t next_free;
+	};
+
+	struct Shard {
+
+		Mutex *mutex;
+		//slots are reused in the order they were freed, so stale IDs take as long as possible to match again
+		uint32_t free_head;
+		uint32_t free_tail;
+	};
+
+#ifdef DEBUG_ENABLED
 	struct ObjectPtrHash {
 
 		static _FORCE_INLINE_ uint32_t hash(const Object *p_obj) {
@@ -690,16 +767,28 @@ class ObjectDB {
 		}
 	};
 
-	static HashMap<uint32_t, Object *> instances;
-	static HashMap<Object *, ObjectID, ObjectPtrHash> instance_checks;
+	struct CheckShard {
+
+		Mutex *mutex;
+		OAHashMap<Object *, ObjectID, ObjectPtrHash> instances;
+	};
+
+	static CheckShard check_shards[SHARD_COUNT];
+	static bool _instance_validate(Object *p_ptr);
+#endif
+
+	static Slot *pages[MAX_PAGES];
+	static uint32_t page_count;
+	static Shard shards[SHARD_COUNT];
+	static uint32_t object_count;
 
-	static uint32_t instance_counter;
 	friend class Object;
 	friend void unregister_core_types();
 
-	static RWLock *rw_lock;
+	static Shard &_get_shard();
+	static void _add_page(Shard &p_shard);
 	static void cleanup();
-	static uint32_t add_instance(Object *p_object);
+	static ObjectID add_instance(Object *p_object);
 	static void remove_instance(Object *p_object);
 	friend void register_core_types();
 	static void setup();
@@ -707,14 +796,29 @@ class ObjectDB {
 public:
 	typedef void (*DebugFunc)(Object *p_obj);
 
-	static Object *get_instance(uint32_t p_instance_ID);
+	_FORCE_INLINE_ static Object *get_instance(ObjectID p_instance_ID) {
+
+		uint32_t index = p_instance_ID & SLOT_MASK;
+		Slot *page = pages[index >> PAGE_BITS];
+		if (!page)
+			return NULL;
+
+		const Slot &slot = page[index & (PAGE_SIZE - 1)];
+		Object *object = slot.object;
+		atomic_memory_barrier(); //read the object before checking it still has this ID
+		if (slot.id != p_instance_ID)
+			return NULL;
+
+		return object;
+	}
+
 	static void debug_objects(DebugFunc p_func);
 	static int get_object_count();
 
 #ifdef DEBUG_ENABLED
 	_FORCE_INLINE_ static bool instance_validate(Object *p_ptr) {
 
-		return instance_checks.has(p_ptr);
+		return _instance_validate(p_ptr);
 	}
 #else
 	_FORCE_INLINE_ static bool instance_validate(Object *p_ptr) { return true; }
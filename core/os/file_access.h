@@ -105,6 +105,9 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
+
+	virtual bool map_memory() { return false; } ///< map the whole open file read only; false if not supported, reads keep working either way
+	virtual const uint8_t *get_mapped_data() const { return NULL; } ///< view of the whole file (get_len() bytes) while it stays open, NULL if not mapped
 	virtual String get_line() const;
 	virtual Vector<String> get_csv_line(String delim = ",") const;
 
@@ -28,6 +28,8 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "main_loop.h"
+
+#include "core_string_names.h"
 #include "script_language.h"
 
 void MainLoop::_bind_methods() {
@@ -70,13 +72,13 @@ MainLoop::~MainLoop() {
 void MainLoop::input_text(const String &p_text) {
 
 	if (get_script_instance())
-		get_script_instance()->call("_input_text", p_text);
+		get_script_instance()->call(CoreStringNames::get_singleton()->_input_text, p_text);
 }
 
 void MainLoop::input_event(const InputEvent &p_event) {
 
 	if (get_script_instance())
-		get_script_instance()->call("_input_event", p_event);
+		get_script_instance()->call(CoreStringNames::get_singleton()->_input_event, p_event);
 }
 
 void MainLoop::init() {
@@ -90,14 +92,14 @@ void MainLoop::init() {
 bool MainLoop::iteration(float p_time) {
 
 	if (get_script_instance())
-		return get_script_instance()->call("_iteration", p_time);
+		return get_script_instance()->call(CoreStringNames::get_singleton()->_iteration, p_time);
 
 	return false;
 }
 bool MainLoop::idle(float p_time) {
 
 	if (get_script_instance())
-		return get_script_instance()->call("_idle", p_time);
+		return get_script_instance()->call(CoreStringNames::get_singleton()->_idle, p_time);
 
 	return false;
 }
@@ -30,6 +30,7 @@
 #include "memory.h"
 #include "copymem.h"
 #include "error_macros.h"
+#include "small_allocator.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -52,15 +53,29 @@ size_t Memory::max_usage = 0;
 
 size_t Memory::alloc_count = 0;
 
+#ifdef SMALL_ALLOC_ENABLED
+//set in the size word of the header when the block came from SmallAllocator, sizes never reach it
+#define SMALL_ALLOC_FLAG (uint64_t(1) << 63)
+#endif
+
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 
-#ifdef DEBUG_ENABLED
-	bool prepad = true;
+#if defined(DEBUG_ENABLED) || defined(SMALL_ALLOC_ENABLED)
+	bool prepad = true; //with small_alloc, the header also records where the block came from
 #else
 	bool prepad = p_pad_align;
 #endif
 
+#ifdef SMALL_ALLOC_ENABLED
+	void *mem = SmallAllocator::alloc(p_bytes + PAD_ALIGN);
+	uint64_t small_flag = SMALL_ALLOC_FLAG;
+	if (!mem) {
+		mem = malloc(p_bytes + PAD_ALIGN);
+		small_flag = 0;
+	}
+#else
 	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+#endif
 
 	alloc_count++;
 
@@ -69,6 +84,9 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	if (prepad) {
 		uint64_t *s = (uint64_t *)mem;
 		*s = p_bytes;
+#ifdef SMALL_ALLOC_ENABLED
+		*s |= small_flag;
+#endif
 
 		uint8_t *s8 = (uint8_t *)mem;
 
@@ -92,7 +110,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_memory;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_ALLOC_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -102,6 +120,32 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
 
+#ifdef SMALL_ALLOC_ENABLED
+		if (*s & SMALL_ALLOC_FLAG) {
+			//size class block, grow in place while it fits, otherwise move it
+			uint64_t old_bytes = *s & ~SMALL_ALLOC_FLAG;
+			if (p_bytes > 0 && p_bytes + PAD_ALIGN <= SmallAllocator::get_block_size(mem)) {
+#ifdef DEBUG_ENABLED
+				mem_usage -= old_bytes;
+				mem_usage += p_bytes;
+#endif
+				*s = p_bytes | SMALL_ALLOC_FLAG;
+				return mem + PAD_ALIGN;
+			}
+
+			void *new_mem = NULL;
+			if (p_bytes > 0) {
+				new_mem = alloc_static(p_bytes, p_pad_align);
+				ERR_FAIL_COND_V(!new_mem, NULL);
+				//the word right before the pointer belongs to the caller (Vector keeps its refcount and size there)
+				*((uint64_t *)new_mem - 1) = *((uint64_t *)p_memory - 1);
+				copymem(new_mem, mem + PAD_ALIGN, MIN(old_bytes, p_bytes));
+			}
+			free_static(p_memory, p_pad_align);
+			return new_mem;
+		}
+#endif
+
 #ifdef DEBUG_ENABLED
 		mem_usage -= *s;
 		mem_usage += p_bytes;
@@ -138,7 +182,7 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 	uint8_t *mem = (uint8_t *)p_ptr;
 
-#ifdef DEBUG_ENABLED
+#if defined(DEBUG_ENABLED) || defined(SMALL_ALLOC_ENABLED)
 	bool prepad = true;
 #else
 	bool prepad = p_pad_align;
@@ -150,6 +194,16 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
 
+#ifdef SMALL_ALLOC_ENABLED
+		if (*s & SMALL_ALLOC_FLAG) {
+#ifdef DEBUG_ENABLED
+			mem_usage -= *s & ~SMALL_ALLOC_FLAG;
+#endif
+			SmallAllocator::free(mem);
+			return;
+		}
+#endif
+
 #ifdef DEBUG_ENABLED
 		mem_usage -= *s;
 #endif
@@ -161,6 +215,11 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 	}
 }
 
+void Memory::thread_exit() {
+
+	SmallAllocator::thread_exit();
+}
+
 size_t Memory::get_mem_available() {
 
 	return 0xFFFFFFFFFFFFF;
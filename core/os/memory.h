@@ -56,6 +56,8 @@ public:
 	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
 	static void free_static(void *p_ptr, bool p_pad_align = false);
 
+	static void thread_exit(); ///< call before a thread ends, releases its allocator cache
+
 	static size_t get_mem_available();
 	static size_t get_mem_usage();
 	static size_t get_mem_max_usage();
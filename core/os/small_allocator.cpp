@@ -0,0 +1,331 @@
+/*************************************************************************/
+/*  small_allocator.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "small_allocator.h"
+
+#ifdef SMALL_ALLOC_ENABLED
+
+#include "safe_refcount.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define SMALL_ALLOC_THREAD_LOCAL __declspec(thread)
+#else
+#define SMALL_ALLOC_THREAD_LOCAL __thread
+#endif
+
+static const uint32_t _class_sizes[SmallAllocator::CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512
+};
+
+struct SmallAllocatorFreeBlock {
+
+	SmallAllocatorFreeBlock *next;
+};
+
+struct SmallAllocatorCache;
+
+struct SmallAllocatorSlab {
+
+	SmallAllocatorCache *owner;
+	uint32_t size_class;
+};
+
+#define SMALL_ALLOC_SLAB_HEADER 64 //keeps the first block 16 bytes aligned
+
+struct SmallAllocatorCache {
+
+	SmallAllocatorFreeBlock *free_list[SmallAllocator::CLASS_COUNT];
+	uint8_t *chunk_pos;
+	uint8_t *chunk_end;
+	uint8_t *slab_pos[SmallAllocator::CLASS_COUNT];
+	uint8_t *slab_end[SmallAllocator::CLASS_COUNT];
+	SmallAllocatorFreeBlock *remote_list[SmallAllocator::CLASS_COUNT]; //pushed to by other threads
+
+	//only written by the owning thread
+	uint64_t allocs[SmallAllocator::CLASS_COUNT];
+	uint64_t frees[SmallAllocator::CLASS_COUNT];
+	uint64_t remote_frees[SmallAllocator::CLASS_COUNT];
+	uint64_t reserved[SmallAllocator::CLASS_COUNT];
+
+	SmallAllocatorCache *next_cache;
+	SmallAllocatorCache *next_abandoned;
+};
+
+static uint8_t _size_to_class[(SmallAllocator::MAX_SIZE >> 4) + 1];
+static bool _size_to_class_ready = false;
+
+static SmallAllocatorCache *_all_caches = NULL;
+static SmallAllocatorCache *_abandoned_caches = NULL;
+static uint32_t _caches_lock = 0;
+
+static SMALL_ALLOC_THREAD_LOCAL SmallAllocatorCache *_thread_cache = NULL;
+
+static void _lock_caches() {
+
+	while (atomic_compare_exchange(&_caches_lock, 0, 1) != 0) {
+	}
+}
+
+static void _unlock_caches() {
+
+	atomic_memory_barrier();
+	_caches_lock = 0;
+}
+
+static SmallAllocatorCache *_acquire_cache() {
+
+	_lock_caches();
+
+	if (!_size_to_class_ready) {
+
+		int c = 0;
+		for (int i = 0; i <= (SmallAllocator::MAX_SIZE >> 4); i++) {
+			while ((uint32_t)(i << 4) > _class_sizes[c])
+				c++;
+			_size_to_class[i] = c;
+		}
+		_size_to_class_ready = true;
+	}
+
+	SmallAllocatorCache *cache = _abandoned_caches;
+	if (cache) {
+		_abandoned_caches = cache->next_abandoned;
+		cache->next_abandoned = NULL;
+	} else {
+
+		//caches live for the whole run, slabs of exited threads still point at them
+		cache = (SmallAllocatorCache *)malloc(sizeof(SmallAllocatorCache));
+		if (!cache) {
+			_unlock_caches();
+			return NULL;
+		}
+		memset(cache, 0, sizeof(SmallAllocatorCache));
+		cache->next_cache = _all_caches;
+		_all_caches = cache;
+	}
+
+	_unlock_caches();
+
+	return cache;
+}
+
+static _FORCE_INLINE_ SmallAllocatorFreeBlock *_take_remote(SmallAllocatorCache *p_cache, int p_class) {
+
+	SmallAllocatorFreeBlock *list;
+	do {
+		list = p_cache->remote_list[p_class];
+	} while (list && atomic_compare_exchange_ptr((void **)&p_cache->remote_list[p_class], list, NULL) != list);
+
+	return list;
+}
+
+static uint8_t *_new_slab(SmallAllocatorCache *p_cache, int p_class) {
+
+	if (p_cache->chunk_pos == p_cache->chunk_end) {
+
+		//slabs come out of larger chunks so they can be aligned to SLAB_SIZE without wasting one per slab
+		uint8_t *raw = (uint8_t *)malloc(SmallAllocator::SLAB_SIZE * (SmallAllocator::CHUNK_SLABS + 1));
+		if (!raw)
+			return NULL;
+		p_cache->chunk_pos = (uint8_t *)((uintptr_t(raw) + SmallAllocator::SLAB_SIZE - 1) & ~uintptr_t(SmallAllocator::SLAB_SIZE - 1));
+		p_cache->chunk_end = p_cache->chunk_pos + SmallAllocator::SLAB_SIZE * SmallAllocator::CHUNK_SLABS;
+	}
+
+	uint8_t *slab = p_cache->chunk_pos;
+	p_cache->chunk_pos += SmallAllocator::SLAB_SIZE;
+
+	SmallAllocatorSlab *header = (SmallAllocatorSlab *)slab;
+	header->owner = p_cache;
+	header->size_class = p_class;
+
+	p_cache->reserved[p_class] += SmallAllocator::SLAB_SIZE;
+
+	return slab;
+}
+
+static _FORCE_INLINE_ SmallAllocatorSlab *_get_slab(void *p_block) {
+
+	return (SmallAllocatorSlab *)(uintptr_t(p_block) & ~uintptr_t(SmallAllocator::SLAB_SIZE - 1));
+}
+
+void *SmallAllocator::alloc(size_t p_bytes) {
+
+	if (p_bytes > MAX_SIZE)
+		return NULL;
+
+	SmallAllocatorCache *cache = _thread_cache;
+	if (!cache) {
+		cache = _thread_cache = _acquire_cache();
+		if (!cache)
+			return NULL;
+	}
+
+	int c = _size_to_class[(p_bytes + 15) >> 4];
+
+	SmallAllocatorFreeBlock *block = cache->free_list[c];
+
+	if (!block) {
+
+		//reclaim what other threads gave back before carving new blocks
+		block = _take_remote(cache, c);
+		if (block) {
+			for (SmallAllocatorFreeBlock *b = block; b; b = b->next) {
+				cache->remote_frees[c]++;
+			}
+		} else {
+
+			uint32_t size = _class_sizes[c];
+			if (cache->slab_pos[c] + size > cache->slab_end[c]) {
+				uint8_t *slab = _new_slab(cache, c);
+				if (!slab)
+					return NULL;
+				cache->slab_pos[c] = slab + SMALL_ALLOC_SLAB_HEADER;
+				cache->slab_end[c] = slab + SLAB_SIZE;
+			}
+
+			block = (SmallAllocatorFreeBlock *)cache->slab_pos[c];
+			block->next = NULL;
+			cache->slab_pos[c] += size;
+		}
+	}
+
+	cache->free_list[c] = block->next;
+	cache->allocs[c]++;
+
+	return block;
+}
+
+void SmallAllocator::free(void *p_block) {
+
+	SmallAllocatorSlab *slab = _get_slab(p_block);
+	SmallAllocatorCache *owner = slab->owner;
+	int c = slab->size_class;
+
+	SmallAllocatorFreeBlock *block = (SmallAllocatorFreeBlock *)p_block;
+
+	if (owner == _thread_cache) {
+
+		block->next = owner->free_list[c];
+		owner->free_list[c] = block;
+		owner->frees[c]++;
+		return;
+	}
+
+	//freed on a thread that does not own the block, queue it for the owner
+	SmallAllocatorFreeBlock *head;
+	do {
+		head = owner->remote_list[c];
+		block->next = head;
+	} while (atomic_compare_exchange_ptr((void **)&owner->remote_list[c], head, block) != head);
+}
+
+size_t SmallAllocator::get_block_size(void *p_block) {
+
+	return _class_sizes[_get_slab(p_block)->size_class];
+}
+
+void SmallAllocator::thread_exit() {
+
+	SmallAllocatorCache *cache = _thread_cache;
+	if (!cache)
+		return;
+
+	_thread_cache = NULL;
+
+	_lock_caches();
+	cache->next_abandoned = _abandoned_caches;
+	_abandoned_caches = cache;
+	_unlock_caches();
+}
+
+void SmallAllocator::get_class_stats(int p_class, ClassStats &r_stats) {
+
+	memset(&r_stats, 0, sizeof(ClassStats));
+	if (p_class < 0 || p_class >= CLASS_COUNT)
+		return;
+
+	r_stats.block_size = _class_sizes[p_class];
+
+	_lock_caches();
+
+	//counters are read without stopping their threads, totals are approximate while running
+	for (SmallAllocatorCache *cache = _all_caches; cache; cache = cache->next_cache) {
+
+		r_stats.allocs += cache->allocs[p_class];
+		r_stats.frees += cache->frees[p_class] + cache->remote_frees[p_class];
+		r_stats.remote_frees += cache->remote_frees[p_class];
+		r_stats.reserved += cache->reserved[p_class];
+	}
+
+	_unlock_caches();
+}
+
+bool SmallAllocator::is_enabled() {
+
+	return true;
+}
+
+#else
+
+void *SmallAllocator::alloc(size_t p_bytes) {
+
+	return NULL;
+}
+
+void SmallAllocator::free(void *p_block) {
+}
+
+size_t SmallAllocator::get_block_size(void *p_block) {
+
+	return 0;
+}
+
+void SmallAllocator::thread_exit() {
+}
+
+void SmallAllocator::get_class_stats(int p_class, ClassStats &r_stats) {
+
+	r_stats.block_size = 0;
+	r_stats.allocs = 0;
+	r_stats.frees = 0;
+	r_stats.remote_frees = 0;
+	r_stats.reserved = 0;
+}
+
+bool SmallAllocator::is_enabled() {
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*************************************************************************/
+/*  small_allocator.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef SMALL_ALLOCATOR_H
+#define SMALL_ALLOCATOR_H
+
+#include "typedefs.h"
+
+#include <stddef.h>
+
+/**
+	Size class allocator used by Memory when built with small_alloc=yes.
+	Each thread carves blocks out of its own slabs and keeps one free list
+	per size class, so allocating and freeing on the same thread takes no
+	lock. A block freed by another thread goes to a lock-free list in the
+	owning cache and is taken back once the owner runs out of blocks.
+*/
+
+class SmallAllocator {
+public:
+	enum {
+		CLASS_COUNT = 16,
+		MAX_SIZE = 512,
+		SLAB_SIZE = 65536, //slabs are aligned to their size, a block finds its slab header by masking its address
+		CHUNK_SLABS = 16
+	};
+
+	struct ClassStats {
+
+		size_t block_size;
+		uint64_t allocs;
+		uint64_t frees;
+		uint64_t remote_frees;
+		uint64_t reserved;
+	};
+
+	static void *alloc(size_t p_bytes); ///< NULL when p_bytes is above MAX_SIZE
+	static void free(void *p_block);
+	static size_t get_block_size(void *p_block);
+
+	static void thread_exit(); ///< hands the calling thread's cache over to the next new thread
+	static void get_class_stats(int p_class, ClassStats &r_stats);
+	static bool is_enabled();
+};
+
+#endif // SMALL_ALLOCATOR_H
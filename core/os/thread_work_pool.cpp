@@ -0,0 +1,184 @@
+/*************************************************************************/
+/*  thread_work_pool.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "thread_work_pool.h"
+
+#include "os/memory.h"
+#include "os/os.h"
+
+void ThreadWorkPool::_process_range(uint32_t p_thread) {
+
+	uint32_t from = uint64_t(work_elements) * p_thread / thread_count;
+	uint32_t to = uint64_t(work_elements) * (p_thread + 1) / thread_count;
+
+	if (from < to) {
+		work_callback(work_userdata, p_thread, from, to);
+	}
+}
+
+void ThreadWorkPool::_thread_function(void *p_data) {
+
+	ThreadData *td = (ThreadData *)p_data;
+	ThreadWorkPool *pool = td->pool;
+
+	while (true) {
+
+		td->start->wait();
+		if (pool->exit_threads)
+			break;
+
+		pool->_process_range(td->index);
+		pool->done->post();
+	}
+}
+
+void ThreadWorkPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(threads != NULL);
+
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton() ? OS::get_singleton()->get_processor_count() : 1;
+	}
+
+	thread_count = MAX(1, p_thread_count);
+
+#ifdef NO_THREADS
+	thread_count = 1;
+#else
+	if (thread_count == 1)
+		return;
+
+	done = Semaphore::create();
+	if (!done) {
+		//platform without semaphores, run everything inline
+		thread_count = 1;
+		return;
+	}
+
+	exit_threads = false;
+	threads = memnew_arr(ThreadData, thread_count);
+
+	//thread 0 is always the caller, only create workers for the rest
+	threads[0].pool = this;
+	threads[0].index = 0;
+	threads[0].thread = NULL;
+	threads[0].start = NULL;
+
+	for (uint32_t i = 1; i < thread_count; i++) {
+
+		threads[i].pool = this;
+		threads[i].index = i;
+		threads[i].start = Semaphore::create();
+		threads[i].thread = Thread::create(_thread_function, &threads[i]);
+
+		if (!threads[i].thread) {
+			//could not spawn more workers, keep the ones that did start
+			memdelete(threads[i].start);
+			thread_count = i;
+			break;
+		}
+	}
+
+	if (thread_count == 1) {
+		memdelete_arr(threads);
+		memdelete(done);
+		threads = NULL;
+		done = NULL;
+	}
+#endif
+}
+
+void ThreadWorkPool::finish() {
+
+	if (!threads) {
+		thread_count = 1;
+		return;
+	}
+
+	exit_threads = true;
+
+	for (uint32_t i = 1; i < thread_count; i++) {
+		threads[i].start->post();
+	}
+
+	for (uint32_t i = 1; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+		memdelete(threads[i].start);
+	}
+
+	memdelete_arr(threads);
+	memdelete(done);
+
+	threads = NULL;
+	done = NULL;
+	thread_count = 1;
+}
+
+void ThreadWorkPool::do_work(uint32_t p_elements, WorkCallback p_callback, void *p_userdata) {
+
+	if (p_elements == 0)
+		return;
+
+	if (!threads || p_elements < thread_count) {
+		//not worth waking up the workers
+		p_callback(p_userdata, 0, 0, p_elements);
+		return;
+	}
+
+	work_callback = p_callback;
+	work_userdata = p_userdata;
+	work_elements = p_elements;
+
+	for (uint32_t i = 1; i < thread_count; i++) {
+		threads[i].start->post();
+	}
+
+	_process_range(0);
+
+	for (uint32_t i = 1; i < thread_count; i++) {
+		done->wait();
+	}
+}
+
+ThreadWorkPool::ThreadWorkPool() {
+
+	threads = NULL;
+	thread_count = 1;
+	done = NULL;
+	exit_threads = false;
+	work_callback = NULL;
+	work_userdata = NULL;
+	work_elements = 0;
+}
+
+ThreadWorkPool::~ThreadWorkPool() {
+
+	finish();
+}
@@ -0,0 +1,87 @@
+/*************************************************************************/
+/*  thread_work_pool.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef THREAD_WORK_POOL_H
+#define THREAD_WORK_POOL_H
+
+#include "os/mutex.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "typedefs.h"
+
+/**
+ * Small fork/join pool for data-parallel loops in the servers.
+ *
+ * do_work() splits [0, p_elements) into one contiguous range per thread and
+ * blocks until all of them have been processed. The calling thread always
+ * processes range 0, so a pool with a thread count of 1 (or a build without
+ * threads) simply runs the callback inline. Ranges are assigned statically,
+ * which keeps results deterministic for a given thread count: merging
+ * per-thread output in thread order gives the same result as a serial loop.
+ */
+
+class ThreadWorkPool {
+public:
+	typedef void (*WorkCallback)(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
+
+private:
+	struct ThreadData {
+
+		ThreadWorkPool *pool;
+		uint32_t index;
+		Thread *thread;
+		Semaphore *start;
+	};
+
+	ThreadData *threads;
+	uint32_t thread_count;
+
+	Semaphore *done;
+	volatile bool exit_threads;
+
+	WorkCallback work_callback;
+	void *work_userdata;
+	uint32_t work_elements;
+
+	void _process_range(uint32_t p_thread);
+	static void _thread_function(void *p_data);
+
+public:
+	void init(int p_thread_count = -1); // -1 means one thread per processor
+	void finish();
+
+	_FORCE_INLINE_ uint32_t get_thread_count() const { return thread_count; }
+
+	void do_work(uint32_t p_elements, WorkCallback p_callback, void *p_userdata);
+
+	ThreadWorkPool();
+	~ThreadWorkPool();
+};
+
+#endif // THREAD_WORK_POOL_H
@@ -38,6 +38,7 @@
 #include "geometry.h"
 #include "global_config.h"
 #include "input_map.h"
+#include "io/compression.h"
 #include "io/config_file.h"
 #include "io/http_client.h"
 #include "io/packet_peer.h"
@@ -49,6 +50,7 @@
 #include "io/tcp_server.h"
 #include "io/translation_loader_po.h"
 #include "math/a_star.h"
+#include "math/math_batch.h"
 #include "math/triangle_mesh.h"
 #include "os/input.h"
 #include "os/main_loop.h"
@@ -76,19 +78,23 @@ static _Geometry *_geometry = NULL;
 extern Mutex *_global_mutex;
 
 extern void register_variant_methods();
+extern void register_variant_operators();
 extern void unregister_variant_methods();
 
 void register_core_types() {
 
 	ObjectDB::setup();
 	ResourceCache::setup();
+	ResourceLoader::initialize_threaded_loading();
 	MemoryPool::setup();
+	MathBatch::init();
 
 	_global_mutex = Mutex::create();
 
 	StringName::setup();
 
 	register_variant_methods();
+	register_variant_operators();
 
 	CoreStringNames::create();
 
@@ -159,6 +165,13 @@ void register_core_types() {
 void register_core_settings() {
 	//since in register core types, globals may not e present
 	GLOBAL_DEF("network/packets/packet_stream_peer_max_buffer_po2", (16));
+	GLOBAL_DEF("application/resource_loader/thread_count", 0);
+	GlobalConfig::get_singleton()->set_custom_property_info("application/resource_loader/thread_count", PropertyInfo(Variant::INT, "application/resource_loader/thread_count", PROPERTY_HINT_RANGE, "0,64,1"));
+	GLOBAL_DEF("compression/formats/lz4/acceleration", Compression::lz4_acceleration);
+	GlobalConfig::get_singleton()->set_custom_property_info("compression/formats/lz4/acceleration", PropertyInfo(Variant::INT, "compression/formats/lz4/acceleration", PROPERTY_HINT_RANGE, "1,64,1"));
+	Compression::lz4_acceleration = GLOBAL_GET("compression/formats/lz4/acceleration");
+	GLOBAL_DEF("compression/formats/binary_resource_mode", (int)Compression::MODE_LZ4);
+	GlobalConfig::get_singleton()->set_custom_property_info("compression/formats/binary_resource_mode", PropertyInfo(Variant::INT, "compression/formats/binary_resource_mode", PROPERTY_HINT_ENUM, "FastLZ,Deflate,LZ4"));
 }
 
 void register_core_singletons() {
@@ -204,6 +217,7 @@ void unregister_core_types() {
 
 	unregister_variant_methods();
 
+	ResourceLoader::finalize_threaded_loading();
 	ClassDB::cleanup();
 	ResourceCache::clear();
 	CoreStringNames::free();
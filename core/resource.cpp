@@ -243,8 +243,7 @@ void Resource::notify_change_to_owners() {
 		Object *obj = ObjectDB::get_instance(E->get());
 		ERR_EXPLAIN("Object was deleted, while still owning a resource");
 		ERR_CONTINUE(!obj); //wtf
-		//TODO store string
-		obj->call("resource_changed", RES(this));
+		obj->call(CoreStringNames::get_singleton()->resource_changed, RES(this));
 	}
 }
 
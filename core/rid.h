@@ -44,81 +44,64 @@ class RID_OwnerBase;
 
 class RID_Data {
 
-	friend class RID_OwnerBase;
-
-#ifndef DEBUG_ENABLED
-	RID_OwnerBase *_owner;
-#endif
-	uint32_t _id;
-
 public:
-	_FORCE_INLINE_ uint32_t get_id() const { return _id; }
-
 	virtual ~RID_Data();
 };
 
 class RID {
 	friend class RID_OwnerBase;
 
-	mutable RID_Data *_data;
+	//slot in the owner plus a globally unique id, the id doubles as the slot generation
+	uint32_t _index;
+	uint32_t _id;
 
 public:
-	_FORCE_INLINE_ RID_Data *get_data() const { return _data; }
-
 	_FORCE_INLINE_ bool operator==(const RID &p_rid) const {
 
-		return _data == p_rid._data;
+		return _id == p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator<(const RID &p_rid) const {
 
-		return _data < p_rid._data;
+		return _id < p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator<=(const RID &p_rid) const {
 
-		return _data <= p_rid._data;
+		return _id <= p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator>(const RID &p_rid) const {
 
-		return _data > p_rid._data;
+		return _id > p_rid._id;
 	}
 	_FORCE_INLINE_ bool operator!=(const RID &p_rid) const {
 
-		return _data != p_rid._data;
+		return _id != p_rid._id;
 	}
-	_FORCE_INLINE_ bool is_valid() const { return _data != NULL; }
+	_FORCE_INLINE_ bool is_valid() const { return _id != 0; }
 
-	_FORCE_INLINE_ uint32_t get_id() const { return _data ? _data->get_id() : 0; }
+	_FORCE_INLINE_ uint32_t get_id() const { return _id; }
 
 	_FORCE_INLINE_ RID() {
-		_data = NULL;
+		_index = 0;
+		_id = 0;
 	}
 };
 
 class RID_OwnerBase {
 protected:
 	static SafeRefCount refcount;
-	_FORCE_INLINE_ void _set_data(RID &p_rid, RID_Data *p_data) {
-		p_rid._data = p_data;
-		refcount.ref();
-		p_data->_id = refcount.get();
-#ifndef DEBUG_ENABLED
-		p_data->_owner = this;
-#endif
-	}
 
-#ifndef DEBUG_ENABLED
-
-	_FORCE_INLINE_ bool _is_owner(const RID &p_rid) const {
-
-		return this == p_rid._data->_owner;
+	_FORCE_INLINE_ static void _set_rid(RID &p_rid, uint32_t p_index, uint32_t p_id) {
+		p_rid._index = p_index;
+		p_rid._id = p_id;
 	}
 
-	_FORCE_INLINE_ void _remove_owner(RID &p_rid) {
+	_FORCE_INLINE_ static uint32_t _get_index(const RID &p_rid) {
+		return p_rid._index;
+	}
 
-		p_rid._data->_owner = NULL;
+	_FORCE_INLINE_ static uint32_t _make_id() {
+		return refcount.refval();
 	}
-#
-#endif
 
 public:
 	virtual void get_owned_list(List<RID> *p_owned) = 0;
@@ -127,81 +110,180 @@ public:
 	virtual ~RID_OwnerBase() {}
 };
 
+/**
+	Owns RIDs through a paged slot table. A RID stores its slot index and the
+	id it was created with, so validating it is two array accesses and stale
+	or foreign RIDs are rejected in every build. Pages never move once
+	allocated and outgrown page directories are only freed with the owner,
+	so get() stays safe while another thread is in make_rid().
+*/
+
 template <class T>
 class RID_Owner : public RID_OwnerBase {
+
+	enum {
+		INVALID_SLOT = 0xFFFFFFFF,
+		PAGE_SHIFT = 8,
+		PAGE_SIZE = 1 << PAGE_SHIFT,
+		PAGE_MASK = PAGE_SIZE - 1,
+		MIN_PAGES = 4
+	};
+
+	struct Slot {
+		T *data;
+		uint32_t id; //0 when free
+		uint32_t next_free;
+	};
+
+	Slot **pages;
+	uint32_t page_count;
+	uint32_t page_capacity;
+	List<Slot **> old_pages; //outgrown directories, a reader may still be going through one
+	uint32_t slot_count;
+	uint32_t free_slot;
+	uint32_t owned_count;
+
+	_FORCE_INLINE_ Slot *_get_slot_ptr(uint32_t p_index) const {
+
+		return &pages[p_index >> PAGE_SHIFT][p_index & PAGE_MASK];
+	}
+
+	_FORCE_INLINE_ const Slot *_get_slot(const RID &p_rid) const {
+
+		uint32_t index = _get_index(p_rid);
+		if (index >= slot_count)
+			return NULL;
+		const Slot *slot = _get_slot_ptr(index);
+		if (slot->id == 0 || slot->id != p_rid.get_id())
+			return NULL;
+		return slot;
+	}
+
 public:
-#ifdef DEBUG_ENABLED
-	mutable Set<RID_Data *> id_map;
-#endif
-public:
-	_FORCE_INLINE_ RID make_rid(T *p_data) {
+	RID make_rid(T *p_data) {
+
+		ERR_FAIL_COND_V(!p_data, RID());
+
+		uint32_t index;
+
+		if (free_slot != INVALID_SLOT) {
+
+			index = free_slot;
+			free_slot = _get_slot_ptr(index)->next_free;
+		} else {
+
+			if (slot_count == page_count * PAGE_SIZE) {
+
+				if (page_count == page_capacity) {
+					uint32_t new_capacity = page_capacity ? page_capacity * 2 : MIN_PAGES;
+					Slot **new_pages = (Slot **)memalloc(sizeof(Slot *) * new_capacity);
+					ERR_FAIL_COND_V(!new_pages, RID());
+					for (uint32_t i = 0; i < page_count; i++)
+						new_pages[i] = pages[i];
+					if (pages)
+						old_pages.push_back(pages);
+					pages = new_pages;
+					page_capacity = new_capacity;
+				}
+
+				Slot *page = (Slot *)memalloc(sizeof(Slot) * PAGE_SIZE);
+				ERR_FAIL_COND_V(!page, RID());
+				for (uint32_t i = 0; i < PAGE_SIZE; i++)
+					page[i].id = 0;
+				pages[page_count++] = page;
+			}
+			index = slot_count;
+		}
 
-		RID rid;
-		_set_data(rid, p_data);
+		uint32_t id = _make_id();
 
-#ifdef DEBUG_ENABLED
-		id_map.insert(p_data);
-#endif
+		Slot *slot = _get_slot_ptr(index);
+		slot->data = p_data;
+		slot->next_free = INVALID_SLOT;
+		slot->id = id;
+		if (index == slot_count)
+			slot_count++; //published last, readers check the index against it
+		owned_count++;
 
+		RID rid;
+		_set_rid(rid, index, id);
 		return rid;
 	}
 
 	_FORCE_INLINE_ T *get(const RID &p_rid) {
 
-#ifdef DEBUG_ENABLED
-
 		ERR_FAIL_COND_V(!p_rid.is_valid(), NULL);
-		ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
-#endif
-		return static_cast<T *>(p_rid.get_data());
+		const Slot *slot = _get_slot(p_rid);
+		ERR_FAIL_COND_V(!slot, NULL);
+		return slot->data;
 	}
 
 	_FORCE_INLINE_ T *getornull(const RID &p_rid) {
 
-#ifdef DEBUG_ENABLED
-
-		if (p_rid.get_data()) {
-			ERR_FAIL_COND_V(!id_map.has(p_rid.get_data()), NULL);
-		}
-#endif
-		return static_cast<T *>(p_rid.get_data());
+		if (!p_rid.is_valid())
+			return NULL;
+		const Slot *slot = _get_slot(p_rid);
+		ERR_FAIL_COND_V(!slot, NULL);
+		return slot->data;
 	}
 
 	_FORCE_INLINE_ T *getptr(const RID &p_rid) {
 
-		return static_cast<T *>(p_rid.get_data());
+		const Slot *slot = _get_slot(p_rid);
+		return slot ? slot->data : NULL;
 	}
 
 	_FORCE_INLINE_ bool owns(const RID &p_rid) const {
 
-		if (p_rid.get_data() == NULL)
-			return false;
-#ifdef DEBUG_ENABLED
-		return id_map.has(p_rid.get_data());
-#else
-		return _is_owner(p_rid);
-#endif
+		return _get_slot(p_rid) != NULL;
 	}
 
 	void free(RID p_rid) {
 
-#ifdef DEBUG_ENABLED
-		id_map.erase(p_rid.get_data());
-#else
-		_remove_owner(p_rid);
-#endif
+		ERR_FAIL_COND(!_get_slot(p_rid));
+
+		uint32_t index = _get_index(p_rid);
+		Slot *slot = _get_slot_ptr(index);
+		slot->id = 0;
+		slot->data = NULL;
+		slot->next_free = free_slot;
+		free_slot = index;
+		owned_count--;
 	}
 
 	void get_owned_list(List<RID> *p_owned) {
 
-#ifdef DEBUG_ENABLED
+		for (uint32_t i = 0; i < slot_count; i++) {
 
-		for (typename Set<RID_Data *>::Element *E = id_map.front(); E; E = E->next()) {
+			const Slot *slot = _get_slot_ptr(i);
+			if (slot->id == 0)
+				continue;
 			RID r;
-			_set_data(r, static_cast<T *>(E->get()));
+			_set_rid(r, i, slot->id);
 			p_owned->push_back(r);
 		}
-#endif
+	}
+
+	_FORCE_INLINE_ uint32_t get_rid_count() const { return owned_count; }
+
+	RID_Owner() {
+
+		pages = NULL;
+		page_count = 0;
+		page_capacity = 0;
+		slot_count = 0;
+		free_slot = INVALID_SLOT;
+		owned_count = 0;
+	}
+
+	~RID_Owner() {
+
+		for (uint32_t i = 0; i < page_count; i++)
+			memfree(pages[i]);
+		if (pages)
+			memfree(pages);
+		for (typename List<Slot **>::Element *E = old_pages.front(); E; E = E->next())
+			memfree(E->get());
 	}
 };
 
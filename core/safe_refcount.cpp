@@ -57,6 +57,49 @@ uint32_t atomic_decrement(register uint32_t *pw) {
 	return *pw;
 }
 
+uint32_t atomic_compare_exchange(register uint32_t *pw, uint32_t p_expected, uint32_t p_value) {
+
+	uint32_t tmp = *pw;
+	if (tmp == p_expected)
+		*pw = p_value;
+
+	return tmp;
+}
+
+void *atomic_compare_exchange_ptr(void **pw, void *p_expected, void *p_value) {
+
+	void *tmp = *pw;
+	if (tmp == p_expected)
+		*pw = p_value;
+
+	return tmp;
+}
+
+void atomic_memory_barrier() {
+}
+
+uint64_t atomic_add(register uint64_t *pw, register uint64_t p_value) {
+
+	*pw += p_value;
+
+	return *pw;
+}
+
+uint64_t atomic_sub(register uint64_t *pw, register uint64_t p_value) {
+
+	*pw -= p_value;
+
+	return *pw;
+}
+
+uint64_t atomic_exchange_if_greater(register uint64_t *pw, register uint64_t p_value) {
+
+	if (p_value > *pw)
+		*pw = p_value;
+
+	return *pw;
+}
+
 #else
 
 #ifdef _MSC_VER
@@ -84,6 +127,37 @@ uint32_t atomic_decrement(register uint32_t *pw) {
 uint32_t atomic_increment(register uint32_t *pw) {
 	return InterlockedIncrement((LONG volatile *)pw);
 }
+
+uint32_t atomic_compare_exchange(register uint32_t *pw, uint32_t p_expected, uint32_t p_value) {
+	return InterlockedCompareExchange((LONG volatile *)pw, p_value, p_expected);
+}
+
+void *atomic_compare_exchange_ptr(void **pw, void *p_expected, void *p_value) {
+	return InterlockedCompareExchangePointer((PVOID volatile *)pw, p_value, p_expected);
+}
+
+void atomic_memory_barrier() {
+	MemoryBarrier();
+}
+
+uint64_t atomic_add(register uint64_t *pw, register uint64_t p_value) {
+	return InterlockedExchangeAdd64((LONGLONG volatile *)pw, p_value) + p_value;
+}
+
+uint64_t atomic_sub(register uint64_t *pw, register uint64_t p_value) {
+	return InterlockedExchangeAdd64((LONGLONG volatile *)pw, -(LONGLONG)p_value) - p_value;
+}
+
+uint64_t atomic_exchange_if_greater(register uint64_t *pw, register uint64_t p_value) {
+
+	while (true) {
+		uint64_t tmp = static_cast<uint64_t const volatile &>(*pw);
+		if (tmp >= p_value)
+			return tmp; // already greater, or equal
+		if (InterlockedCompareExchange64((LONGLONG volatile *)pw, p_value, tmp) == (LONGLONG)tmp)
+			return p_value;
+	}
+}
 #elif defined(__GNUC__)
 
 uint32_t atomic_conditional_increment(register uint32_t *pw) {
@@ -107,6 +181,42 @@ uint32_t atomic_increment(register uint32_t *pw) {
 	return __sync_add_and_fetch(pw, 1);
 }
 
+uint32_t atomic_compare_exchange(register uint32_t *pw, uint32_t p_expected, uint32_t p_value) {
+
+	return __sync_val_compare_and_swap(pw, p_expected, p_value);
+}
+
+void *atomic_compare_exchange_ptr(void **pw, void *p_expected, void *p_value) {
+
+	return __sync_val_compare_and_swap(pw, p_expected, p_value);
+}
+
+void atomic_memory_barrier() {
+
+	__sync_synchronize();
+}
+
+uint64_t atomic_add(register uint64_t *pw, register uint64_t p_value) {
+
+	return __sync_add_and_fetch(pw, p_value);
+}
+
+uint64_t atomic_sub(register uint64_t *pw, register uint64_t p_value) {
+
+	return __sync_sub_and_fetch(pw, p_value);
+}
+
+uint64_t atomic_exchange_if_greater(register uint64_t *pw, register uint64_t p_value) {
+
+	while (true) {
+		uint64_t tmp = static_cast<uint64_t const volatile &>(*pw);
+		if (tmp >= p_value)
+			return tmp; // already greater, or equal
+		if (__sync_val_compare_and_swap(pw, tmp, p_value) == tmp)
+			return p_value;
+	}
+}
+
 #else
 //no threads supported?
 #error Must provide atomic functions for this platform or compiler!
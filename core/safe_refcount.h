@@ -39,6 +39,12 @@
 uint32_t atomic_conditional_increment(register uint32_t *counter);
 uint32_t atomic_decrement(register uint32_t *pw);
 uint32_t atomic_increment(register uint32_t *pw);
+uint32_t atomic_compare_exchange(register uint32_t *pw, uint32_t p_expected, uint32_t p_value); ///< returns the previous value, swap happened if it equals p_expected
+void *atomic_compare_exchange_ptr(void **pw, void *p_expected, void *p_value); ///< same as atomic_compare_exchange, for pointers
+void atomic_memory_barrier(); ///< full barrier, orders plain loads/stores around it
+uint64_t atomic_add(register uint64_t *pw, register uint64_t p_value); ///< returns the new value
+uint64_t atomic_sub(register uint64_t *pw, register uint64_t p_value); ///< returns the new value
+uint64_t atomic_exchange_if_greater(register uint64_t *pw, register uint64_t p_value); ///< stores p_value if it is greater, returns the resulting value
 
 struct SafeRefCount {
 
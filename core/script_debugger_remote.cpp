@@ -90,7 +90,7 @@ Error ScriptDebuggerRemote::connect_to_host(const String &p_host, uint16_t p_por
 	return OK;
 }
 
-static int _ScriptDebuggerRemote_found_id = 0;
+static ObjectID _ScriptDebuggerRemote_found_id = 0;
 static Object *_ScriptDebuggerRemote_find = NULL;
 static void _ScriptDebuggerRemote_debug_func(Object *p_obj) {
 
@@ -30,6 +30,7 @@
 #include "string_db.h"
 
 #include "os/os.h"
+#include "os/thread.h"
 #include "print_string.h"
 
 StaticCString StaticCString::create(const char *p_ptr) {
@@ -38,7 +39,35 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+/* Names are looked up without taking any lock: readers announce themselves
+ * in a reader slot, walk the bucket chain and take a reference only if the
+ * entry is still alive. Insertions and removals lock one of LOCK_STRIPES
+ * mutexes, and growing the table locks all of them. Removed entries and old
+ * bucket arrays are retired and only freed once no reader is in flight, so a
+ * concurrent lookup never touches freed memory. A lookup that misses (for
+ * example while the table is being grown) retries under the stripe lock. */
+
+struct StringName::_Table {
+
+	uint32_t mask;
+	_Data **buckets;
+	_Table *retired_next;
+};
+
+struct _StringNameReaderSlot {
+
+	uint32_t count;
+	uint8_t pad[64 - sizeof(uint32_t)]; //keep each slot on its own cache line
+};
+
+#define STRING_NAME_READER_SLOTS 16
+
+static _StringNameReaderSlot _string_name_readers[STRING_NAME_READER_SLOTS];
+
+StringName::_Table *volatile StringName::_table = NULL;
+StringName::_Data *StringName::_retired = NULL;
+StringName::_Table *StringName::_retired_tables = NULL;
+uint32_t StringName::_count = 0;
 
 StringName _scs_create(const char *p_chr) {
 
@@ -47,16 +76,248 @@ StringName _scs_create(const char *p_chr) {
 
 bool StringName::configured = false;
 Mutex *StringName::lock = NULL;
+Mutex *StringName::stripe_locks[StringName::LOCK_STRIPES];
+
+static _FORCE_INLINE_ bool _string_name_equals(const char *p_cname, const String &p_name, const char *p_str) {
+
+	if (p_cname) {
+		const char *a = p_cname;
+		while (*a && *a == *p_str) {
+			a++;
+			p_str++;
+		}
+		return *a == *p_str;
+	}
+	return p_name == p_str;
+}
+
+static _FORCE_INLINE_ bool _string_name_equals(const char *p_cname, const String &p_name, const CharType *p_str) {
+
+	if (p_cname) {
+		const char *a = p_cname;
+		while (*a && CharType((uint8_t)*a) == *p_str) {
+			a++;
+			p_str++;
+		}
+		return CharType((uint8_t)*a) == *p_str;
+	}
+	return p_name == p_str;
+}
+
+static _FORCE_INLINE_ bool _string_name_equals(const char *p_cname, const String &p_name, const String &p_str) {
+
+	if (p_cname)
+		return p_str == p_cname;
+	return p_name == p_str;
+}
+
+static _FORCE_INLINE_ uint32_t _string_name_reader_slot() {
+
+	uint64_t id = Thread::get_caller_ID();
+	return uint32_t(id ^ (id >> 12) ^ (id >> 24)) & (STRING_NAME_READER_SLOTS - 1);
+}
+
+template <class T>
+StringName::_Data *StringName::_find(const T &p_name, uint32_t p_hash) {
+
+	_StringNameReaderSlot &slot = _string_name_readers[_string_name_reader_slot()];
+	atomic_increment(&slot.count);
+
+	_Table *table = _table;
+	_Data *d = table->buckets[p_hash & table->mask];
+
+	while (d) {
+
+		// compare hash first, entries with no references left are being removed
+		if (d->hash == p_hash && _string_name_equals(d->cname, d->name, p_name) && d->refcount.ref())
+			break;
+		d = d->next;
+	}
+
+	atomic_decrement(&slot.count);
+	return d;
+}
+
+template <class T>
+StringName::_Data *StringName::_find_locked(const T &p_name, uint32_t p_hash) {
+
+	//caller holds the stripe lock of p_hash, so the table can't be grown under us
+	_Table *table = _table;
+	_Data *d = table->buckets[p_hash & table->mask];
+
+	while (d) {
+
+		if (d->hash == p_hash && _string_name_equals(d->cname, d->name, p_name) && d->refcount.ref())
+			break;
+		d = d->next;
+	}
+
+	return d;
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(const T &p_name, uint32_t p_hash, const char *p_cname) {
+
+	_Data *d = _find(p_name, p_hash);
+	if (d)
+		return d;
+
+	Mutex *stripe = stripe_locks[p_hash & (LOCK_STRIPES - 1)];
+	stripe->lock();
+
+	d = _find_locked(p_name, p_hash);
+	if (d) {
+		// inserted by another thread meanwhile
+		stripe->unlock();
+		return d;
+	}
+
+	_Table *table = _table;
+	uint32_t idx = p_hash & table->mask;
+
+	d = memnew(_Data);
+	if (p_cname)
+		d->cname = p_cname;
+	else
+		d->name = p_name;
+	d->refcount.init();
+	d->hash = p_hash;
+	d->prev = NULL;
+	d->next = table->buckets[idx];
+	if (d->next)
+		d->next->prev = d;
+
+	atomic_memory_barrier(); // entry must be complete before lock-free readers can see it
+	table->buckets[idx] = d;
+
+	stripe->unlock();
+
+	if (atomic_increment(&_count) > table->mask + 1) {
+		_grow();
+	}
+
+	return d;
+}
+
+void StringName::_grow() {
+
+	lock->lock();
+
+	for (int i = 0; i < LOCK_STRIPES; i++) {
+		stripe_locks[i]->lock();
+	}
+
+	_Table *old_table = _table;
+	uint32_t old_len = old_table->mask + 1;
+
+	if (_count > old_len) {
+
+		_Table *new_table = memnew(_Table);
+		uint32_t new_len = old_len * 2;
+		new_table->mask = new_len - 1;
+		new_table->buckets = memnew_arr(_Data *, new_len);
+		new_table->retired_next = NULL;
+		for (uint32_t i = 0; i < new_len; i++) {
+			new_table->buckets[i] = NULL;
+		}
+
+		// entries are moved one by one from the front of each chain, a concurrent
+		// reader may jump from an old chain into a new one and miss, but never loops
+		for (uint32_t i = 0; i < old_len; i++) {
+
+			while (old_table->buckets[i]) {
+
+				_Data *d = old_table->buckets[i];
+				old_table->buckets[i] = d->next;
+
+				uint32_t idx = d->hash & new_table->mask;
+				d->prev = NULL;
+				d->next = new_table->buckets[idx];
+				if (d->next)
+					d->next->prev = d;
+				new_table->buckets[idx] = d;
+			}
+		}
+
+		atomic_memory_barrier();
+		_table = new_table;
+
+		old_table->retired_next = _retired_tables;
+		_retired_tables = old_table;
+	}
+
+	for (int i = LOCK_STRIPES - 1; i >= 0; i--) {
+		stripe_locks[i]->unlock();
+	}
+
+	_reclaim();
+
+	lock->unlock();
+}
+
+void StringName::_retire(_Data *p_data) {
+
+	lock->lock();
+
+	p_data->retired_next = _retired;
+	_retired = p_data;
+
+	_reclaim();
+
+	lock->unlock();
+}
+
+void StringName::_reclaim() {
+
+	//caller holds lock, retired memory can only be freed while no lock-free reader is running
+	atomic_memory_barrier();
+
+	for (int i = 0; i < STRING_NAME_READER_SLOTS; i++) {
+		if (_string_name_readers[i].count)
+			return;
+	}
+
+	while (_retired) {
+
+		_Data *d = _retired;
+		_retired = d->retired_next;
+		memdelete(d);
+	}
+
+	while (_retired_tables) {
+
+		_Table *t = _retired_tables;
+		_retired_tables = t->retired_next;
+		memdelete_arr(t->buckets);
+		memdelete(t);
+	}
+}
 
 void StringName::setup() {
 
+	ERR_FAIL_COND(configured);
+
 	lock = Mutex::create();
+	for (int i = 0; i < LOCK_STRIPES; i++) {
+		stripe_locks[i] = Mutex::create();
+	}
 
-	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	for (int i = 0; i < STRING_NAME_READER_SLOTS; i++) {
+		_string_name_readers[i].count = 0;
+	}
+
+	_Table *table = memnew(_Table);
+	uint32_t len = 1 << STRING_TABLE_MIN_BITS;
+	table->mask = len - 1;
+	table->buckets = memnew_arr(_Data *, len);
+	table->retired_next = NULL;
+	for (uint32_t i = 0; i < len; i++) {
 
-		_table[i] = NULL;
+		table->buckets[i] = NULL;
 	}
+	_table = table;
+	_count = 0;
+
 	configured = true;
 }
 
@@ -64,12 +325,13 @@ void StringName::cleanup() {
 
 	lock->lock();
 
+	_Table *table = _table;
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	for (uint32_t i = 0; i <= table->mask; i++) {
 
-		while (_table[i]) {
+		while (table->buckets[i]) {
 
-			_Data *d = _table[i];
+			_Data *d = table->buckets[i];
 			lost_strings++;
 			if (OS::get_singleton()->is_stdout_verbose()) {
 
@@ -80,15 +342,25 @@ void StringName::cleanup() {
 				}
 			}
 
-			_table[i] = _table[i]->next;
+			table->buckets[i] = table->buckets[i]->next;
 			memdelete(d);
 		}
 	}
 	if (OS::get_singleton()->is_stdout_verbose() && lost_strings) {
 		print_line("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+
+	_reclaim();
+
+	memdelete_arr(table->buckets);
+	memdelete(table);
+	_table = NULL;
+
 	lock->unlock();
 
+	for (int i = 0; i < LOCK_STRIPES; i++) {
+		memdelete(stripe_locks[i]);
+	}
 	memdelete(lock);
 }
 
@@ -98,22 +370,30 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		Mutex *stripe = stripe_locks[_data->hash & (LOCK_STRIPES - 1)];
+		stripe->lock();
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
 		} else {
-			if (_table[_data->idx] != _data) {
+			_Table *table = _table;
+			uint32_t idx = _data->hash & table->mask;
+			if (table->buckets[idx] != _data) {
 				ERR_PRINT("BUG!");
 			}
-			_table[_data->idx] = _data->next;
+			table->buckets[idx] = _data->next;
 		}
 
 		if (_data->next) {
 			_data->next->prev = _data->prev;
 		}
-		memdelete(_data);
-		lock->unlock();
+
+		stripe->unlock();
+
+		atomic_decrement(&_count);
+
+		// next is left intact, readers standing on this entry can keep walking
+		_retire(_data);
 	}
 
 	_data = NULL;
@@ -191,44 +471,7 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_name, String::hash(p_name), NULL);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -239,44 +482,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_static_string.ptr, String::hash(p_static_string.ptr), p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -288,43 +494,7 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		} else {
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_name, p_name.hash(), NULL);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -335,29 +505,20 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
+	_Data *_data = _find(p_name, hash);
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
+	if (!_data) {
+		Mutex *stripe = stripe_locks[hash & (LOCK_STRIPES - 1)];
+		stripe->lock();
+		_data = _find_locked(p_name, hash);
+		stripe->unlock();
 	}
 
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-
+	if (_data)
 		return StringName(_data);
-	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -369,56 +530,40 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
+	_Data *_data = _find(p_name, hash);
 
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
+	if (!_data) {
+		Mutex *stripe = stripe_locks[hash & (LOCK_STRIPES - 1)];
+		stripe->lock();
+		_data = _find_locked(p_name, hash);
+		stripe->unlock();
 	}
 
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data)
 		return StringName(_data);
-	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
+	_Data *_data = _find(p_name, hash);
 
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
+	if (!_data) {
+		Mutex *stripe = stripe_locks[hash & (LOCK_STRIPES - 1)];
+		stripe->lock();
+		_data = _find_locked(p_name, hash);
+		stripe->unlock();
 	}
 
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+	if (_data)
 		return StringName(_data);
-	}
 
-	lock->unlock();
 	return StringName(); //does not exist
 }
 
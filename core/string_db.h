@@ -48,9 +48,8 @@ class StringName {
 
 	enum {
 
-		STRING_TABLE_BITS = 12,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MIN_BITS = 12,
+		LOCK_STRIPES = 64 //insert/remove locks, a bucket belongs to stripe (hash & (LOCK_STRIPES - 1))
 	};
 
 	struct _Data {
@@ -59,18 +58,24 @@ class StringName {
 		String name;
 
 		String get_name() const { return cname ? String(cname) : name; }
-		int idx;
 		uint32_t hash;
 		_Data *prev;
-		_Data *next;
+		_Data *volatile next;
+		_Data *retired_next;
 		_Data() {
 			cname = NULL;
 			next = prev = NULL;
+			retired_next = NULL;
 			hash = 0;
 		}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	struct _Table;
+
+	static _Table *volatile _table;
+	static _Data *_retired;
+	static _Table *_retired_tables;
+	static uint32_t _count;
 
 	_Data *_data;
 
@@ -85,10 +90,21 @@ class StringName {
 	friend void unregister_core_types();
 
 	static Mutex *lock;
+	static Mutex *stripe_locks[LOCK_STRIPES];
 	static void setup();
 	static void cleanup();
 	static bool configured;
 
+	template <class T>
+	static _Data *_find(const T &p_name, uint32_t p_hash);
+	template <class T>
+	static _Data *_find_locked(const T &p_name, uint32_t p_hash);
+	template <class T>
+	static _Data *_intern(const T &p_name, uint32_t p_hash, const char *p_cname);
+	static void _grow();
+	static void _retire(_Data *p_data);
+	static void _reclaim();
+
 	StringName(_Data *p_data) { _data = p_data; }
 
 public:
@@ -121,6 +121,9 @@ public:
 
 private:
 	friend class _VariantCall;
+	friend class GDFunction; //typed operator fast paths
+	friend struct _VariantEvaluator;
+	friend class MethodBind; //ptrcall from Variant arguments
 	// Variant takes 20 bytes when real_t is float, and 36 if double
 	// it only allocates extra memory for aabb/matrix.
 
@@ -154,6 +157,20 @@ private:
 	void reference(const Variant &p_variant);
 	void clear();
 
+	//address of the stored value, laid out the way ptrcall() reads it
+	_FORCE_INLINE_ void *_get_native_ptr() const {
+
+		switch (type) {
+			case TRANSFORM2D: return _data._transform2d;
+			case RECT3: return _data._rect3;
+			case BASIS: return _data._basis;
+			case TRANSFORM: return _data._transform;
+			case IMAGE: return _data._image;
+			case INPUT_EVENT: return _data._input_event;
+			default: return const_cast<uint8_t *>(_data._mem);
+		}
+	}
+
 public:
 	_FORCE_INLINE_ Type get_type() const { return type; }
 	static String get_type_name(Variant::Type p_type);
@@ -344,8 +361,16 @@ public:
 
 	};
 
+	typedef void (*OperatorEvaluator)(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid);
+
 	static String get_operator_name(Operator p_op);
 	static void evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid);
+	static OperatorEvaluator get_operator_evaluator(Operator p_op, Type p_type_a, Type p_type_b);
+
+private:
+	static void _evaluate_generic(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid);
+
+public:
 	static _FORCE_INLINE_ Variant evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b) {
 
 		bool valid = true;
@@ -376,6 +401,15 @@ public:
 	Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, CallError &r_error);
 	Variant call(const StringName &p_method, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), const Variant &p_arg3 = Variant(), const Variant &p_arg4 = Variant(), const Variant &p_arg5 = Variant());
 
+	//resolve a builtin method once, then call it many times without the name lookup
+	struct BuiltinMethod;
+	static int get_builtin_method_id(Variant::Type p_type, const StringName &p_method);
+	static int get_builtin_method_count(Variant::Type p_type);
+	static const BuiltinMethod *get_builtin_method(Variant::Type p_type, int p_id);
+	static const BuiltinMethod *get_builtin_method(Variant::Type p_type, const StringName &p_method);
+	static Variant::Type get_builtin_method_base_type(const BuiltinMethod *p_method);
+	void call_builtin(const BuiltinMethod *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error);
+
 	static String get_call_error_text(Object *p_base, const StringName &p_method, const Variant **p_argptrs, int p_argcount, const Variant::CallError &ce);
 
 	static Variant construct(const Variant::Type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict = true);
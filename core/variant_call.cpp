@@ -30,6 +30,8 @@
 #include "variant.h"
 
 #include "core_string_names.h"
+#include "math/math_batch.h"
+#include "oa_hash_map.h"
 #include "object.h"
 #include "os/os.h"
 #include "script_language.h"
@@ -40,94 +42,126 @@ typedef void (*VariantConstructFunc)(Variant &r_ret, const Variant **p_args);
 VARIANT_ENUM_CAST(Image::CompressMode);
 //VARIANT_ENUM_CAST(Image::Format);
 
-struct _VariantCall {
-
-	static void Vector3_dot(Variant &r_ret, Variant &p_self, const Variant **p_args) {
-
-		r_ret = reinterpret_cast<Vector3 *>(p_self._data._mem)->dot(*reinterpret_cast<const Vector3 *>(p_args[0]->_data._mem));
-	}
+struct Variant::BuiltinMethod {
 
-	struct FuncData {
-
-		int arg_count;
-		Vector<Variant> default_args;
-		Vector<Variant::Type> arg_types;
-		Vector<StringName> arg_names;
-		Variant::Type return_type;
+	Variant::Type type; //type the method belongs to
+	int id; //index in the type method table, assigned after registration
+	int arg_count;
+	Vector<Variant> default_args;
+	Vector<Variant::Type> arg_types;
+	Vector<StringName> arg_names;
+	Variant::Type return_type;
 
 #ifdef DEBUG_ENABLED
-		bool returns;
+	bool returns;
 #endif
-		VariantFunc func;
+	VariantFunc func;
 
-		_FORCE_INLINE_ bool verify_arguments(const Variant **p_args, Variant::CallError &r_error) {
+	_FORCE_INLINE_ bool verify_arguments(const Variant **p_args, Variant::CallError &r_error) {
 
-			if (arg_count == 0)
-				return true;
+		if (arg_count == 0)
+			return true;
 
-			Variant::Type *tptr = &arg_types[0];
+		Variant::Type *tptr = &arg_types[0];
 
-			for (int i = 0; i < arg_count; i++) {
+		for (int i = 0; i < arg_count; i++) {
 
-				if (!tptr[i] || tptr[i] == p_args[i]->type)
-					continue; // all good
-				if (!Variant::can_convert(p_args[i]->type, tptr[i])) {
-					r_error.error = Variant::CallError::CALL_ERROR_INVALID_ARGUMENT;
-					r_error.argument = i;
-					r_error.expected = tptr[i];
-					return false;
-				}
+			if (!tptr[i] || tptr[i] == p_args[i]->type)
+				continue; // all good
+			if (!Variant::can_convert(p_args[i]->type, tptr[i])) {
+				r_error.error = Variant::CallError::CALL_ERROR_INVALID_ARGUMENT;
+				r_error.argument = i;
+				r_error.expected = tptr[i];
+				return false;
 			}
-			return true;
 		}
+		return true;
+	}
 
-		_FORCE_INLINE_ void call(Variant &r_ret, Variant &p_self, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+	_FORCE_INLINE_ void call(Variant &r_ret, Variant &p_self, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
 #ifdef DEBUG_ENABLED
-			if (p_argcount > arg_count) {
-				r_error.error = Variant::CallError::CALL_ERROR_TOO_MANY_ARGUMENTS;
-				r_error.argument = arg_count;
-				return;
-			} else
+		if (p_argcount > arg_count) {
+			r_error.error = Variant::CallError::CALL_ERROR_TOO_MANY_ARGUMENTS;
+			r_error.argument = arg_count;
+			return;
+		} else
 #endif
-					if (p_argcount < arg_count) {
-				int def_argcount = default_args.size();
+				if (p_argcount < arg_count) {
+			int def_argcount = default_args.size();
 #ifdef DEBUG_ENABLED
-				if (p_argcount < (arg_count - def_argcount)) {
-					r_error.error = Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
-					r_error.argument = arg_count - def_argcount;
-					return;
-				}
+			if (p_argcount < (arg_count - def_argcount)) {
+				r_error.error = Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
+				r_error.argument = arg_count - def_argcount;
+				return;
+			}
 
 #endif
-				ERR_FAIL_COND(p_argcount > VARIANT_ARG_MAX);
-				const Variant *newargs[VARIANT_ARG_MAX];
-				for (int i = 0; i < p_argcount; i++)
-					newargs[i] = p_args[i];
-				int defargcount = def_argcount;
-				for (int i = p_argcount; i < arg_count; i++)
-					newargs[i] = &default_args[defargcount - (i - p_argcount) - 1]; //default arguments
+			ERR_FAIL_COND(p_argcount > VARIANT_ARG_MAX);
+			const Variant *newargs[VARIANT_ARG_MAX];
+			for (int i = 0; i < p_argcount; i++)
+				newargs[i] = p_args[i];
+			int defargcount = def_argcount;
+			for (int i = p_argcount; i < arg_count; i++)
+				newargs[i] = &default_args[defargcount - (i - p_argcount) - 1]; //default arguments
 #ifdef DEBUG_ENABLED
-				if (!verify_arguments(newargs, r_error))
-					return;
+			if (!verify_arguments(newargs, r_error))
+				return;
 #endif
-				func(r_ret, p_self, newargs);
-			} else {
+			func(r_ret, p_self, newargs);
+		} else {
 #ifdef DEBUG_ENABLED
-				if (!verify_arguments(p_args, r_error))
-					return;
+			if (!verify_arguments(p_args, r_error))
+				return;
 #endif
-				func(r_ret, p_self, p_args);
-			}
+			func(r_ret, p_self, p_args);
 		}
-	};
+	}
+};
+
+struct _VariantCall {
+
+	static void Vector3_dot(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+
+		r_ret = reinterpret_cast<Vector3 *>(p_self._data._mem)->dot(*reinterpret_cast<const Vector3 *>(p_args[0]->_data._mem));
+	}
+
+	typedef Variant::BuiltinMethod FuncData;
 
 	struct TypeFunc {
 
 		Map<StringName, FuncData> functions;
+
+		//flattened once registration is done, so lookups don't walk the map
+		Vector<FuncData *> method_table;
+		OAHashMap<StringName, FuncData *, StringNameHasher> method_ptrs;
 	};
 
 	static TypeFunc *type_funcs;
 
+	static _FORCE_INLINE_ FuncData *get_func(Variant::Type p_type, const StringName &p_method) {
+
+		FuncData *const *fd = type_funcs[p_type].method_ptrs.getptr(p_method);
+		return fd ? *fd : NULL;
+	}
+
+	static void build_method_tables() {
+
+		for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+
+			TypeFunc &tf = type_funcs[i];
+			tf.method_table.resize(tf.functions.size());
+			tf.method_ptrs.reserve(tf.functions.size());
+
+			int idx = 0;
+			for (Map<StringName, FuncData>::Element *E = tf.functions.front(); E; E = E->next()) {
+
+				E->get().id = idx;
+				tf.method_table[idx++] = &E->get();
+				tf.method_ptrs.set(E->key(), &E->get());
+			}
+		}
+	}
+
 	struct Arg {
 		StringName name;
 		Variant::Type type;
@@ -150,6 +184,8 @@ struct _VariantCall {
 	static void addfunc(Variant::Type p_type, Variant::Type p_return, const StringName &p_name, VariantFunc p_func, const Vector<Variant> &p_defaultarg, const Arg &p_argtype1 = Arg(), const Arg &p_argtype2 = Arg(), const Arg &p_argtype3 = Arg(), const Arg &p_argtype4 = Arg(), const Arg &p_argtype5 = Arg()) {
 
 		FuncData funcdata;
+		funcdata.type = p_type;
+		funcdata.id = -1;
 		funcdata.func = p_func;
 		funcdata.default_args = p_defaultarg;
 #ifdef DEBUG_ENABLED
@@ -727,6 +763,19 @@ struct _VariantCall {
 			case Variant::VECTOR3: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform(p_args[0]->operator Vector3()); return;
 			case Variant::PLANE: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform(p_args[0]->operator Plane()); return;
 			case Variant::RECT3: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform(p_args[0]->operator Rect3()); return;
+			case Variant::POOL_VECTOR3_ARRAY: {
+
+				PoolVector<Vector3> src = p_args[0]->operator PoolVector<Vector3>();
+				PoolVector<Vector3> dst;
+				dst.resize(src.size());
+				{
+					PoolVector<Vector3>::Read r = src.read();
+					PoolVector<Vector3>::Write w = dst.write();
+					MathBatch::xform_points(*reinterpret_cast<Transform *>(p_self._data._ptr), r.ptr(), w.ptr(), src.size());
+				}
+				r_ret = dst;
+				return;
+			}
 			default: r_ret = Variant();
 		}
 	}
@@ -738,6 +787,24 @@ struct _VariantCall {
 			case Variant::VECTOR3: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform_inv(p_args[0]->operator Vector3()); return;
 			case Variant::PLANE: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform_inv(p_args[0]->operator Plane()); return;
 			case Variant::RECT3: r_ret = reinterpret_cast<Transform *>(p_self._data._ptr)->xform_inv(p_args[0]->operator Rect3()); return;
+			case Variant::POOL_VECTOR3_ARRAY: {
+
+				// xform_inv() uses the transposed basis, not a real inverse
+				const Transform *t = reinterpret_cast<Transform *>(p_self._data._ptr);
+				Basis inv_basis = t->basis.transposed();
+				Transform inv(inv_basis, inv_basis.xform(-t->origin));
+
+				PoolVector<Vector3> src = p_args[0]->operator PoolVector<Vector3>();
+				PoolVector<Vector3> dst;
+				dst.resize(src.size());
+				{
+					PoolVector<Vector3>::Read r = src.read();
+					PoolVector<Vector3>::Write w = dst.write();
+					MathBatch::xform_points(inv, r.ptr(), w.ptr(), src.size());
+				}
+				r_ret = dst;
+				return;
+			}
 			default: r_ret = Variant();
 		}
 	}
@@ -992,21 +1059,70 @@ void Variant::call_ptr(const StringName &p_method, const Variant **p_args, int p
 
 		r_error.error = Variant::CallError::CALL_OK;
 
-		Map<StringName, _VariantCall::FuncData>::Element *E = _VariantCall::type_funcs[type].functions.find(p_method);
+		_VariantCall::FuncData *funcdata = _VariantCall::get_func(type, p_method);
 #ifdef DEBUG_ENABLED
-		if (!E) {
+		if (!funcdata) {
 			r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 			return;
 		}
 #endif
-		_VariantCall::FuncData &funcdata = E->get();
-		funcdata.call(ret, *this, p_args, p_argcount, r_error);
+		funcdata->call(ret, *this, p_args, p_argcount, r_error);
 	}
 
 	if (r_error.error == Variant::CallError::CALL_OK && r_ret)
 		*r_ret = ret;
 }
 
+int Variant::get_builtin_method_id(Variant::Type p_type, const StringName &p_method) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, -1);
+	const _VariantCall::FuncData *funcdata = _VariantCall::get_func(p_type, p_method);
+	return funcdata ? funcdata->id : -1;
+}
+
+int Variant::get_builtin_method_count(Variant::Type p_type) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, 0);
+	return _VariantCall::type_funcs[p_type].method_table.size();
+}
+
+const Variant::BuiltinMethod *Variant::get_builtin_method(Variant::Type p_type, int p_id) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	const Vector<_VariantCall::FuncData *> &table = _VariantCall::type_funcs[p_type].method_table;
+	ERR_FAIL_INDEX_V(p_id, table.size(), NULL);
+	return table[p_id];
+}
+
+const Variant::BuiltinMethod *Variant::get_builtin_method(Variant::Type p_type, const StringName &p_method) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	return _VariantCall::get_func(p_type, p_method);
+}
+
+Variant::Type Variant::get_builtin_method_base_type(const BuiltinMethod *p_method) {
+
+	ERR_FAIL_COND_V(!p_method, NIL);
+	return p_method->type;
+}
+
+void Variant::call_builtin(const BuiltinMethod *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error) {
+
+	r_error.error = CallError::CALL_OK;
+
+	//the method works on the raw data of its own type, anything else would be misread
+	if (!p_method || p_method->type != type) {
+		r_error.error = CallError::CALL_ERROR_INVALID_METHOD;
+		return;
+	}
+
+	Variant ret;
+	const_cast<BuiltinMethod *>(p_method)->call(ret, *this, p_args, p_argcount, r_error);
+
+	if (r_error.error == CallError::CALL_OK && r_ret)
+		*r_ret = ret;
+}
+
 #define VCALL(m_type, m_method) _VariantCall::_call_##m_type##_##m_method
 
 Variant Variant::construct(const Variant::Type p_type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict) {
@@ -1170,55 +1286,46 @@ bool Variant::has_method(const StringName &p_method) const {
 #endif
 	}
 
-	const _VariantCall::TypeFunc &fd = _VariantCall::type_funcs[type];
-	return fd.functions.has(p_method);
+	return _VariantCall::get_func(type, p_method) != NULL;
 }
 
 Vector<Variant::Type> Variant::get_method_argument_types(Variant::Type p_type, const StringName &p_method) {
 
-	const _VariantCall::TypeFunc &fd = _VariantCall::type_funcs[p_type];
-
-	const Map<StringName, _VariantCall::FuncData>::Element *E = fd.functions.find(p_method);
+	const _VariantCall::FuncData *E = _VariantCall::get_func(p_type, p_method);
 	if (!E)
 		return Vector<Variant::Type>();
 
-	return E->get().arg_types;
+	return E->arg_types;
 }
 
 Vector<StringName> Variant::get_method_argument_names(Variant::Type p_type, const StringName &p_method) {
 
-	const _VariantCall::TypeFunc &fd = _VariantCall::type_funcs[p_type];
-
-	const Map<StringName, _VariantCall::FuncData>::Element *E = fd.functions.find(p_method);
+	const _VariantCall::FuncData *E = _VariantCall::get_func(p_type, p_method);
 	if (!E)
 		return Vector<StringName>();
 
-	return E->get().arg_names;
+	return E->arg_names;
 }
 
 Variant::Type Variant::get_method_return_type(Variant::Type p_type, const StringName &p_method, bool *r_has_return) {
 
-	const _VariantCall::TypeFunc &fd = _VariantCall::type_funcs[p_type];
-
-	const Map<StringName, _VariantCall::FuncData>::Element *E = fd.functions.find(p_method);
+	const _VariantCall::FuncData *E = _VariantCall::get_func(p_type, p_method);
 	if (!E)
 		return Variant::NIL;
 
 	if (r_has_return)
-		*r_has_return = E->get().return_type;
+		*r_has_return = E->return_type;
 
-	return E->get().return_type;
+	return E->return_type;
 }
 
 Vector<Variant> Variant::get_method_default_arguments(Variant::Type p_type, const StringName &p_method) {
 
-	const _VariantCall::TypeFunc &fd = _VariantCall::type_funcs[p_type];
-
-	const Map<StringName, _VariantCall::FuncData>::Element *E = fd.functions.find(p_method);
+	const _VariantCall::FuncData *E = _VariantCall::get_func(p_type, p_method);
 	if (!E)
 		return Vector<Variant>();
 
-	return E->get().default_args;
+	return E->default_args;
 }
 
 void Variant::get_method_list(List<MethodInfo> *p_list) const {
@@ -1820,6 +1927,8 @@ void register_variant_methods() {
 	_VariantCall::add_constant(Variant::IMAGE, "INTERPOLATE_NEAREST", Image::INTERPOLATE_NEAREST);
 	_VariantCall::add_constant(Variant::IMAGE, "INTERPOLATE_BILINEAR", Image::INTERPOLATE_BILINEAR);
 	_VariantCall::add_constant(Variant::IMAGE, "INTERPOLATE_CUBIC", Image::INTERPOLATE_CUBIC);
+
+	_VariantCall::build_method_tables();
 }
 
 void unregister_variant_methods() {
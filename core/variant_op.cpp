@@ -239,7 +239,7 @@ bool Variant::booleanize(bool &r_valid) const {
 		return;                 \
 	}
 
-void Variant::evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+void Variant::_evaluate_generic(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
 
 	r_valid = true;
 
@@ -974,6 +974,318 @@ void Variant::evaluate(const Operator &p_op, const Variant &p_a, const Variant &
 	r_valid = false;
 }
 
+/* Flat dispatch table for the hot operand pairs. Every (operator, type, type) triplet maps to
+ * a one byte index into a small array of specialized evaluators, so the whole table stays
+ * within a few cache lines per operator. Index 0 means no fast path and uses the generic switch. */
+
+struct _VariantEvaluator {
+
+	enum {
+		MAX_EVALUATORS = 256
+	};
+
+	static uint8_t index[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+	static Variant::OperatorEvaluator evaluators[MAX_EVALUATORS];
+	static int evaluator_count;
+
+	//types up to REAL own no memory, so the result can be overwritten in place
+	static _FORCE_INLINE_ void set(Variant &r_ret, bool p_value) {
+		if (r_ret.type <= Variant::REAL) {
+			r_ret.type = Variant::BOOL;
+			r_ret._data._bool = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	static _FORCE_INLINE_ void set(Variant &r_ret, int64_t p_value) {
+		if (r_ret.type <= Variant::REAL) {
+			r_ret.type = Variant::INT;
+			r_ret._data._int = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	static _FORCE_INLINE_ void set(Variant &r_ret, double p_value) {
+		if (r_ret.type <= Variant::REAL) {
+			r_ret.type = Variant::REAL;
+			r_ret._data._real = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	static _FORCE_INLINE_ void set(Variant &r_ret, const Vector2 &p_value) {
+		if (r_ret.type <= Variant::REAL || r_ret.type == Variant::VECTOR2) {
+			r_ret.type = Variant::VECTOR2;
+			*reinterpret_cast<Vector2 *>(r_ret._data._mem) = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	static _FORCE_INLINE_ void set(Variant &r_ret, const Vector3 &p_value) {
+		if (r_ret.type <= Variant::REAL || r_ret.type == Variant::VECTOR3) {
+			r_ret.type = Variant::VECTOR3;
+			*reinterpret_cast<Vector3 *>(r_ret._data._mem) = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	static _FORCE_INLINE_ void set(Variant &r_ret, const String &p_value) {
+		if (r_ret.type == Variant::STRING) {
+			*reinterpret_cast<String *>(r_ret._data._mem) = p_value;
+		} else {
+			r_ret = p_value;
+		}
+	}
+
+	//the pointer argument only selects the overload
+	static _FORCE_INLINE_ const bool &get(const Variant &p_value, const bool *) { return p_value._data._bool; }
+	static _FORCE_INLINE_ const int64_t &get(const Variant &p_value, const int64_t *) { return p_value._data._int; }
+	static _FORCE_INLINE_ const double &get(const Variant &p_value, const double *) { return p_value._data._real; }
+
+	template <class T>
+	static _FORCE_INLINE_ const T &get(const Variant &p_value, const T *) { return *reinterpret_cast<const T *>(p_value._data._mem); }
+
+#define EVALUATOR_OP(m_name, m_op)                                                       \
+	struct m_name {                                                                      \
+		template <class R, class A, class B>                                             \
+		static _FORCE_INLINE_ R eval(const A &p_a, const B &p_b) { return p_a m_op p_b; } \
+	};
+
+	EVALUATOR_OP(OpEqual, ==);
+	EVALUATOR_OP(OpNotEqual, !=);
+	EVALUATOR_OP(OpLess, <);
+	EVALUATOR_OP(OpLessEqual, <=);
+	EVALUATOR_OP(OpGreater, >);
+	EVALUATOR_OP(OpGreaterEqual, >=);
+	EVALUATOR_OP(OpAdd, +);
+	EVALUATOR_OP(OpSubstract, -);
+	EVALUATOR_OP(OpMultiply, *);
+	EVALUATOR_OP(OpDivide, /);
+	EVALUATOR_OP(OpShiftLeft, <<);
+	EVALUATOR_OP(OpShiftRight, >>);
+	EVALUATOR_OP(OpBitAnd, &);
+	EVALUATOR_OP(OpBitOr, |);
+	EVALUATOR_OP(OpBitXor, ^);
+
+#undef EVALUATOR_OP
+
+	struct OpNegate {
+		template <class R, class A>
+		static _FORCE_INLINE_ R eval(const A &p_a) { return -p_a; }
+	};
+
+	struct OpPositive {
+		template <class R, class A>
+		static _FORCE_INLINE_ R eval(const A &p_a) { return p_a; }
+	};
+
+	struct OpBitNegate {
+		template <class R, class A>
+		static _FORCE_INLINE_ R eval(const A &p_a) { return ~p_a; }
+	};
+
+	struct OpNot {
+		template <class R, class A>
+		static _FORCE_INLINE_ R eval(const A &p_a) { return !p_a; }
+	};
+
+	template <class R, class A, class B, class Op>
+	static void binary(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+		r_valid = true;
+		set(r_ret, Op::template eval<R, A, B>(get(p_a, (const A *)NULL), get(p_b, (const B *)NULL)));
+	}
+
+	template <class R, class A, class Op>
+	static void unary(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+		r_valid = true;
+		set(r_ret, Op::template eval<R, A>(get(p_a, (const A *)NULL)));
+	}
+
+	static void divide_int(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+		int64_t b = p_b._data._int;
+		if (b == 0) {
+			r_valid = false;
+			r_ret = "Division By Zero";
+			return;
+		}
+		r_valid = true;
+		set(r_ret, p_a._data._int / b);
+	}
+
+	static void module_int(const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+#ifdef DEBUG_ENABLED
+		if (p_b._data._int == 0) {
+			r_valid = false;
+			r_ret = "Division By Zero";
+			return;
+		}
+#endif
+		r_valid = true;
+		set(r_ret, p_a._data._int % p_b._data._int);
+	}
+
+	static void add(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b, Variant::OperatorEvaluator p_func) {
+
+		int idx = 0;
+		for (int i = 1; i < evaluator_count; i++) {
+			if (evaluators[i] == p_func) {
+				idx = i;
+				break;
+			}
+		}
+
+		if (!idx) {
+			ERR_FAIL_COND(evaluator_count >= MAX_EVALUATORS);
+			idx = evaluator_count++;
+			evaluators[idx] = p_func;
+		}
+
+		index[p_op][p_type_a][p_type_b] = idx;
+	}
+
+	static void add_unary(Variant::Operator p_op, Variant::Type p_type_a, Variant::OperatorEvaluator p_func) {
+
+		//the second operand of unary operators is ignored, so any type can be paired
+		for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+			add(p_op, p_type_a, Variant::Type(i), p_func);
+		}
+	}
+
+	template <class A, class B>
+	static void add_compare(Variant::Type p_type_a, Variant::Type p_type_b) {
+
+		add(Variant::OP_EQUAL, p_type_a, p_type_b, binary<bool, A, B, OpEqual>);
+		add(Variant::OP_NOT_EQUAL, p_type_a, p_type_b, binary<bool, A, B, OpNotEqual>);
+	}
+
+	template <class A, class B>
+	static void add_order(Variant::Type p_type_a, Variant::Type p_type_b) {
+
+		add(Variant::OP_LESS, p_type_a, p_type_b, binary<bool, A, B, OpLess>);
+		add(Variant::OP_LESS_EQUAL, p_type_a, p_type_b, binary<bool, A, B, OpLessEqual>);
+		add(Variant::OP_GREATER, p_type_a, p_type_b, binary<bool, A, B, OpGreater>);
+		add(Variant::OP_GREATER_EQUAL, p_type_a, p_type_b, binary<bool, A, B, OpGreaterEqual>);
+	}
+
+	template <class R, class A, class B>
+	static void add_arithmetic(Variant::Type p_type_a, Variant::Type p_type_b) {
+
+		add(Variant::OP_ADD, p_type_a, p_type_b, binary<R, A, B, OpAdd>);
+		add(Variant::OP_SUBSTRACT, p_type_a, p_type_b, binary<R, A, B, OpSubstract>);
+		add(Variant::OP_MULTIPLY, p_type_a, p_type_b, binary<R, A, B, OpMultiply>);
+	}
+
+	static void register_evaluators() {
+
+		evaluator_count = 1; //0 is the generic switch
+
+		//numbers
+		add_compare<int64_t, int64_t>(Variant::INT, Variant::INT);
+		add_compare<int64_t, double>(Variant::INT, Variant::REAL);
+		add_compare<double, int64_t>(Variant::REAL, Variant::INT);
+		add_compare<double, double>(Variant::REAL, Variant::REAL);
+
+		add_order<int64_t, int64_t>(Variant::INT, Variant::INT);
+		add_order<int64_t, double>(Variant::INT, Variant::REAL);
+		add_order<double, int64_t>(Variant::REAL, Variant::INT);
+		add_order<double, double>(Variant::REAL, Variant::REAL);
+
+		add_arithmetic<int64_t, int64_t, int64_t>(Variant::INT, Variant::INT);
+		add_arithmetic<double, int64_t, double>(Variant::INT, Variant::REAL);
+		add_arithmetic<double, double, int64_t>(Variant::REAL, Variant::INT);
+		add_arithmetic<double, double, double>(Variant::REAL, Variant::REAL);
+
+		add(Variant::OP_DIVIDE, Variant::INT, Variant::INT, divide_int);
+		add(Variant::OP_DIVIDE, Variant::INT, Variant::REAL, binary<double, int64_t, double, OpDivide>);
+		add(Variant::OP_DIVIDE, Variant::REAL, Variant::INT, binary<double, double, int64_t, OpDivide>);
+		add(Variant::OP_DIVIDE, Variant::REAL, Variant::REAL, binary<double, double, double, OpDivide>);
+		add(Variant::OP_MODULE, Variant::INT, Variant::INT, module_int);
+
+		add(Variant::OP_SHIFT_LEFT, Variant::INT, Variant::INT, binary<int64_t, int64_t, int64_t, OpShiftLeft>);
+		add(Variant::OP_SHIFT_RIGHT, Variant::INT, Variant::INT, binary<int64_t, int64_t, int64_t, OpShiftRight>);
+		add(Variant::OP_BIT_AND, Variant::INT, Variant::INT, binary<int64_t, int64_t, int64_t, OpBitAnd>);
+		add(Variant::OP_BIT_OR, Variant::INT, Variant::INT, binary<int64_t, int64_t, int64_t, OpBitOr>);
+		add(Variant::OP_BIT_XOR, Variant::INT, Variant::INT, binary<int64_t, int64_t, int64_t, OpBitXor>);
+
+		add_unary(Variant::OP_NEGATE, Variant::INT, unary<int64_t, int64_t, OpNegate>);
+		add_unary(Variant::OP_NEGATE, Variant::REAL, unary<double, double, OpNegate>);
+		add_unary(Variant::OP_POSITIVE, Variant::INT, unary<int64_t, int64_t, OpPositive>);
+		add_unary(Variant::OP_POSITIVE, Variant::REAL, unary<double, double, OpPositive>);
+		add_unary(Variant::OP_BIT_NEGATE, Variant::INT, unary<int64_t, int64_t, OpBitNegate>);
+
+		add_compare<bool, bool>(Variant::BOOL, Variant::BOOL);
+		add_unary(Variant::OP_NOT, Variant::BOOL, unary<bool, bool, OpNot>);
+
+		//vectors
+		add_compare<Vector2, Vector2>(Variant::VECTOR2, Variant::VECTOR2);
+		add_arithmetic<Vector2, Vector2, Vector2>(Variant::VECTOR2, Variant::VECTOR2);
+		add(Variant::OP_DIVIDE, Variant::VECTOR2, Variant::VECTOR2, binary<Vector2, Vector2, Vector2, OpDivide>);
+		add(Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::INT, binary<Vector2, Vector2, int64_t, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::VECTOR2, Variant::REAL, binary<Vector2, Vector2, double, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::INT, Variant::VECTOR2, binary<Vector2, int64_t, Vector2, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::REAL, Variant::VECTOR2, binary<Vector2, double, Vector2, OpMultiply>);
+		add(Variant::OP_DIVIDE, Variant::VECTOR2, Variant::INT, binary<Vector2, Vector2, int64_t, OpDivide>);
+		add(Variant::OP_DIVIDE, Variant::VECTOR2, Variant::REAL, binary<Vector2, Vector2, double, OpDivide>);
+		add_unary(Variant::OP_NEGATE, Variant::VECTOR2, unary<Vector2, Vector2, OpNegate>);
+
+		add_compare<Vector3, Vector3>(Variant::VECTOR3, Variant::VECTOR3);
+		add_arithmetic<Vector3, Vector3, Vector3>(Variant::VECTOR3, Variant::VECTOR3);
+		add(Variant::OP_DIVIDE, Variant::VECTOR3, Variant::VECTOR3, binary<Vector3, Vector3, Vector3, OpDivide>);
+		add(Variant::OP_MULTIPLY, Variant::VECTOR3, Variant::INT, binary<Vector3, Vector3, int64_t, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::VECTOR3, Variant::REAL, binary<Vector3, Vector3, double, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::INT, Variant::VECTOR3, binary<Vector3, int64_t, Vector3, OpMultiply>);
+		add(Variant::OP_MULTIPLY, Variant::REAL, Variant::VECTOR3, binary<Vector3, double, Vector3, OpMultiply>);
+		add(Variant::OP_DIVIDE, Variant::VECTOR3, Variant::INT, binary<Vector3, Vector3, int64_t, OpDivide>);
+		add(Variant::OP_DIVIDE, Variant::VECTOR3, Variant::REAL, binary<Vector3, Vector3, double, OpDivide>);
+		add_unary(Variant::OP_NEGATE, Variant::VECTOR3, unary<Vector3, Vector3, OpNegate>);
+
+		//strings
+		add_compare<String, String>(Variant::STRING, Variant::STRING);
+		add(Variant::OP_ADD, Variant::STRING, Variant::STRING, binary<String, String, String, OpAdd>);
+	}
+};
+
+uint8_t _VariantEvaluator::index[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+Variant::OperatorEvaluator _VariantEvaluator::evaluators[_VariantEvaluator::MAX_EVALUATORS];
+int _VariantEvaluator::evaluator_count = 0;
+
+void Variant::evaluate(const Operator &p_op, const Variant &p_a, const Variant &p_b, Variant &r_ret, bool &r_valid) {
+
+	if ((unsigned int)p_op < OP_MAX) {
+		int idx = _VariantEvaluator::index[p_op][p_a.type][p_b.type];
+		if (idx) {
+			_VariantEvaluator::evaluators[idx](p_a, p_b, r_ret, r_valid);
+			return;
+		}
+	}
+
+	_evaluate_generic(p_op, p_a, p_b, r_ret, r_valid);
+}
+
+Variant::OperatorEvaluator Variant::get_operator_evaluator(Operator p_op, Type p_type_a, Type p_type_b) {
+
+	ERR_FAIL_INDEX_V(p_op, OP_MAX, NULL);
+	ERR_FAIL_INDEX_V(p_type_a, VARIANT_MAX, NULL);
+	ERR_FAIL_INDEX_V(p_type_b, VARIANT_MAX, NULL);
+
+	int idx = _VariantEvaluator::index[p_op][p_type_a][p_type_b];
+	return idx ? _VariantEvaluator::evaluators[idx] : NULL;
+}
+
+void register_variant_operators() {
+
+	_VariantEvaluator::register_evaluators();
+}
+
 void Variant::set_named(const StringName &p_index, const Variant &p_value, bool *r_valid) {
 
 	if (type == OBJECT) {
@@ -1036,7 +1036,7 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 						state.canvas_shader.set_uniform(CanvasShaderGLES3::EXTRA_MATRIX, Transform2D());
 					}
 
-					glBindBufferBase(GL_UNIFORM_BUFFER, 1, static_cast<LightInternal *>(light->light_internal.get_data())->ubo);
+					glBindBufferBase(GL_UNIFORM_BUFFER, 1, light_internal_owner.getptr(light->light_internal)->ubo);
 
 					if (has_shadow) {
 
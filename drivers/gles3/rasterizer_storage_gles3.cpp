@@ -29,6 +29,7 @@
 /*************************************************************************/
 #include "rasterizer_storage_gles3.h"
 #include "global_config.h"
+#include "math_batch.h"
 #include "rasterizer_canvas_gles3.h"
 #include "rasterizer_scene_gles3.h"
 
@@ -3747,30 +3748,7 @@ void RasterizerStorageGLES3::update_dirty_multimeshes() {
 				}
 			} else {
 
-				for (int i = 0; i < count; i += stride) {
-
-					float *dataptr = &data[i];
-					Transform xform;
-
-					xform.basis.elements[0][0] = dataptr[0];
-					xform.basis.elements[0][1] = dataptr[1];
-					xform.basis.elements[0][2] = dataptr[2];
-					xform.origin.x = dataptr[3];
-					xform.basis.elements[1][0] = dataptr[4];
-					xform.basis.elements[1][1] = dataptr[5];
-					xform.basis.elements[1][2] = dataptr[6];
-					xform.origin.y = dataptr[7];
-					xform.basis.elements[2][0] = dataptr[8];
-					xform.basis.elements[2][1] = dataptr[9];
-					xform.basis.elements[2][2] = dataptr[10];
-					xform.origin.z = dataptr[11];
-
-					Rect3 laabb = xform.xform(mesh_aabb);
-					if (i == 0)
-						aabb = laabb;
-					else
-						aabb.merge_with(laabb);
-				}
+				aabb = MathBatch::merge_xformed_aabb(mesh_aabb, data, stride, count / stride);
 			}
 
 			multimesh->aabb = aabb;
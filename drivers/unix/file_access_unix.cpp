@@ -40,6 +40,10 @@
 #include <sys/statvfs.h>
 #endif
 
+#ifdef UNIX_ENABLED
+#include <sys/mman.h>
+#endif
+
 #ifdef MSVC
 #define S_ISREG(m) ((m)&_S_IFREG)
 #endif
@@ -59,6 +63,13 @@ void FileAccessUnix::check_errors() const {
 
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 
+#ifdef UNIX_ENABLED
+	if (mapped) {
+		munmap(mapped, mapped_len);
+		mapped = NULL;
+		mapped_len = 0;
+	}
+#endif
 	if (f)
 		fclose(f);
 	f = NULL;
@@ -112,6 +123,13 @@ void FileAccessUnix::close() {
 
 	if (!f)
 		return;
+#ifdef UNIX_ENABLED
+	if (mapped) {
+		munmap(mapped, mapped_len);
+		mapped = NULL;
+		mapped_len = 0;
+	}
+#endif
 	fclose(f);
 	f = NULL;
 	if (close_notification_func) {
@@ -243,10 +261,38 @@ FileAccess *FileAccessUnix::create_libc() {
 
 CloseNotificationFunc FileAccessUnix::close_notification_func = NULL;
 
+bool FileAccessUnix::map_memory() {
+
+#ifdef UNIX_ENABLED
+	ERR_FAIL_COND_V(!f, false);
+
+	if (mapped)
+		return true;
+	if (flags != READ)
+		return false;
+
+	size_t len = get_len();
+	if (len == 0)
+		return false;
+
+	void *data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (data == MAP_FAILED)
+		return false;
+
+	mapped = (uint8_t *)data;
+	mapped_len = len;
+	return true;
+#else
+	return false;
+#endif
+}
+
 FileAccessUnix::FileAccessUnix() {
 
 	f = NULL;
 	flags = 0;
+	mapped = NULL;
+	mapped_len = 0;
 	last_error = OK;
 }
 FileAccessUnix::~FileAccessUnix() {
@@ -46,6 +46,8 @@ class FileAccessUnix : public FileAccess {
 
 	FILE *f;
 	int flags;
+	uint8_t *mapped;
+	size_t mapped_len;
 	void check_errors() const;
 	mutable Error last_error;
 	String save_path;
@@ -70,6 +72,9 @@ public:
 	virtual uint8_t get_8() const; ///< get a byte
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
 
+	virtual bool map_memory();
+	virtual const uint8_t *get_mapped_data() const { return mapped; }
+
 	virtual Error get_error() const; ///< get last error
 
 	virtual void store_8(uint8_t p_dest); ///< store a byte
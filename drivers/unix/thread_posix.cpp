@@ -36,6 +36,8 @@
 #include <pthread_np.h>
 #endif
 
+#include "command_queue_mt.h"
+#include "dvector.h"
 #include "os/memory.h"
 
 Thread::ID ThreadPosix::get_ID() const {
@@ -58,6 +60,9 @@ void *ThreadPosix::thread_callback(void *userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	CommandQueueMT::thread_exit();
+	MemoryPool::thread_exit();
+	Memory::thread_exit();
 
 	return NULL;
 }
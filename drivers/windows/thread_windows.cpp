@@ -31,6 +31,8 @@
 
 #if defined(WINDOWS_ENABLED) && !defined(UWP_ENABLED)
 
+#include "command_queue_mt.h"
+#include "dvector.h"
 #include "os/memory.h"
 
 Thread::ID ThreadWindows::get_ID() const {
@@ -53,6 +55,9 @@ DWORD ThreadWindows::thread_callback(LPVOID userdata) {
 	t->callback(t->user);
 
 	ScriptServer::thread_exit();
+	CommandQueueMT::thread_exit();
+	MemoryPool::thread_exit();
+	Memory::thread_exit();
 
 	return 0;
 }
@@ -1211,7 +1211,7 @@ void EditorNode::_dialog_action(String p_file) {
 		case RESOURCE_SAVE:
 		case RESOURCE_SAVE_AS: {
 
-			uint32_t current = editor_history.get_current();
+			ObjectID current = editor_history.get_current();
 			Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 			ERR_FAIL_COND(!current_obj->cast_to<Resource>())
@@ -1301,7 +1301,7 @@ void EditorNode::push_item(Object *p_object, const String &p_property) {
 		return;
 	}
 
-	uint32_t id = p_object->get_instance_ID();
+	ObjectID id = p_object->get_instance_ID();
 	if (id != editor_history.get_current()) {
 
 		if (p_property == "")
@@ -1419,7 +1419,7 @@ void EditorNode::_set_editing_top_editors(Object *p_current_object) {
 
 void EditorNode::_edit_current() {
 
-	uint32_t current = editor_history.get_current();
+	ObjectID current = editor_history.get_current();
 	Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 	property_back->set_disabled(editor_history.is_at_begining());
@@ -2236,7 +2236,7 @@ void EditorNode::_menu_option_confirm(int p_option, bool p_confirmed) {
 		} break;
 		case RESOURCE_SAVE: {
 
-			uint32_t current = editor_history.get_current();
+			ObjectID current = editor_history.get_current();
 			Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 			ERR_FAIL_COND(!current_obj->cast_to<Resource>())
@@ -2248,7 +2248,7 @@ void EditorNode::_menu_option_confirm(int p_option, bool p_confirmed) {
 		} break;
 		case RESOURCE_SAVE_AS: {
 
-			uint32_t current = editor_history.get_current();
+			ObjectID current = editor_history.get_current();
 			Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 			ERR_FAIL_COND(!current_obj->cast_to<Resource>())
@@ -2260,7 +2260,7 @@ void EditorNode::_menu_option_confirm(int p_option, bool p_confirmed) {
 		} break;
 		case RESOURCE_UNREF: {
 
-			uint32_t current = editor_history.get_current();
+			ObjectID current = editor_history.get_current();
 			Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 			ERR_FAIL_COND(!current_obj->cast_to<Resource>())
@@ -2271,7 +2271,7 @@ void EditorNode::_menu_option_confirm(int p_option, bool p_confirmed) {
 		} break;
 		case RESOURCE_COPY: {
 
-			uint32_t current = editor_history.get_current();
+			ObjectID current = editor_history.get_current();
 			Object *current_obj = current > 0 ? ObjectDB::get_instance(current) : NULL;
 
 			ERR_FAIL_COND(!current_obj->cast_to<Resource>())
@@ -1680,6 +1680,9 @@ void Main::cleanup() {
 		memdelete(audio_server);
 	}
 
+	//workers may hold scene resources, stop them before those types go away
+	ResourceLoader::finalize_threaded_loading();
+
 #ifdef TOOLS_ENABLED
 	EditorNode::unregister_editor_types();
 #endif
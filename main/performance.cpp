@@ -30,6 +30,7 @@
 #include "performance.h"
 #include "message_queue.h"
 #include "os/os.h"
+#include "os/small_allocator.h"
 #include "scene/main/scene_main_loop.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
@@ -39,6 +40,8 @@ Performance *Performance::singleton = NULL;
 void Performance::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_monitor", "monitor"), &Performance::get_monitor);
+	ClassDB::bind_method(D_METHOD("get_memory_size_class_stats"), &Performance::get_memory_size_class_stats);
+	ClassDB::bind_method(D_METHOD("get_process_group_stats"), &Performance::get_process_group_stats);
 
 	BIND_CONSTANT(TIME_FPS);
 	BIND_CONSTANT(TIME_PROCESS);
@@ -67,6 +70,8 @@ void Performance::_bind_methods() {
 	BIND_CONSTANT(PHYSICS_3D_ACTIVE_OBJECTS);
 	BIND_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
+	BIND_CONSTANT(MEMORY_SMALL_ALLOC_USED);
+	BIND_CONSTANT(MEMORY_SMALL_ALLOC_RESERVED);
 
 	BIND_CONSTANT(MONITOR_MAX);
 }
@@ -103,6 +108,8 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/active_objects",
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
+		"memory/small_alloc_used",
+		"memory/small_alloc_reserved",
 
 	};
 
@@ -148,6 +155,21 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_ACTIVE_OBJECTS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ACTIVE_OBJECTS);
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
+		case MEMORY_SMALL_ALLOC_USED:
+		case MEMORY_SMALL_ALLOC_RESERVED: {
+
+			uint64_t total = 0;
+			for (int i = 0; i < SmallAllocator::CLASS_COUNT; i++) {
+
+				SmallAllocator::ClassStats stats;
+				SmallAllocator::get_class_stats(i, stats);
+				if (p_monitor == MEMORY_SMALL_ALLOC_USED)
+					total += (stats.allocs - stats.frees) * stats.block_size;
+				else
+					total += stats.reserved;
+			}
+			return total;
+		};
 
 		default: {}
 	}
@@ -155,6 +177,42 @@ float Performance::get_monitor(Monitor p_monitor) const {
 	return 0;
 }
 
+Array Performance::get_memory_size_class_stats() const {
+
+	Array ret;
+
+	if (!SmallAllocator::is_enabled())
+		return ret;
+
+	for (int i = 0; i < SmallAllocator::CLASS_COUNT; i++) {
+
+		SmallAllocator::ClassStats stats;
+		SmallAllocator::get_class_stats(i, stats);
+
+		Dictionary d;
+		d["size"] = int(stats.block_size);
+		d["allocs"] = stats.allocs;
+		d["frees"] = stats.frees;
+		d["remote_frees"] = stats.remote_frees;
+		d["used"] = stats.allocs - stats.frees;
+		d["reserved"] = stats.reserved;
+		ret.push_back(d);
+	}
+
+	return ret;
+}
+
+Array Performance::get_process_group_stats() const {
+
+	MainLoop *ml = OS::get_singleton()->get_main_loop();
+	if (!ml)
+		return Array();
+	SceneTree *sml = ml->cast_to<SceneTree>();
+	if (!sml)
+		return Array();
+	return sml->get_process_group_stats();
+}
+
 void Performance::set_process_time(float p_pt) {
 
 	_process_time = p_pt;
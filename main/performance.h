@@ -75,12 +75,16 @@ public:
 		PHYSICS_3D_ACTIVE_OBJECTS,
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
+		MEMORY_SMALL_ALLOC_USED,
+		MEMORY_SMALL_ALLOC_RESERVED,
 		//physics
 		MONITOR_MAX
 	};
 
 	float get_monitor(Monitor p_monitor) const;
 	String get_monitor_name(Monitor p_monitor) const;
+	Array get_memory_size_class_stats() const;
+	Array get_process_group_stats() const;
 
 	void set_process_time(float p_pt);
 	void set_fixed_process_time(float p_pt);
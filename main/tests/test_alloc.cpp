@@ -0,0 +1,364 @@
+/*************************************************************************/
+/*  test_alloc.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_alloc.h"
+
+#include "dictionary.h"
+#include "dvector.h"
+#include "os/os.h"
+#include "os/small_allocator.h"
+#include "os/thread.h"
+#include "print_string.h"
+#include "scene/3d/spatial.h"
+#include "scene/resources/packed_scene.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/*
+ * Allocation heavy workloads: raw small blocks on one thread and handed
+ * between threads, Dictionary churn, GDScript dictionaries and packed scene
+ * instancing. Times are printed for whichever allocator the engine was built
+ * with (small_alloc=yes/no), followed by the size class statistics.
+ */
+
+namespace TestAlloc {
+
+enum {
+	RAW_BLOCKS = 4096,
+	RAW_ROUNDS = 256,
+	CROSS_BLOCKS = 262144,
+	POOL_LIVE_ARRAYS = 100000, //more than the old fixed table could hold
+	POOL_THREAD_ROUNDS = 100000
+};
+
+static uint64_t _ticks() {
+
+	return OS::get_singleton()->get_ticks_usec();
+}
+
+static void _report(const String &p_name, uint64_t p_ops, uint64_t p_usec) {
+
+	double rate = double(p_ops) / double(MAX(p_usec, (uint64_t)1));
+	print_line(p_name + ": " + rtos(p_usec / 1000.0) + " ms, " + rtos(rate) + " M ops/s");
+}
+
+static void _test_raw() {
+
+	void **blocks = (void **)memalloc(sizeof(void *) * RAW_BLOCKS);
+	uint32_t seed = 1;
+
+	uint64_t from = _ticks();
+
+	for (int r = 0; r < RAW_ROUNDS; r++) {
+
+		for (int i = 0; i < RAW_BLOCKS; i++) {
+			seed = seed * 1103515245 + 12345;
+			blocks[i] = memalloc(8 + ((seed >> 16) % 200));
+		}
+
+		//free in a different order than allocated
+		for (int i = 0; i < RAW_BLOCKS; i++) {
+			int idx = (i * 7919) % RAW_BLOCKS;
+			memfree(blocks[idx]);
+		}
+	}
+
+	_report("raw alloc/free", uint64_t(RAW_BLOCKS) * RAW_ROUNDS * 2, _ticks() - from);
+
+	memfree(blocks);
+}
+
+struct CrossThreadData {
+
+	void **blocks;
+	int count;
+};
+
+static void _cross_free(void *p_data) {
+
+	CrossThreadData *cd = (CrossThreadData *)p_data;
+	for (int i = 0; i < cd->count; i++) {
+		memfree(cd->blocks[i]);
+	}
+}
+
+static void _test_cross_thread() {
+
+	CrossThreadData cd;
+	cd.count = CROSS_BLOCKS;
+	cd.blocks = (void **)memalloc(sizeof(void *) * CROSS_BLOCKS);
+
+	uint64_t from = _ticks();
+
+	for (int i = 0; i < CROSS_BLOCKS; i++) {
+		cd.blocks[i] = memalloc(16 + (i & 63));
+	}
+
+	//blocks are freed on another thread, then this thread allocates again and must get them back
+	Thread *thread = Thread::create(_cross_free, &cd);
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+
+	for (int i = 0; i < CROSS_BLOCKS; i++) {
+		cd.blocks[i] = memalloc(16 + (i & 63));
+	}
+	for (int i = 0; i < CROSS_BLOCKS; i++) {
+		memfree(cd.blocks[i]);
+	}
+
+	_report("cross thread free", uint64_t(CROSS_BLOCKS) * 4, _ticks() - from);
+
+	memfree(cd.blocks);
+}
+
+static void _test_dictionary() {
+
+	const int rounds = 2000;
+	const int keys = 64;
+
+	Vector<String> names;
+	for (int i = 0; i < keys; i++) {
+		names.push_back("key_" + itos(i));
+	}
+
+	uint64_t from = _ticks();
+	int total = 0;
+
+	for (int r = 0; r < rounds; r++) {
+
+		Dictionary d;
+		for (int i = 0; i < keys; i++) {
+			d[names[i]] = i + r;
+		}
+
+		Dictionary copy = d.copy();
+		for (int i = 0; i < keys; i += 2) {
+			copy.erase(names[i]);
+		}
+
+		Array values = copy.values();
+		total += values.size();
+	}
+
+	_report("dictionary churn (" + itos(total) + " values)", uint64_t(rounds) * keys * 3, _ticks() - from);
+}
+
+static void _test_gdscript_dictionary() {
+
+#ifdef GDSCRIPT_ENABLED
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(
+			"static func run(n):\n"
+			"\tvar total = 0\n"
+			"\tfor i in range(n):\n"
+			"\t\tvar d = { \"name\": \"item\", \"id\": i, \"pos\": Vector2(i, i), \"tags\": [ \"a\", \"b\" ] }\n"
+			"\t\td[\"score\"] = i * 2\n"
+			"\t\ttotal += d.size()\n"
+			"\treturn total\n");
+
+	if (script->reload() != OK) {
+		print_line("gdscript dictionaries: compile error");
+		return;
+	}
+
+	const int n = 100000;
+	Variant arg = n;
+	const Variant *args[1] = { &arg };
+	Variant::CallError ce;
+
+	uint64_t from = _ticks();
+	Variant result = static_cast<Object *>(script.ptr())->call("run", args, 1, ce);
+	_report("gdscript dictionaries (" + String(result) + ")", n, _ticks() - from);
+#endif
+}
+
+static void _test_scene_instancing() {
+
+	const int children = 64;
+	const int instances = 200;
+
+	Node *root = memnew(Node);
+	root->set_name("root");
+
+	for (int i = 0; i < children; i++) {
+
+		Spatial *s = memnew(Spatial);
+		s->set_name("child" + itos(i));
+		s->set_translation(Vector3(i, 0, 0));
+		root->add_child(s);
+		s->set_owner(root);
+
+		Node *leaf = memnew(Node);
+		leaf->set_name("leaf");
+		s->add_child(leaf);
+		leaf->set_owner(root);
+	}
+
+	Ref<PackedScene> scene;
+	scene.instance();
+	Error err = scene->pack(root);
+	memdelete(root);
+
+	if (err != OK) {
+		print_line("scene instancing: pack failed");
+		return;
+	}
+
+	uint64_t from = _ticks();
+
+	for (int i = 0; i < instances; i++) {
+
+		Node *instance = scene->instance();
+		ERR_FAIL_COND(!instance);
+		memdelete(instance);
+	}
+
+	_report("scene instancing (" + itos(children * 2 + 1) + " nodes)", uint64_t(instances), _ticks() - from);
+}
+
+static bool _test_pool_vector_slices() {
+
+	PoolVector<int> array;
+	array.resize(100);
+	{
+		PoolVector<int>::Write w = array.write();
+		for (int i = 0; i < 100; i++) {
+			w[i] = i;
+		}
+	}
+
+	PoolVector<int> slice = array.slice(10, 20);
+	PoolVector<int> inner = slice.slice(5, 5);
+	PoolVector<int> sub = array.subarray(90, 99);
+
+	if (slice.size() != 20 || !slice.is_slice() || slice[0] != 10 || slice[19] != 29)
+		return false;
+	if (inner.size() != 5 || inner[0] != 15 || sub.size() != 10 || sub[9] != 99)
+		return false;
+	if (slice.read().ptr() != array.read().ptr() + 10)
+		return false; //must share memory
+
+	//writing to the source detaches it, slices keep the old contents
+	array.set(10, -1);
+	if (slice[0] != 10 || array[10] != -1)
+		return false;
+
+	//writing to a slice copies it
+	slice.set(0, -2);
+	if (slice.is_slice() || slice[0] != -2 || inner[0] != 15)
+		return false;
+
+	array = PoolVector<int>();
+	slice = PoolVector<int>();
+	return inner[4] == 19 && sub[0] == 90;
+}
+
+static void _pool_vector_churn(void *p_data) {
+
+	int *total = (int *)p_data;
+
+	for (int i = 0; i < POOL_THREAD_ROUNDS; i++) {
+
+		PoolVector<uint8_t> a;
+		a.resize(16 + (i & 63));
+		PoolVector<uint8_t> b = a;
+		b.set(0, i & 0xFF); //copy on write
+		*total += b.size() - a.size();
+	}
+}
+
+static void _test_pool_vector() {
+
+	uint32_t used_before = MemoryPool::allocs_used;
+
+	print_line("pool vector slices: " + String(_test_pool_vector_slices() ? "ok" : "FAILED"));
+
+	uint64_t from = _ticks();
+
+	{
+		Vector<PoolVector<float> > live;
+		live.resize(POOL_LIVE_ARRAYS);
+		for (int i = 0; i < POOL_LIVE_ARRAYS; i++) {
+			live[i].resize(4);
+		}
+		print_line("pool vector live arrays: " + itos(MemoryPool::allocs_used - used_before) + " of " + itos(MemoryPool::alloc_count) + " allocs");
+	}
+
+	_report("pool vector live arrays", POOL_LIVE_ARRAYS * 2, _ticks() - from);
+
+	int totals[2] = { 0, 0 };
+
+	from = _ticks();
+
+	Thread *thread = Thread::create(_pool_vector_churn, &totals[1]);
+	_pool_vector_churn(&totals[0]);
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+
+	_report("pool vector copy on write, 2 threads", uint64_t(POOL_THREAD_ROUNDS) * 2 * 3, _ticks() - from);
+
+	if (MemoryPool::allocs_used != used_before) {
+		print_line("pool vector leaked " + itos(MemoryPool::allocs_used - used_before) + " allocs");
+	}
+}
+
+static void _print_stats() {
+
+	if (!SmallAllocator::is_enabled()) {
+		print_line("small_alloc disabled, all allocations went to malloc");
+		return;
+	}
+
+	for (int i = 0; i < SmallAllocator::CLASS_COUNT; i++) {
+
+		SmallAllocator::ClassStats stats;
+		SmallAllocator::get_class_stats(i, stats);
+		print_line("\tclass " + itos(stats.block_size) + ": allocs " + itos(stats.allocs) + " frees " + itos(stats.frees) + " (remote " + itos(stats.remote_frees) + ") reserved " + itos(stats.reserved / 1024) + "KB");
+	}
+}
+
+MainLoop *test() {
+
+	print_line("small_alloc: " + String(SmallAllocator::is_enabled() ? "enabled" : "disabled"));
+
+	_test_raw();
+	_test_cross_thread();
+	_test_dictionary();
+	_test_gdscript_dictionary();
+	_test_scene_instancing();
+	_test_pool_vector();
+	_print_stats();
+
+	return NULL;
+}
+}
@@ -0,0 +1,142 @@
+/*************************************************************************/
+/*  test_broadphase.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_broadphase.h"
+
+#include "dynamic_bvh.h"
+#include "math_funcs.h"
+#include "octree.h"
+#include "os/os.h"
+#include "print_string.h"
+
+/*
+ * Compares Octree and DynamicBVH for the broadphase workload: every object
+ * moves a little every frame, most of them are pairable (like rigid bodies),
+ * and pairs are reported through the pair/unpair callbacks.
+ */
+
+namespace TestBroadphase {
+
+struct BenchObject {
+
+	Vector3 pos;
+	Vector3 vel;
+	OctreeElementID id;
+};
+
+static int pairs_added = 0;
+static int pairs_removed = 0;
+
+static void *_pair(void *, OctreeElementID, BenchObject *, int, OctreeElementID, BenchObject *, int) {
+
+	pairs_added++;
+	return NULL;
+}
+
+static void _unpair(void *, OctreeElementID, BenchObject *, int, OctreeElementID, BenchObject *, int, void *) {
+
+	pairs_removed++;
+}
+
+template <class S>
+static void _bench(const String &p_name, int p_count, int p_frames) {
+
+	static const float world_size = 400.0;
+	static const Vector3 half_extents(0.5, 0.5, 0.5);
+
+	S structure;
+	structure.set_pair_callback(_pair, NULL);
+	structure.set_unpair_callback(_unpair, NULL);
+
+	BenchObject *objects = memnew_arr(BenchObject, p_count);
+
+	Math::seed(1234);
+	pairs_added = 0;
+	pairs_removed = 0;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_count; i++) {
+
+		BenchObject &o = objects[i];
+		o.pos = Vector3(Math::randf(), Math::randf(), Math::randf()) * world_size;
+		o.vel = Vector3(Math::randf() - 0.5, Math::randf() - 0.5, Math::randf() - 0.5) * 0.5;
+		bool pairable = (i % 8) != 0; // a few static ones
+		o.id = structure.create(&o, Rect3(o.pos - half_extents, half_extents * 2), 0, pairable, 1, pairable ? 0xFFFFF : 0);
+	}
+
+	uint64_t created = OS::get_singleton()->get_ticks_usec();
+
+	for (int f = 0; f < p_frames; f++) {
+
+		for (int i = 0; i < p_count; i++) {
+
+			BenchObject &o = objects[i];
+			if ((i % 8) == 0)
+				continue;
+
+			o.pos += o.vel;
+			for (int j = 0; j < 3; j++) {
+				if (o.pos[j] < 0 || o.pos[j] > world_size) {
+					o.vel[j] = -o.vel[j];
+				}
+			}
+
+			structure.move(o.id, Rect3(o.pos - half_extents, half_extents * 2));
+		}
+	}
+
+	uint64_t moved = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_count; i++) {
+		structure.erase(objects[i].id);
+	}
+
+	uint64_t erased = OS::get_singleton()->get_ticks_usec();
+
+	memdelete_arr(objects);
+
+	float move_ms = (moved - created) / 1000.0;
+	print_line(p_name + " objects: " + itos(p_count) + " create: " + rtos((created - from) / 1000.0) + "ms move (" + itos(p_frames) + " frames): " + rtos(move_ms) + "ms (" + rtos(move_ms / p_frames) + "ms/frame) erase: " + rtos((erased - moved) / 1000.0) + "ms pairs added: " + itos(pairs_added) + " removed: " + itos(pairs_removed));
+}
+
+MainLoop *test() {
+
+	static const int counts[] = { 10000, 50000, 0 };
+	static const int frames = 60;
+
+	for (int i = 0; counts[i]; i++) {
+
+		_bench<Octree<BenchObject, true> >("Octree", counts[i], frames);
+		_bench<DynamicBVH<BenchObject, true> >("DynamicBVH", counts[i], frames);
+	}
+
+	return NULL;
+}
+}
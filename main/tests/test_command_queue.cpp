@@ -0,0 +1,373 @@
+/*************************************************************************/
+/*  test_command_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_command_queue.h"
+
+#include "command_queue_mt.h"
+#include "os/mutex.h"
+#include "os/os.h"
+#include "os/semaphore.h"
+#include "os/thread.h"
+#include "print_string.h"
+#include "safe_refcount.h"
+
+/*
+ * Contention benchmark for CommandQueueMT: several producer threads push
+ * into one consumer thread, like game threads feeding a server thread.
+ * The same load is also run through a copy of the previous design (a ring
+ * under a single mutex, posting the semaphore on every push) so the two
+ * can be compared on the same machine. Ordering per producer and the
+ * push_and_ret round trips are checked along the way.
+ */
+
+namespace TestCommandQueue {
+
+enum {
+	MAX_PRODUCERS = 16,
+	RET_INTERVAL = 1024
+};
+
+struct Receiver {
+
+	uint32_t last[MAX_PRODUCERS];
+	uint64_t sum;
+	uint32_t errors;
+	bool done;
+
+	void add(uint32_t p_producer, uint32_t p_value) {
+
+		if (p_value != last[p_producer] + 1)
+			errors++;
+		last[p_producer] = p_value;
+		sum += p_value;
+	}
+
+	uint32_t get_last(uint32_t p_producer) {
+
+		return last[p_producer];
+	}
+
+	void quit() {
+
+		done = true;
+	}
+
+	Receiver() {
+
+		for (int i = 0; i < MAX_PRODUCERS; i++) {
+			last[i] = 0;
+		}
+		sum = 0;
+		errors = 0;
+		done = false;
+	}
+};
+
+// the queue as it was before producers got their own lanes
+class LegacyCommandQueue {
+
+	struct Command {
+
+		Receiver *instance;
+		uint32_t producer;
+		uint32_t value;
+		bool quit;
+	};
+
+	enum {
+		RING_SIZE = 256 * 1024 / sizeof(Command)
+	};
+
+	Command ring[RING_SIZE];
+	uint32_t read_pos;
+	uint32_t write_pos;
+	Mutex *mutex;
+	Semaphore *sync;
+
+	void _push(const Command &p_command) {
+
+		mutex->lock();
+		while ((write_pos + 1) % RING_SIZE == read_pos) {
+			mutex->unlock();
+			OS::get_singleton()->delay_usec(1000);
+			mutex->lock();
+		}
+		ring[write_pos] = p_command;
+		write_pos = (write_pos + 1) % RING_SIZE;
+		mutex->unlock();
+
+		sync->post();
+	}
+
+public:
+	void push_add(Receiver *p_instance, uint32_t p_producer, uint32_t p_value) {
+
+		Command c;
+		c.instance = p_instance;
+		c.producer = p_producer;
+		c.value = p_value;
+		c.quit = false;
+		_push(c);
+	}
+
+	void push_quit(Receiver *p_instance) {
+
+		Command c;
+		c.instance = p_instance;
+		c.producer = 0;
+		c.value = 0;
+		c.quit = true;
+		_push(c);
+	}
+
+	void wait_and_flush_one() {
+
+		sync->wait();
+		mutex->lock();
+		if (read_pos != write_pos) {
+			Command &c = ring[read_pos];
+			if (c.quit)
+				c.instance->quit();
+			else
+				c.instance->add(c.producer, c.value);
+			read_pos = (read_pos + 1) % RING_SIZE;
+		}
+		mutex->unlock();
+	}
+
+	LegacyCommandQueue() {
+
+		read_pos = 0;
+		write_pos = 0;
+		mutex = Mutex::create();
+		sync = Semaphore::create();
+	}
+
+	~LegacyCommandQueue() {
+
+		memdelete(mutex);
+		memdelete(sync);
+	}
+};
+
+struct BenchData {
+
+	Receiver receiver;
+	CommandQueueMT *queue;
+	LegacyCommandQueue *legacy;
+	uint32_t commands;
+	uint32_t ret_errors;
+};
+
+struct ProducerData {
+
+	BenchData *bench;
+	uint32_t index;
+};
+
+static void _consumer_thread(void *p_data) {
+
+	BenchData *bench = (BenchData *)p_data;
+
+	while (!bench->receiver.done) {
+		if (bench->queue)
+			bench->queue->wait_and_flush_one();
+		else
+			bench->legacy->wait_and_flush_one();
+	}
+}
+
+static void _producer_thread(void *p_data) {
+
+	ProducerData *pd = (ProducerData *)p_data;
+	BenchData *bench = pd->bench;
+
+	for (uint32_t i = 1; i <= bench->commands; i++) {
+
+		if (bench->queue) {
+			bench->queue->push(&bench->receiver, &Receiver::add, pd->index, i);
+
+			if (i % RET_INTERVAL == 0) {
+				uint32_t last = 0;
+				bench->queue->push_and_ret(&bench->receiver, &Receiver::get_last, pd->index, &last);
+				if (last != i)
+					bench->ret_errors++;
+			}
+		} else {
+			bench->legacy->push_add(&bench->receiver, pd->index, i);
+		}
+	}
+}
+
+static void _bench(bool p_legacy, int p_producers, uint32_t p_commands) {
+
+	BenchData bench;
+	bench.queue = p_legacy ? NULL : memnew(CommandQueueMT(true));
+	bench.legacy = p_legacy ? memnew(LegacyCommandQueue) : NULL;
+	bench.commands = p_commands;
+	bench.ret_errors = 0;
+
+	ProducerData pd[MAX_PRODUCERS];
+	Thread *producers[MAX_PRODUCERS];
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	Thread *consumer = Thread::create(_consumer_thread, &bench);
+
+	for (int i = 0; i < p_producers; i++) {
+		pd[i].bench = &bench;
+		pd[i].index = i;
+		producers[i] = Thread::create(_producer_thread, &pd[i]);
+	}
+
+	for (int i = 0; i < p_producers; i++) {
+		Thread::wait_to_finish(producers[i]);
+		memdelete(producers[i]);
+	}
+
+	if (p_legacy)
+		bench.legacy->push_quit(&bench.receiver);
+	else
+		bench.queue->push(&bench.receiver, &Receiver::quit);
+
+	Thread::wait_to_finish(consumer);
+	memdelete(consumer);
+
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	uint64_t total = uint64_t(p_commands) * p_producers;
+	uint64_t expected_sum = uint64_t(p_commands) * (p_commands + 1) / 2 * p_producers;
+	bool ok = bench.receiver.errors == 0 && bench.ret_errors == 0 && bench.receiver.sum == expected_sum;
+
+	print_line(String(p_legacy ? "mutex ring" : "lanes") + " producers: " + itos(p_producers) + " commands/ms: " + rtos(total / MAX(usec / 1000.0, 0.001)) + (ok ? "" : " ERROR: order or count mismatch"));
+
+	if (bench.queue)
+		memdelete(bench.queue);
+	if (bench.legacy)
+		memdelete(bench.legacy);
+}
+
+/* Threads taking turns to push, each push made after the previous one
+ * returned, must run in that order even though every turn comes from another
+ * lane. The threads exit after every wave, so their lanes must be reused. */
+
+struct TurnData {
+
+	CommandQueueMT *queue;
+	Receiver *receiver;
+	uint32_t turn;
+	uint32_t first;
+	uint32_t turns;
+	uint32_t threads;
+};
+
+struct TurnThread {
+
+	TurnData *data;
+	uint32_t index;
+};
+
+static void _turn_thread(void *p_data) {
+
+	TurnThread *tt = (TurnThread *)p_data;
+	TurnData *td = tt->data;
+
+	for (uint32_t i = tt->index; i < td->turns; i += td->threads) {
+
+		while (static_cast<uint32_t const volatile &>(td->turn) != i) {
+			OS::get_singleton()->delay_usec(1);
+		}
+		td->queue->push(td->receiver, &Receiver::add, uint32_t(MAX_PRODUCERS - 1), td->first + i + 1);
+		atomic_increment(&td->turn);
+	}
+}
+
+static void _test_turns(int p_waves, int p_threads, uint32_t p_turns) {
+
+	BenchData bench;
+	bench.queue = memnew(CommandQueueMT(true));
+	bench.legacy = NULL;
+
+	Thread *consumer = Thread::create(_consumer_thread, &bench);
+
+	TurnData td;
+	td.queue = bench.queue;
+	td.receiver = &bench.receiver;
+	td.turns = p_turns;
+	td.threads = p_threads;
+
+	TurnThread tt[MAX_PRODUCERS];
+	Thread *threads[MAX_PRODUCERS];
+
+	for (int w = 0; w < p_waves; w++) {
+
+		td.turn = 0;
+		td.first = w * p_turns;
+
+		for (int i = 0; i < p_threads; i++) {
+			tt[i].data = &td;
+			tt[i].index = i;
+			threads[i] = Thread::create(_turn_thread, &tt[i]);
+		}
+
+		for (int i = 0; i < p_threads; i++) {
+			Thread::wait_to_finish(threads[i]);
+			memdelete(threads[i]);
+		}
+	}
+
+	bench.queue->push(&bench.receiver, &Receiver::quit);
+	Thread::wait_to_finish(consumer);
+	memdelete(consumer);
+
+	//the thread pushing quit takes one more
+	int lanes = bench.queue->get_lane_count();
+	bool ok = bench.receiver.errors == 0 && bench.receiver.get_last(MAX_PRODUCERS - 1) == p_waves * p_turns && lanes <= p_threads + 1;
+
+	print_line("turns: " + itos(p_waves) + " waves of " + itos(p_threads) + " threads, lanes: " + itos(lanes) + (ok ? "" : " ERROR: order mismatch or lanes not reused"));
+
+	memdelete(bench.queue);
+}
+
+MainLoop *test() {
+
+	static const uint32_t commands = 200000;
+	static const int producer_counts[] = { 1, 2, 4, 8, 0 };
+
+	for (int i = 0; producer_counts[i]; i++) {
+
+		_bench(true, producer_counts[i], commands);
+		_bench(false, producer_counts[i], commands);
+	}
+
+	_test_turns(16, 4, 1000);
+
+	return NULL;
+}
+}
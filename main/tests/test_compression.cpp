@@ -0,0 +1,267 @@
+/*************************************************************************/
+/*  test_compression.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_compression.h"
+
+#include "global_config.h"
+#include "io/compression.h"
+#include "io/file_access_pack.h"
+#include "io/pck_packer.h"
+#include "os/dir_access.h"
+#include "os/file_access.h"
+#include "os/os.h"
+#include "print_string.h"
+
+/*
+ * Compresses every file of the current project (or the directory given as
+ * the first argument after the test name) in the same 64KB blocks
+ * FileAccessCompressed uses, once per Compression mode, and reports the
+ * ratio plus compress and decode throughput. Every block is checked to
+ * round trip, and a compressed PCK entry is read back through PackedData.
+ */
+
+namespace TestCompression {
+
+enum {
+	BLOCK_SIZE = 65536,
+	MAX_TOTAL = 64 * 1024 * 1024
+};
+
+struct Block {
+
+	int offset;
+	int size;
+};
+
+static void _gather(const String &p_dir, Vector<uint8_t> &r_data, int p_depth = 0) {
+
+	DirAccess *da = DirAccess::open(p_dir);
+	if (!da)
+		return;
+
+	da->list_dir_begin();
+	String n = da->get_next();
+	while (n != String() && r_data.size() < MAX_TOTAL) {
+
+		if (!n.begins_with(".")) {
+
+			String path = p_dir.plus_file(n);
+			if (da->current_is_dir()) {
+				if (p_depth < 16)
+					_gather(path, r_data, p_depth + 1);
+			} else {
+
+				FileAccess *f = FileAccess::open(path, FileAccess::READ);
+				if (f) {
+					int len = MIN(int(f->get_len()), MAX_TOTAL - r_data.size());
+					if (len > 0) {
+						int ofs = r_data.size();
+						r_data.resize(ofs + len);
+						f->get_buffer(&r_data[ofs], len);
+					}
+					memdelete(f);
+				}
+			}
+		}
+		n = da->get_next();
+	}
+	da->list_dir_end();
+	memdelete(da);
+}
+
+static void _bench(const char *p_name, Compression::Mode p_mode, const Vector<uint8_t> &p_data) {
+
+	const uint8_t *src = p_data.ptr();
+	int total = p_data.size();
+
+	Vector<Block> blocks;
+	Vector<uint8_t> comp;
+	comp.resize(Compression::get_max_compressed_buffer_size(BLOCK_SIZE, p_mode) * (total / BLOCK_SIZE + 1));
+	uint8_t *cw = comp.ptr();
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	int comp_total = 0;
+	for (int ofs = 0; ofs < total; ofs += BLOCK_SIZE) {
+
+		Block b;
+		b.offset = comp_total;
+		b.size = Compression::compress(&cw[comp_total], &src[ofs], MIN(BLOCK_SIZE, total - ofs), p_mode);
+		ERR_FAIL_COND(b.size < 0);
+		comp_total += b.size;
+		blocks.push_back(b);
+	}
+	uint64_t comp_usec = MAX(OS::get_singleton()->get_ticks_usec() - from, 1);
+
+	Vector<uint8_t> out;
+	out.resize(BLOCK_SIZE);
+	uint8_t *ow = out.ptr();
+
+	//decode the whole set several times, so small projects still give a stable number
+	int passes = 0;
+	bool valid = true;
+	from = OS::get_singleton()->get_ticks_usec();
+	uint64_t decomp_usec = 0;
+	do {
+		for (int i = 0; i < blocks.size(); i++) {
+
+			int ofs = i * BLOCK_SIZE;
+			int size = MIN(BLOCK_SIZE, total - ofs);
+			int ret = Compression::decompress(ow, size, &cw[blocks[i].offset], blocks[i].size, p_mode);
+			if (passes == 0 && (ret != size || memcmp(ow, &src[ofs], size) != 0))
+				valid = false;
+		}
+		passes++;
+		decomp_usec = OS::get_singleton()->get_ticks_usec() - from;
+	} while (decomp_usec < 500000);
+
+	double mb = total / (1024.0 * 1024.0);
+	print_line(String(p_name) + ": ratio " + rtos(double(comp_total) / total) + ", compress " + rtos(mb * 1000000.0 / comp_usec) + " MB/s, decode " + rtos(mb * passes * 1000000.0 / decomp_usec) + " MB/s" + (valid ? "" : ", ROUND TRIP FAILED"));
+}
+
+static void _test_pack(const Vector<uint8_t> &p_data) {
+
+	String dir = OS::get_singleton()->get_data_dir();
+	String src_path = dir.plus_file("compression_bench.bin");
+	String pack_path = dir.plus_file("compression_bench.pck");
+
+	int len = MIN(p_data.size(), 4 * 1024 * 1024);
+	FileAccess *f = FileAccess::open(src_path, FileAccess::WRITE);
+	ERR_FAIL_COND(!f);
+	f->store_buffer(p_data.ptr(), len);
+	memdelete(f);
+
+	PCKPacker packer;
+	packer.set_compression_mode(Compression::MODE_LZ4);
+	ERR_FAIL_COND(packer.pck_start(pack_path, 0) != OK);
+	packer.add_file("res://compression_bench/stored.bin", src_path);
+	packer.add_file("res://compression_bench/lz4.bin", src_path, true);
+	ERR_FAIL_COND(packer.flush() != OK);
+
+	uint64_t pack_len = 0;
+	f = FileAccess::open(pack_path, FileAccess::READ);
+	if (f) {
+		pack_len = f->get_len();
+		memdelete(f);
+	}
+
+	ERR_FAIL_COND(PackedData::get_singleton()->add_pack(pack_path) != OK);
+
+	bool valid = true;
+	const char *names[2] = { "res://compression_bench/stored.bin", "res://compression_bench/lz4.bin" };
+	for (int i = 0; i < 2; i++) {
+
+		f = FileAccess::open(names[i], FileAccess::READ);
+		if (!f || int(f->get_len()) != len) {
+			valid = false;
+		} else {
+			Vector<uint8_t> back;
+			back.resize(len);
+			f->get_buffer(back.ptr(), len);
+			valid = valid && memcmp(back.ptr(), p_data.ptr(), len) == 0;
+		}
+		if (f)
+			memdelete(f);
+	}
+
+	print_line("pck with a stored and an lz4 copy of " + itos(len / 1024) + "KB: " + itos(pack_len / 1024) + "KB, " + (valid ? "both read back intact" : "READ BACK FAILED"));
+
+	//a damaged block header must fail the file instead of decoding garbage
+	Vector<uint8_t> pack;
+	pack.resize(pack_len);
+	f = FileAccess::open(pack_path, FileAccess::READ);
+	if (f) {
+		f->get_buffer(pack.ptr(), pack_len);
+		memdelete(f);
+	}
+
+	bool rejected = false;
+	for (int i = 0; i + 4 <= pack.size(); i++) {
+
+		if (memcmp(&pack[i], "GCPF", 4) != 0)
+			continue;
+
+		pack[i] = 'X';
+		f = FileAccess::open(pack_path, FileAccess::WRITE);
+		ERR_FAIL_COND(!f);
+		f->store_buffer(pack.ptr(), pack.size());
+		memdelete(f);
+		pack[i] = 'G';
+
+		ERR_FAIL_COND(PackedData::get_singleton()->add_pack(pack_path) != OK);
+		f = FileAccess::open(names[1], FileAccess::READ);
+		rejected = !f;
+		if (f)
+			memdelete(f);
+		break;
+	}
+
+	//and so must a pack from a newer format version
+	pack[4] = 0xFF;
+	f = FileAccess::open(pack_path, FileAccess::WRITE);
+	ERR_FAIL_COND(!f);
+	f->store_buffer(pack.ptr(), pack.size());
+	memdelete(f);
+	rejected = rejected && PackedData::get_singleton()->add_pack(pack_path) != OK;
+
+	print_line(String("damaged pck: ") + (rejected ? "block header and version rejected" : "DAMAGE NOT DETECTED"));
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(src_path);
+	da->remove(pack_path);
+	memdelete(da);
+}
+
+MainLoop *test() {
+
+	String dir = "res://";
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+	for (List<String>::Element *E = args.front(); E; E = E->next()) {
+		if (E->get() == "compression" && E->next()) {
+			dir = E->next()->get();
+			break;
+		}
+	}
+
+	Vector<uint8_t> data;
+	_gather(dir, data);
+	if (data.size() == 0) {
+		print_line("compression: no files found in " + dir);
+		return NULL;
+	}
+
+	print_line("compression: " + itos(data.size() / 1024) + "KB of assets from " + dir + ", " + itos(BLOCK_SIZE / 1024) + "KB blocks");
+	_bench("fastlz", Compression::MODE_FASTLZ, data);
+	_bench("deflate", Compression::MODE_DEFLATE, data);
+	_bench("lz4", Compression::MODE_LZ4, data);
+
+	_test_pack(data);
+
+	return NULL;
+}
+}
@@ -30,7 +30,10 @@
 #include "test_containers.h"
 
 #include "dvector.h"
+#include "hash_map.h"
 #include "math_funcs.h"
+#include "oa_hash_map.h"
+#include "os/os.h"
 #include "print_string.h"
 #include "servers/visual/default_mouse_cursor.xpm"
 #include "set.h"
@@ -41,8 +44,153 @@
 
 namespace TestContainers {
 
+/* Compares HashMap with OAHashMap on the key types the engine maps use:
+ * integer ids (ObjectDB), StringNames (ClassDB, signals) and Variants (PackedScene). */
+
+template <class M, class K>
+static void _bench_map(const String &p_name, const Vector<K> &p_keys, const Vector<K> &p_missing) {
+
+	const int lookup_rounds = 5;
+	int count = p_keys.size();
+	int found = 0;
+
+	uint64_t t0 = OS::get_singleton()->get_ticks_usec();
+
+	M map;
+	for (int i = 0; i < count; i++) {
+		map[p_keys[i]] = i;
+	}
+
+	uint64_t t1 = OS::get_singleton()->get_ticks_usec();
+
+	for (int r = 0; r < lookup_rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			//scattered order, engine code rarely looks up keys in insertion order
+			int idx = (int)((uint64_t(i) * 7919) % count);
+			if (map.getptr(p_keys[idx]))
+				found++;
+			if (map.getptr(p_missing[idx]))
+				found--;
+		}
+	}
+
+	uint64_t t2 = OS::get_singleton()->get_ticks_usec();
+
+	int sum = 0;
+	const K *k = NULL;
+	while ((k = map.next(k))) {
+		sum += map[*k];
+	}
+
+	uint64_t t3 = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < count; i += 2) {
+		map.erase(p_keys[i]);
+	}
+	for (int i = 0; i < count; i += 2) {
+		map[p_keys[i]] = i;
+	}
+
+	uint64_t t4 = OS::get_singleton()->get_ticks_usec();
+
+	if (found != count * lookup_rounds || sum != count * (count - 1) / 2 || (int)map.size() != count) {
+		print_line(p_name + ": WRONG RESULTS");
+	}
+
+	print_line(p_name + ": insert " + rtos((t1 - t0) / 1000.0) + " ms, lookup " + rtos((t2 - t1) / 1000.0) + " ms, iterate " + rtos((t3 - t2) / 1000.0) + " ms, erase/reinsert " + rtos((t4 - t3) / 1000.0) + " ms");
+}
+
+template <class K, class H, class C>
+static void _bench_key_type(const String &p_name, const Vector<K> &p_keys, const Vector<K> &p_missing) {
+
+	_bench_map<HashMap<K, int, H, C>, K>(p_name + " HashMap", p_keys, p_missing);
+	_bench_map<OAHashMap<K, int, H, C>, K>(p_name + " OAHashMap", p_keys, p_missing);
+}
+
+static bool _test_oa_hash_map() {
+
+	//random operations, checked against HashMap
+	OAHashMap<int, int> oa;
+	HashMap<int, int> ref;
+
+	uint32_t seed = 1234;
+	for (int i = 0; i < 200000; i++) {
+
+		seed = seed * 1103515245 + 12345;
+		int key = (seed >> 16) % 5000;
+		int op = (seed >> 8) & 3;
+
+		if (op == 0) {
+			if (oa.erase(key) != ref.erase(key))
+				return false;
+		} else {
+			oa[key] = i;
+			ref[key] = i;
+		}
+
+		if (oa.size() != ref.size())
+			return false;
+	}
+
+	const int *k = NULL;
+	int visited = 0;
+	while ((k = ref.next(k))) {
+		const int *v = oa.getptr(*k);
+		if (!v || *v != ref[*k])
+			return false;
+	}
+
+	//erasing while iterating
+	k = NULL;
+	while ((k = oa.next(k))) {
+		visited++;
+		if (*k & 1)
+			oa.erase(*k);
+	}
+
+	if (visited != (int)ref.size())
+		return false;
+
+	k = NULL;
+	while ((k = oa.next(k))) {
+		if (*k & 1)
+			return false;
+	}
+
+	OAHashMap<int, int> copy = oa;
+	copy.reserve(100000);
+	return copy.size() == oa.size() && !copy.has(1) && (ref.has(2) == copy.has(2));
+}
+
+static void _test_hash_maps() {
+
+	print_line("OAHashMap random operations: " + String(_test_oa_hash_map() ? "ok" : "FAILED"));
+
+	const int count = 100000;
+
+	Vector<uint32_t> ids, missing_ids;
+	Vector<StringName> names, missing_names;
+	Vector<Variant> variants, missing_variants;
+
+	for (int i = 0; i < count; i++) {
+
+		ids.push_back(i + 1);
+		missing_ids.push_back(count + i + 1);
+		names.push_back(StringName("method_" + itos(i)));
+		missing_names.push_back(StringName("missing_" + itos(i)));
+		variants.push_back(i % 2 ? Variant(Vector2(i, -i)) : Variant("value_" + itos(i)));
+		missing_variants.push_back(Variant(Vector3(i, i, i)));
+	}
+
+	_bench_key_type<uint32_t, HashMapHasherDefault, HashMapComparatorDefault<uint32_t> >("uint32_t", ids, missing_ids);
+	_bench_key_type<StringName, StringNameHasher, HashMapComparatorDefault<StringName> >("StringName", names, missing_names);
+	_bench_key_type<Variant, VariantHasher, VariantComparator>("Variant", variants, missing_variants);
+}
+
 MainLoop *test() {
 
+	_test_hash_maps();
+
 	/*
 	HashMap<int,int> int_map;
 
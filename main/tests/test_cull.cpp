@@ -0,0 +1,250 @@
+/*************************************************************************/
+/*  test_cull.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+#include "test_cull.h"
+
+#include "camera_matrix.h"
+#include "math_funcs.h"
+#include "octree.h"
+#include "os/os.h"
+#include "os/thread_work_pool.h"
+#include "print_string.h"
+#include "servers/visual/visual_server_scene.h"
+
+/*
+ * Headless test for the scene cull: walks an octree with a camera frustum
+ * and classifies the results with VisualServerScene::_cull_instances, the
+ * same way _render_scene does. Every thread count must keep the same
+ * instances, in the same order, as the serial pass. Octree and
+ * classification times are reported for growing instance counts.
+ */
+
+namespace TestCull {
+
+typedef VisualServerScene::Instance Instance;
+
+static Instance *_create_instance(int p_index, float p_world_size) {
+
+	Instance *ins = memnew(Instance);
+
+	ins->transform.origin = Vector3(Math::randf() - 0.5, Math::randf() * 0.05, Math::randf() - 0.5) * p_world_size;
+	ins->aabb = Rect3(Vector3(-1, -1, -1), Vector3(2, 2, 2));
+	ins->transformed_aabb = ins->transform.xform(ins->aabb);
+
+	// a mix of everything the classification looks at
+	switch (p_index % 16) {
+		case 0: {
+			ins->base_type = VS::INSTANCE_LIGHT;
+		} break;
+		case 1: {
+			ins->base_type = VS::INSTANCE_PARTICLES;
+		} break;
+		case 2: {
+			ins->base_type = VS::INSTANCE_MESH;
+			ins->layer_mask = 2;
+		} break;
+		case 3: {
+			ins->base_type = VS::INSTANCE_MESH;
+			ins->visible = false;
+		} break;
+		case 4: {
+			ins->base_type = VS::INSTANCE_MESH;
+			ins->cast_shadows = VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY;
+		} break;
+		case 5: {
+			ins->base_type = VS::INSTANCE_MESH;
+			ins->lod_begin = p_world_size * 0.1;
+			ins->lod_end = p_world_size * 0.5;
+		} break;
+		default: {
+			ins->base_type = VS::INSTANCE_MESH;
+		}
+	}
+
+	if ((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) {
+		ins->base_data = memnew(VisualServerScene::InstanceGeometryData);
+	}
+
+	return ins;
+}
+
+struct CullRun {
+
+	Vector<Instance *> geometry;
+	Vector<Instance *> deferred;
+	Vector<int> depth_layers;
+	uint64_t octree_usec;
+	uint64_t classify_usec;
+};
+
+static void _cull(ThreadWorkPool &p_pool, Octree<Instance, true> &p_octree, const Vector<Plane> &p_planes, VisualServerScene::CullThreadParams &p_params, CullRun &r_run) {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	int cull_count = p_octree.cull_convex(p_planes, p_params.cull_result, VisualServerScene::MAX_INSTANCE_CULL);
+	uint64_t mid = OS::get_singleton()->get_ticks_usec();
+
+	cull_count = VisualServerScene::_cull_instances(p_pool, cull_count, p_params);
+
+	uint64_t to = OS::get_singleton()->get_ticks_usec();
+	r_run.octree_usec += mid - from;
+	r_run.classify_usec += to - mid;
+
+	r_run.geometry.resize(cull_count);
+	r_run.depth_layers.resize(cull_count);
+	for (int i = 0; i < cull_count; i++) {
+		r_run.geometry[i] = p_params.cull_result[i];
+		r_run.depth_layers[i] = p_params.cull_result[i]->depth_layer;
+	}
+
+	r_run.deferred.clear();
+	for (uint32_t i = 0; i < p_pool.get_thread_count(); i++) {
+		const VisualServerScene::CullThreadResult &result = p_params.results[i];
+		for (uint32_t j = 0; j < result.deferred_count; j++) {
+			r_run.deferred.push_back(p_params.deferred[result.from + j]);
+		}
+	}
+}
+
+static int _compare(const CullRun &p_serial, const CullRun &p_threaded, uint64_t p_render_pass) {
+
+	int errors = 0;
+
+	if (p_serial.geometry.size() != p_threaded.geometry.size() || p_serial.deferred.size() != p_threaded.deferred.size()) {
+		return 1;
+	}
+
+	for (int i = 0; i < p_serial.geometry.size(); i++) {
+		if (p_serial.geometry[i] != p_threaded.geometry[i] || p_serial.depth_layers[i] != p_threaded.depth_layers[i] || p_threaded.geometry[i]->last_render_pass != p_render_pass) {
+			errors++;
+		}
+	}
+
+	for (int i = 0; i < p_serial.deferred.size(); i++) {
+		if (p_serial.deferred[i] != p_threaded.deferred[i]) {
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+MainLoop *test() {
+
+	static const int instance_counts[] = { 1000, 5000, 10000, 20000, 40000, 0 };
+	static const int thread_counts[] = { 2, 3, 4, 7, 0 };
+	static const int passes = 20;
+	static const float world_size = 2000.0;
+
+	Instance **cull_result = memnew_arr(Instance *, VisualServerScene::MAX_INSTANCE_CULL);
+	Instance **cull_deferred = memnew_arr(Instance *, VisualServerScene::MAX_INSTANCE_CULL);
+
+	Transform cam_xform;
+	cam_xform.origin = Vector3(0, 10, world_size * 0.5);
+	CameraMatrix cm;
+	cm.set_perspective(70, 16.0 / 9.0, 0.1, world_size);
+	Vector<Plane> planes = cm.get_projection_planes(cam_xform);
+
+	VisualServerScene::CullThreadParams params;
+	params.cull_result = cull_result;
+	params.deferred = cull_deferred;
+	params.camera_layer_mask = 1;
+	params.render_pass = 0;
+	params.near_plane = Plane(cam_xform.origin, -cam_xform.basis.get_axis(2).normalized());
+	params.camera_origin = cam_xform.origin;
+	params.z_far = cm.get_z_far();
+
+	int errors = 0;
+
+	for (int c = 0; instance_counts[c]; c++) {
+
+		int count = instance_counts[c];
+
+		Octree<Instance, true> octree;
+		Vector<Instance *> instances;
+		instances.resize(count);
+
+		for (int i = 0; i < count; i++) {
+			Instance *ins = _create_instance(i, world_size);
+			ins->octree_id = octree.create(ins, ins->transformed_aabb, 0, false, 1 << ins->base_type, 0);
+			instances[i] = ins;
+		}
+
+		ThreadWorkPool serial_pool;
+		serial_pool.init(1);
+		params.results = memnew_arr(VisualServerScene::CullThreadResult, 1);
+
+		CullRun serial;
+		serial.octree_usec = 0;
+		serial.classify_usec = 0;
+		for (int p = 0; p < passes; p++) {
+			params.render_pass++;
+			_cull(serial_pool, octree, planes, params, serial);
+		}
+
+		print_line("instances: " + itos(count) + " threads: 1 visible: " + itos(serial.geometry.size()) + " deferred: " + itos(serial.deferred.size()) + " octree: " + rtos(serial.octree_usec / (passes * 1000.0)) + "ms classify: " + rtos(serial.classify_usec / (passes * 1000.0)) + "ms");
+
+		memdelete_arr(params.results);
+		serial_pool.finish();
+
+		for (int t = 0; thread_counts[t]; t++) {
+
+			ThreadWorkPool pool;
+			pool.init(thread_counts[t]);
+			params.results = memnew_arr(VisualServerScene::CullThreadResult, pool.get_thread_count());
+
+			CullRun threaded;
+			threaded.octree_usec = 0;
+			threaded.classify_usec = 0;
+			for (int p = 0; p < passes; p++) {
+				params.render_pass++;
+				_cull(pool, octree, planes, params, threaded);
+				errors += _compare(serial, threaded, params.render_pass);
+			}
+
+			print_line("instances: " + itos(count) + " threads: " + itos(pool.get_thread_count()) + " visible: " + itos(threaded.geometry.size()) + " deferred: " + itos(threaded.deferred.size()) + " octree: " + rtos(threaded.octree_usec / (passes * 1000.0)) + "ms classify: " + rtos(threaded.classify_usec / (passes * 1000.0)) + "ms");
+
+			memdelete_arr(params.results);
+			pool.finish();
+		}
+
+		for (int i = 0; i < count; i++) {
+			octree.erase(instances[i]->octree_id);
+			memdelete(instances[i]);
+		}
+	}
+
+	memdelete_arr(cull_result);
+	memdelete_arr(cull_deferred);
+
+	if (errors) {
+		print_line("ERROR: " + itos(errors) + " differences between the threaded and the serial cull");
+	}
+
+	return NULL;
+}
+}
@@ -568,10 +568,15 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 			switch (code[ip]) {
 
-				case GDFunction::OPCODE_OPERATOR: {
+				case GDFunction::OPCODE_OPERATOR:
+				case GDFunction::OPCODE_OPERATOR_INT:
+				case GDFunction::OPCODE_OPERATOR_REAL:
+				case GDFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDFunction::OPCODE_OPERATOR_VECTOR3: {
 
+					static const char *op_prefix[] = { "op ", "op:int ", "op:real ", "op:vector2 ", "op:vector3 " };
 					int op = code[ip + 1];
-					txt += "op ";
+					txt += op_prefix[code[ip] - GDFunction::OPCODE_OPERATOR];
 
 					String opname = Variant::get_operator_name(Variant::Operator(op));
 
@@ -614,19 +619,21 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]=";
 					txt += DADDR(3);
-					incr += 4;
+					txt += " cache " + itos(code[ip + 4]);
+					incr += 5;
 
 				} break;
 				case GDFunction::OPCODE_GET_NAMED: {
 
 					txt += " get_named ";
-					txt += DADDR(3);
+					txt += DADDR(4);
 					txt += "=";
 					txt += DADDR(1);
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]";
-					incr += 4;
+					txt += " cache " + itos(code[ip + 3]);
+					incr += 5;
 
 				} break;
 				case GDFunction::OPCODE_SET_MEMBER: {
@@ -636,18 +643,20 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += func.get_global_name(code[ip + 1]);
 					txt += "\"]=";
 					txt += DADDR(2);
-					incr += 3;
+					txt += " cache " + itos(code[ip + 3]);
+					incr += 4;
 
 				} break;
 				case GDFunction::OPCODE_GET_MEMBER: {
 
 					txt += " get_member ";
-					txt += DADDR(2);
+					txt += DADDR(3);
 					txt += "=";
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 1]);
 					txt += "\"]";
-					incr += 3;
+					txt += " cache " + itos(code[ip + 2]);
+					incr += 4;
 
 				} break;
 				case GDFunction::OPCODE_ASSIGN: {
@@ -747,7 +756,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -757,11 +766,11 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					for (int i = 0; i < argc; i++) {
 						if (i > 0)
 							txt += ", ";
-						txt += DADDR(4 + i);
+						txt += DADDR(5 + i);
 					}
-					txt += ")";
+					txt += ") cache " + itos(code[ip + 4]);
 
-					incr = 5 + argc;
+					incr = 6 + argc;
 
 				} break;
 				case GDFunction::OPCODE_CALL_BUILT_IN: {
@@ -911,8 +920,297 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+struct Benchmark {
+
+	const char *name;
+	int ops_per_iteration;
+	const char *code;
+};
+
+//every script exposes "static func run(n)", ops_per_iteration counts the operators evaluated per loop pass
+static const Benchmark benchmarks[] = {
+	{ "int arithmetic", 6,
+			"static func run(n):\n"
+			"\tvar acc = 0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tacc = (acc + i * 3 - 1) & 65535\n"
+			"\t\ti += 1\n"
+			"\treturn acc\n" },
+	{ "float arithmetic", 7,
+			"static func run(n):\n"
+			"\tvar acc = 0.0\n"
+			"\tvar x = 0.5\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tacc = acc * 0.5 + x * 1.5 - 0.25\n"
+			"\t\tx += 0.001\n"
+			"\t\ti += 1\n"
+			"\treturn acc\n" },
+	{ "vector2 arithmetic", 6,
+			"static func run(n):\n"
+			"\tvar p = Vector2(0, 0)\n"
+			"\tvar v = Vector2(1.5, -0.5)\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tp = p + v * 0.5\n"
+			"\t\tv = v - p * 0.01\n"
+			"\t\ti += 1\n"
+			"\treturn p.x\n" },
+	{ "vector3 arithmetic", 6,
+			"static func run(n):\n"
+			"\tvar p = Vector3(0, 0, 0)\n"
+			"\tvar v = Vector3(1.5, -0.5, 0.25)\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tp = p + v * 0.5\n"
+			"\t\tv = v - p * 0.01\n"
+			"\t\ti += 1\n"
+			"\treturn p.x\n" },
+	{ "compare and branch", 6,
+			"static func run(n):\n"
+			"\tvar count = 0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tif i % 3 == 0 or i > 1000:\n"
+			"\t\t\tcount += 1\n"
+			"\t\ti += 1\n"
+			"\treturn count\n" },
+	{ "untyped operands", 4,
+			"static func run(n):\n"
+			"\tvar d = { \"a\": 1 }\n"
+			"\tvar acc = 0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tacc = d[\"a\"] + acc\n"
+			"\t\ti += 1\n"
+			"\treturn acc\n" },
+	{ "native method calls", 3,
+			"static func run(n):\n"
+			"\tvar o = Reference.new()\n"
+			"\tvar acc = 0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\to.set_block_signals(i & 1)\n"
+			"\t\tif o.is_blocking_signals():\n"
+			"\t\t\tacc += 1\n"
+			"\t\tif o.is_class(\"Reference\"):\n"
+			"\t\t\tacc += 1\n"
+			"\t\ti += 1\n"
+			"\treturn acc\n" },
+	{ "script member access", 6,
+			"class Agent:\n"
+			"\tvar speed = 1.5\n"
+			"\tvar dist = 0.0\n"
+			"class Mover extends Resource:\n"
+			"\tfunc move(n, agent):\n"
+			"\t\tvar i = 0\n"
+			"\t\twhile i < n:\n"
+			"\t\t\tagent.dist = agent.dist + agent.speed\n"
+			"\t\t\tresource_local_to_scene = agent.dist > 10.0\n"
+			"\t\t\tif resource_local_to_scene:\n"
+			"\t\t\t\tagent.dist = 0.0\n"
+			"\t\t\ti += 1\n"
+			"\t\treturn agent.dist\n"
+			"static func run(n):\n"
+			"\tvar mover = Mover.new()\n"
+			"\treturn mover.move(n, Agent.new())\n" },
+	{ "builtin method calls", 4,
+			"static func run(n):\n"
+			"\tvar values = [Vector2(3, 4), Vector3(1, 2, 2)]\n"
+			"\tvar acc = 0.0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tacc += values[i & 1].length()\n"
+			"\t\ti += 1\n"
+			"\treturn acc\n" },
+	{ "native property access", 3,
+			"static func run(n):\n"
+			"\tvar r = Resource.new()\n"
+			"\tr.resource_name = \"agent\"\n"
+			"\tvar count = 0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tr.resource_local_to_scene = i & 1\n"
+			"\t\tcount += int(r.resource_local_to_scene) + r.resource_name.length()\n"
+			"\t\ti += 1\n"
+			"\treturn count\n" },
+	{ NULL, 0, NULL }
+};
+
+static void _run_benchmarks() {
+
+	//time each script until it runs long enough to be measurable, then report operators per second
+	const uint64_t min_usec = 200000;
+
+	for (int i = 0; benchmarks[i].name; i++) {
+
+		const Benchmark &b = benchmarks[i];
+
+		Ref<GDScript> script;
+		script.instance();
+		script->set_source_code(b.code);
+		Error err = script->reload();
+		if (err != OK) {
+			print_line(String(b.name) + ": compile error");
+			continue;
+		}
+
+		int n = 1000;
+		uint64_t usec = 0;
+		Variant result;
+
+		while (true) {
+
+			Variant arg = n;
+			const Variant *args[1] = { &arg };
+			Variant::CallError ce;
+
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+			result = static_cast<Object *>(script.ptr())->call("run", args, 1, ce);
+			usec = OS::get_singleton()->get_ticks_usec() - from;
+
+			if (ce.error != Variant::CallError::CALL_OK) {
+				print_line(String(b.name) + ": call error");
+				break;
+			}
+
+			if (usec >= min_usec || n >= (1 << 28))
+				break;
+			n *= 2;
+		}
+
+		if (usec == 0)
+			usec = 1;
+
+		double mops = double(n) * b.ops_per_iteration / double(usec);
+		print_line(String(b.name) + ": " + rtos(mops) + " Mops/s (" + itos(n) + " iterations in " + rtos(usec / 1000.0) + " ms, result " + String(result) + ")");
+	}
+}
+
+//named gets, sets and calls must give the same results through the inline caches,
+//also when script instances and placeholders of the same script share a call site
+static void _test_inline_caches() {
+
+	Ref<GDScript> target;
+	target.instance();
+	target->set_source_code("var speed = 1.5\n");
+
+	Ref<GDScript> driver;
+	driver.instance();
+	driver->set_source_code(
+			"static func run(objects, n):\n"
+			"\tvar total = 0.0\n"
+			"\tvar i = 0\n"
+			"\twhile i < n:\n"
+			"\t\tfor o in objects:\n"
+			"\t\t\to.speed = o.speed + 1.0\n"
+			"\t\t\ttotal += o.speed\n"
+			"\t\t\to.set_meta(\"touched\", i)\n"
+			"\t\ti += 1\n"
+			"\treturn total\n");
+
+	if (target->reload() != OK || driver->reload() != OK) {
+		print_line("ERROR: inline cache test scripts failed to compile");
+		return;
+	}
+
+	Ref<Reference> instance = memnew(Reference);
+	instance->set_script(target.get_ref_ptr());
+
+	//what the editor creates for scripts that can't run there
+	Ref<Reference> placeholder = memnew(Reference);
+	PlaceHolderScriptInstance *placeholder_instance = memnew(PlaceHolderScriptInstance(GDScriptLanguage::get_singleton(), target, placeholder.ptr()));
+	List<PropertyInfo> properties;
+	properties.push_back(PropertyInfo(Variant::REAL, "speed"));
+	Map<StringName, Variant> values;
+	values["speed"] = 1.5;
+	placeholder_instance->update(properties, values);
+	placeholder->set_script_instance(placeholder_instance);
+
+	Array objects;
+	objects.push_back(instance);
+	objects.push_back(placeholder);
+
+	const int n = 100;
+	Variant arg_objects = objects;
+	Variant arg_n = n;
+	const Variant *args[2] = { &arg_objects, &arg_n };
+	Variant::CallError ce;
+	static_cast<Object *>(driver.ptr())->call("run", args, 2, ce);
+
+	int errors = 0;
+	if (ce.error != Variant::CallError::CALL_OK)
+		errors++;
+	if (instance->get("speed") != Variant(1.5 + n) || placeholder->get("speed") != Variant(1.5 + n))
+		errors++;
+	if (instance->get_meta("touched") != Variant(n - 1) || placeholder->get_meta("touched") != Variant(n - 1))
+		errors++;
+
+	if (errors) {
+		print_line("ERROR: inline caches gave different results for script and placeholder instances");
+	} else {
+		print_line("inline caches: script and placeholder instances ok");
+	}
+
+	//a call site seeing several builtin types must not reuse the method resolved for another type
+	Ref<GDScript> builtins;
+	builtins.instance();
+	builtins->set_source_code(
+			"static func run(values):\n"
+			"\tvar total = 0.0\n"
+			"\tfor v in values:\n"
+			"\t\ttotal += v.length()\n"
+			"\treturn total\n");
+
+	if (builtins->reload() != OK) {
+		print_line("ERROR: builtin call test script failed to compile");
+		return;
+	}
+
+	Array builtin_values;
+	builtin_values.push_back(Vector2(3, 4));
+	builtin_values.push_back(Vector3(0, 0, 2));
+	builtin_values.push_back(Vector2(0, 1));
+	builtin_values.push_back("abc");
+	Variant arg_values = builtin_values;
+	const Variant *builtin_args[1] = { &arg_values };
+	Variant total = static_cast<Object *>(builtins.ptr())->call("run", builtin_args, 1, ce);
+
+	if (ce.error != Variant::CallError::CALL_OK || total != Variant(11.0)) {
+		print_line("ERROR: builtin calls gave wrong results when the type changed at the call site");
+	} else {
+		print_line("inline caches: builtin calls on changing types ok");
+	}
+
+	//every script that goes away invalidates all caches, the ones replaced must not pile up while the driver keeps running
+	size_t mem_before = 0;
+	for (int i = 0; i < 1100; i++) {
+
+		if (i == 100)
+			mem_before = Memory::get_mem_usage();
+		memdelete(memnew(GDScript));
+		arg_n = 1;
+		static_cast<Object *>(driver.ptr())->call("run", args, 2, ce);
+	}
+	size_t mem_growth = Memory::get_mem_usage() - mem_before;
+
+	if (ce.error != Variant::CallError::CALL_OK || mem_growth > 16384) {
+		print_line("ERROR: replaced inline caches are not reclaimed, " + itos(mem_growth) + " bytes kept");
+	} else {
+		print_line("inline caches: replaced caches reclaimed");
+	}
+}
+
 MainLoop *test(TestType p_test) {
 
+	if (p_test == TEST_BENCHMARK) {
+
+		_test_inline_caches();
+		_run_benchmarks();
+		return NULL;
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
@@ -32,14 +32,23 @@
 
 #ifdef DEBUG_ENABLED
 
+#include "test_alloc.h"
+#include "test_broadphase.h"
+#include "test_command_queue.h"
+#include "test_compression.h"
 #include "test_containers.h"
+#include "test_cull.h"
 #include "test_gui.h"
 #include "test_math.h"
+#include "test_narrowphase.h"
+#include "test_pack.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
 #include "test_render.h"
+#include "test_scene.h"
 #include "test_sound.h"
 #include "test_string.h"
+#include "test_variant.h"
 
 #include "test_gdscript.h"
 #include "test_image.h"
@@ -52,12 +61,21 @@ const char **tests_get_names() {
 		"string",
 		"containers",
 		"math",
+		"cull",
+		"broadphase",
+		"narrowphase",
+		"command_queue",
+		"pack",
+		"compression",
+		"alloc",
 		"render",
 		"multimesh",
 		"gui",
 		"io",
 		"shaderlang",
 		"physics",
+		"variant",
+		"scene",
 		NULL
 	};
 
@@ -81,6 +99,46 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestMath::test();
 	}
 
+	if (p_test == "cull") {
+
+		return TestCull::test();
+	}
+
+	if (p_test == "broadphase") {
+
+		return TestBroadphase::test();
+	}
+
+	if (p_test == "narrowphase") {
+
+		return TestNarrowphase::test();
+	}
+
+	if (p_test == "command_queue") {
+
+		return TestCommandQueue::test();
+	}
+
+	if (p_test == "pack") {
+
+		return TestPack::test();
+	}
+
+	if (p_test == "compression") {
+
+		return TestCompression::test();
+	}
+
+	if (p_test == "alloc") {
+
+		return TestAlloc::test();
+	}
+
+	if (p_test == "variant") {
+
+		return TestVariant::test();
+	}
+
 	if (p_test == "physics") {
 
 		return TestPhysics::test();
@@ -91,6 +149,9 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "scene") {
+		return TestScene::test();
+	}
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -138,6 +199,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
 	if (p_test == "image") {
 
 		return TestImage::test();
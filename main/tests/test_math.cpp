@@ -30,6 +30,7 @@
 #include "test_math.h"
 
 #include "camera_matrix.h"
+#include "math_batch.h"
 #include "math_funcs.h"
 #include "matrix3.h"
 #include "os/file_access.h"
@@ -460,8 +461,257 @@ uint32_t ihash3(uint32_t a) {
 	return a;
 }
 
+static Transform _random_transform() {
+
+	Transform t;
+	t.basis.rotate(Vector3(Math::randf(), Math::randf(), Math::randf()).normalized(), Math::randf() * Math_PI);
+	t.basis.scale(Vector3(1, 1, 1) * (0.5 + Math::randf()));
+	t.origin = Vector3(Math::randf(), Math::randf(), Math::randf()) * 100.0;
+	return t;
+}
+
+static bool _is_close(real_t p_a, real_t p_b) {
+
+	// SIMD backends may round differently from the scalar path, or fuse multiply and add
+	return Math::abs(p_a - p_b) <= 1e-4 * MAX(1.0, Math::abs(p_a));
+}
+
+static bool _is_close(const Vector3 &p_a, const Vector3 &p_b) {
+
+	return _is_close(p_a.x, p_b.x) && _is_close(p_a.y, p_b.y) && _is_close(p_a.z, p_b.z);
+}
+
+static bool _is_close(const Rect3 &p_a, const Rect3 &p_b) {
+
+	return _is_close(p_a.pos, p_b.pos) && _is_close(p_a.size, p_b.size);
+}
+
+static bool _is_close(const Transform &p_a, const Transform &p_b) {
+
+	for (int i = 0; i < 3; i++) {
+		if (!_is_close(p_a.basis[i], p_b.basis[i]))
+			return false;
+	}
+	return _is_close(p_a.origin, p_b.origin);
+}
+
+// elements up to p_count must match the scalar result, the ones after it must be left untouched
+template <class T>
+static int _count_batch_mismatches(const Vector<T> &p_scalar, const Vector<T> &p_result, int p_count) {
+
+	int mismatches = 0;
+
+	for (int i = 0; i < p_result.size(); i++) {
+		if (i < p_count ? !_is_close(p_scalar[i], p_result[i]) : !(p_scalar[i] == p_result[i]))
+			mismatches++;
+	}
+
+	return mismatches;
+}
+
+template <class T>
+static void _fill_batch_output(Vector<T> &r_output, int p_count, const T &p_sentinel) {
+
+	static const int padding = 3;
+
+	r_output.resize(p_count + padding);
+	for (int i = 0; i < r_output.size(); i++) {
+		r_output[i] = p_sentinel;
+	}
+}
+
+struct MathBatchResults {
+
+	Vector<Vector3> points;
+	Vector<Vector3> points_in_place;
+	Vector<Vector3> normals;
+	Vector<Rect3> aabbs;
+	Vector<Rect3> world_aabbs;
+	Vector<Transform> parent;
+	Vector<Transform> pairs;
+	Rect3 merged;
+};
+
+static void _run_math_batch(const Transform &p_xform, const Vector<Vector3> &p_points, const Vector<Rect3> &p_aabbs, const Vector<Transform> &p_xforms, const Vector<Transform> &p_xforms_b, const Vector<float> &p_matrices, int p_count, MathBatchResults &r_results) {
+
+	Transform sentinel;
+	sentinel.origin = Vector3(-7, -7, -7);
+
+	_fill_batch_output(r_results.points, p_count, sentinel.origin);
+	MathBatch::xform_points(p_xform, p_points.ptr(), r_results.points.ptr(), p_count);
+
+	_fill_batch_output(r_results.points_in_place, p_count, sentinel.origin);
+	for (int i = 0; i < p_count; i++) {
+		r_results.points_in_place[i] = p_points[i];
+	}
+	MathBatch::xform_points(p_xform, r_results.points_in_place.ptr(), r_results.points_in_place.ptr(), p_count);
+
+	_fill_batch_output(r_results.normals, p_count, sentinel.origin);
+	MathBatch::xform_normals(p_xform, p_points.ptr(), r_results.normals.ptr(), p_count);
+
+	_fill_batch_output(r_results.aabbs, p_count, Rect3(sentinel.origin, sentinel.origin));
+	MathBatch::xform_aabbs(p_xform, p_aabbs.ptr(), r_results.aabbs.ptr(), p_count);
+
+	_fill_batch_output(r_results.world_aabbs, p_count, Rect3(sentinel.origin, sentinel.origin));
+	MathBatch::xform_aabbs(p_xforms.ptr(), p_aabbs.ptr(), r_results.world_aabbs.ptr(), p_count);
+
+	_fill_batch_output(r_results.parent, p_count, sentinel);
+	MathBatch::multiply(p_xform, p_xforms_b.ptr(), r_results.parent.ptr(), p_count);
+
+	_fill_batch_output(r_results.pairs, p_count, sentinel);
+	MathBatch::multiply(p_xforms.ptr(), p_xforms_b.ptr(), r_results.pairs.ptr(), p_count);
+
+	r_results.merged = MathBatch::merge_xformed_aabb(p_aabbs[0], p_matrices.ptr(), 12, p_count);
+}
+
+static int _check_batch_kernel(MathBatch::Backend p_backend, const char *p_kernel, int p_count, int p_mismatches) {
+
+	if (p_mismatches) {
+		print_line(String("ERROR: MathBatch ") + MathBatch::get_backend_name(p_backend) + " " + p_kernel + " (" + itos(p_count) + " elements): " + itos(p_mismatches) + " elements differ from the scalar backend");
+	}
+	return p_mismatches;
+}
+
+// compares every SIMD backend with the scalar one, element by element, for
+// counts that do and do not fill the vector width of the backend
+static int _test_math_batch_backends(const Transform &p_xform, const Vector<Vector3> &p_points, const Vector<Rect3> &p_aabbs, const Vector<Transform> &p_xforms, const Vector<Transform> &p_xforms_b, const Vector<float> &p_matrices) {
+
+	static const int counts[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 255, 0 };
+
+	MathBatch::Backend prev_backend = MathBatch::get_backend();
+	int errors = 0;
+
+	for (int c = 0; counts[c]; c++) {
+
+		int count = counts[c];
+
+		MathBatchResults scalar;
+		MathBatch::set_backend(MathBatch::BACKEND_SCALAR);
+		_run_math_batch(p_xform, p_points, p_aabbs, p_xforms, p_xforms_b, p_matrices, count, scalar);
+
+		for (int b = MathBatch::BACKEND_SCALAR + 1; b < MathBatch::BACKEND_MAX; b++) {
+
+			MathBatch::Backend backend = MathBatch::Backend(b);
+			if (!MathBatch::is_backend_supported(backend))
+				continue;
+
+			MathBatchResults result;
+			MathBatch::set_backend(backend);
+			_run_math_batch(p_xform, p_points, p_aabbs, p_xforms, p_xforms_b, p_matrices, count, result);
+
+			errors += _check_batch_kernel(backend, "xform_points", count, _count_batch_mismatches(scalar.points, result.points, count));
+			errors += _check_batch_kernel(backend, "xform_points (in place)", count, _count_batch_mismatches(scalar.points_in_place, result.points_in_place, count));
+			errors += _check_batch_kernel(backend, "xform_normals", count, _count_batch_mismatches(scalar.normals, result.normals, count));
+			errors += _check_batch_kernel(backend, "xform_aabbs", count, _count_batch_mismatches(scalar.aabbs, result.aabbs, count));
+			errors += _check_batch_kernel(backend, "world aabbs", count, _count_batch_mismatches(scalar.world_aabbs, result.world_aabbs, count));
+			errors += _check_batch_kernel(backend, "multiply (parent)", count, _count_batch_mismatches(scalar.parent, result.parent, count));
+			errors += _check_batch_kernel(backend, "multiply (pairs)", count, _count_batch_mismatches(scalar.pairs, result.pairs, count));
+			errors += _check_batch_kernel(backend, "merge_xformed_aabb", count, _is_close(scalar.merged, result.merged) ? 0 : 1);
+		}
+	}
+
+	MathBatch::set_backend(prev_backend);
+
+	return errors;
+}
+
+void test_math_batch() {
+
+	static const int count = 100000;
+	static const int passes = 20;
+
+	Vector<Vector3> points;
+	Vector<Vector3> points_out;
+	Vector<Rect3> aabbs;
+	Vector<Rect3> aabbs_out;
+	Vector<Transform> xforms;
+	Vector<Transform> xforms_b;
+	Vector<Transform> xforms_out;
+	Vector<float> matrices;
+
+	points.resize(count);
+	points_out.resize(count);
+	aabbs.resize(count);
+	aabbs_out.resize(count);
+	xforms.resize(count);
+	xforms_b.resize(count);
+	xforms_out.resize(count);
+	matrices.resize(count * 12);
+
+	Math::seed(1234);
+
+	for (int i = 0; i < count; i++) {
+
+		points[i] = Vector3(Math::randf(), Math::randf(), Math::randf()) * 10.0;
+		aabbs[i] = Rect3(points[i], Vector3(1, 2, 3) * Math::randf());
+		xforms[i] = _random_transform();
+		xforms_b[i] = _random_transform();
+
+		for (int j = 0; j < 12; j++) {
+			matrices[i * 12 + j] = Math::randf();
+		}
+	}
+
+	Transform xform = _random_transform();
+
+	int errors = _test_math_batch_backends(xform, points, aabbs, xforms, xforms_b, matrices);
+	print_line("MathBatch backends checked against scalar: " + itos(errors) + " mismatches");
+
+	MathBatch::Backend prev_backend = MathBatch::get_backend();
+
+	for (int b = 0; b < MathBatch::BACKEND_MAX; b++) {
+
+		MathBatch::Backend backend = MathBatch::Backend(b);
+		if (!MathBatch::is_backend_supported(backend))
+			continue;
+
+		MathBatch::set_backend(backend);
+		print_line(String("MathBatch backend: ") + MathBatch::get_backend_name(backend) + " (" + itos(count) + " elements, " + itos(passes) + " passes)");
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::xform_points(xform, points.ptr(), points_out.ptr(), count);
+		print_line("\txform_points: " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::xform_normals(xform, points.ptr(), points_out.ptr(), count);
+		print_line("\txform_normals: " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::xform_aabbs(xform, aabbs.ptr(), aabbs_out.ptr(), count);
+		print_line("\txform_aabbs: " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::xform_aabbs(xforms.ptr(), aabbs.ptr(), aabbs_out.ptr(), count);
+		print_line("\tworld aabbs: " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::multiply(xform, xforms_b.ptr(), xforms_out.ptr(), count);
+		print_line("\tmultiply (parent): " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			MathBatch::multiply(xforms.ptr(), xforms_b.ptr(), xforms_out.ptr(), count);
+		print_line("\tmultiply (pairs): " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms");
+
+		Rect3 merged;
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int p = 0; p < passes; p++)
+			merged = MathBatch::merge_xformed_aabb(aabbs[0], matrices.ptr(), 12, count);
+		print_line("\tmerge_xformed_aabb: " + rtos((OS::get_singleton()->get_ticks_usec() - from) / 1000.0) + "ms (" + Variant(merged) + ")");
+	}
+
+	MathBatch::set_backend(prev_backend);
+}
+
 MainLoop *test() {
 
+	test_math_batch();
+
 	print_line("Dvectors: " + itos(MemoryPool::allocs_used));
 	print_line("Mem used: " + itos(MemoryPool::total_memory));
 	print_line("MAx mem used: " + itos(MemoryPool::max_memory));
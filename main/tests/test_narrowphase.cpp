@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  test_narrowphase.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_narrowphase.h"
+
+#include "global_config.h"
+#include "math_funcs.h"
+#include "os/os.h"
+#include "print_string.h"
+#include "servers/physics_server.h"
+
+/*
+ * Stress test for the 3D narrowphase: drops piles of boxes and convex hulls
+ * on a floor and steps the physics server directly, reporting how many
+ * collision pairs are processed per millisecond. Run it with different
+ * physics/3d/thread_count values to compare the serial and parallel paths.
+ */
+
+namespace TestNarrowphase {
+
+static RID _make_convex_shape() {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	//a slightly irregular rock, so hulls do not rest flat on each other
+	PoolVector<Vector3> points;
+	for (int i = 0; i < 24; i++) {
+
+		Vector3 dir(Math::randf() - 0.5, Math::randf() - 0.5, Math::randf() - 0.5);
+		points.push_back(dir.normalized() * (0.4 + Math::randf() * 0.1));
+	}
+
+	RID shape = ps->shape_create(PhysicsServer::SHAPE_CONVEX_POLYGON);
+	ps->shape_set_data(shape, points);
+	return shape;
+}
+
+static void _bench(const String &p_name, bool p_convex, int p_piles, int p_side, int p_height, int p_frames) {
+
+	PhysicsServer *ps = PhysicsServer::get_singleton();
+
+	Math::seed(4321);
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor_shape = ps->shape_create(PhysicsServer::SHAPE_PLANE);
+	ps->shape_set_data(floor_shape, Plane(Vector3(0, 1, 0), 0));
+	RID floor = ps->body_create(PhysicsServer::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+
+	RID shape;
+	if (p_convex) {
+		shape = _make_convex_shape();
+	} else {
+		shape = ps->shape_create(PhysicsServer::SHAPE_BOX);
+		ps->shape_set_data(shape, Vector3(0.5, 0.5, 0.5));
+	}
+
+	Vector<RID> bodies;
+	int pile_row = Math::ceil(Math::sqrt((double)p_piles));
+
+	for (int p = 0; p < p_piles; p++) {
+
+		Vector3 pile_origin((p % pile_row) * (p_side + 4), 0, (p / pile_row) * (p_side + 4));
+
+		for (int y = 0; y < p_height; y++) {
+			for (int x = 0; x < p_side; x++) {
+				for (int z = 0; z < p_side; z++) {
+
+					RID body = ps->body_create(PhysicsServer::BODY_MODE_RIGID);
+					ps->body_set_space(body, space);
+					ps->body_add_shape(body, shape);
+
+					Vector3 jitter(Math::randf() * 0.05, 0, Math::randf() * 0.05);
+					Transform t(Basis(), pile_origin + Vector3(x, 0.5 + y * 1.01, z) + jitter);
+					ps->body_set_state(body, PhysicsServer::BODY_STATE_TRANSFORM, t);
+					bodies.push_back(body);
+				}
+			}
+		}
+	}
+
+	const float step = 1.0 / 60.0;
+
+	//let the piles settle so most pairs are touching
+	for (int i = 0; i < 30; i++) {
+		ps->step(step);
+		ps->flush_queries();
+	}
+
+	uint64_t total_usec = 0;
+	uint64_t total_pairs = 0;
+
+	for (int i = 0; i < p_frames; i++) {
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		ps->step(step);
+		total_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		total_pairs += ps->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
+		ps->flush_queries();
+	}
+
+	float total_ms = total_usec / 1000.0;
+	print_line(p_name + " bodies: " + itos(bodies.size()) + " avg pairs: " + itos(total_pairs / p_frames) + " step: " + rtos(total_ms / p_frames) + "ms pairs/ms: " + rtos(total_pairs / MAX(total_ms, 0.001)));
+
+	for (int i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+	}
+
+	ps->free(floor);
+	ps->free(floor_shape);
+	ps->free(shape);
+	ps->free(space);
+}
+
+MainLoop *test() {
+
+	static const int frames = 120;
+
+	print_line("physics/3d/thread_count: " + itos(GlobalConfig::get_singleton()->get("physics/3d/thread_count")));
+
+	_bench("boxes", false, 16, 5, 8, frames);
+	_bench("convexes", true, 16, 5, 8, frames);
+	_bench("boxes (large)", false, 36, 6, 10, frames);
+
+	return NULL;
+}
+}
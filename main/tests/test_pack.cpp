@@ -0,0 +1,212 @@
+/*************************************************************************/
+/*  test_pack.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_pack.h"
+
+#include "io/file_access_pack.h"
+#include "io/pck_packer.h"
+#include "os/dir_access.h"
+#include "os/file_access.h"
+#include "os/os.h"
+#include "print_string.h"
+
+/*
+ * Builds a large pack in the user data dir and reads every file in it
+ * twice: once from a pack opened the regular way, copying through
+ * get_buffer(), and once from a memory mapped pack, reading the entries in
+ * place. Reports how long adding the pack and reading it took, how much
+ * went through intermediate buffers and (on Linux) how much resident memory
+ * grew; mapped pages show up there but are clean and shared with the OS
+ * file cache.
+ */
+
+namespace TestPack {
+
+enum {
+	FILE_COUNT = 64,
+	FILE_SIZE = 1024 * 1024
+};
+
+static uint64_t _get_rss() {
+
+	FileAccess *f = FileAccess::open("/proc/self/statm", FileAccess::READ);
+	if (!f)
+		return 0;
+
+	Vector<String> fields = f->get_line().split(" ");
+	memdelete(f);
+
+	return fields.size() > 1 ? fields[1].to_int64() * 4096 : 0;
+}
+
+static bool _make_pack(const String &p_pack, const String &p_prefix, const String &p_scratch) {
+
+	FileAccess *f = FileAccess::open(p_scratch, FileAccess::WRITE);
+	ERR_FAIL_COND_V(!f, false);
+
+	Vector<uint8_t> data;
+	data.resize(FILE_SIZE);
+	for (int i = 0; i < FILE_SIZE; i++) {
+		data[i] = (i * 7 + (i >> 8)) & 0xFF;
+	}
+	f->store_buffer(data.ptr(), FILE_SIZE);
+	memdelete(f);
+
+	PCKPacker packer;
+	ERR_FAIL_COND_V(packer.pck_start(p_pack, 0) != OK, false);
+	for (int i = 0; i < FILE_COUNT; i++) {
+		packer.add_file(p_prefix + itos(i) + ".bin", p_scratch);
+	}
+	return packer.flush() == OK;
+}
+
+static void _bench(const String &p_name, const String &p_pack, const String &p_prefix, bool p_mmap) {
+
+	PackedData *pd = PackedData::get_singleton();
+	bool was_mmap = pd->is_using_mmap();
+	pd->set_use_mmap(p_mmap);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	Error err = pd->add_pack(p_pack);
+	uint64_t open_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	pd->set_use_mmap(was_mmap);
+	ERR_FAIL_COND(err != OK);
+
+	uint64_t rss = _get_rss();
+	uint64_t copied = 0;
+	uint32_t checksum = 0;
+	int mapped = 0;
+
+	from = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < FILE_COUNT; i++) {
+
+		FileAccess *f = pd->try_open_path(p_prefix + itos(i) + ".bin");
+		ERR_CONTINUE(!f);
+
+		int len = f->get_len();
+		const uint8_t *src = f->get_mapped_data();
+		Vector<uint8_t> buffer;
+
+		if (src) {
+			mapped++;
+		} else {
+			buffer.resize(len);
+			copied += f->get_buffer(buffer.ptr(), len);
+			src = buffer.ptr();
+		}
+
+		for (int j = 0; j < len; j++) {
+			checksum += src[j];
+		}
+
+		memdelete(f);
+	}
+
+	uint64_t read_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	print_line(p_name + ": add_pack " + rtos(open_usec / 1000.0) + "ms, read " + rtos(read_usec / 1000.0) + "ms, files mapped: " + itos(mapped) + "/" + itos(FILE_COUNT) + ", copied: " + itos(copied / 1024) + "KB, rss growth: " + itos(int64_t(_get_rss() - rss) / 1024) + "KB, checksum: " + itos(checksum));
+}
+
+static uint32_t _sum(const uint8_t *p_data, int p_len) {
+
+	uint32_t sum = 0;
+	for (int i = 0; i < p_len; i++) {
+		sum += p_data[i];
+	}
+	return sum;
+}
+
+static void _test_reload(const String &p_pack, const String &p_prefix) {
+
+	PackedData *pd = PackedData::get_singleton();
+	bool was_mmap = pd->is_using_mmap();
+	pd->set_use_mmap(true);
+	pd->add_pack(p_pack);
+
+	FileAccess *f = pd->try_open_path(p_prefix + "0.bin");
+	if (!f || !f->get_mapped_data()) {
+		print_line("reload: pack not mapped, skipped");
+		if (f)
+			memdelete(f);
+		pd->set_use_mmap(was_mmap);
+		return;
+	}
+
+	uint32_t before = _sum(f->get_mapped_data(), f->get_len());
+
+	//loading the pack again, mapped and then not, must leave the open file readable
+	pd->add_pack(p_pack);
+	pd->set_use_mmap(false);
+	pd->add_pack(p_pack);
+	pd->set_use_mmap(was_mmap);
+
+	uint32_t after = _sum(f->get_mapped_data(), f->get_len());
+	memdelete(f);
+
+	FileAccess *g = pd->try_open_path(p_prefix + "0.bin");
+	bool unmapped = g && !g->get_mapped_data();
+	if (g)
+		memdelete(g);
+
+	if (before != after || !unmapped) {
+		ERR_PRINT("reload: open file lost its mapping or the stale mapping is still used");
+	} else {
+		print_line("reload: open file still reads its mapping, new files read from disk");
+	}
+}
+
+MainLoop *test() {
+
+	ERR_FAIL_COND_V(!PackedData::get_singleton(), NULL);
+
+	String dir = OS::get_singleton()->get_data_dir();
+	String scratch = dir.plus_file("pack_bench.bin");
+	String pack_read = dir.plus_file("pack_bench_read.pck");
+	String pack_mmap = dir.plus_file("pack_bench_mmap.pck");
+
+	//two separate packs, so the second run does not find the first one's pages already cached by the same entries
+	ERR_FAIL_COND_V(!_make_pack(pack_read, "res://pack_bench_read/", scratch), NULL);
+	ERR_FAIL_COND_V(!_make_pack(pack_mmap, "res://pack_bench_mmap/", scratch), NULL);
+
+	print_line("pack: " + itos(FILE_COUNT) + " files of " + itos(FILE_SIZE / 1024) + "KB");
+	_bench("get_buffer", pack_read, "res://pack_bench_read/", false);
+	_bench("mmap", pack_mmap, "res://pack_bench_mmap/", true);
+	_test_reload(pack_mmap, "res://pack_bench_mmap/");
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(scratch);
+	da->remove(pack_read);
+	da->remove(pack_mmap);
+	memdelete(da);
+
+	return NULL;
+}
+}
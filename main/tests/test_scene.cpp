@@ -0,0 +1,668 @@
+/*************************************************************************/
+/*  test_scene.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_scene.h"
+
+#include "global_config.h"
+#include "message_queue.h"
+#include "os/os.h"
+#include "os/thread.h"
+#include "print_string.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/scene_main_loop.h"
+#include "scene/main/timer.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/packed_scene.h"
+
+/*
+ * SceneTree benchmarks. Each one builds a scene in a private SceneTree,
+ * runs a few frames of a typical workload through it and checks the
+ * results against values computed independently of the tree.
+ */
+
+namespace TestScene {
+
+static void _frame(SceneTree *p_tree) {
+
+	p_tree->idle(1.0 / 60.0);
+	MessageQueue::get_singleton()->flush();
+}
+
+/* 2D transforms: deep Node2D hierarchies where every level moves each frame */
+
+static Transform2D _expected_global(Node2D *p_node) {
+
+	Transform2D xform = p_node->get_transform();
+	for (Node2D *n = p_node->get_parent()->cast_to<Node2D>(); n; n = n->get_parent()->cast_to<Node2D>()) {
+		xform = n->get_transform() * xform;
+	}
+	return xform;
+}
+
+static void _test_canvas_transforms(SceneTree *p_tree) {
+
+	static const int trees = 64;
+	static const int depth = 24;
+	static const int leaves = 3;
+	static const int frames = 60;
+
+	Node2D *world = memnew(Node2D);
+	p_tree->get_root()->add_child(world);
+
+	Vector<Node2D *> chain;
+	Vector<Node2D *> leaf_nodes;
+
+	for (int i = 0; i < trees; i++) {
+
+		Node *parent = world;
+		for (int j = 0; j < depth; j++) {
+
+			Node2D *n = memnew(Node2D);
+			parent->add_child(n);
+			chain.push_back(n);
+
+			for (int k = 0; k < leaves; k++) {
+				Node2D *leaf = memnew(Node2D);
+				leaf->set_position(Vector2(k, 1));
+				n->add_child(leaf);
+				leaf_nodes.push_back(leaf);
+			}
+
+			parent = n;
+		}
+	}
+
+	_frame(p_tree);
+
+	int errors = 0;
+	Vector<Vector2> read;
+	read.resize(chain.size());
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		//the second pass reads each global position back right after moving, like game code often does
+		bool read_back = pass == 1;
+		uint64_t move_usec = 0;
+		uint64_t frame_usec = 0;
+
+		for (int f = 0; f < frames; f++) {
+
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+			for (int i = 0; i < chain.size(); i++) {
+
+				Node2D *n = chain[i];
+				n->set_position(Vector2(f * 0.5, i % depth));
+				n->set_rotation(f * 0.01 + i * 0.001 + pass);
+				if (read_back)
+					read[i] = n->get_global_position();
+			}
+
+			uint64_t moved = OS::get_singleton()->get_ticks_usec();
+			uint64_t checked = moved;
+
+			if (read_back) {
+				//still before the flush, later nodes in the chain only move their own descendants
+				for (int i = 0; i < chain.size(); i++) {
+					if (read[i].distance_to(_expected_global(chain[i]).elements[2]) > 0.01)
+						errors++;
+				}
+				checked = OS::get_singleton()->get_ticks_usec();
+			}
+
+			_frame(p_tree);
+			uint64_t to = OS::get_singleton()->get_ticks_usec();
+
+			move_usec += moved - from;
+			frame_usec += (moved - from) + (to - checked); //the check is not part of the timings
+		}
+
+		print_line(String("canvas transforms (") + (read_back ? "move+read" : "move") + "): " + itos(chain.size() + leaf_nodes.size()) + " nodes, depth " + itos(depth) + ", moving: " + rtos(move_usec / (frames * 1000.0)) + " ms/frame, with flush: " + rtos(frame_usec / (frames * 1000.0)) + " ms/frame");
+	}
+
+	for (int i = 0; i < leaf_nodes.size(); i++) {
+
+		Transform2D got = leaf_nodes[i]->get_global_transform();
+		Transform2D expected = _expected_global(leaf_nodes[i]);
+		if (got.elements[2].distance_to(expected.elements[2]) > 0.01 || Math::abs(got.get_rotation() - expected.get_rotation()) > 0.001)
+			errors++;
+	}
+
+	if (errors)
+		print_line("ERROR: " + itos(errors) + " wrong global transforms");
+
+	world->queue_delete();
+	_frame(p_tree);
+}
+
+/* thread-safe process: independent agents stepping their own state each frame */
+
+class ThreadedAgent : public Node2D {
+
+	GDCLASS(ThreadedAgent, Node2D);
+
+public:
+	int index;
+	int steps;
+	int frame;
+	Node *spawn; //added to this agent with call_deferred() on the first frame
+
+	Vector2 pos;
+	Vector2 vel;
+
+	//cheap steering integration, deterministic so the result can be checked afterwards
+	static void step(int p_index, int p_frame, int p_steps, Vector2 &r_pos, Vector2 &r_vel) {
+
+		Vector2 target(Math::sin(p_frame * 0.1 + p_index) * 100.0, Math::cos(p_frame * 0.07 + p_index) * 100.0);
+		for (int i = 0; i < p_steps; i++) {
+			Vector2 steer = (target - r_pos).clamped(4.0) - r_vel;
+			r_vel = (r_vel + steer * 0.1).clamped(8.0);
+			r_pos += r_vel * (1.0 / p_steps);
+		}
+	}
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what != NOTIFICATION_PROCESS)
+			return;
+
+		if (spawn) {
+			call_deferred("add_child", spawn);
+			spawn = NULL;
+		}
+
+		step(index, frame++, steps, pos, vel);
+		set_position(pos);
+		//reads the shared transform state, which must stay consistent while other agents move
+		get_global_transform();
+	}
+
+public:
+	ThreadedAgent() {
+		index = 0;
+		steps = 0;
+		frame = 0;
+		spawn = NULL;
+	}
+};
+
+static void _test_threaded_process(SceneTree *p_tree) {
+
+	static const int agents = 4096;
+	static const int steps = 64;
+	static const int frames = 60;
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		bool threaded = pass == 1;
+
+		Node2D *world = memnew(Node2D);
+		world->set_position(Vector2(10, 20));
+		p_tree->get_root()->add_child(world);
+
+		Vector<ThreadedAgent *> list;
+		for (int i = 0; i < agents; i++) {
+
+			ThreadedAgent *a = memnew(ThreadedAgent);
+			a->index = i;
+			a->steps = steps;
+			a->spawn = memnew(Node);
+			a->set_process_thread_safe(threaded);
+			a->set_process(true);
+			world->add_child(a);
+			list.push_back(a);
+		}
+
+		uint64_t process_usec = 0;
+		for (int f = 0; f < frames; f++) {
+
+			uint64_t from = OS::get_singleton()->get_ticks_usec();
+			_frame(p_tree);
+			process_usec += OS::get_singleton()->get_ticks_usec() - from;
+		}
+
+		int errors = 0;
+		for (int i = 0; i < list.size(); i++) {
+
+			ThreadedAgent *a = list[i];
+			Vector2 expected;
+			Vector2 vel;
+			for (int f = 0; f < frames; f++) {
+				ThreadedAgent::step(i, f, steps, expected, vel);
+			}
+			if (a->get_position().distance_to(expected) > 0.001 || a->get_global_position().distance_to(expected + world->get_position()) > 0.001)
+				errors++;
+			if (a->get_child_count() != 1)
+				errors++;
+		}
+
+		int threaded_nodes = 0;
+		Array stats = p_tree->get_process_group_stats();
+		for (int i = 0; i < stats.size(); i++) {
+			Dictionary d = stats[i];
+			if (d["group"] == "idle_process")
+				threaded_nodes = d["threaded"];
+		}
+
+		print_line(String("process (") + (threaded ? "thread-safe" : "serial") + "): " + itos(agents) + " agents, " + rtos(process_usec / (frames * 1000.0)) + " ms/frame, " + itos(threaded_nodes) + " threaded");
+
+		if (errors)
+			print_line("ERROR: " + itos(errors) + " agents with wrong results");
+
+		world->queue_delete();
+		_frame(p_tree);
+	}
+}
+
+//tries to free a child from a thread-safe callback, which must fail and leave the tree intact
+class ThreadedFreer : public Node {
+
+	GDCLASS(ThreadedFreer, Node);
+
+protected:
+	void _notification(int p_what) {
+
+		if (p_what != NOTIFICATION_PROCESS)
+			return;
+
+		if (get_child_count())
+			get_child(0)->call("free");
+
+		//refused as well, the flags must keep matching the process groups
+		set_process(false);
+		set_fixed_process(true);
+	}
+};
+
+static void _test_threaded_process_guard(SceneTree *p_tree) {
+
+	ThreadedFreer *freer = memnew(ThreadedFreer);
+	Node *child = memnew(Node);
+	ObjectID child_id = child->get_instance_ID();
+	freer->add_child(child);
+	freer->set_process_thread_safe(true);
+	freer->set_process(true);
+	p_tree->get_root()->add_child(freer);
+
+	print_line("process guard: errors about freeing a node and changing the tree are expected");
+	_frame(p_tree);
+
+	if (ObjectDB::get_instance(child_id) != child || freer->get_child_count() != 1 || child->get_parent() != freer)
+		print_line("ERROR: a node was freed from a thread-safe process callback");
+
+	if (!freer->is_processing() || !freer->is_in_group("idle_process") || freer->is_fixed_processing() || freer->is_in_group("fixed_process"))
+		print_line("ERROR: process flags changed from a thread-safe process callback");
+
+	freer->queue_delete();
+	_frame(p_tree);
+}
+
+/* groups: bullets spawned and despawned in bulk every frame, while processing and iterating their group */
+
+static uint32_t _rand(uint32_t &r_seed) {
+
+	r_seed = r_seed * 1664525 + 1013904223;
+	return r_seed >> 8;
+}
+
+static void _test_group_churn(SceneTree *p_tree) {
+
+	static const int emitters = 100;
+	static const int bullets = 20000;
+	static const int churn = 1000;
+	static const int frames = 60;
+
+	Node *world = memnew(Node);
+	p_tree->get_root()->add_child(world);
+
+	for (int i = 0; i < emitters; i++) {
+		world->add_child(memnew(Node));
+	}
+
+	Vector<Node *> live;
+	uint32_t seed = 1;
+	uint64_t churn_usec = 0;
+	uint64_t frame_usec = 0;
+	int errors = 0;
+
+	for (int f = -1; f < frames; f++) {
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+		//the first round only fills the world
+		int despawn = f < 0 ? 0 : churn;
+		int spawn = f < 0 ? bullets : churn;
+
+		for (int i = 0; i < despawn; i++) {
+
+			int idx = _rand(seed) % live.size();
+			Node *b = live[idx];
+			live.set(idx, live[live.size() - 1]);
+			live.resize(live.size() - 1);
+			b->get_parent()->remove_child(b);
+			memdelete(b);
+		}
+
+		//reordering an emitter moves its bullets in tree order too
+		if (f >= 0)
+			world->move_child(world->get_child(_rand(seed) % emitters), _rand(seed) % emitters);
+
+		for (int i = 0; i < spawn; i++) {
+
+			Node *b = memnew(Node);
+			b->add_to_group("bullets");
+			b->set_process(true);
+			world->get_child(_rand(seed) % emitters)->add_child(b);
+			live.push_back(b);
+		}
+
+		uint64_t churned = OS::get_singleton()->get_ticks_usec();
+
+		//game code usually looks the group up every frame
+		List<Node *> group;
+		p_tree->get_nodes_in_group("bullets", &group);
+		if (group.size() != live.size())
+			errors++;
+
+		_frame(p_tree);
+
+		uint64_t to = OS::get_singleton()->get_ticks_usec();
+		if (f >= 0) {
+			churn_usec += churned - from;
+			frame_usec += to - from;
+		}
+	}
+
+	//groups must still be in tree order
+	List<Node *> group;
+	p_tree->get_nodes_in_group("bullets", &group);
+	if (group.size() != live.size())
+		errors++;
+
+	List<Node *>::Element *E = group.front();
+	for (int i = 0; i < emitters; i++) {
+
+		Node *emitter = world->get_child(i);
+		for (int j = 0; j < emitter->get_child_count(); j++) {
+
+			if (!E || E->get() != emitter->get_child(j))
+				errors++;
+			if (E)
+				E = E->next();
+		}
+	}
+
+	print_line("groups: " + itos(bullets) + " bullets, " + itos(churn) + " spawned and freed per frame, spawning: " + rtos(churn_usec / (frames * 1000.0)) + " ms/frame, with process: " + rtos(frame_usec / (frames * 1000.0)) + " ms/frame");
+
+	if (errors)
+		print_line("ERROR: " + itos(errors) + " group mismatches");
+
+	world->queue_delete();
+	_frame(p_tree);
+}
+
+/* instancing: a 200 node prefab, built fresh and recycled through the scene pool */
+
+static Node *_make_prefab() {
+
+	Node2D *root = memnew(Node2D);
+	root->set_name("Enemy");
+	root->add_to_group("enemies");
+
+	for (int i = 0; i < 20; i++) {
+
+		Node2D *part = memnew(Node2D);
+		part->set_name("Part" + itos(i));
+		part->set_position(Vector2(i * 4, -i));
+		part->set_rotation(i * 0.1);
+		part->set_scale(Vector2(1, 1 + i * 0.05));
+		part->set_z(i % 3);
+		part->set_modulate(Color(1, 0.5, 0.5));
+		root->add_child(part);
+		part->set_owner(root);
+
+		for (int j = 0; j < 9; j++) {
+
+			if (j < 6) {
+				Node2D *bit = memnew(Node2D);
+				bit->set_name("Bit" + itos(j));
+				bit->set_position(Vector2(j, j * 2));
+				bit->set_self_modulate(Color(0.5, 1, 0.5));
+				bit->add_to_group("hitboxes", true);
+				part->add_child(bit);
+				bit->set_owner(root);
+			} else {
+				Timer *timer = memnew(Timer);
+				timer->set_name("Timer" + itos(j));
+				timer->set_wait_time(0.5 + j);
+				timer->set_one_shot(true);
+				part->add_child(timer);
+				timer->set_owner(root);
+				timer->connect("timeout", part, "update", varray(), Object::CONNECT_PERSIST);
+			}
+		}
+	}
+
+	return root;
+}
+
+//compares what instancing must restore, the node order is the same as in the prefab
+static int _compare_instance(Node *p_a, Node *p_b) {
+
+	int errors = 0;
+
+	if (p_a->get_name() != p_b->get_name() || p_a->get_child_count() != p_b->get_child_count() || p_a->get_class() != p_b->get_class())
+		return 1;
+
+	if (Node2D *a = p_a->cast_to<Node2D>()) {
+
+		Node2D *b = p_b->cast_to<Node2D>();
+		if (a->get_position() != b->get_position() || a->get_rotation() != b->get_rotation() || a->get_scale() != b->get_scale() || a->get_z() != b->get_z())
+			errors++;
+		if (a->get_modulate() != b->get_modulate() || a->get_self_modulate() != b->get_self_modulate() || a->is_visible() != b->is_visible())
+			errors++;
+	}
+
+	if (Timer *a = p_a->cast_to<Timer>()) {
+
+		Timer *b = p_b->cast_to<Timer>();
+		if (a->get_wait_time() != b->get_wait_time() || a->is_one_shot() != b->is_one_shot())
+			errors++;
+		if (!b->is_connected("timeout", b->get_parent(), "update"))
+			errors++;
+	}
+
+	if (p_a->is_in_group("hitboxes") != p_b->is_in_group("hitboxes"))
+		errors++;
+
+	for (int i = 0; i < p_a->get_child_count(); i++) {
+		errors += _compare_instance(p_a->get_child(i), p_b->get_child(i));
+	}
+
+	return errors;
+}
+
+static void _test_scene_instancing() {
+
+	static const int count = 200;
+
+	Node *prefab = _make_prefab();
+	Ref<PackedScene> scene = memnew(PackedScene);
+	scene->pack(prefab);
+
+	int errors = 0;
+	Vector<Node *> instances;
+	instances.resize(count);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		instances[i] = scene->instance();
+	}
+	uint64_t instance_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	errors += _compare_instance(prefab, instances[0]);
+
+	//recycled instances must come back as saved, even after being changed
+	scene->set_pool_size(count);
+	for (int i = 0; i < count; i++) {
+
+		//including values the scene left at their defaults, which it doesn't store
+		Node2D *root = instances[i]->cast_to<Node2D>();
+		root->set_position(Vector2(50, 50));
+		root->set_rotation(1);
+		root->get_child(1)->cast_to<Node2D>()->hide();
+		root->get_child(2)->cast_to<Node2D>()->set_self_modulate(Color(0, 0, 0));
+		root->get_child(3)->cast_to<Node2D>()->set_rotation(3);
+		root->get_child(4)->get_child(2)->cast_to<Node2D>()->set_position(Vector2(100, 100));
+		root->get_child(5)->get_child(7)->cast_to<Timer>()->set_wait_time(100);
+		if (!scene->recycle(root))
+			errors++;
+	}
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		instances[i] = scene->instance();
+	}
+	uint64_t pooled_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	errors += _compare_instance(prefab, instances[count - 1]);
+
+	//nodes, groups and connections added at runtime can't be undone, those instances are freed instead
+	instances[0]->add_child(memnew(Node));
+	instances[1]->add_to_group("bosses");
+	instances[2]->get_child(0)->connect("tree_entered", instances[2], "update");
+	for (int i = 0; i < 3; i++) {
+		if (scene->recycle(instances[i]))
+			errors++;
+		instances[i] = scene->instance();
+	}
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		scene->recycle(instances[i]);
+	}
+	uint64_t recycle_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	print_line("instancing: " + itos(prefab->get_child_count() * 10 + 1) + " node scene, instance: " + rtos(instance_usec / (count * 1000.0)) + " ms, from pool: " + rtos(pooled_usec / (count * 1000.0)) + " ms, recycle: " + rtos(recycle_usec / (count * 1000.0)) + " ms");
+
+	if (errors)
+		print_line("ERROR: " + itos(errors) + " differences with the packed scene");
+
+	scene->clear_pool();
+	memdelete(prefab);
+}
+
+//instances taken from and given back to a shared pool on several threads
+struct ScenePoolThreadData {
+
+	Ref<PackedScene> scene;
+	int rounds;
+	int errors;
+};
+
+static void _scene_pool_thread(void *p_data) {
+
+	ScenePoolThreadData *data = (ScenePoolThreadData *)p_data;
+	for (int i = 0; i < data->rounds; i++) {
+
+		Node *n = data->scene->instance();
+		if (!n) {
+			data->errors++;
+			continue;
+		}
+		n->cast_to<Node2D>()->set_position(Vector2(i, i));
+		data->scene->recycle(n);
+	}
+}
+
+static void _test_scene_pool_threads() {
+
+	static const int threads = 4;
+
+	Node *prefab = _make_prefab();
+	Ref<PackedScene> scene = memnew(PackedScene);
+	scene->pack(prefab);
+	scene->set_path("res://pooled_enemy.tscn");
+	scene->set_pool_size(threads);
+
+	ScenePoolThreadData data[threads];
+	Thread *thread[threads];
+	for (int i = 0; i < threads; i++) {
+		data[i].scene = scene;
+		data[i].rounds = 200;
+		data[i].errors = 0;
+		thread[i] = Thread::create(_scene_pool_thread, &data[i]);
+	}
+
+	int errors = 0;
+	for (int i = 0; i < threads; i++) {
+		Thread::wait_to_finish(thread[i]);
+		memdelete(thread[i]);
+		errors += data[i].errors;
+		data[i].scene = Ref<PackedScene>();
+	}
+
+	Node *last = scene->instance();
+	errors += _compare_instance(prefab, last);
+
+	//recycle() takes the node even when it belongs to another scene
+	last->set_filename("res://other.tscn");
+	ObjectID last_id = last->get_instance_ID();
+	print_line("scene pool: an error about another scene is expected");
+	if (scene->recycle(last) || ObjectDB::get_instance(last_id))
+		errors++;
+
+	print_line("scene pool: " + itos(threads) + " threads, " + String(errors ? "FAILED" : "OK"));
+
+	scene->clear_pool();
+	memdelete(prefab);
+}
+
+MainLoop *test() {
+
+	//use a few workers even on single core machines, so the threaded paths are exercised
+	GlobalConfig::get_singleton()->set("application/run/process_thread_count", 4);
+
+	SceneTree *tree = memnew(SceneTree);
+	tree->init();
+
+	_test_canvas_transforms(tree);
+	_test_threaded_process(tree);
+	_test_threaded_process_guard(tree);
+	_test_group_churn(tree);
+	_test_scene_instancing();
+	_test_scene_pool_threads();
+
+	tree->finish();
+	memdelete(tree);
+
+	return NULL;
+}
+}
@@ -32,6 +32,8 @@
 //#include "math_funcs.h"
 #include "core/io/ip_address.h"
 #include "os/os.h"
+#include "os/thread.h"
+#include "string_db.h"
 #include <stdio.h>
 
 #include "test_string.h"
@@ -854,6 +856,134 @@ bool test_29() {
 	return state;
 };
 
+struct StringNameThreadData {
+
+	const Vector<String> *names;
+	const Vector<StringName> *expected;
+	Vector<StringName> interned; //what this thread got for each name, when collecting
+	bool collect;
+	int rounds;
+	int offset;
+	bool ok;
+};
+
+static void _string_name_thread(void *p_data) {
+
+	StringNameThreadData *td = (StringNameThreadData *)p_data;
+	const Vector<String> &names = *td->names;
+	const Vector<StringName> &expected = *td->expected;
+	int count = names.size();
+	if (td->collect)
+		td->interned.resize(count);
+
+	for (int r = 0; r < td->rounds; r++) {
+		for (int i = 0; i < count; i++) {
+
+			int idx = (i + td->offset) % count;
+			StringName sn = names[idx];
+			if (!expected.empty() && sn != expected[idx])
+				td->ok = false;
+			if (td->collect)
+				td->interned[idx] = sn;
+		}
+	}
+}
+
+static uint64_t _string_name_run_threads(int p_threads, const Vector<String> &p_names, const Vector<StringName> &p_expected, int p_rounds, bool &r_ok, Vector<Vector<StringName> > *r_interned = NULL) {
+
+	Vector<StringNameThreadData> data;
+	data.resize(p_threads);
+	Vector<Thread *> threads;
+	threads.resize(p_threads);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_threads; i++) {
+
+		StringNameThreadData &td = data[i];
+		td.names = &p_names;
+		td.expected = &p_expected;
+		td.collect = r_interned != NULL;
+		td.rounds = p_rounds;
+		td.offset = i * (p_names.size() / p_threads);
+		td.ok = true;
+		threads[i] = Thread::create(_string_name_thread, &td);
+	}
+
+	for (int i = 0; i < p_threads; i++) {
+
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+		if (!data[i].ok)
+			r_ok = false;
+		if (r_interned)
+			r_interned->push_back(data[i].interned);
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - from;
+}
+
+bool test_30() {
+
+	OS::get_singleton()->print("\n\nTest 30: StringName interning from several threads\n");
+
+	bool state = true;
+
+	const int name_count = 20000; //enough to force the table to grow past its initial size
+	const int rounds = 20;
+	int thread_count = MAX(4, OS::get_singleton()->get_processor_count());
+
+	Vector<String> names;
+	for (int i = 0; i < name_count; i++) {
+		names.push_back("string_name_test_" + itos(i));
+	}
+
+	// all threads race to intern the same new names, they must agree on every entry
+	Vector<StringName> none;
+	Vector<Vector<StringName> > interned;
+	uint64_t usec = _string_name_run_threads(thread_count, names, none, 1, state, &interned);
+	OS::get_singleton()->print("\tintern: %i names x %i threads in %i usec\n", name_count, thread_count, int(usec));
+
+	if (interned.size() != thread_count)
+		state = false;
+	for (int t = 0; t < interned.size(); t++) {
+		for (int i = 0; i < name_count; i++) {
+			//StringName compares the entry pointers
+			if (interned[t][i] != interned[0][i] || interned[t][i] == StringName() || interned[t][i] != StringName::search(names[i])) {
+				state = false;
+				break;
+			}
+		}
+	}
+	interned.clear();
+
+	Vector<StringName> expected;
+	for (int i = 0; i < name_count; i++) {
+		expected.push_back(StringName::search(names[i]));
+		if (expected[i] != StringName()) //interned names are released when the threads finish
+			state = false;
+	}
+
+	for (int i = 0; i < name_count; i++) {
+		expected[i] = names[i];
+	}
+
+	usec = _string_name_run_threads(thread_count, names, expected, rounds, state);
+	uint64_t lookups = uint64_t(name_count) * rounds * thread_count;
+	OS::get_singleton()->print("\tlookup: %i threads, %.2f M lookups/s\n", thread_count, double(lookups) / double(MAX(usec, (uint64_t)1)));
+
+	for (int i = 0; i < name_count; i++) {
+		if (StringName::search(names[i]) != expected[i]) {
+			state = false;
+			break;
+		}
+	}
+
+	OS::get_singleton()->print("\t%s\n", state ? "all threads resolved the same entries" : "mismatching entries");
+
+	return state;
+}
+
 typedef bool (*TestFunc)(void);
 
 TestFunc test_funcs[] = {
@@ -887,6 +1017,7 @@ TestFunc test_funcs[] = {
 	test_27,
 	test_28,
 	test_29,
+	test_30,
 	0
 
 };
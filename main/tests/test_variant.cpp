@@ -0,0 +1,455 @@
+/*************************************************************************/
+/*  test_variant.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_variant.h"
+
+#include "class_db.h"
+#include "os/os.h"
+#include "print_string.h"
+#include "reference.h"
+
+/*
+ * Checks the specialized operator evaluators against the results the generic
+ * operator switch produces, and times operators and builtin method calls
+ * through the name lookup and through a resolved method. Object methods
+ * called through the pointer call path must behave as Object::call does.
+ * Signals must tolerate slots that connect, disconnect or delete the emitter
+ * while being emitted.
+ */
+
+namespace TestVariant {
+
+enum {
+	BENCH_OPS = 2000000,
+	BENCH_CALLS = 1000000
+};
+
+static uint64_t _ticks() {
+
+	return OS::get_singleton()->get_ticks_usec();
+}
+
+static void _report(const String &p_name, uint64_t p_ops, uint64_t p_usec) {
+
+	print_line(p_name + ": " + rtos(double(p_usec) * 1000.0 / double(MAX(p_ops, (uint64_t)1))) + " ns/op");
+}
+
+struct OperatorCase {
+
+	Variant::Operator op;
+	Variant a;
+	Variant b;
+	Variant expected;
+	bool valid;
+};
+
+static bool _test_operators() {
+
+	OperatorCase cases[] = {
+		{ Variant::OP_ADD, 7, 5, 12, true },
+		{ Variant::OP_SUBSTRACT, 7, 5, 2, true },
+		{ Variant::OP_MULTIPLY, 7, 5, 35, true },
+		{ Variant::OP_DIVIDE, 7, 2, 3, true },
+		{ Variant::OP_DIVIDE, 7, 0, "Division By Zero", false },
+		{ Variant::OP_MODULE, 7, 5, 2, true },
+		{ Variant::OP_SHIFT_LEFT, 1, 4, 16, true },
+		{ Variant::OP_BIT_XOR, 6, 3, 5, true },
+		{ Variant::OP_NEGATE, 7, Variant(), -7, true },
+		{ Variant::OP_BIT_NEGATE, 0, Variant(), -1, true },
+		{ Variant::OP_ADD, 7, 0.5, 7.5, true },
+		{ Variant::OP_DIVIDE, 7, 2.0, 3.5, true },
+		{ Variant::OP_DIVIDE, 1.0, 0, Math_INF, true },
+		{ Variant::OP_MULTIPLY, 1.5, 2, 3.0, true },
+		{ Variant::OP_EQUAL, 2, 2.0, true, true },
+		{ Variant::OP_NOT_EQUAL, 2, 2.5, true, true },
+		{ Variant::OP_LESS, 2, 2.5, true, true },
+		{ Variant::OP_GREATER_EQUAL, 2.5, 3, false, true },
+		{ Variant::OP_NOT, true, Variant(), false, true },
+		{ Variant::OP_EQUAL, true, false, false, true },
+		{ Variant::OP_ADD, Vector2(1, 2), Vector2(3, 4), Vector2(4, 6), true },
+		{ Variant::OP_MULTIPLY, 2, Vector2(1, 2), Vector2(2, 4), true },
+		{ Variant::OP_DIVIDE, Vector2(1, 2), 2.0, Vector2(0.5, 1), true },
+		{ Variant::OP_SUBSTRACT, Vector3(1, 2, 3), Vector3(1, 1, 1), Vector3(0, 1, 2), true },
+		{ Variant::OP_MULTIPLY, Vector3(1, 2, 3), Vector3(2, 2, 2), Vector3(2, 4, 6), true },
+		{ Variant::OP_NEGATE, Vector3(1, 2, 3), Variant(), Vector3(-1, -2, -3), true },
+		{ Variant::OP_NOT_EQUAL, Vector3(1, 2, 3), Vector3(1, 2, 3), false, true },
+		{ Variant::OP_ADD, "foo", "bar", "foobar", true },
+		{ Variant::OP_EQUAL, "foo", "foo", true, true },
+		{ Variant::OP_EQUAL, Array(), Array(), true, true }, //generic path
+	};
+
+	bool ok = true;
+	int count = sizeof(cases) / sizeof(cases[0]);
+
+	for (int i = 0; i < count; i++) {
+
+		const OperatorCase &c = cases[i];
+
+		//evaluate into a destination holding another type, like a reused stack slot
+		Variant r = Vector3(9, 9, 9);
+		bool valid = !c.valid;
+		Variant::evaluate(c.op, c.a, c.b, r, valid);
+
+		if (valid != c.valid || r.get_type() != c.expected.get_type() || r != c.expected) {
+			print_line("FAIL: " + Variant::get_operator_name(c.op) + " " + Variant::get_type_name(c.a.get_type()) + "(" + String(c.a) + "), " + Variant::get_type_name(c.b.get_type()) + "(" + String(c.b) + ") gave " + Variant::get_type_name(r.get_type()) + "(" + String(r) + ")");
+			ok = false;
+		}
+	}
+
+	if (!Variant::get_operator_evaluator(Variant::OP_ADD, Variant::INT, Variant::INT)) {
+		print_line("FAIL: no evaluator for int + int");
+		ok = false;
+	}
+
+	if (Variant::get_operator_evaluator(Variant::OP_ADD, Variant::ARRAY, Variant::ARRAY)) {
+		print_line("FAIL: array + array should use the generic path");
+		ok = false;
+	}
+
+	print_line("operators: " + itos(count) + " cases " + String(ok ? "OK" : "FAILED"));
+	return ok;
+}
+
+static void _bench_operator(const String &p_name, Variant::Operator p_op, const Variant &p_a, const Variant &p_b) {
+
+	Variant r;
+	bool valid;
+
+	uint64_t from = _ticks();
+	for (int i = 0; i < BENCH_OPS; i++) {
+		Variant::evaluate(p_op, p_a, p_b, r, valid);
+	}
+	_report(p_name, BENCH_OPS, _ticks() - from);
+}
+
+static bool _test_builtin_methods() {
+
+	bool ok = true;
+
+	StringName dot = "dot";
+	int id = Variant::get_builtin_method_id(Variant::VECTOR3, dot);
+	const Variant::BuiltinMethod *method = Variant::get_builtin_method(Variant::VECTOR3, dot);
+
+	if (id < 0 || id >= Variant::get_builtin_method_count(Variant::VECTOR3) || Variant::get_builtin_method(Variant::VECTOR3, id) != method) {
+		print_line("FAIL: Vector3.dot id does not match the resolved method");
+		ok = false;
+	}
+
+	if (Variant::get_builtin_method(Variant::VECTOR3, "not_a_method") || Variant::get_builtin_method_id(Variant::VECTOR3, "not_a_method") != -1) {
+		print_line("FAIL: unknown method resolved");
+		ok = false;
+	}
+
+	Variant v = Vector3(1, 2, 3);
+	Variant arg = Vector3(3, 2, 1);
+	const Variant *args[1] = { &arg };
+	Variant::CallError ce;
+	Variant ret;
+
+	v.call_builtin(method, args, 1, &ret, ce);
+	if (ce.error != Variant::CallError::CALL_OK || ret != v.call(dot, arg)) {
+		print_line("FAIL: call_builtin(dot) differs from call(dot)");
+		ok = false;
+	}
+
+	v.call_builtin(method, NULL, 0, &ret, ce);
+	if (ce.error != Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS) {
+		print_line("FAIL: call_builtin did not check the argument count");
+		ok = false;
+	}
+
+	Variant v2 = Vector2(1, 2);
+	Variant arg2 = Vector2(2, 1);
+	const Variant *args2[1] = { &arg2 };
+	ret = Variant();
+	v2.call_builtin(method, args2, 1, &ret, ce);
+	if (ce.error != Variant::CallError::CALL_ERROR_INVALID_METHOD || ret.get_type() != Variant::NIL || Variant::get_builtin_method_base_type(method) != Variant::VECTOR3) {
+		print_line("FAIL: call_builtin accepted a method of another type");
+		ok = false;
+	}
+
+	uint64_t from = _ticks();
+	for (int i = 0; i < BENCH_CALLS; i++) {
+		v.call_ptr(dot, args, 1, &ret, ce);
+	}
+	_report("Vector3.dot by name", BENCH_CALLS, _ticks() - from);
+
+	from = _ticks();
+	for (int i = 0; i < BENCH_CALLS; i++) {
+		v.call_builtin(method, args, 1, &ret, ce);
+	}
+	_report("Vector3.dot resolved", BENCH_CALLS, _ticks() - from);
+
+	print_line("builtin methods: " + String(ok ? "OK" : "FAILED"));
+	return ok;
+}
+
+static bool _test_method_ptrcall() {
+
+	bool ok = true;
+
+	Ref<Reference> ref;
+	ref.instance();
+	Object *obj = ref.ptr();
+
+	struct Case {
+		const char *method;
+		int argc;
+		Variant args[2];
+	};
+
+	const Case cases[] = {
+		{ "is_class", 1, { String("Reference"), Variant() } },
+		{ "is_class", 1, { String("Node"), Variant() } },
+		{ "set_meta", 2, { String("meta"), Vector3(1, 2, 3) } },
+		{ "get_meta", 1, { String("meta"), Variant() } },
+		{ "has_meta", 1, { String("missing"), Variant() } },
+		{ "set_block_signals", 1, { 1, Variant() } }, //int to bool
+		{ "is_blocking_signals", 0, { Variant(), Variant() } },
+		{ "is_class", 1, { 5, Variant() } }, //not convertible without call()
+		{ "is_class", 0, { Variant(), Variant() } }, //too few arguments
+		{ NULL, 0, { Variant(), Variant() } }
+	};
+
+	for (int i = 0; cases[i].method; i++) {
+
+		const Case &c = cases[i];
+		MethodBind *method = ClassDB::get_method(obj->get_class_name(), c.method);
+		if (!method) {
+			print_line("FAIL: method not bound: " + String(c.method));
+			ok = false;
+			continue;
+		}
+
+		const Variant *args[2] = { &c.args[0], &c.args[1] };
+		Variant::CallError ce_call, ce_bind;
+
+		Variant expected = obj->call(c.method, args, c.argc, ce_call);
+		Variant ret = String("stale");
+		obj->call_method_bind(method, args, c.argc, &ret, ce_bind);
+
+		if (ce_call.error != ce_bind.error || (ce_call.error == Variant::CallError::CALL_OK && (ret.get_type() != expected.get_type() || ret != expected))) {
+			print_line("FAIL: call_method_bind(" + String(c.method) + ") differs from call(): " + String(ret) + " != " + String(expected));
+			ok = false;
+		}
+	}
+
+	MethodBind *method = ClassDB::get_method(obj->get_class_name(), "is_class");
+	StringName name = "is_class";
+	Variant arg = String("Reference");
+	const Variant *args[1] = { &arg };
+	Variant::CallError ce;
+	Variant ret;
+
+	uint64_t from = _ticks();
+	for (int i = 0; i < BENCH_CALLS; i++) {
+		ret = obj->call(name, args, 1, ce);
+	}
+	_report("Object.is_class by name", BENCH_CALLS, _ticks() - from);
+
+	from = _ticks();
+	for (int i = 0; i < BENCH_CALLS; i++) {
+		obj->call_method_bind(method, args, 1, &ret, ce);
+	}
+	_report("Object.is_class resolved", BENCH_CALLS, _ticks() - from);
+
+	print_line("method ptrcall: " + String(ok ? "OK" : "FAILED"));
+	return ok;
+}
+
+class SignalProbe : public Object {
+
+	GDCLASS(SignalProbe, Object);
+
+public:
+	int calls;
+	Object *source; //emitter the script below acts on
+	Object *other;
+	int action;
+
+	enum {
+		ACTION_NONE,
+		ACTION_DISCONNECT_OTHER,
+		ACTION_CONNECT_OTHER,
+		ACTION_DISCONNECT_SELF,
+		ACTION_EMIT_AGAIN,
+		ACTION_DELETE_SOURCE
+	};
+
+	void received(int p_value) {
+
+		calls++;
+
+		int a = action;
+		action = ACTION_NONE;
+
+		switch (a) {
+			case ACTION_DISCONNECT_OTHER: source->disconnect("probe", other, "received"); break;
+			case ACTION_CONNECT_OTHER: source->connect("probe", other, "received"); break;
+			case ACTION_DISCONNECT_SELF: source->disconnect("probe", this, "received"); break;
+			case ACTION_EMIT_AGAIN: source->emit_signal("probe", p_value); break;
+			case ACTION_DELETE_SOURCE: memdelete(source); break;
+		}
+	}
+
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("received", "value"), &SignalProbe::received);
+	}
+
+	SignalProbe() {
+
+		calls = 0;
+		source = NULL;
+		other = NULL;
+		action = ACTION_NONE;
+	}
+};
+
+static int _incoming_connections(Object *p_object) {
+
+	List<Object::Connection> conns;
+	p_object->get_signals_connected_to_this(&conns);
+	return conns.size();
+}
+
+static bool _test_signals() {
+
+	ClassDB::register_class<SignalProbe>();
+
+	bool ok = true;
+
+#define CHECK_SIGNAL(m_cond, m_what)                   \
+	if (!(m_cond)) {                                   \
+		print_line("FAIL: signals: " + String(m_what)); \
+		ok = false;                                    \
+	}
+
+	Object *source = memnew(Object);
+	source->add_user_signal(MethodInfo("probe", PropertyInfo(Variant::INT, "value")));
+
+	SignalProbe *a = memnew(SignalProbe);
+	SignalProbe *b = memnew(SignalProbe);
+	a->source = source;
+	a->other = b;
+
+	//a disconnects b before b is reached, b must not be called
+	source->connect("probe", a, "received");
+	source->connect("probe", b, "received");
+	a->action = SignalProbe::ACTION_DISCONNECT_OTHER;
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(a->calls == 1 && b->calls == 0, "slot disconnected during emission was called");
+	CHECK_SIGNAL(!source->is_connected("probe", b, "received"), "disconnect during emission was lost");
+
+	//a connects b, b runs from the next emission on
+	a->action = SignalProbe::ACTION_CONNECT_OTHER;
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(b->calls == 0, "slot connected during emission was called in the same emission");
+	CHECK_SIGNAL(source->is_connected("probe", b, "received"), "connect during emission was lost");
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(a->calls == 3 && b->calls == 1, "slot connected during emission was not called later");
+
+	//a disconnects itself, nested emissions see the same rule
+	a->action = SignalProbe::ACTION_DISCONNECT_SELF;
+	b->source = source;
+	b->action = SignalProbe::ACTION_EMIT_AGAIN;
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(a->calls == 4 && b->calls == 3, "nested emission after disconnecting self");
+	CHECK_SIGNAL(!source->is_connected("probe", a, "received"), "self disconnect was lost");
+
+	List<Object::Connection> conns;
+	source->get_signal_connection_list("probe", &conns);
+	CHECK_SIGNAL(conns.size() == 1 && _incoming_connections(b) == 1, "stale connections after emission");
+
+	//oneshot slots run once
+	source->connect("probe", a, "received", Vector<Variant>(), Object::CONNECT_ONESHOT);
+	source->emit_signal("probe", 1);
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(a->calls == 5 && !source->is_connected("probe", a, "received"), "oneshot slot");
+
+	//deleting the emitter from a slot ends the emission safely, slots after it are skipped
+	int a_calls = a->calls;
+	int b_calls = b->calls;
+	b->action = SignalProbe::ACTION_DELETE_SOURCE;
+	source->connect("probe", a, "received");
+	source->emit_signal("probe", 1);
+	CHECK_SIGNAL(b->calls == b_calls + 1 && a->calls <= a_calls + 1, "slots called after the emitter was deleted");
+	CHECK_SIGNAL(_incoming_connections(a) == 0 && _incoming_connections(b) == 0, "connections left after deleting the emitter");
+
+#undef CHECK_SIGNAL
+
+	//throughput, a few native slots on one signal
+	source = memnew(Object);
+	source->add_user_signal(MethodInfo("probe", PropertyInfo(Variant::INT, "value")));
+	SignalProbe *slots[4];
+	for (int i = 0; i < 4; i++) {
+		slots[i] = memnew(SignalProbe);
+		source->connect("probe", slots[i], "received");
+	}
+
+	StringName name = "probe";
+	Variant arg = 1;
+	const Variant *args[1] = { &arg };
+
+	uint64_t from = _ticks();
+	for (int i = 0; i < BENCH_CALLS; i++) {
+		source->emit_signal(name, args, 1);
+	}
+	_report("emit_signal to 4 slots", BENCH_CALLS, _ticks() - from);
+
+	memdelete(source);
+	for (int i = 0; i < 4; i++) {
+		memdelete(slots[i]);
+	}
+	memdelete(a);
+	memdelete(b);
+
+	print_line("signals: " + String(ok ? "OK" : "FAILED"));
+	return ok;
+}
+
+MainLoop *test() {
+
+	_test_operators();
+
+	_bench_operator("int + int", Variant::OP_ADD, 1, 3);
+	_bench_operator("int < real", Variant::OP_LESS, 1, 3.5);
+	_bench_operator("real * real", Variant::OP_MULTIPLY, 1.5, 2.5);
+	_bench_operator("Vector3 + Vector3", Variant::OP_ADD, Vector3(1, 2, 3), Vector3(3, 2, 1));
+	_bench_operator("Vector2 * real", Variant::OP_MULTIPLY, Vector2(1, 2), 0.5);
+	_bench_operator("String == String", Variant::OP_EQUAL, String("hello"), String("world"));
+	_bench_operator("Array == Array (generic)", Variant::OP_EQUAL, Array(), Array());
+
+	_test_builtin_methods();
+	_test_method_ptrcall();
+	_test_signals();
+
+	return NULL;
+}
+}
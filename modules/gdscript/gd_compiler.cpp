@@ -69,15 +69,189 @@ void GDCompiler::_set_error(const String &p_error, const GDParser::Node *p_node)
 	}
 }
 
+Variant::Type GDCompiler::_guess_operator_type(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b) {
+
+	bool a_number = p_a == Variant::INT || p_a == Variant::REAL;
+	bool b_number = p_b == Variant::INT || p_b == Variant::REAL;
+	bool a_vector = p_a == Variant::VECTOR2 || p_a == Variant::VECTOR3;
+
+	switch (p_op) {
+
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL:
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL:
+		case Variant::OP_NOT:
+		case Variant::OP_AND:
+		case Variant::OP_OR:
+		case Variant::OP_IN: {
+
+			return Variant::BOOL;
+		} break;
+		case Variant::OP_ADD:
+		case Variant::OP_SUBSTRACT:
+		case Variant::OP_MULTIPLY:
+		case Variant::OP_DIVIDE: {
+
+			if (p_a == Variant::INT && p_b == Variant::INT)
+				return Variant::INT;
+			if (a_number && b_number)
+				return Variant::REAL;
+			if (a_vector && (p_b == p_a || (b_number && (p_op == Variant::OP_MULTIPLY || p_op == Variant::OP_DIVIDE))))
+				return p_a;
+			if (a_number && p_op == Variant::OP_MULTIPLY && (p_b == Variant::VECTOR2 || p_b == Variant::VECTOR3))
+				return p_b;
+		} break;
+		case Variant::OP_MODULE:
+		case Variant::OP_SHIFT_LEFT:
+		case Variant::OP_SHIFT_RIGHT:
+		case Variant::OP_BIT_AND:
+		case Variant::OP_BIT_OR:
+		case Variant::OP_BIT_XOR: {
+
+			if (p_a == Variant::INT && p_b == Variant::INT)
+				return Variant::INT;
+		} break;
+		case Variant::OP_NEGATE:
+		case Variant::OP_POSITIVE: {
+
+			if (a_number || a_vector)
+				return p_a;
+		} break;
+		case Variant::OP_BIT_NEGATE: {
+
+			if (p_a == Variant::INT)
+				return Variant::INT;
+		} break;
+		default: {}
+	}
+
+	return Variant::NIL;
+}
+
+GDFunction::Opcode GDCompiler::_get_operator_opcode(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b) {
+
+	//an operand of unknown type is expected to match the other one, the VM checks anyway
+	if (p_a == Variant::NIL)
+		p_a = p_b;
+	else if (p_b == Variant::NIL)
+		p_b = p_a;
+
+	Variant::Type result = _guess_operator_type(p_op, p_a, p_b);
+	if (result == Variant::NIL || p_op == Variant::OP_IN || p_op == Variant::OP_NOT)
+		return GDFunction::OPCODE_OPERATOR;
+
+	if (p_a == Variant::INT && p_b == Variant::INT)
+		return GDFunction::OPCODE_OPERATOR_INT;
+	if ((p_a == Variant::INT || p_a == Variant::REAL) && (p_b == Variant::INT || p_b == Variant::REAL))
+		return result == Variant::INT ? GDFunction::OPCODE_OPERATOR_INT : GDFunction::OPCODE_OPERATOR_REAL;
+	if (p_a == Variant::VECTOR2 || p_b == Variant::VECTOR2)
+		return GDFunction::OPCODE_OPERATOR_VECTOR2;
+	if (p_a == Variant::VECTOR3 || p_b == Variant::VECTOR3)
+		return GDFunction::OPCODE_OPERATOR_VECTOR3;
+
+	return GDFunction::OPCODE_OPERATOR;
+}
+
+Variant::Type GDCompiler::_guess_expression_type(CodeGen &codegen, const GDParser::Node *p_expression) const {
+
+	switch (p_expression->type) {
+
+		case GDParser::Node::TYPE_CONSTANT: {
+
+			return static_cast<const GDParser::ConstantNode *>(p_expression)->value.get_type();
+		} break;
+		case GDParser::Node::TYPE_IDENTIFIER: {
+
+			const Map<StringName, Variant::Type>::Element *E = codegen.stack_identifier_types.find(static_cast<const GDParser::IdentifierNode *>(p_expression)->name);
+			return E ? E->get() : Variant::NIL;
+		} break;
+		case GDParser::Node::TYPE_OPERATOR: {
+
+			const GDParser::OperatorNode *on = static_cast<const GDParser::OperatorNode *>(p_expression);
+
+			Variant::Operator op = Variant::OP_MAX;
+			switch (on->op) {
+
+				case GDParser::OperatorNode::OP_CALL: {
+					//constructor of a built-in type, ie: Vector2(x,y) or float(x)
+					if (on->arguments.size() && on->arguments[0]->type == GDParser::Node::TYPE_TYPE)
+						return static_cast<const GDParser::TypeNode *>(on->arguments[0])->vtype;
+					if (on->arguments.size() && on->arguments[0]->type == GDParser::Node::TYPE_BUILT_IN_FUNCTION && static_cast<const GDParser::BuiltInFunctionNode *>(on->arguments[0])->function == GDFunctions::GEN_RANGE)
+						return Variant::ARRAY;
+					return Variant::NIL;
+				} break;
+				case GDParser::OperatorNode::OP_INDEX_NAMED: {
+
+					Variant::Type base = _guess_expression_type(codegen, on->arguments[0]);
+					if ((base == Variant::VECTOR2 || base == Variant::VECTOR3) && on->arguments[1]->type == GDParser::Node::TYPE_IDENTIFIER) {
+						StringName name = static_cast<const GDParser::IdentifierNode *>(on->arguments[1])->name;
+						if (name == "x" || name == "y" || (name == "z" && base == Variant::VECTOR3))
+							return Variant::REAL;
+					}
+					return Variant::NIL;
+				} break;
+				case GDParser::OperatorNode::OP_INIT_ASSIGN:
+				case GDParser::OperatorNode::OP_ASSIGN: return _guess_expression_type(codegen, on->arguments[1]);
+				case GDParser::OperatorNode::OP_NEG: op = Variant::OP_NEGATE; break;
+				case GDParser::OperatorNode::OP_POS: op = Variant::OP_POSITIVE; break;
+				case GDParser::OperatorNode::OP_NOT: op = Variant::OP_NOT; break;
+				case GDParser::OperatorNode::OP_BIT_INVERT: op = Variant::OP_BIT_NEGATE; break;
+				case GDParser::OperatorNode::OP_IN: op = Variant::OP_IN; break;
+				case GDParser::OperatorNode::OP_EQUAL: op = Variant::OP_EQUAL; break;
+				case GDParser::OperatorNode::OP_NOT_EQUAL: op = Variant::OP_NOT_EQUAL; break;
+				case GDParser::OperatorNode::OP_LESS: op = Variant::OP_LESS; break;
+				case GDParser::OperatorNode::OP_LESS_EQUAL: op = Variant::OP_LESS_EQUAL; break;
+				case GDParser::OperatorNode::OP_GREATER: op = Variant::OP_GREATER; break;
+				case GDParser::OperatorNode::OP_GREATER_EQUAL: op = Variant::OP_GREATER_EQUAL; break;
+				case GDParser::OperatorNode::OP_AND: op = Variant::OP_AND; break;
+				case GDParser::OperatorNode::OP_OR: op = Variant::OP_OR; break;
+				case GDParser::OperatorNode::OP_ASSIGN_ADD:
+				case GDParser::OperatorNode::OP_ADD: op = Variant::OP_ADD; break;
+				case GDParser::OperatorNode::OP_ASSIGN_SUB:
+				case GDParser::OperatorNode::OP_SUB: op = Variant::OP_SUBSTRACT; break;
+				case GDParser::OperatorNode::OP_ASSIGN_MUL:
+				case GDParser::OperatorNode::OP_MUL: op = Variant::OP_MULTIPLY; break;
+				case GDParser::OperatorNode::OP_ASSIGN_DIV:
+				case GDParser::OperatorNode::OP_DIV: op = Variant::OP_DIVIDE; break;
+				case GDParser::OperatorNode::OP_ASSIGN_MOD:
+				case GDParser::OperatorNode::OP_MOD: op = Variant::OP_MODULE; break;
+				case GDParser::OperatorNode::OP_ASSIGN_SHIFT_LEFT:
+				case GDParser::OperatorNode::OP_SHIFT_LEFT: op = Variant::OP_SHIFT_LEFT; break;
+				case GDParser::OperatorNode::OP_ASSIGN_SHIFT_RIGHT:
+				case GDParser::OperatorNode::OP_SHIFT_RIGHT: op = Variant::OP_SHIFT_RIGHT; break;
+				case GDParser::OperatorNode::OP_ASSIGN_BIT_AND:
+				case GDParser::OperatorNode::OP_BIT_AND: op = Variant::OP_BIT_AND; break;
+				case GDParser::OperatorNode::OP_ASSIGN_BIT_OR:
+				case GDParser::OperatorNode::OP_BIT_OR: op = Variant::OP_BIT_OR; break;
+				case GDParser::OperatorNode::OP_ASSIGN_BIT_XOR:
+				case GDParser::OperatorNode::OP_BIT_XOR: op = Variant::OP_BIT_XOR; break;
+				default: return Variant::NIL;
+			}
+
+			Variant::Type a = _guess_expression_type(codegen, on->arguments[0]);
+			Variant::Type b = on->arguments.size() > 1 ? _guess_expression_type(codegen, on->arguments[1]) : a;
+			return _guess_operator_type(op, a, b);
+		} break;
+		default: {}
+	}
+
+	return Variant::NIL;
+}
+
 bool GDCompiler::_create_unary_operator(CodeGen &codegen, const GDParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
 
+	Variant::Type type_a = _guess_expression_type(codegen, on->arguments[0]);
+
 	int src_address_a = _parse_expression(codegen, on->arguments[0], p_stack_level);
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, type_a, type_a)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -89,6 +263,9 @@ bool GDCompiler::_create_binary_operator(CodeGen &codegen, const GDParser::Opera
 
 	ERR_FAIL_COND_V(on->arguments.size() != 2, false);
 
+	Variant::Type type_a = _guess_expression_type(codegen, on->arguments[0]);
+	Variant::Type type_b = _guess_expression_type(codegen, on->arguments[1]);
+
 	int src_address_a = _parse_expression(codegen, on->arguments[0], p_stack_level, false, p_initializer);
 	if (src_address_a < 0)
 		return false;
@@ -99,7 +276,7 @@ bool GDCompiler::_create_binary_operator(CodeGen &codegen, const GDParser::Opera
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, type_a, type_b)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
@@ -186,6 +363,7 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 				//get property
 				codegen.opcodes.push_back(GDFunction::OPCODE_GET_MEMBER); // perform operator
 				codegen.opcodes.push_back(codegen.get_name_map_pos(identifier)); // argument 2 (unary only takes one parameter)
+				codegen.opcodes.push_back(codegen.alloc_inline_cache());
 				int dst_addr = (p_stack_level) | (GDFunction::ADDR_TYPE_STACK << GDFunction::ADDR_BITS);
 				codegen.opcodes.push_back(dst_addr); // append the stack level as destination address of the opcode
 				codegen.alloc_stack(p_stack_level);
@@ -517,8 +695,11 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 						codegen.opcodes.push_back(p_root ? GDFunction::OPCODE_CALL : GDFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
-						for (int i = 0; i < arguments.size(); i++)
+						for (int i = 0; i < arguments.size(); i++) {
 							codegen.opcodes.push_back(arguments[i]);
+							if (i == 1)
+								codegen.opcodes.push_back(codegen.alloc_inline_cache()); //slot remembering the method resolved at this call site
+						}
 					}
 				} break;
 				case GDParser::OperatorNode::OP_YIELD: {
@@ -608,6 +789,8 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 					codegen.opcodes.push_back(named ? GDFunction::OPCODE_GET_NAMED : GDFunction::OPCODE_GET); // perform operator
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (named)
+						codegen.opcodes.push_back(codegen.alloc_inline_cache());
 
 				} break;
 				case GDParser::OperatorNode::OP_AND: {
@@ -879,6 +1062,7 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 							// recover and assign at the end, this allows stuff like
 							// position.x+=2.0
 							// in Node2D
+							setchain.push_back(codegen.alloc_inline_cache());
 							setchain.push_back(prev_pos);
 							setchain.push_back(codegen.get_name_map_pos(assign_property));
 							setchain.push_back(GDFunction::OPCODE_SET_MEMBER);
@@ -917,6 +1101,8 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 							codegen.opcodes.push_back(named ? GDFunction::OPCODE_GET_NAMED : GDFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
+							if (named)
+								codegen.opcodes.push_back(codegen.alloc_inline_cache());
 							slevel++;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDFunction::ADDR_TYPE_STACK << GDFunction::ADDR_BITS) | slevel;
@@ -925,6 +1111,8 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 
 							//add in reverse order, since it will be reverted
 
+							if (named)
+								setchain.push_back(codegen.alloc_inline_cache());
 							setchain.push_back(dst_pos);
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
@@ -964,6 +1152,8 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
+						if (named)
+							codegen.opcodes.push_back(codegen.alloc_inline_cache());
 
 						for (int i = 0; i < setchain.size(); i++) {
 
@@ -986,6 +1176,7 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 						codegen.opcodes.push_back(GDFunction::OPCODE_SET_MEMBER);
 						codegen.opcodes.push_back(codegen.get_name_map_pos(name));
 						codegen.opcodes.push_back(src_address);
+						codegen.opcodes.push_back(codegen.alloc_inline_cache());
 
 						return GDFunction::ADDR_TYPE_NIL << GDFunction::ADDR_BITS;
 					} else {
@@ -994,6 +1185,8 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 
 						int slevel = p_stack_level;
 
+						Variant::Type assigned_type = _guess_expression_type(codegen, on);
+
 						int dst_address_a = _parse_expression(codegen, on->arguments[0], slevel, false, on->op == GDParser::OperatorNode::OP_INIT_ASSIGN);
 						if (dst_address_a < 0)
 							return -1;
@@ -1010,6 +1203,14 @@ int GDCompiler::_parse_expression(CodeGen &codegen, const GDParser::Node *p_expr
 						codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN); // perform operator
 						codegen.opcodes.push_back(dst_address_a); // argument 1
 						codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
+
+						if (on->arguments[0]->type == GDParser::Node::TYPE_IDENTIFIER && (dst_address_a >> GDFunction::ADDR_BITS) == GDFunction::ADDR_TYPE_STACK_VARIABLE) {
+							StringName name = static_cast<GDParser::IdentifierNode *>(on->arguments[0])->name;
+							if (assigned_type == Variant::NIL)
+								codegen.stack_identifier_types.erase(name);
+							else
+								codegen.stack_identifier_types[name] = assigned_type;
+						}
 						return dst_address_a; //if anything, returns wathever was assigned or correct stack position
 					}
 
@@ -1199,6 +1400,11 @@ Error GDCompiler::_parse_block(CodeGen &codegen, const GDParser::BlockNode *p_bl
 						codegen.push_stack_identifiers();
 						codegen.add_stack_identifier(static_cast<const GDParser::IdentifierNode *>(cf->arguments[0])->name, iter_stack_pos);
 
+						//counting loops (for i in 10 or for i in range(...)) iterate ints
+						Variant::Type container_type = _guess_expression_type(codegen, cf->arguments[1]);
+						if (container_type == Variant::INT || (container_type == Variant::ARRAY && cf->arguments[1]->type == GDParser::Node::TYPE_OPERATOR))
+							codegen.stack_identifier_types[static_cast<const GDParser::IdentifierNode *>(cf->arguments[0])->name] = Variant::INT;
+
 						int ret = _parse_expression(codegen, cf->arguments[1], slevel, false);
 						if (ret < 0)
 							return ERR_COMPILATION_FAILED;
@@ -1367,6 +1573,7 @@ Error GDCompiler::_parse_function(GDScript *p_script, const GDParser::ClassNode
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
+	codegen.inline_cache_count = 0;
 	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
 	Vector<StringName> argnames;
 
@@ -1526,6 +1733,21 @@ Error GDCompiler::_parse_function(GDScript *p_script, const GDParser::ClassNode
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
+	if (codegen.inline_cache_count) {
+
+		gdfunc->inline_caches.resize(codegen.inline_cache_count);
+		gdfunc->_inline_caches_ptr = gdfunc->inline_caches.ptr();
+		gdfunc->builtin_caches.resize(codegen.inline_cache_count);
+		gdfunc->_builtin_caches_ptr = gdfunc->builtin_caches.ptr();
+		for (int i = 0; i < codegen.inline_cache_count; i++) {
+			gdfunc->_inline_caches_ptr[i] = NULL;
+			gdfunc->_builtin_caches_ptr[i] = NULL;
+		}
+	} else {
+		gdfunc->_inline_caches_ptr = NULL;
+		gdfunc->_builtin_caches_ptr = NULL;
+	}
+	gdfunc->_inline_cache_count = codegen.inline_cache_count;
 	gdfunc->name = func_name;
 #ifdef DEBUG_ENABLED
 	if (ScriptDebugger::get_singleton()) {
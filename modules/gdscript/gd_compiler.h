@@ -45,6 +45,7 @@ class GDCompiler {
 
 		List<Map<StringName, int> > stack_id_stack;
 		Map<StringName, int> stack_identifiers;
+		Map<StringName, Variant::Type> stack_identifier_types; //type last assigned to a local, only a hint for typed opcodes
 
 		List<GDFunction::StackDebug> stack_debug;
 		List<Map<StringName, int> > block_identifier_stack;
@@ -52,6 +53,7 @@ class GDCompiler {
 
 		void add_stack_identifier(const StringName &p_id, int p_stackpos) {
 			stack_identifiers[p_id] = p_stackpos;
+			stack_identifier_types.erase(p_id);
 			if (debug_stack) {
 				block_identifiers[p_id] = p_stackpos;
 				GDFunction::StackDebug sd;
@@ -121,10 +123,14 @@ class GDCompiler {
 		void alloc_call(int p_params) {
 			if (p_params >= call_max) call_max = p_params;
 		}
+		int alloc_inline_cache() {
+			return inline_cache_count++;
+		}
 
 		int current_line;
 		int stack_max;
 		int call_max;
+		int inline_cache_count;
 	};
 
 #if 0
@@ -143,6 +149,10 @@ class GDCompiler {
 
 	void _set_error(const String &p_error, const GDParser::Node *p_node);
 
+	static Variant::Type _guess_operator_type(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b);
+	static GDFunction::Opcode _get_operator_opcode(Variant::Operator p_op, Variant::Type p_a, Variant::Type p_b);
+	Variant::Type _guess_expression_type(CodeGen &codegen, const GDParser::Node *p_expression) const;
+
 	bool _create_unary_operator(CodeGen &codegen, const GDParser::OperatorNode *on, Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen &codegen, const GDParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer = false);
 
@@ -28,6 +28,7 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "gd_function.h"
+#include "class_db.h"
 
 #include "gd_functions.h"
 #include "gd_script.h"
@@ -130,6 +131,181 @@ String GDFunction::_get_call_error(const Variant::CallError &p_err, const String
 	return err_text;
 }
 
+//object held by a Variant when its calls and properties can go through the inline caches
+static _FORCE_INLINE_ Object *_get_cacheable_object(const Variant *p_variant) {
+
+	if (p_variant->get_type() != Variant::OBJECT)
+		return NULL;
+
+	Object *obj = *p_variant;
+#ifdef DEBUG_ENABLED
+	if (obj && ScriptDebugger::get_singleton() && !p_variant->is_ref() && !ObjectDB::instance_validate(obj)) {
+		return NULL; //let the regular path report it
+	}
+#endif
+	return obj;
+}
+
+bool GDFunction::_resolve_inline_cache_entry(InlineCacheKind p_kind, Object *p_object, GDInstance *p_instance, const StringName &p_name, InlineCacheEntry &r_entry) {
+
+	//must find exactly what Object::call, Object::get and Object::set would, anything less direct is not cached
+	GDScript *script = p_instance ? p_instance->script.ptr() : NULL;
+	const StringName &class_name = p_object->get_class_name();
+
+	r_entry.class_name = class_name;
+	r_entry.script = script;
+	r_entry.method = NULL;
+	r_entry.member_index = -1;
+
+	switch (p_kind) {
+
+		case INLINE_CACHE_CALL: {
+
+			if (p_instance && p_instance->has_method(p_name))
+				return false; //script functions take precedence
+			r_entry.method = ClassDB::get_method(class_name, p_name);
+		} break;
+		case INLINE_CACHE_GET:
+		case INLINE_CACHE_SET: {
+
+			bool get = p_kind == INLINE_CACHE_GET;
+
+			if (script) {
+
+				const Map<StringName, GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
+				if (E) {
+					if (get ? E->get().getter : E->get().setter)
+						return false;
+					r_entry.member_index = E->get().index;
+					return true;
+				}
+
+				const StringName &handler = get ? GDScriptLanguage::get_singleton()->strings._get : GDScriptLanguage::get_singleton()->strings._set;
+				for (const GDScript *sptr = script; sptr; sptr = sptr->_base) {
+					if (sptr->member_functions.has(handler) || (get && sptr->constants.has(p_name)))
+						return false;
+				}
+			}
+
+			r_entry.method = get ? ClassDB::get_property_getter_method(class_name, p_name) : ClassDB::get_property_setter_method(class_name, p_name);
+		} break;
+		case INLINE_CACHE_GET_NATIVE: {
+
+			r_entry.method = ClassDB::get_property_getter_method(class_name, p_name);
+		} break;
+		case INLINE_CACHE_SET_NATIVE: {
+
+			r_entry.method = ClassDB::get_property_setter_method(class_name, p_name);
+		} break;
+	}
+
+	return r_entry.method != NULL;
+}
+
+const GDFunction::InlineCacheEntry *GDFunction::_get_inline_cache(int p_slot, InlineCacheKind p_kind, Object *p_object, const StringName &p_name) const {
+
+	GDInstance *instance = NULL;
+	if (p_kind != INLINE_CACHE_GET_NATIVE && p_kind != INLINE_CACHE_SET_NATIVE) {
+
+		ScriptInstance *script_instance = p_object->get_script_instance();
+		if (script_instance) {
+			if (script_instance->get_language() != GDScriptLanguage::get_singleton())
+				return NULL; //other languages may handle any name, always ask them
+			if (script_instance->is_placeholder())
+				return NULL; //not a GDInstance, it only stores exported values
+			instance = static_cast<GDInstance *>(script_instance);
+		}
+	}
+
+	const StringName &class_name = p_object->get_class_name();
+	GDScript *script = instance ? instance->script.ptr() : NULL;
+	uint32_t epoch = GDScriptLanguage::get_singleton()->inline_cache_epoch;
+	InlineCache *cache = _inline_caches_ptr[p_slot];
+
+	if (cache && cache->epoch == epoch) {
+
+		for (int i = 0; i < cache->count; i++) {
+
+			const InlineCacheEntry &entry = cache->entries[i];
+			if (entry.class_name == class_name && entry.script == script)
+				return (entry.method || entry.member_index >= 0) ? &entry : NULL;
+		}
+
+		if (cache->misses >= INLINE_CACHE_MAX_MISSES)
+			return NULL; //megamorphic, not worth caching
+	}
+
+	InlineCache *new_cache = memnew(InlineCache);
+	new_cache->epoch = epoch;
+	new_cache->count = 0;
+	new_cache->misses = 1;
+	new_cache->retired_next = NULL;
+
+	if (cache && cache->epoch == epoch) {
+		//keep the most recent classes, dropping the oldest one when full
+		int from = cache->count == INLINE_CACHE_SIZE ? 1 : 0;
+		for (int i = from; i < cache->count; i++) {
+			new_cache->entries[new_cache->count++] = cache->entries[i];
+		}
+		new_cache->misses = cache->misses + 1;
+	}
+
+	InlineCacheEntry &entry = new_cache->entries[new_cache->count++];
+	bool resolved = _resolve_inline_cache_entry(p_kind, p_object, instance, p_name, entry);
+
+	if (atomic_compare_exchange_ptr((void **)&_inline_caches_ptr[p_slot], cache, new_cache) != cache) {
+		//another thread replaced it first, skip the cache this time
+		memdelete(new_cache);
+		return NULL;
+	}
+
+	if (cache) {
+		//other threads may still be reading it, keep it alive until no other frame runs this function
+		InlineCache *retired;
+		do {
+			retired = _retired_inline_caches;
+			cache->retired_next = retired;
+		} while (atomic_compare_exchange_ptr((void **)&_retired_inline_caches, retired, cache) != retired);
+	}
+
+	return resolved ? &entry : NULL;
+}
+
+void GDFunction::_reclaim_retired_inline_caches() {
+
+	//detach the list, caches retired after this wait for a later call
+	InlineCache *retired;
+	do {
+		retired = _retired_inline_caches;
+	} while (atomic_compare_exchange_ptr((void **)&_retired_inline_caches, retired, NULL) != retired);
+
+	if (!retired)
+		return;
+
+	atomic_memory_barrier();
+
+	if (_running == 1) {
+		//no other frame is running, and new ones only see the published caches
+		while (retired) {
+			InlineCache *next = retired->retired_next;
+			memdelete(retired);
+			retired = next;
+		}
+		return;
+	}
+
+	//a frame that started meanwhile may still be reading one of them, give the list back
+	InlineCache *tail = retired;
+	while (tail->retired_next)
+		tail = tail->retired_next;
+
+	InlineCache *current;
+	do {
+		current = _retired_inline_caches;
+		tail->retired_next = current;
+	} while (atomic_compare_exchange_ptr((void **)&_retired_inline_caches, current, retired) != current);
+}
+
 static String _get_var_type(const Variant *p_type) {
 
 	String basestr;
@@ -161,6 +337,232 @@ static String _get_var_type(const Variant *p_type) {
 	return basestr;
 }
 
+#if defined(__GNUC__)
+//GCC and Clang support taking the address of labels, so every opcode can jump
+//straight to the next one instead of going back through a switch
+#define GD_COMPUTED_GOTO
+#endif
+
+#ifdef GD_COMPUTED_GOTO
+
+//must follow the order of GDFunction::Opcode
+#define OPCODES_TABLE                            \
+	static const void *switch_table_ops[] = {    \
+		&&OPCODE_OPERATOR,                       \
+		&&OPCODE_OPERATOR_INT,                   \
+		&&OPCODE_OPERATOR_REAL,                  \
+		&&OPCODE_OPERATOR_VECTOR2,               \
+		&&OPCODE_OPERATOR_VECTOR3,               \
+		&&OPCODE_EXTENDS_TEST,                   \
+		&&OPCODE_SET,                            \
+		&&OPCODE_GET,                            \
+		&&OPCODE_SET_NAMED,                      \
+		&&OPCODE_GET_NAMED,                      \
+		&&OPCODE_SET_MEMBER,                     \
+		&&OPCODE_GET_MEMBER,                     \
+		&&OPCODE_ASSIGN,                         \
+		&&OPCODE_ASSIGN_TRUE,                    \
+		&&OPCODE_ASSIGN_FALSE,                   \
+		&&OPCODE_CONSTRUCT,                      \
+		&&OPCODE_CONSTRUCT_ARRAY,                \
+		&&OPCODE_CONSTRUCT_DICTIONARY,           \
+		&&OPCODE_CALL,                           \
+		&&OPCODE_CALL_RETURN,                    \
+		&&OPCODE_CALL_BUILT_IN,                  \
+		&&OPCODE_CALL_SELF,                      \
+		&&OPCODE_CALL_SELF_BASE,                 \
+		&&OPCODE_YIELD,                          \
+		&&OPCODE_YIELD_SIGNAL,                   \
+		&&OPCODE_YIELD_RESUME,                   \
+		&&OPCODE_JUMP,                           \
+		&&OPCODE_JUMP_IF,                        \
+		&&OPCODE_JUMP_IF_NOT,                    \
+		&&OPCODE_JUMP_TO_DEF_ARGUMENT,           \
+		&&OPCODE_RETURN,                         \
+		&&OPCODE_ITERATE_BEGIN,                  \
+		&&OPCODE_ITERATE,                        \
+		&&OPCODE_ASSERT,                         \
+		&&OPCODE_BREAKPOINT,                     \
+		&&OPCODE_LINE,                           \
+		&&OPCODE_END                             \
+	}
+
+#define OPCODE(m_op) \
+	m_op:
+#define OPCODE_WHILE(m_test)
+#define OPCODE_SWITCH(m_test) DISPATCH_OPCODE;
+#define DISPATCH_OPCODE goto *switch_table_ops[last_opcode = _code_ptr[ip]]
+#define OPCODE_BREAK goto OPSEXIT
+#define OPCODE_OUT goto OPSOUT
+#define OPCODES_END \
+	OPSEXIT:
+#define OPCODES_OUT \
+	OPSOUT:
+
+#else
+
+#define OPCODES_TABLE
+#define OPCODE(m_op) case m_op:
+#define OPCODE_WHILE(m_test) while (m_test)
+#define OPCODE_SWITCH(m_test) switch (m_test)
+#define DISPATCH_OPCODE continue
+#define OPCODE_BREAK break
+#define OPCODE_OUT break
+#define OPCODES_END
+#define OPCODES_OUT
+
+#endif
+
+//same as ERR_BREAK, but leaves the opcode instead of the innermost loop
+#define GD_ERR_BREAK(m_cond)                                                                                           \
+	{                                                                                                                  \
+		if (m_cond) {                                                                                                  \
+			_err_print_error(FUNCTION_STR, __FILE__, __LINE__, "Condition ' " _STR(m_cond) " ' is true. Breaking..:"); \
+			OPCODE_BREAK;                                                                                              \
+		} else                                                                                                         \
+			_err_error_exists = false;                                                                                 \
+	}
+
+//types up to REAL own no memory, so the destination can be overwritten in place
+#define GD_SET_VALUE(m_dst, m_type, m_member, m_value) \
+	if (m_dst->type <= Variant::REAL) {                \
+		m_dst->type = m_type;                          \
+		m_dst->_data.m_member = m_value;               \
+	} else {                                           \
+		*m_dst = m_value;                              \
+	}
+
+#define GD_SET_LOCALMEM(m_dst, m_type, m_class, m_value)             \
+	if (m_dst->type <= Variant::REAL || m_dst->type == m_type) {     \
+		m_dst->type = m_type;                                        \
+		*reinterpret_cast<m_class *>(m_dst->_data._mem) = m_value;   \
+	} else {                                                         \
+		*m_dst = m_value;                                            \
+	}
+
+#define GD_IS_NUMBER(m_v) ((m_v)->type == Variant::INT || (m_v)->type == Variant::REAL)
+#define GD_NUMBER(m_v) ((m_v)->type == Variant::INT ? double((m_v)->_data._int) : (m_v)->_data._real)
+
+bool GDFunction::_evaluate_int(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	int64_t a = p_a->_data._int;
+	int64_t b = p_b->_data._int;
+	int64_t r;
+
+	switch (p_op) {
+
+		case Variant::OP_ADD: r = a + b; break;
+		case Variant::OP_SUBSTRACT: r = a - b; break;
+		case Variant::OP_MULTIPLY: r = a * b; break;
+		case Variant::OP_DIVIDE: {
+			if (b == 0)
+				return false; //let the generic path report it
+			r = a / b;
+		} break;
+		case Variant::OP_MODULE: {
+			if (b == 0)
+				return false;
+			r = a % b;
+		} break;
+		case Variant::OP_SHIFT_LEFT: r = a << b; break;
+		case Variant::OP_SHIFT_RIGHT: r = a >> b; break;
+		case Variant::OP_BIT_AND: r = a & b; break;
+		case Variant::OP_BIT_OR: r = a | b; break;
+		case Variant::OP_BIT_XOR: r = a ^ b; break;
+		case Variant::OP_NEGATE: r = -a; break;
+		case Variant::OP_POSITIVE: r = a; break;
+		case Variant::OP_BIT_NEGATE: r = ~a; break;
+		case Variant::OP_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a == b) return true;
+		case Variant::OP_NOT_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a != b) return true;
+		case Variant::OP_LESS: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a < b) return true;
+		case Variant::OP_LESS_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a <= b) return true;
+		case Variant::OP_GREATER: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a > b) return true;
+		case Variant::OP_GREATER_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a >= b) return true;
+		default: return false;
+	}
+
+	GD_SET_VALUE(r_dst, Variant::INT, _int, r)
+	return true;
+}
+
+bool GDFunction::_evaluate_real(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	double a = GD_NUMBER(p_a);
+	double b = GD_NUMBER(p_b);
+	double r;
+
+	switch (p_op) {
+
+		case Variant::OP_ADD: r = a + b; break;
+		case Variant::OP_SUBSTRACT: r = a - b; break;
+		case Variant::OP_MULTIPLY: r = a * b; break;
+		case Variant::OP_DIVIDE: r = a / b; break;
+		case Variant::OP_NEGATE: r = -a; break;
+		case Variant::OP_POSITIVE: r = a; break;
+		case Variant::OP_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a == b) return true;
+		case Variant::OP_NOT_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a != b) return true;
+		case Variant::OP_LESS: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a < b) return true;
+		case Variant::OP_LESS_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a <= b) return true;
+		case Variant::OP_GREATER: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a > b) return true;
+		case Variant::OP_GREATER_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a >= b) return true;
+		default: return false;
+	}
+
+	GD_SET_VALUE(r_dst, Variant::REAL, _real, r)
+	return true;
+}
+
+#define GD_EVALUATE_VECTOR(m_type, m_class)                                                                       \
+	if (p_a->type == m_type && p_b->type == m_type) {                                                             \
+                                                                                                                  \
+		const m_class &a = *reinterpret_cast<const m_class *>(p_a->_data._mem);                                  \
+		const m_class &b = *reinterpret_cast<const m_class *>(p_b->_data._mem);                                  \
+                                                                                                                  \
+		switch (p_op) {                                                                                           \
+			case Variant::OP_ADD: GD_SET_LOCALMEM(r_dst, m_type, m_class, a + b) return true;                     \
+			case Variant::OP_SUBSTRACT: GD_SET_LOCALMEM(r_dst, m_type, m_class, a - b) return true;               \
+			case Variant::OP_MULTIPLY: GD_SET_LOCALMEM(r_dst, m_type, m_class, a * b) return true;                \
+			case Variant::OP_DIVIDE: GD_SET_LOCALMEM(r_dst, m_type, m_class, a / b) return true;                  \
+			case Variant::OP_NEGATE: GD_SET_LOCALMEM(r_dst, m_type, m_class, -a) return true;                     \
+			case Variant::OP_POSITIVE: GD_SET_LOCALMEM(r_dst, m_type, m_class, a) return true;                    \
+			case Variant::OP_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a == b) return true;                \
+			case Variant::OP_NOT_EQUAL: GD_SET_VALUE(r_dst, Variant::BOOL, _bool, a != b) return true;            \
+			default: return false;                                                                                \
+		}                                                                                                         \
+	}                                                                                                             \
+                                                                                                                  \
+	if (p_a->type == m_type && GD_IS_NUMBER(p_b)) {                                                               \
+                                                                                                                  \
+		const m_class &a = *reinterpret_cast<const m_class *>(p_a->_data._mem);                                  \
+		real_t b = GD_NUMBER(p_b);                                                                                \
+                                                                                                                  \
+		switch (p_op) {                                                                                           \
+			case Variant::OP_MULTIPLY: GD_SET_LOCALMEM(r_dst, m_type, m_class, a * b) return true;                \
+			case Variant::OP_DIVIDE: GD_SET_LOCALMEM(r_dst, m_type, m_class, a / b) return true;                  \
+			default: return false;                                                                                \
+		}                                                                                                         \
+	}                                                                                                             \
+                                                                                                                  \
+	if (p_op == Variant::OP_MULTIPLY && GD_IS_NUMBER(p_a) && p_b->type == m_type) {                               \
+                                                                                                                  \
+		real_t a = GD_NUMBER(p_a);                                                                                \
+		const m_class &b = *reinterpret_cast<const m_class *>(p_b->_data._mem);                                  \
+		GD_SET_LOCALMEM(r_dst, m_type, m_class, b * a)                                                            \
+		return true;                                                                                              \
+	}                                                                                                             \
+                                                                                                                  \
+	return false;
+
+bool GDFunction::_evaluate_vector2(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	GD_EVALUATE_VECTOR(Variant::VECTOR2, Vector2)
+}
+
+bool GDFunction::_evaluate_vector3(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst) {
+
+	GD_EVALUATE_VECTOR(Variant::VECTOR3, Vector3)
+}
+
 Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state) {
 
 	if (!_code_ptr) {
@@ -266,19 +668,23 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 	String err_text;
 
+	//a frame that just started holds no inline cache, so when it is the only one nothing retired is in use
+	if (atomic_increment(&_running) == 1 && _retired_inline_caches)
+		_reclaim_retired_inline_caches();
+
 #ifdef DEBUG_ENABLED
 
 	if (ScriptDebugger::get_singleton())
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 
 #define CHECK_SPACE(m_space) \
-	ERR_BREAK((ip + m_space) > _code_size)
+	GD_ERR_BREAK((ip + m_space) > _code_size)
 
 #define GET_VARIANT_PTR(m_v, m_code_ofs)                                                       \
 	Variant *m_v;                                                                              \
 	m_v = _get_variant(_code_ptr[ip + m_code_ofs], p_instance, _class, self, stack, err_text); \
 	if (!m_v)                                                                                  \
-		break;
+		OPCODE_BREAK;
 
 #else
 #define CHECK_SPACE(m_space)
@@ -301,19 +707,22 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 	}
 #endif
 	bool exit_ok = false;
+	int last_opcode = OPCODE_END;
+
+	OPCODES_TABLE;
 
-	while (ip < _code_size) {
+	OPCODE_WHILE(ip < _code_size) {
 
-		int last_opcode = _code_ptr[ip];
-		switch (_code_ptr[ip]) {
+		OPCODE_SWITCH(last_opcode = _code_ptr[ip]) {
 
-			case OPCODE_OPERATOR: {
+			OPCODE(OPCODE_OPERATOR) {
+			operator_generic:
 
 				CHECK_SPACE(5);
 
 				bool valid;
 				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
-				ERR_BREAK(op >= Variant::OP_MAX);
+				GD_ERR_BREAK(op >= Variant::OP_MAX);
 
 				GET_VARIANT_PTR(a, 2);
 				GET_VARIANT_PTR(b, 3);
@@ -337,16 +746,76 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						err_text = "Invalid operands '" + Variant::get_type_name(a->get_type()) + "' and '" + Variant::get_type_name(b->get_type()) + "' in operator '" + Variant::get_operator_name(op) + "'.";
 					}
 #endif
-					break;
+					OPCODE_BREAK;
 				}
 #ifdef DEBUG_ENABLED
 				*dst = ret;
 #endif
 
 				ip += 5;
-				continue;
+				DISPATCH_OPCODE;
+			}
+			OPCODE(OPCODE_OPERATOR_INT) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (a->type == Variant::INT && b->type == Variant::INT && _evaluate_int(op, a, b, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+				goto operator_generic;
+			}
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (GD_IS_NUMBER(a) && GD_IS_NUMBER(b) && (a->type == Variant::REAL || b->type == Variant::REAL) && _evaluate_real(op, a, b, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+				goto operator_generic;
 			}
-			case OPCODE_EXTENDS_TEST: {
+			OPCODE(OPCODE_OPERATOR_VECTOR2) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (_evaluate_vector2(op, a, b, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+				goto operator_generic;
+			}
+			OPCODE(OPCODE_OPERATOR_VECTOR3) {
+
+				CHECK_SPACE(5);
+
+				Variant::Operator op = (Variant::Operator)_code_ptr[ip + 1];
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+				GET_VARIANT_PTR(dst, 4);
+
+				if (_evaluate_vector3(op, a, b, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+				goto operator_generic;
+			}
+			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
 
@@ -359,12 +828,12 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (a->get_type() != Variant::OBJECT || a->operator Object *() == NULL) {
 
 					err_text = "Left operand of 'extends' is not an instance of anything.";
-					break;
+					OPCODE_BREAK;
 				}
 				if (b->get_type() != Variant::OBJECT || b->operator Object *() == NULL) {
 
 					err_text = "Right operand of 'extends' is not a class.";
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 
@@ -402,7 +871,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					if (!nc) {
 
 						err_text = "Right operand of 'extends' is not a class (type: '" + obj_B->get_class() + "').";
-						break;
+						OPCODE_BREAK;
 					}
 
 					extends_ok = ClassDB::is_parent_class(obj_A->get_class_name(), nc->get_name());
@@ -410,9 +879,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				*dst = extends_ok;
 				ip += 4;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_SET: {
+			OPCODE(OPCODE_SET) {
 
 				CHECK_SPACE(3);
 
@@ -431,13 +900,13 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v = "of type '" + _get_var_type(index) + "'";
 					}
 					err_text = "Invalid set index " + v + " (on base: '" + _get_var_type(dst) + "').";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip += 4;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_GET: {
+			OPCODE(OPCODE_GET) {
 
 				CHECK_SPACE(3);
 
@@ -461,51 +930,91 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v = "of type '" + _get_var_type(index) + "'";
 					}
 					err_text = "Invalid get index " + v + " (on base: '" + _get_var_type(src) + "').";
-					break;
+					OPCODE_BREAK;
 				}
 #ifdef DEBUG_ENABLED
 				*dst = ret;
 #endif
 				ip += 4;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_SET_NAMED: {
+			OPCODE(OPCODE_SET_NAMED) {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(value, 3);
 
 				int indexname = _code_ptr[ip + 2];
+				int cache_slot = _code_ptr[ip + 4];
 
-				ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
+				GD_ERR_BREAK(cache_slot < 0 || cache_slot >= _inline_cache_count);
 
 				bool valid;
-				dst->set_named(*index, *value, &valid);
+				Object *obj = _get_cacheable_object(dst);
+				const InlineCacheEntry *cached = obj ? _get_inline_cache(cache_slot, INLINE_CACHE_SET, obj, *index) : NULL;
+
+				if (cached) {
+#ifdef TOOLS_ENABLED
+					obj->_mark_edited();
+#endif
+					if (cached->member_index >= 0) {
+						static_cast<GDInstance *>(obj->get_script_instance())->members[cached->member_index] = *value;
+						valid = true;
+					} else {
+						Variant::CallError ce;
+						const Variant *args[1] = { value };
+						obj->call_method_bind(cached->method, args, 1, NULL, ce);
+						valid = ce.error == Variant::CallError::CALL_OK;
+					}
+				} else {
+					dst->set_named(*index, *value, &valid);
+				}
 
 				if (!valid) {
 					String err_type;
 					err_text = "Invalid set index '" + String(*index) + "' (on base: '" + _get_var_type(dst) + "').";
-					break;
+					OPCODE_BREAK;
 				}
 
-				ip += 4;
-				continue;
+				ip += 5;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_GET_NAMED: {
+			OPCODE(OPCODE_GET_NAMED) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(src, 1);
-				GET_VARIANT_PTR(dst, 3);
+				GET_VARIANT_PTR(dst, 4);
 
 				int indexname = _code_ptr[ip + 2];
+				int cache_slot = _code_ptr[ip + 3];
 
-				ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
+				GD_ERR_BREAK(cache_slot < 0 || cache_slot >= _inline_cache_count);
 
 				bool valid;
+				Object *obj = _get_cacheable_object(src);
+				const InlineCacheEntry *cached = obj ? _get_inline_cache(cache_slot, INLINE_CACHE_GET, obj, *index) : NULL;
+
+				if (cached) {
+
+					//src may be the only reference to obj and share the stack position with dst, so dst is written last
+					Variant ret;
+					if (cached->member_index >= 0) {
+						ret = static_cast<GDInstance *>(obj->get_script_instance())->members[cached->member_index];
+					} else {
+						Variant::CallError ce;
+						obj->call_method_bind(cached->method, NULL, 0, &ret, ce);
+					}
+					*dst = ret;
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
 				Variant ret = src->get_named(*index, &valid);
@@ -520,55 +1029,82 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					} else {
 						err_text = "Invalid get index '" + index->operator String() + "' (on base: '" + _get_var_type(src) + "').";
 					}
-					break;
+					OPCODE_BREAK;
 				}
 #ifdef DEBUG_ENABLED
 				*dst = ret;
 #endif
-				ip += 4;
-				continue;
+				ip += 5;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_SET_MEMBER: {
+			OPCODE(OPCODE_SET_MEMBER) {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 				int indexname = _code_ptr[ip + 1];
-				ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 				GET_VARIANT_PTR(src, 2);
+				int cache_slot = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_slot < 0 || cache_slot >= _inline_cache_count);
 
 				bool valid;
-				bool ok = ClassDB::set_property(p_instance->owner, *index, *src, &valid);
+				bool ok;
+				const InlineCacheEntry *cached = _get_inline_cache(cache_slot, INLINE_CACHE_SET_NATIVE, p_instance->owner, *index);
+
+				if (cached) {
+					Variant::CallError ce;
+					const Variant *args[1] = { src };
+					p_instance->owner->call_method_bind(cached->method, args, 1, NULL, ce);
+					ok = true;
+					valid = ce.error == Variant::CallError::CALL_OK;
+				} else {
+					ok = ClassDB::set_property(p_instance->owner, *index, *src, &valid);
+				}
 #ifdef DEBUG_ENABLED
 				if (!ok) {
 					err_text = "Internal error setting property: " + String(*index);
-					break;
+					OPCODE_BREAK;
 				} else if (!valid) {
 					err_text = "Error setting property '" + String(*index) + "' with value of type " + Variant::get_type_name(src->get_type()) + ".";
-					break;
+					OPCODE_BREAK;
 				}
 #endif
-				ip += 3;
-				continue;
+				ip += 4;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_GET_MEMBER: {
+			OPCODE(OPCODE_GET_MEMBER) {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 				int indexname = _code_ptr[ip + 1];
-				ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
-				GET_VARIANT_PTR(dst, 2);
-				bool ok = ClassDB::get_property(p_instance->owner, *index, *dst);
+				int cache_slot = _code_ptr[ip + 2];
+				GD_ERR_BREAK(cache_slot < 0 || cache_slot >= _inline_cache_count);
+				GET_VARIANT_PTR(dst, 3);
+
+				bool ok;
+				const InlineCacheEntry *cached = _get_inline_cache(cache_slot, INLINE_CACHE_GET_NATIVE, p_instance->owner, *index);
+
+				if (cached) {
+					Variant::CallError ce;
+					p_instance->owner->call_method_bind(cached->method, NULL, 0, dst, ce);
+					if (ce.error != Variant::CallError::CALL_OK)
+						*dst = Variant();
+					ok = true;
+				} else {
+					ok = ClassDB::get_property(p_instance->owner, *index, *dst);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!ok) {
 					err_text = "Internal error getting property: " + String(*index);
-					break;
+					OPCODE_BREAK;
 				}
 #endif
-				ip += 3;
-				continue;
+				ip += 4;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_ASSIGN: {
+			OPCODE(OPCODE_ASSIGN) {
 
 				CHECK_SPACE(3);
 				GET_VARIANT_PTR(dst, 1);
@@ -577,9 +1113,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = *src;
 
 				ip += 3;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_ASSIGN_TRUE: {
+			OPCODE(OPCODE_ASSIGN_TRUE) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst, 1);
@@ -587,9 +1123,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = true;
 
 				ip += 2;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_ASSIGN_FALSE: {
+			OPCODE(OPCODE_ASSIGN_FALSE) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst, 1);
@@ -597,9 +1133,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = false;
 
 				ip += 2;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CONSTRUCT: {
+			OPCODE(OPCODE_CONSTRUCT) {
 
 				CHECK_SPACE(2);
 				Variant::Type t = Variant::Type(_code_ptr[ip + 1]);
@@ -618,14 +1154,14 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (err.error != Variant::CallError::CALL_OK) {
 
 					err_text = _get_call_error(err, "'" + Variant::get_type_name(t) + "' constructor", (const Variant **)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip += 4 + argc;
 				//construct a basic type
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CONSTRUCT_ARRAY: {
+			OPCODE(OPCODE_CONSTRUCT_ARRAY) {
 
 				CHECK_SPACE(1);
 				int argc = _code_ptr[ip + 1];
@@ -643,9 +1179,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = array;
 
 				ip += 3 + argc;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CONSTRUCT_DICTIONARY: {
+			OPCODE(OPCODE_CONSTRUCT_DICTIONARY) {
 
 				CHECK_SPACE(1);
 				int argc = _code_ptr[ip + 1];
@@ -665,23 +1201,25 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = dict;
 
 				ip += 3 + argc * 2;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CALL_RETURN:
-			case OPCODE_CALL: {
+			OPCODE(OPCODE_CALL_RETURN)
+			OPCODE(OPCODE_CALL) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
 
 				int argc = _code_ptr[ip + 1];
 				GET_VARIANT_PTR(base, 2);
 				int nameg = _code_ptr[ip + 3];
+				int cache_slot = _code_ptr[ip + 4];
 
-				ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
-				ERR_BREAK(argc < 0);
-				ip += 4;
+				GD_ERR_BREAK(cache_slot < 0 || cache_slot >= _inline_cache_count);
+				GD_ERR_BREAK(argc < 0);
+				ip += 5;
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -699,13 +1237,36 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 #endif
 				Variant::CallError err;
+				Variant *ret = NULL;
 				if (call_ret) {
 
-					GET_VARIANT_PTR(ret, argc);
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+					GET_VARIANT_PTR(retptr, argc);
+					ret = retptr;
+				}
+
+				Object *obj = _get_cacheable_object(base);
+				const InlineCacheEntry *cached = obj ? _get_inline_cache(cache_slot, INLINE_CACHE_CALL, obj, *methodname) : NULL;
+
+				if (cached) {
+
+					obj->call_method_bind(cached->method, (const Variant **)argptrs, argc, ret, err);
+				} else if (base->get_type() != Variant::OBJECT) {
+
+					//the same site may see different types, so check the method still belongs to this one
+					const Variant::BuiltinMethod *builtin = _builtin_caches_ptr[cache_slot];
+					if (!builtin || Variant::get_builtin_method_base_type(builtin) != base->get_type()) {
+						builtin = Variant::get_builtin_method(base->get_type(), *methodname);
+						_builtin_caches_ptr[cache_slot] = builtin;
+					}
+
+					if (builtin) {
+						base->call_builtin(builtin, (const Variant **)argptrs, argc, ret, err);
+					} else {
+						base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
+					}
 				} else {
 
-					base->call_ptr(*methodname, (const Variant **)argptrs, argc, NULL, err);
+					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -731,29 +1292,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 							if (base->is_ref()) {
 								err_text = "Attempted to free a reference.";
-								break;
+								OPCODE_BREAK;
 							} else if (base->get_type() == Variant::OBJECT) {
 
 								err_text = "Attempted to free a locked object (calling or emitting).";
-								break;
+								OPCODE_BREAK;
 							}
 						}
 					}
 					err_text = _get_call_error(err, "function '" + methodstr + "' in base '" + basestr + "'", (const Variant **)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
 				ip += argc + 1;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CALL_BUILT_IN: {
+			OPCODE(OPCODE_CALL_BUILT_IN) {
 
 				CHECK_SPACE(4);
 
 				GDFunctions::Function func = GDFunctions::Function(_code_ptr[ip + 1]);
 				int argc = _code_ptr[ip + 2];
-				ERR_BREAK(argc < 0);
+				GD_ERR_BREAK(argc < 0);
 
 				ip += 3;
 				CHECK_SPACE(argc + 1);
@@ -779,16 +1340,16 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					} else {
 						err_text = _get_call_error(err, "built-in function '" + methodstr + "'", (const Variant **)argptrs);
 					}
-					break;
+					OPCODE_BREAK;
 				}
 				ip += argc + 1;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_CALL_SELF: {
+			OPCODE(OPCODE_CALL_SELF) {
 
-				break;
+				OPCODE_BREAK;
 			}
-			case OPCODE_CALL_SELF_BASE: {
+			OPCODE(OPCODE_CALL_SELF_BASE) {
 
 				CHECK_SPACE(2);
 				int self_fun = _code_ptr[ip + 1];
@@ -797,7 +1358,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (self_fun < 0 || self_fun >= _global_names_count) {
 
 					err_text = "compiler bug, function name not found";
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				const StringName *methodname = &_global_names_ptr[self_fun];
@@ -857,14 +1418,14 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					String methodstr = *methodname;
 					err_text = _get_call_error(err, "function '" + methodstr + "'", (const Variant **)argptrs);
 
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip += 4 + argc;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_YIELD:
-			case OPCODE_YIELD_SIGNAL: {
+			OPCODE(OPCODE_YIELD)
+			OPCODE(OPCODE_YIELD_SIGNAL) {
 
 				int ipofs = 1;
 				if (_code_ptr[ip] == OPCODE_YIELD_SIGNAL) {
@@ -904,11 +1465,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					if (argobj->get_type() != Variant::OBJECT) {
 						err_text = "First argument of yield() not of type object.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (argname->get_type() != Variant::STRING) {
 						err_text = "Second argument of yield() not a string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
 					Object *obj = argobj->operator Object *();
 					String signal = argname->operator String();
@@ -916,53 +1477,53 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					if (!obj) {
 						err_text = "First argument of yield() is null.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (ScriptDebugger::get_singleton()) {
 						if (!ObjectDB::instance_validate(obj)) {
 							err_text = "First argument of yield() is a previously freed instance.";
-							break;
+							OPCODE_BREAK;
 						}
 					}
 					if (signal.length() == 0) {
 
 						err_text = "Second argument of yield() is an empty string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
 
 #endif
 					Error err = obj->connect(signal, gdfs.ptr(), "_signal_callback", varray(gdfs), Object::CONNECT_ONESHOT);
 					if (err != OK) {
 						err_text = "Error connecting to signal: " + signal + " during yield().";
-						break;
+						OPCODE_BREAK;
 					}
 				}
 
 				exit_ok = true;
-				break;
+				OPCODE_BREAK;
 			}
-			case OPCODE_YIELD_RESUME: {
+			OPCODE(OPCODE_YIELD_RESUME) {
 
 				CHECK_SPACE(2);
 				if (!p_state) {
 					err_text = ("Invalid Resume (bug?)");
-					break;
+					OPCODE_BREAK;
 				}
 				GET_VARIANT_PTR(result, 1);
 				*result = p_state->result;
 				ip += 2;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_JUMP: {
+			OPCODE(OPCODE_JUMP) {
 
 				CHECK_SPACE(2);
 				int to = _code_ptr[ip + 1];
 
-				ERR_BREAK(to < 0 || to > _code_size);
+				GD_ERR_BREAK(to < 0 || to > _code_size);
 				ip = to;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_JUMP_IF: {
+			OPCODE(OPCODE_JUMP_IF) {
 
 				CHECK_SPACE(3);
 
@@ -974,19 +1535,19 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text = "cannot evaluate conditional expression of type: " + Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (result) {
 					int to = _code_ptr[ip + 2];
-					ERR_BREAK(to < 0 || to > _code_size);
+					GD_ERR_BREAK(to < 0 || to > _code_size);
 					ip = to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip += 3;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_JUMP_IF_NOT: {
+			OPCODE(OPCODE_JUMP_IF_NOT) {
 
 				CHECK_SPACE(3);
 
@@ -998,33 +1559,33 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text = "cannot evaluate conditional expression of type: " + Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (!result) {
 					int to = _code_ptr[ip + 2];
-					ERR_BREAK(to < 0 || to > _code_size);
+					GD_ERR_BREAK(to < 0 || to > _code_size);
 					ip = to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip += 3;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_JUMP_TO_DEF_ARGUMENT: {
+			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 
 				CHECK_SPACE(2);
 				ip = _default_arg_ptr[defarg];
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_RETURN: {
+			OPCODE(OPCODE_RETURN) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(r, 1);
 				retvalue = *r;
 				exit_ok = true;
-				break;
+				OPCODE_BREAK;
 			}
-			case OPCODE_ITERATE_BEGIN: {
+			OPCODE(OPCODE_ITERATE_BEGIN) {
 
 				CHECK_SPACE(8); //space for this an regular iterate
 
@@ -1035,25 +1596,25 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!container->iter_init(*counter, valid)) {
 					if (!valid) {
 						err_text = "Unable to iterate on object of type  " + Variant::get_type_name(container->get_type()) + "'.";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto = _code_ptr[ip + 3];
-					ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
 					ip = jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator, 4);
 
 				*iterator = container->iter_get(*counter, valid);
 				if (!valid) {
 					err_text = "Unable to obtain iterator object of type  " + Variant::get_type_name(container->get_type()) + "'.";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip += 5; //skip regular iterate which is always next
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_ITERATE: {
+			OPCODE(OPCODE_ITERATE) {
 
 				CHECK_SPACE(4);
 
@@ -1064,25 +1625,25 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!container->iter_next(*counter, valid)) {
 					if (!valid) {
 						err_text = "Unable to iterate on object of type  " + Variant::get_type_name(container->get_type()) + "' (type changed since first iteration?).";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto = _code_ptr[ip + 3];
-					ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
 					ip = jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator, 4);
 
 				*iterator = container->iter_get(*counter, valid);
 				if (!valid) {
 					err_text = "Unable to obtain iterator object of type  " + Variant::get_type_name(container->get_type()) + "' (but was obtained on first iteration?).";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip += 5; //loop again
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_ASSERT: {
+			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(test, 1);
 
@@ -1093,30 +1654,30 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text = "cannot evaluate conditional expression of type: " + Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 
 				if (!result) {
 
 					err_text = "Assertion failed.";
-					break;
+					OPCODE_BREAK;
 				}
 
 #endif
 
 				ip += 2;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_BREAKPOINT: {
+			OPCODE(OPCODE_BREAKPOINT) {
 #ifdef DEBUG_ENABLED
 				if (ScriptDebugger::get_singleton()) {
 					GDScriptLanguage::get_singleton()->debug_break("Breakpoint Statement", true);
 				}
 #endif
 				ip += 1;
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_LINE: {
+			OPCODE(OPCODE_LINE) {
 				CHECK_SPACE(2);
 
 				line = _code_ptr[ip + 1];
@@ -1143,22 +1704,26 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					ScriptDebugger::get_singleton()->line_poll();
 				}
-				continue;
+				DISPATCH_OPCODE;
 			}
-			case OPCODE_END: {
+			OPCODE(OPCODE_END) {
 
 				exit_ok = true;
-				break;
+				OPCODE_BREAK;
 			}
+#ifndef GD_COMPUTED_GOTO
 			default: {
 
 				err_text = "Illegal opcode " + itos(_code_ptr[ip]) + " at address " + itos(ip);
-				break;
+				OPCODE_BREAK;
 			}
+#endif
 		}
 
+		OPCODES_END;
+
 		if (exit_ok)
-			break;
+			OPCODE_OUT;
 		//error
 		// function, file, line, error, explanation
 		String err_file;
@@ -1182,9 +1747,11 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 			_err_print_error(err_func.utf8().get_data(), err_file.utf8().get_data(), err_line, err_text.utf8().get_data(), ERR_HANDLER_SCRIPT);
 		}
 
-		break;
+		OPCODE_OUT;
 	}
 
+	OPCODES_OUT;
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->profiling) {
 		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
@@ -1205,6 +1772,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 			stack[i].~Variant();
 	}
 
+	atomic_decrement(&_running);
+
 	return retvalue;
 }
 
@@ -1340,6 +1909,11 @@ GDFunction::GDFunction()
 
 	_stack_size = 0;
 	_call_size = 0;
+	_inline_caches_ptr = NULL;
+	_inline_cache_count = 0;
+	_retired_inline_caches = NULL;
+	_running = 0;
+	_builtin_caches_ptr = NULL;
 	rpc_mode = ScriptInstance::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1368,6 +1942,18 @@ GDFunction::GDFunction()
 }
 
 GDFunction::~GDFunction() {
+
+	for (int i = 0; i < _inline_cache_count; i++) {
+		if (_inline_caches_ptr[i])
+			memdelete(_inline_caches_ptr[i]);
+	}
+
+	while (_retired_inline_caches) {
+		InlineCache *next = _retired_inline_caches->retired_next;
+		memdelete(_retired_inline_caches);
+		_retired_inline_caches = next;
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
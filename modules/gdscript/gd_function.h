@@ -45,6 +45,10 @@ class GDFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT, // operands expected to be int, falls back to OPCODE_OPERATOR when they are not
+		OPCODE_OPERATOR_REAL, // operands expected to be float, or int and float
+		OPCODE_OPERATOR_VECTOR2, // operands expected to be Vector2, or Vector2 and a number
+		OPCODE_OPERATOR_VECTOR3, // operands expected to be Vector3, or Vector3 and a number
 		OPCODE_EXTENDS_TEST,
 		OPCODE_SET,
 		OPCODE_GET,
@@ -133,11 +137,51 @@ private:
 
 	GDScript *_script;
 
+	enum InlineCacheKind {
+		INLINE_CACHE_CALL, //method called through Object::call
+		INLINE_CACHE_GET, //property read through Object::get
+		INLINE_CACHE_SET, //property written through Object::set
+		INLINE_CACHE_GET_NATIVE, //property of the owner read through ClassDB
+		INLINE_CACHE_SET_NATIVE //property of the owner written through ClassDB
+	};
+
+	enum {
+		INLINE_CACHE_SIZE = 4, //classes remembered per instruction
+		INLINE_CACHE_MAX_MISSES = 8 //instructions missing more than this stop caching
+	};
+
+	//what an instruction resolved to for one class and script
+	struct InlineCacheEntry {
+
+		StringName class_name;
+		GDScript *script;
+		MethodBind *method; //method to call, or property setter/getter
+		int member_index; //script member accessed directly, -1 when using the method
+	};
+
+	//never modified once published, replaced as a whole when an instruction sees a new class
+	struct InlineCache {
+
+		uint32_t epoch;
+		uint32_t misses;
+		int count;
+		InlineCacheEntry entries[INLINE_CACHE_SIZE];
+		InlineCache *retired_next;
+	};
+
+	InlineCache **_inline_caches_ptr;
+	int _inline_cache_count;
+	mutable InlineCache *_retired_inline_caches;
+	uint32_t _running; //frames executing this function on any thread
+	const Variant::BuiltinMethod **_builtin_caches_ptr; //method last resolved by each call site on a builtin type
+
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
 	Vector<int> default_arguments;
 	Vector<int> code;
+	Vector<InlineCache *> inline_caches;
+	Vector<const Variant::BuiltinMethod *> builtin_caches;
 
 #ifdef TOOLS_ENABLED
 	Vector<StringName> arg_names;
@@ -147,6 +191,15 @@ private:
 
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
+	static bool _resolve_inline_cache_entry(InlineCacheKind p_kind, Object *p_object, GDInstance *p_instance, const StringName &p_name, InlineCacheEntry &r_entry);
+	const InlineCacheEntry *_get_inline_cache(int p_slot, InlineCacheKind p_kind, Object *p_object, const StringName &p_name) const;
+	void _reclaim_retired_inline_caches();
+
+	//typed operator fast paths, return false when the generic evaluation must be used instead
+	_FORCE_INLINE_ static bool _evaluate_int(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst);
+	_FORCE_INLINE_ static bool _evaluate_real(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst);
+	_FORCE_INLINE_ static bool _evaluate_vector2(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst);
+	_FORCE_INLINE_ static bool _evaluate_vector3(Variant::Operator p_op, const Variant *p_a, const Variant *p_b, Variant *r_dst);
 
 	friend class GDScriptLanguage;
 
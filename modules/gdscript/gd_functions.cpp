@@ -1150,7 +1150,7 @@ void GDFunctions::call(Function p_func, const Variant **p_args, int p_arg_count,
 				break;
 			}
 
-			uint32_t id = *p_args[0];
+			ObjectID id = *p_args[0];
 			r_ret = ObjectDB::get_instance(id);
 
 		} break;
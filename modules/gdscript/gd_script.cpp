@@ -630,6 +630,7 @@ Error GDScript::reload(bool p_keep_state) {
 
 	GDCompiler compiler;
 	err = compiler.compile(&parser, this, p_keep_state);
+	atomic_increment(&GDScriptLanguage::singleton->inline_cache_epoch); //members and methods may have changed
 
 	if (err) {
 
@@ -949,6 +950,8 @@ GDScript::~GDScript() {
 		E->get()->_owner = NULL; //bye, you are no longer owned cause I died
 	}
 
+	atomic_increment(&GDScriptLanguage::get_singleton()->inline_cache_epoch); //a new script may reuse this address
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -1874,6 +1877,7 @@ GDScriptLanguage::GDScriptLanguage() {
 #endif
 	profiling = false;
 	script_frame_time = 0;
+	inline_cache_epoch = 0;
 
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/script/max_call_stack", 1024);
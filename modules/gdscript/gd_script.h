@@ -290,6 +290,8 @@ class GDScriptLanguage : public ScriptLanguage {
 	bool profiling;
 	uint64_t script_frame_time;
 
+	uint32_t inline_cache_epoch; //bumped whenever a script changes or goes away, invalidating all inline caches
+
 public:
 	int calls;
 
@@ -91,9 +91,17 @@ Error jpeg_load_image_from_buffer(Image *p_image, const uint8_t *p_buffer, int p
 
 Error ImageLoaderJPG::load_image(Image *p_image, FileAccess *f) {
 
-	PoolVector<uint8_t> src_image;
 	int src_image_len = f->get_len();
 	ERR_FAIL_COND_V(src_image_len == 0, ERR_FILE_CORRUPT);
+
+	if (f->get_mapped_data()) {
+		//decode straight from the mapped pack
+		Error err = jpeg_load_image_from_buffer(p_image, f->get_mapped_data(), src_image_len);
+		f->close();
+		return err;
+	}
+
+	PoolVector<uint8_t> src_image;
 	src_image.resize(src_image_len);
 
 	PoolVector<uint8_t>::Write w = src_image.write();
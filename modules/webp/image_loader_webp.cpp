@@ -116,15 +116,25 @@ Error ImageLoaderWEBP::load_image(Image *p_image, FileAccess *f) {
 
 	uint32_t size = f->get_len();
 	PoolVector<uint8_t> src_image;
-	src_image.resize(size);
+	PoolVector<uint8_t>::Read src_r;
 
-	WebPBitstreamFeatures features;
+	//decode straight from the mapped pack when possible
+	const uint8_t *src = f->get_mapped_data();
+
+	if (!src) {
+		src_image.resize(size);
+		PoolVector<uint8_t>::Write src_w = src_image.write();
+		f->get_buffer(src_w.ptr(), size);
+		ERR_FAIL_COND_V(f->eof_reached(), ERR_FILE_EOF);
+		src_w = PoolVector<uint8_t>::Write();
+
+		src_r = src_image.read();
+		src = src_r.ptr();
+	}
 
-	PoolVector<uint8_t>::Write src_w = src_image.write();
-	f->get_buffer(src_w.ptr(), size);
-	ERR_FAIL_COND_V(f->eof_reached(), ERR_FILE_EOF);
+	WebPBitstreamFeatures features;
 
-	if (WebPGetFeatures(src_w.ptr(), size, &features) != VP8_STATUS_OK) {
+	if (WebPGetFeatures(src, size, &features) != VP8_STATUS_OK) {
 		f->close();
 		//ERR_EXPLAIN("Error decoding WEBP image: "+p_file);
 		ERR_FAIL_V(ERR_FILE_CORRUPT);
@@ -134,20 +144,17 @@ Error ImageLoaderWEBP::load_image(Image *p_image, FileAccess *f) {
 	print_line("height: " + itos(features.height));
 	print_line("alpha: " + itos(features.has_alpha));
 
-	src_w = PoolVector<uint8_t>::Write();
-
 	PoolVector<uint8_t> dst_image;
 	int datasize = features.width * features.height * (features.has_alpha ? 4 : 3);
 	dst_image.resize(datasize);
 
-	PoolVector<uint8_t>::Read src_r = src_image.read();
 	PoolVector<uint8_t>::Write dst_w = dst_image.write();
 
 	bool errdec = false;
 	if (features.has_alpha) {
-		errdec = WebPDecodeRGBAInto(src_r.ptr(), size, dst_w.ptr(), datasize, 4 * features.width) == NULL;
+		errdec = WebPDecodeRGBAInto(src, size, dst_w.ptr(), datasize, 4 * features.width) == NULL;
 	} else {
-		errdec = WebPDecodeRGBInto(src_r.ptr(), size, dst_w.ptr(), datasize, 3 * features.width) == NULL;
+		errdec = WebPDecodeRGBInto(src, size, dst_w.ptr(), datasize, 3 * features.width) == NULL;
 	}
 
 	//ERR_EXPLAIN("Error decoding webp! - "+p_file);
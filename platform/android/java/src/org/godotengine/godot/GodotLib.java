@@ -65,7 +65,7 @@ public class GodotLib {
      public static native void singleton(String p_name,Object p_object);
      public static native void method(String p_sname,String p_name,String p_ret,String[] p_params);
      public static native String getGlobal(String p_key);
-	public static native void callobject(int p_ID, String p_method, Object[] p_params);
-	public static native void calldeferred(int p_ID, String p_method, Object[] p_params);
+	public static native void callobject(long p_ID, String p_method, Object[] p_params);
+	public static native void calldeferred(long p_ID, String p_method, Object[] p_params);
 
 }
@@ -29,6 +29,7 @@
 /*************************************************************************/
 #include "thread_jandroid.h"
 
+#include "command_queue_mt.h"
 #include "os/memory.h"
 #include "script_language.h"
 
@@ -50,6 +51,7 @@ void *ThreadAndroid::thread_callback(void *userdata) {
 	t->id = (ID)pthread_self();
 	t->callback(t->user);
 	ScriptServer::thread_exit();
+	CommandQueueMT::thread_exit();
 	return NULL;
 }
 
@@ -177,6 +177,15 @@ Transform2D CanvasItem::get_global_transform_with_canvas() const {
 
 Transform2D CanvasItem::get_global_transform() const {
 
+	SceneTree *tree = is_inside_tree() ? get_tree() : NULL;
+	//the dirty lists are shared with nodes running thread-safe process callbacks
+	MutexLock lock(tree ? tree->_get_threaded_process_lock() : NULL);
+
+	if (tree && tree->canvas_xform_dirty_list.first()) {
+		//a parent may have moved, invalidate before reading
+		tree->_flush_canvas_invalidation();
+	}
+
 	if (global_invalid) {
 
 		const CanvasItem *pi = get_parent_item();
@@ -292,6 +301,12 @@ void CanvasItem::_notification(int p_what) {
 		case NOTIFICATION_EXIT_TREE: {
 			if (xform_change.in_list())
 				get_tree()->xform_change_list.remove(&xform_change);
+			if (xform_dirty.in_list())
+				get_tree()->canvas_xform_dirty_list.remove(&xform_dirty);
+			if (server_xform_dirty.in_list()) {
+				get_tree()->canvas_xform_server_list.remove(&server_xform_dirty);
+				VisualServer::get_singleton()->canvas_item_set_transform(canvas_item, get_transform());
+			}
 			_exit_canvas();
 			if (C) {
 				get_parent()->cast_to<CanvasItem>()->children_items.erase(C);
@@ -561,6 +576,54 @@ float CanvasItem::draw_char(const Ref<Font> &p_font, const Point2 &p_pos, const
 	return p_font->draw_char(canvas_item, p_pos, p_char[0], p_next.c_str()[0], p_modulate);
 }
 
+void CanvasItem::_queue_transform_dirty() {
+
+	SceneTree *tree = get_tree();
+	MutexLock lock(tree->_get_threaded_process_lock());
+
+	if (global_invalid)
+		return; //either queued already, or invalid since the last flush along with all its children
+
+	//children are invalidated later, once per flush, no matter how many times this item moves
+	global_invalid = true;
+
+	tree->_queue_canvas_xform_flush();
+	tree->canvas_xform_dirty_list.add(&xform_dirty);
+}
+
+void CanvasItem::_queue_server_transform() {
+
+	if (!is_inside_tree()) {
+		VisualServer::get_singleton()->canvas_item_set_transform(canvas_item, get_transform());
+		return;
+	}
+
+	SceneTree *tree = get_tree();
+	MutexLock lock(tree->_get_threaded_process_lock());
+
+	if (!server_xform_dirty.in_list()) {
+		//reading global transforms does not send these, so they stay batched for the whole frame
+		tree->_queue_canvas_xform_flush();
+		tree->canvas_xform_server_list.add(&server_xform_dirty);
+	}
+	_queue_transform_dirty();
+}
+
+void CanvasItem::_flush_transform_dirty() {
+
+	if (notify_transform && !block_transform_notify && !xform_change.in_list()) {
+		get_tree()->xform_change_list.add(&xform_change);
+	}
+
+	for (List<CanvasItem *>::Element *E = children_items.front(); E; E = E->next()) {
+
+		CanvasItem *ci = E->get();
+		if (ci->toplevel)
+			continue;
+		_notify_transform(ci);
+	}
+}
+
 void CanvasItem::_notify_transform(CanvasItem *p_node) {
 
 	if (/*p_node->xform_change.in_list() &&*/ p_node->global_invalid)
@@ -896,7 +959,9 @@ Rect2 CanvasItem::get_item_and_children_rect() const {
 }
 
 CanvasItem::CanvasItem()
-	: xform_change(this) {
+	: xform_change(this),
+	  xform_dirty(this),
+	  server_xform_dirty(this) {
 
 	canvas_item = VisualServer::get_singleton()->canvas_item_create();
 	visible = true;
@@ -57,7 +57,11 @@ public:
 	};
 
 private:
+	friend class SceneTree;
+
 	mutable SelfList<Node> xform_change;
+	SelfList<CanvasItem> xform_dirty;
+	SelfList<CanvasItem> server_xform_dirty;
 
 	RID canvas_item;
 	String group;
@@ -98,6 +102,8 @@ private:
 	void _exit_canvas();
 
 	void _notify_transform(CanvasItem *p_node);
+	void _queue_transform_dirty();
+	void _flush_transform_dirty();
 
 	void _set_on_top(bool p_on_top) { set_draw_behind_parent(!p_on_top); }
 	bool _is_on_top() const { return !is_draw_behind_parent_enabled(); }
@@ -105,10 +111,14 @@ private:
 protected:
 	_FORCE_INLINE_ void _notify_transform() {
 		if (!is_inside_tree()) return;
-		_notify_transform(this);
+		_queue_transform_dirty();
 		if (!block_transform_notify && notify_local_transform) notification(NOTIFICATION_LOCAL_TRANSFORM_CHANGED);
 	}
 
+	// get_transform() changed and must be sent to the VisualServer, inside the
+	// tree this is done in bulk when dirty transforms are flushed
+	void _queue_server_transform();
+
 	void item_rect_changed(bool p_size_changed = true);
 
 	void _notification(int p_what);
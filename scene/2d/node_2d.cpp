@@ -123,11 +123,7 @@ void Node2D::_update_transform() {
 	_mat.set_rotation_and_scale(angle, _scale);
 	_mat.elements[2] = pos;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
-
-	if (!is_inside_tree())
-		return;
-
+	_queue_server_transform();
 	_notify_transform();
 }
 
@@ -330,11 +326,7 @@ void Node2D::set_transform(const Transform2D &p_transform) {
 	_mat = p_transform;
 	_xform_dirty = true;
 
-	VisualServer::get_singleton()->canvas_item_set_transform(get_canvas_item(), _mat);
-
-	if (!is_inside_tree())
-		return;
-
+	_queue_server_transform();
 	_notify_transform();
 }
 
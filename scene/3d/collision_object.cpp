@@ -324,6 +324,7 @@ CollisionObject::CollisionObject(RID p_rid, bool p_area) {
 		PhysicsServer::get_singleton()->area_attach_object_instance_ID(rid, get_instance_ID());
 	} else {
 		PhysicsServer::get_singleton()->body_attach_object_instance_ID(rid, get_instance_ID());
+		_set_transform_server_sink(TransformHierarchy::SINK_BODY, rid);
 	}
 	//set_transform_notify(true);
 }
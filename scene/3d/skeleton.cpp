@@ -32,6 +32,7 @@
 #include "message_queue.h"
 
 #include "core/global_config.h"
+#include "core/math/math_batch.h"
 #include "scene/resources/surface_tool.h"
 
 bool Skeleton::_set(const StringName &p_path, const Variant &p_value) {
@@ -162,7 +163,7 @@ void Skeleton::_notification(int p_what) {
 			vs->skeleton_allocate(skeleton, len); // if same size, nothin really happens
 
 			// pose changed, rebuild cache of inverses
-			if (rest_global_inverse_dirty) {
+			if (rest_global_inverse_dirty || rest_global_inverses.size() != len) {
 
 				// calculate global rests and invert them
 				for (int i = 0; i < len; i++) {
@@ -172,14 +173,22 @@ void Skeleton::_notification(int p_what) {
 					else
 						b.rest_global_inverse = b.rest;
 				}
+
+				rest_global_inverses.resize(len);
+				Transform *inverses = rest_global_inverses.ptr();
+
 				for (int i = 0; i < len; i++) {
 					Bone &b = bonesptr[i];
 					b.rest_global_inverse.affine_invert();
+					inverses[i] = b.rest_global_inverse;
 				}
 
 				rest_global_inverse_dirty = false;
 			}
 
+			skin_transforms.resize(len);
+			Transform *skin = skin_transforms.ptr();
+
 			for (int i = 0; i < len; i++) {
 
 				Bone &b = bonesptr[i];
@@ -239,7 +248,16 @@ void Skeleton::_notification(int p_what) {
 					}
 				}
 
-				vs->skeleton_bone_set_transform(skeleton, i, b.pose_global * b.rest_global_inverse);
+				skin[i] = b.pose_global;
+			}
+
+			MathBatch::multiply(skin, rest_global_inverses.ptr(), skin, len);
+
+			for (int i = 0; i < len; i++) {
+
+				Bone &b = bonesptr[i];
+
+				vs->skeleton_bone_set_transform(skeleton, i, skin[i]);
 
 				for (List<uint32_t>::Element *E = b.nodes_bound.front(); E; E = E->next()) {
 
@@ -407,7 +425,7 @@ void Skeleton::bind_child_node_to_bone(int p_bone, Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	ERR_FAIL_INDEX(p_bone, bones.size());
 
-	uint32_t id = p_node->get_instance_ID();
+	ObjectID id = p_node->get_instance_ID();
 
 	for (List<uint32_t>::Element *E = bones[p_bone].nodes_bound.front(); E; E = E->next()) {
 
@@ -422,7 +440,7 @@ void Skeleton::unbind_child_node_from_bone(int p_bone, Node *p_node) {
 	ERR_FAIL_NULL(p_node);
 	ERR_FAIL_INDEX(p_bone, bones.size());
 
-	uint32_t id = p_node->get_instance_ID();
+	ObjectID id = p_node->get_instance_ID();
 	bones[p_bone].nodes_bound.erase(id);
 }
 void Skeleton::get_bound_child_nodes_to_bone(int p_bone, List<Node *> *p_bound) const {
@@ -71,6 +71,11 @@ class Skeleton : public Spatial {
 
 	Vector<Bone> bones;
 
+	// contiguous copies of the bone transforms, so skinning transforms can be
+	// computed with MathBatch
+	Vector<Transform> rest_global_inverses;
+	Vector<Transform> skin_transforms;
+
 	RID skeleton;
 
 	void _make_dirty();
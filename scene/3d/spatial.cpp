@@ -70,11 +70,47 @@ future: no idea
 SpatialGizmo::SpatialGizmo() {
 }
 
+bool Spatial::_is_transform_reported() const {
+
+	//nodes that only forward their transform to a server are updated in bulk by the hierarchy
+	if (data.server_sink == TransformHierarchy::SINK_NONE || get_script_instance())
+		return false;
+#ifdef TOOLS_ENABLED
+	if (data.gizmo.is_valid())
+		return false;
+#endif
+	return true;
+}
+
 void Spatial::_notify_dirty() {
 
-	if (data.notify_transform && !data.ignore_notification && !xform_change.in_list()) {
+	bool report = false;
 
-		get_tree()->xform_change_list.add(&xform_change);
+	if (data.notify_transform && !data.ignore_notification) {
+
+		report = _is_transform_reported();
+		if (!report && !xform_change.in_list())
+			get_tree()->xform_change_list.add(&xform_change);
+	}
+
+	data.hierarchy->set_dirty(data.xform_slot, report);
+}
+
+void Spatial::_set_transform_server_sink(TransformHierarchy::ServerSink p_sink, const RID &p_rid) {
+
+	ERR_FAIL_COND(is_inside_tree());
+
+	data.server_sink = p_sink;
+	data.server_rid = p_rid;
+}
+
+void Spatial::_propagate_xform_parent() {
+
+	data.hierarchy->set_parent(data.xform_slot, (data.parent && !data.toplevel_active) ? data.parent->data.xform_slot : -1);
+
+	for (List<Spatial *>::Element *E = data.children.front(); E; E = E->next()) {
+
+		E->get()->_propagate_xform_parent();
 	}
 }
 
@@ -87,14 +123,16 @@ void Spatial::_update_local_transform() const {
 }
 void Spatial::_propagate_transform_changed(Spatial *p_origin) {
 
-	if (!is_inside_tree()) {
+	if (data.xform_slot < 0) {
 		return;
 	}
 
-	/*
-	if (data.dirty&DIRTY_GLOBAL)
-		return; //already dirty
-	*/
+	//the hierarchy is shared with nodes running thread-safe process callbacks
+	MutexLock lock(p_origin == this ? get_tree()->_get_threaded_process_lock() : NULL);
+
+	if (p_origin == this) {
+		data.hierarchy->set_local(data.xform_slot, get_transform());
+	}
 
 	data.children_lock++;
 
@@ -105,11 +143,7 @@ void Spatial::_propagate_transform_changed(Spatial *p_origin) {
 		E->get()->_propagate_transform_changed(p_origin);
 	}
 
-	if (data.notify_transform && !data.ignore_notification && !xform_change.in_list()) {
-
-		get_tree()->xform_change_list.add(&xform_change);
-	}
-	data.dirty |= DIRTY_GLOBAL;
+	_notify_dirty();
 
 	data.children_lock--;
 }
@@ -137,8 +171,9 @@ void Spatial::_notification(int p_what) {
 				data.toplevel_active = true;
 			}
 
-			data.dirty |= DIRTY_GLOBAL; //global is always dirty upon entering a scene
-			_notify_dirty();
+			data.hierarchy = get_tree()->transform_hierarchy;
+			data.xform_slot = data.hierarchy->create((data.parent && !data.toplevel_active) ? data.parent->data.xform_slot : -1, get_transform(), data.server_sink, data.server_rid);
+			_notify_dirty(); //global is always dirty upon entering a scene
 
 			notification(NOTIFICATION_ENTER_WORLD);
 
@@ -153,6 +188,9 @@ void Spatial::_notification(int p_what) {
 			data.parent = NULL;
 			data.C = NULL;
 			data.toplevel_active = false;
+			data.hierarchy->free(data.xform_slot);
+			data.hierarchy = NULL;
+			data.xform_slot = -1;
 		} break;
 		case NOTIFICATION_ENTER_WORLD: {
 
@@ -252,27 +290,10 @@ Transform Spatial::get_transform() const {
 }
 Transform Spatial::get_global_transform() const {
 
-	ERR_FAIL_COND_V(!is_inside_tree(), Transform());
-
-	if (data.dirty & DIRTY_GLOBAL) {
+	ERR_FAIL_COND_V(data.xform_slot < 0, Transform());
 
-		if (data.dirty & DIRTY_LOCAL) {
-
-			_update_local_transform();
-		}
-
-		if (data.parent && !data.toplevel_active) {
-
-			data.global_transform = data.parent->get_global_transform() * data.local_transform;
-		} else {
-
-			data.global_transform = data.local_transform;
-		}
-
-		data.dirty &= ~DIRTY_GLOBAL;
-	}
-
-	return data.global_transform;
+	MutexLock lock(get_tree()->_get_threaded_process_lock());
+	return data.hierarchy->get_global(data.xform_slot);
 }
 #if 0
 void Spatial::add_child_notify(Node *p_child) {
@@ -495,6 +516,8 @@ void Spatial::set_as_toplevel(bool p_enabled) {
 
 		data.toplevel = p_enabled;
 		data.toplevel_active = p_enabled;
+		_propagate_xform_parent();
+		_propagate_transform_changed(this);
 
 	} else {
 		data.toplevel = p_enabled;
@@ -801,7 +824,11 @@ Spatial::Spatial()
 	data.notify_transform = false;
 	data.parent = NULL;
 	data.C = NULL;
+	data.hierarchy = NULL;
+	data.xform_slot = -1;
+	data.server_sink = TransformHierarchy::SINK_NONE;
 }
 
+
 Spatial::~Spatial() {
 }
@@ -31,6 +31,7 @@
 #define SPATIAL_H
 
 #include "scene/main/node.h"
+#include "scene/3d/transform_hierarchy.h"
 #include "scene/main/scene_main_loop.h"
 
 /**
@@ -59,15 +60,13 @@ class Spatial : public Node {
 	enum TransformDirty {
 		DIRTY_NONE = 0,
 		DIRTY_VECTORS = 1,
-		DIRTY_LOCAL = 2,
-		DIRTY_GLOBAL = 4
+		DIRTY_LOCAL = 2
 	};
 
 	mutable SelfList<Node> xform_change;
 
 	struct Data {
 
-		mutable Transform global_transform;
 		mutable Transform local_transform;
 		mutable Vector3 rotation;
 		mutable Vector3 scale;
@@ -91,6 +90,11 @@ class Spatial : public Node {
 
 		bool visible;
 
+		TransformHierarchy *hierarchy;
+		int xform_slot;
+		TransformHierarchy::ServerSink server_sink;
+		RID server_rid;
+
 #ifdef TOOLS_ENABLED
 		Ref<SpatialGizmo> gizmo;
 		bool gizmo_disabled;
@@ -102,7 +106,9 @@ class Spatial : public Node {
 
 	void _update_gizmo();
 #endif
+	bool _is_transform_reported() const;
 	void _notify_dirty();
+	void _propagate_xform_parent();
 	void _propagate_transform_changed(Spatial *p_origin);
 
 	// Deprecated, should be removed in a future version.
@@ -116,6 +122,11 @@ protected:
 
 	_FORCE_INLINE_ void _update_local_transform() const;
 
+	// the node only reacts to NOTIFICATION_TRANSFORM_CHANGED by sending its global
+	// transform to p_rid, so the SceneTree may send it in bulk instead (unless a
+	// script or gizmo needs the notification)
+	void _set_transform_server_sink(TransformHierarchy::ServerSink p_sink, const RID &p_rid);
+
 	void _notification(int p_what);
 	static void _bind_methods();
 
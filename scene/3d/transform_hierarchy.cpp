@@ -0,0 +1,258 @@
+/*************************************************************************/
+/*  transform_hierarchy.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "transform_hierarchy.h"
+
+#include "os/memory.h"
+#include "servers/physics_server.h"
+#include "servers/visual_server.h"
+
+void TransformHierarchy::_grow() {
+
+	int new_capacity = capacity ? capacity * 2 : 256;
+
+	locals = (Transform *)memrealloc(locals, sizeof(Transform) * new_capacity);
+	globals = (Transform *)memrealloc(globals, sizeof(Transform) * new_capacity);
+	parents = (int *)memrealloc(parents, sizeof(int) * new_capacity);
+	depths = (int *)memrealloc(depths, sizeof(int) * new_capacity);
+	flags = (uint8_t *)memrealloc(flags, sizeof(uint8_t) * new_capacity);
+	sinks = (uint8_t *)memrealloc(sinks, sizeof(uint8_t) * new_capacity);
+	rids = (RID *)memrealloc(rids, sizeof(RID) * new_capacity);
+
+	for (int i = capacity; i < new_capacity; i++) {
+
+		flags[i] = 0;
+		sinks[i] = SINK_NONE;
+		rids[i] = RID();
+		parents[i] = i + 1 < new_capacity ? i + 1 : free_list;
+	}
+
+	free_list = capacity;
+	capacity = new_capacity;
+}
+
+void TransformHierarchy::_push_pending(int p_slot) {
+
+	if (pending_count == pending_capacity) {
+
+		pending_capacity = pending_capacity ? pending_capacity * 2 : 256;
+		pending = (int *)memrealloc(pending, sizeof(int) * pending_capacity);
+		sorted = (int *)memrealloc(sorted, sizeof(int) * pending_capacity);
+		for (int i = 0; i < 2; i++) {
+			report_rids[i] = (RID *)memrealloc(report_rids[i], sizeof(RID) * pending_capacity);
+			report_xforms[i] = (Transform *)memrealloc(report_xforms[i], sizeof(Transform) * pending_capacity);
+		}
+	}
+
+	flags[p_slot] |= FLAG_PENDING;
+	pending[pending_count++] = p_slot;
+}
+
+void TransformHierarchy::_update_global(int p_slot) {
+
+	int parent = parents[p_slot];
+	if (parent >= 0) {
+		globals[p_slot] = get_global(parent) * locals[p_slot];
+	} else {
+		globals[p_slot] = locals[p_slot];
+	}
+
+	flags[p_slot] &= ~FLAG_DIRTY;
+}
+
+int TransformHierarchy::create(int p_parent, const Transform &p_local, ServerSink p_sink, const RID &p_rid) {
+
+	ERR_FAIL_COND_V(p_parent >= capacity, -1);
+
+	if (free_list < 0)
+		_grow();
+
+	int slot = free_list;
+	free_list = parents[slot];
+
+	locals[slot] = p_local;
+	parents[slot] = p_parent;
+	depths[slot] = p_parent >= 0 ? depths[p_parent] + 1 : 0;
+	// a freed slot may still be in the pending list, keep it there
+	flags[slot] = (flags[slot] & FLAG_PENDING) | FLAG_USED | FLAG_DIRTY;
+	sinks[slot] = p_sink;
+	rids[slot] = p_rid;
+
+	return slot;
+}
+
+void TransformHierarchy::free(int p_slot) {
+
+	ERR_FAIL_INDEX(p_slot, capacity);
+	ERR_FAIL_COND(!(flags[p_slot] & FLAG_USED));
+
+	flags[p_slot] &= FLAG_PENDING;
+	sinks[p_slot] = SINK_NONE;
+	rids[p_slot] = RID();
+	parents[p_slot] = free_list;
+	free_list = p_slot;
+}
+
+void TransformHierarchy::set_parent(int p_slot, int p_parent) {
+
+	ERR_FAIL_INDEX(p_slot, capacity);
+
+	parents[p_slot] = p_parent;
+	depths[p_slot] = p_parent >= 0 ? depths[p_parent] + 1 : 0;
+}
+
+void TransformHierarchy::flush() {
+
+	if (pending_count == 0)
+		return;
+
+	// sort pending slots by depth, so parents are resolved before their children
+
+	int max_depth = 0;
+	for (int i = 0; i < pending_count; i++) {
+
+		int slot = pending[i];
+		if ((flags[slot] & FLAG_USED) && depths[slot] > max_depth)
+			max_depth = depths[slot];
+	}
+
+	if (max_depth + 1 >= depth_capacity) {
+		depth_capacity = max_depth + 2;
+		depth_count = (int *)memrealloc(depth_count, sizeof(int) * depth_capacity);
+	}
+
+	for (int i = 0; i <= max_depth + 1; i++) {
+		depth_count[i] = 0;
+	}
+
+	for (int i = 0; i < pending_count; i++) {
+
+		int slot = pending[i];
+		flags[slot] &= ~FLAG_PENDING;
+		if (flags[slot] & FLAG_USED)
+			depth_count[depths[slot] + 1]++;
+	}
+
+	for (int i = 1; i <= max_depth; i++) {
+		depth_count[i] += depth_count[i - 1];
+	}
+
+	int count = 0;
+	for (int i = 0; i < pending_count; i++) {
+
+		int slot = pending[i];
+		if (flags[slot] & FLAG_USED) {
+			sorted[depth_count[depths[slot]]++] = slot;
+			count++;
+		}
+	}
+
+	pending_count = 0;
+
+	// resolve globals and gather the ones the servers want
+
+	report_count[0] = 0;
+	report_count[1] = 0;
+
+	for (int i = 0; i < count; i++) {
+
+		int slot = sorted[i];
+		const Transform &global = get_global(slot);
+
+		if (flags[slot] & FLAG_REPORT) {
+
+			int sink = sinks[slot] - SINK_VISUAL_INSTANCE;
+			if (sink >= 0) {
+				int idx = report_count[sink]++;
+				report_rids[sink][idx] = rids[slot];
+				report_xforms[sink][idx] = global;
+			}
+			flags[slot] &= ~FLAG_REPORT;
+		}
+	}
+
+	if (report_count[0]) {
+		VisualServer::get_singleton()->instances_set_transform(report_rids[0], report_xforms[0], report_count[0]);
+	}
+	if (report_count[1]) {
+		PhysicsServer::get_singleton()->bodies_set_transform(report_rids[1], report_xforms[1], report_count[1]);
+	}
+}
+
+TransformHierarchy::TransformHierarchy() {
+
+	locals = NULL;
+	globals = NULL;
+	parents = NULL;
+	depths = NULL;
+	flags = NULL;
+	sinks = NULL;
+	rids = NULL;
+	capacity = 0;
+	free_list = -1;
+
+	pending = NULL;
+	pending_count = 0;
+	pending_capacity = 0;
+
+	sorted = NULL;
+	depth_count = NULL;
+	depth_capacity = 0;
+	for (int i = 0; i < 2; i++) {
+		report_rids[i] = NULL;
+		report_xforms[i] = NULL;
+		report_count[i] = 0;
+	}
+}
+
+TransformHierarchy::~TransformHierarchy() {
+
+	if (locals) {
+		memfree(locals);
+		memfree(globals);
+		memfree(parents);
+		memfree(depths);
+		memfree(flags);
+		memfree(sinks);
+		memfree(rids);
+	}
+
+	if (pending) {
+		memfree(pending);
+		memfree(sorted);
+		for (int i = 0; i < 2; i++) {
+			memfree(report_rids[i]);
+			memfree(report_xforms[i]);
+		}
+	}
+
+	if (depth_count) {
+		memfree(depth_count);
+	}
+}
@@ -0,0 +1,119 @@
+/*************************************************************************/
+/*  transform_hierarchy.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2017 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2017 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include "rid.h"
+#include "transform.h"
+
+/**
+ * Flat storage for the local and global transforms of every Spatial in a
+ * SceneTree. Each Spatial owns a slot while inside the tree, and the slot
+ * remembers the parent slot, so global transforms can be resolved without
+ * touching the nodes.
+ *
+ * Changes are accumulated in a pending list and resolved at flush() in
+ * depth order. Slots flagged for reporting (nodes whose only reaction to a
+ * transform change is forwarding it to the visual or physics server) are
+ * then sent in one bulk call per server instead of one notification each.
+ */
+
+class TransformHierarchy {
+public:
+	enum ServerSink {
+		SINK_NONE,
+		SINK_VISUAL_INSTANCE,
+		SINK_BODY
+	};
+
+private:
+	enum {
+		FLAG_USED = 1,
+		FLAG_DIRTY = 2,
+		FLAG_REPORT = 4,
+		FLAG_PENDING = 8
+	};
+
+	Transform *locals;
+	Transform *globals;
+	int *parents; // parent slot, -1 for roots; next free slot when unused
+	int *depths;
+	uint8_t *flags;
+	uint8_t *sinks;
+	RID *rids;
+	int capacity;
+	int free_list;
+
+	int *pending;
+	int pending_count;
+	int pending_capacity;
+
+	// scratch buffers for flush()
+	int *sorted;
+	int *depth_count;
+	int depth_capacity;
+	RID *report_rids[2];
+	Transform *report_xforms[2];
+	int report_count[2];
+
+	void _grow();
+	void _push_pending(int p_slot);
+	void _update_global(int p_slot);
+
+public:
+	int create(int p_parent, const Transform &p_local, ServerSink p_sink, const RID &p_rid);
+	void free(int p_slot);
+
+	void set_parent(int p_slot, int p_parent);
+	_FORCE_INLINE_ void set_local(int p_slot, const Transform &p_local) { locals[p_slot] = p_local; }
+
+	// the global transform of p_slot (and everything below it) must be recomputed
+	_FORCE_INLINE_ void set_dirty(int p_slot, bool p_report) {
+
+		flags[p_slot] |= FLAG_DIRTY | (p_report ? FLAG_REPORT : 0);
+		if (!(flags[p_slot] & FLAG_PENDING))
+			_push_pending(p_slot);
+	}
+
+	_FORCE_INLINE_ const Transform &get_global(int p_slot) {
+
+		if (flags[p_slot] & FLAG_DIRTY)
+			_update_global(p_slot);
+		return globals[p_slot];
+	}
+
+	_FORCE_INLINE_ bool has_pending() const { return pending_count > 0; }
+	void flush();
+
+	TransformHierarchy();
+	~TransformHierarchy();
+};
+
+#endif // TRANSFORM_HIERARCHY_H
@@ -152,6 +152,7 @@ VisualInstance::VisualInstance() {
 	VisualServer::get_singleton()->instance_attach_object_instance_ID(instance, get_instance_ID());
 	layers = 1;
 	set_notify_transform(true);
+	_set_transform_server_sink(TransformHierarchy::SINK_VISUAL_INSTANCE, instance);
 }
 
 VisualInstance::~VisualInstance() {
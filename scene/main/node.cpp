@@ -40,6 +40,13 @@ VARIANT_ENUM_CAST(Node::PauseMode);
 VARIANT_ENUM_CAST(Node::NetworkMode);
 VARIANT_ENUM_CAST(Node::RPCMode);
 
+//nodes processed in parallel can't change the tree, they must use call_deferred()
+#define _THREADED_PROCESS_GUARD_                                                                             \
+	if (data.tree && data.tree->_is_threaded_process_active()) {                                             \
+		ERR_EXPLAIN("Can't change the scene tree from a thread-safe process callback, use call_deferred()."); \
+		ERR_FAIL();                                                                                          \
+	}
+
 void Node::_notification(int p_notification) {
 
 	switch (p_notification) {
@@ -156,6 +163,13 @@ void Node::_notification(int p_notification) {
 		} break;
 		case NOTIFICATION_PREDELETE: {
 
+			if (data.tree && data.tree->_is_threaded_process_active()) {
+				//removing it from its parent is not allowed here, freeing it anyway would leave a dangling child
+				cancel_delete();
+				ERR_EXPLAIN("Can't free a node from a thread-safe process callback, use call_deferred().");
+				ERR_FAIL();
+			}
+
 			set_owner(NULL);
 
 			while (data.owned.size()) {
@@ -213,7 +227,7 @@ void Node::_propagate_enter_tree() {
 	data.inside_tree = true;
 
 	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		E->get().group = data.tree->add_to_group(E->key(), this);
+		E->get().group = data.tree->add_to_group(E->key(), this, &E->get().index);
 	}
 
 	notification(NOTIFICATION_ENTER_TREE);
@@ -296,7 +310,7 @@ void Node::_propagate_exit_tree() {
 	// exit groups
 
 	for (Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
-		data.tree->remove_from_group(E->key(), this);
+		data.tree->remove_from_group(E->key(), this, E->get().index);
 		E->get().group = NULL;
 	}
 
@@ -313,6 +327,8 @@ void Node::_propagate_exit_tree() {
 
 void Node::move_child(Node *p_child, int p_pos) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_NULL(p_child);
 	ERR_EXPLAIN("Invalid new child position: " + itos(p_pos));
 	ERR_FAIL_INDEX(p_pos, data.children.size() + 1);
@@ -347,13 +363,24 @@ void Node::move_child(Node *p_child, int p_pos) {
 	for (int i = motion_from; i <= motion_to; i++) {
 		data.children[i]->notification(NOTIFICATION_MOVED_IN_PARENT);
 	}
-	for (const Map<StringName, GroupData>::Element *E = p_child->data.grouped.front(); E; E = E->next()) {
-		E->get().group->changed = true;
-	}
+	//tree order changed for the whole subtree, not just the moved child
+	p_child->_propagate_groups_changed();
 
 	data.blocked--;
 }
 
+void Node::_propagate_groups_changed() {
+
+	for (const Map<StringName, GroupData>::Element *E = data.grouped.front(); E; E = E->next()) {
+		if (E->get().group)
+			E->get().group->changed = true;
+	}
+
+	for (int i = 0; i < data.children.size(); i++) {
+		data.children[i]->_propagate_groups_changed();
+	}
+}
+
 void Node::raise() {
 
 	if (!data.parent)
@@ -394,6 +421,8 @@ void Node::set_fixed_process(bool p_process) {
 	if (data.fixed_process == p_process)
 		return;
 
+	_THREADED_PROCESS_GUARD_;
+
 	data.fixed_process = p_process;
 
 	if (data.fixed_process)
@@ -415,6 +444,8 @@ void Node::set_fixed_process_internal(bool p_process_internal) {
 	if (data.fixed_process_internal == p_process_internal)
 		return;
 
+	_THREADED_PROCESS_GUARD_;
+
 	data.fixed_process_internal = p_process_internal;
 
 	if (data.fixed_process_internal)
@@ -1116,6 +1147,8 @@ void Node::set_process(bool p_idle_process) {
 	if (data.idle_process == p_idle_process)
 		return;
 
+	_THREADED_PROCESS_GUARD_;
+
 	data.idle_process = p_idle_process;
 
 	if (data.idle_process)
@@ -1137,6 +1170,8 @@ void Node::set_process_internal(bool p_idle_process_internal) {
 	if (data.idle_process_internal == p_idle_process_internal)
 		return;
 
+	_THREADED_PROCESS_GUARD_;
+
 	data.idle_process_internal = p_idle_process_internal;
 
 	if (data.idle_process_internal)
@@ -1153,11 +1188,24 @@ bool Node::is_processing_internal() const {
 	return data.idle_process_internal;
 }
 
+void Node::set_process_thread_safe(bool p_enable) {
+
+	_THREADED_PROCESS_GUARD_;
+	data.process_thread_safe = p_enable;
+}
+
+bool Node::is_process_thread_safe() const {
+
+	return data.process_thread_safe;
+}
+
 void Node::set_process_input(bool p_enable) {
 
 	if (p_enable == data.input)
 		return;
 
+	_THREADED_PROCESS_GUARD_;
+
 	data.input = p_enable;
 	if (!is_inside_tree())
 		return;
@@ -1176,6 +1224,9 @@ void Node::set_process_unhandled_input(bool p_enable) {
 
 	if (p_enable == data.unhandled_input)
 		return;
+
+	_THREADED_PROCESS_GUARD_;
+
 	data.unhandled_input = p_enable;
 	if (!is_inside_tree())
 		return;
@@ -1194,6 +1245,9 @@ void Node::set_process_unhandled_key_input(bool p_enable) {
 
 	if (p_enable == data.unhandled_key_input)
 		return;
+
+	_THREADED_PROCESS_GUARD_;
+
 	data.unhandled_key_input = p_enable;
 	if (!is_inside_tree())
 		return;
@@ -1220,6 +1274,8 @@ void Node::_set_name_nocheck(const StringName &p_name) {
 
 void Node::set_name(const String &p_name) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	String name = p_name.replace(":", "").replace("/", "").replace("@", "");
 
 	ERR_FAIL_COND(name == "");
@@ -1396,6 +1452,8 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
 
 void Node::add_child(Node *p_child, bool p_legible_unique_name) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_NULL(p_child);
 	/* Fail if node has a parent */
 	if (p_child == this) {
@@ -1462,6 +1520,8 @@ void Node::_propagate_validate_owner() {
 
 void Node::remove_child(Node *p_child) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_NULL(p_child);
 	if (data.blocked > 0) {
 		ERR_EXPLAIN("Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\",child) instead.");
@@ -1731,6 +1791,8 @@ void Node::_set_owner_nocheck(Node *p_owner) {
 
 void Node::set_owner(Node *p_owner) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	if (data.owner) {
 
 		data.owner->data.owned.erase(data.OW);
@@ -1879,26 +1941,27 @@ bool Node::is_in_group(const StringName &p_identifier) const {
 
 void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_COND(!p_identifier.operator String().length());
 
 	if (data.grouped.has(p_identifier))
 		return;
 
-	GroupData gd;
-
-	if (data.tree) {
-		gd.group = data.tree->add_to_group(p_identifier, this);
-	} else {
-		gd.group = NULL;
-	}
+	//the tree keeps the index of the node in the group updated, so it must not move in memory
+	GroupData &gd = data.grouped.insert(p_identifier, GroupData())->get();
 
 	gd.persistent = p_persistent;
 
-	data.grouped[p_identifier] = gd;
+	if (data.tree) {
+		gd.group = data.tree->add_to_group(p_identifier, this, &gd.index);
+	}
 }
 
 void Node::remove_from_group(const StringName &p_identifier) {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_COND(!data.grouped.has(p_identifier));
 
 	Map<StringName, GroupData>::Element *E = data.grouped.find(p_identifier);
@@ -1906,7 +1969,7 @@ void Node::remove_from_group(const StringName &p_identifier) {
 	ERR_FAIL_COND(!E);
 
 	if (data.tree)
-		data.tree->remove_from_group(E->key(), this);
+		data.tree->remove_from_group(E->key(), this, E->get().index);
 
 	data.grouped.erase(E);
 }
@@ -2672,6 +2735,8 @@ void Node::print_stray_nodes() {
 
 void Node::queue_delete() {
 
+	_THREADED_PROCESS_GUARD_;
+
 	ERR_FAIL_COND(!is_inside_tree());
 	get_tree()->queue_delete(this);
 }
@@ -2828,6 +2893,9 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_process_internal", "enable"), &Node::set_process_internal);
 	ClassDB::bind_method(D_METHOD("is_processing_internal"), &Node::is_processing_internal);
 
+	ClassDB::bind_method(D_METHOD("set_process_thread_safe", "enable"), &Node::set_process_thread_safe);
+	ClassDB::bind_method(D_METHOD("is_process_thread_safe"), &Node::is_process_thread_safe);
+
 	ClassDB::bind_method(D_METHOD("set_fixed_process_internal", "enable"), &Node::set_fixed_process_internal);
 	ClassDB::bind_method(D_METHOD("is_fixed_processing_internal"), &Node::is_fixed_processing_internal);
 
@@ -2929,6 +2997,7 @@ void Node::_bind_methods() {
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/fixed_process" ), "set_fixed_process","is_fixed_processing") ;
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/input" ), "set_process_input","is_processing_input" ) ;
 	//ADD_PROPERTYNZ( PropertyInfo( Variant::BOOL, "process/unhandled_input" ), "set_process_unhandled_input","is_processing_unhandled_input" ) ;
+	ADD_PROPERTYNZ(PropertyInfo(Variant::BOOL, "process_thread_safe"), "set_process_thread_safe", "is_process_thread_safe");
 	ADD_GROUP("Pause", "pause_");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::INT, "pause_mode", PROPERTY_HINT_ENUM, "Inherit,Stop,Process"), "set_pause_mode", "get_pause_mode");
 	ADD_PROPERTYNZ(PropertyInfo(Variant::BOOL, "editor/display_folded", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NOEDITOR), "set_display_folded", "is_displayed_folded");
@@ -2967,6 +3036,7 @@ Node::Node() {
 	data.idle_process = false;
 	data.fixed_process_internal = false;
 	data.idle_process_internal = false;
+	data.process_thread_safe = false;
 	data.inside_tree = false;
 	data.ready_notified = false;
 
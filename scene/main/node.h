@@ -87,7 +87,12 @@ private:
 
 		bool persistent;
 		SceneTree::Group *group;
-		GroupData() { persistent = false; }
+		int index; //position in group->nodes, maintained by SceneTree
+		GroupData() {
+			persistent = false;
+			group = NULL;
+			index = -1;
+		}
 	};
 
 	struct Data {
@@ -135,6 +140,8 @@ private:
 		bool fixed_process_internal;
 		bool idle_process_internal;
 
+		bool process_thread_safe;
+
 		bool input;
 		bool unhandled_input;
 		bool unhandled_key_input;
@@ -174,6 +181,7 @@ private:
 	void _print_stray_nodes();
 	void _propagate_pause_owner(Node *p_owner);
 	void _propagate_network_owner(Node *p_owner);
+	void _propagate_groups_changed();
 	Array _get_node_and_resource(const NodePath &p_path);
 
 	void _duplicate_signals(const Node *p_original, Node *p_copy) const;
@@ -322,6 +330,9 @@ public:
 	void set_process_internal(bool p_process);
 	bool is_processing_internal() const;
 
+	void set_process_thread_safe(bool p_enable);
+	bool is_process_thread_safe() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
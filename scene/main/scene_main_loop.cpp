@@ -35,6 +35,8 @@
 #include "os/keyboard.h"
 #include "os/os.h"
 #include "print_string.h"
+#include "scene/2d/canvas_item.h"
+#include "scene/3d/transform_hierarchy.h"
 #include <stdio.h>
 //#include "servers/spatial_sound_2d_server.h"
 #include "io/marshalls.h"
@@ -94,46 +96,136 @@ void SceneTree::node_removed(Node *p_node) {
 		call_skip.insert(p_node);
 }
 
-SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node) {
+SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node, int *p_index) {
 
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
 	if (!E) {
 		E = group_map.insert(p_group, Group());
 	}
 
-	if (E->get().nodes.find(p_node) != -1) {
-		ERR_EXPLAIN("Already in group: " + p_group);
-		ERR_FAIL_V(&E->get());
-	}
-	E->get().nodes.push_back(p_node);
+	//nodes check for duplicates themselves, appending is enough (ordered groups merge it later)
+	Group &g = E->get();
+	*p_index = g.nodes.size();
+	g.nodes.push_back(p_node);
+	g.index_slots.push_back(p_index);
 	//E->get().last_tree_version=0;
-	E->get().changed = true;
-	return &E->get();
+	return &g;
 }
 
-void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
+void SceneTree::remove_from_group(const StringName &p_group, Node *p_node, int p_index) {
 
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
 	ERR_FAIL_COND(!E);
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.empty())
+	Group &g = E->get();
+	ERR_FAIL_INDEX(p_index, g.nodes.size());
+	ERR_FAIL_COND(g.nodes.get(p_index) != p_node);
+
+	if (p_index < g.sorted) {
+
+		//keep the sorted part in order, the gap is compacted on the next iteration
+		g.nodes.set(p_index, NULL);
+		g.removed++;
+	} else {
+
+		int last = g.nodes.size() - 1;
+		if (p_index != last) {
+			int *slot = g.index_slots.get(last);
+			g.nodes.set(p_index, g.nodes.get(last));
+			g.index_slots.set(p_index, slot);
+			*slot = p_index;
+		}
+		g.nodes.resize(last);
+		g.index_slots.resize(last);
+	}
+
+	if (g.size() == 0)
 		group_map.erase(E);
 }
 
 void SceneTree::_flush_transform_notifications() {
 
-	SelfList<Node> *n = xform_change_list.first();
+	while (true) {
+
+		//resolves global transforms and sends the server-only ones in bulk
+		transform_hierarchy->flush();
+		_flush_canvas_transforms();
+
+		SelfList<Node> *n = xform_change_list.first();
+		if (!n)
+			break;
+
+		while (n) {
+
+			Node *node = n->self();
+			SelfList<Node> *nx = n->next();
+			xform_change_list.remove(n);
+			n = nx;
+			node->notification(NOTIFICATION_TRANSFORM_CHANGED);
+		}
+	}
+}
+
+void SceneTree::_flush_canvas_invalidation() {
+
+	SelfList<CanvasItem> *n = canvas_xform_dirty_list.first();
 	while (n) {
 
-		Node *node = n->self();
-		SelfList<Node> *nx = n->next();
-		xform_change_list.remove(n);
+		CanvasItem *ci = n->self();
+		SelfList<CanvasItem> *nx = n->next();
+		canvas_xform_dirty_list.remove(n);
 		n = nx;
-		node->notification(NOTIFICATION_TRANSFORM_CHANGED);
+
+		ci->_flush_transform_dirty();
 	}
 }
 
+void SceneTree::_flush_canvas_transforms() {
+
+	_flush_canvas_invalidation();
+
+	int count = 0;
+
+	SelfList<CanvasItem> *n = canvas_xform_server_list.first();
+	while (n) {
+
+		CanvasItem *ci = n->self();
+		SelfList<CanvasItem> *nx = n->next();
+		canvas_xform_server_list.remove(n);
+		n = nx;
+
+		if (count == canvas_xform_capacity) {
+			canvas_xform_capacity = canvas_xform_capacity ? canvas_xform_capacity * 2 : 256;
+			canvas_xform_rids = (RID *)memrealloc(canvas_xform_rids, sizeof(RID) * canvas_xform_capacity);
+			canvas_xforms = (Transform2D *)memrealloc(canvas_xforms, sizeof(Transform2D) * canvas_xform_capacity);
+		}
+
+		canvas_xform_rids[count] = ci->get_canvas_item();
+		canvas_xforms[count] = ci->get_transform();
+		count++;
+	}
+
+	if (count) {
+		VisualServer::get_singleton()->canvas_items_set_transform(canvas_xform_rids, canvas_xforms, count);
+	}
+}
+
+void SceneTree::_queue_canvas_xform_flush() {
+
+	if (canvas_xform_flush_queued)
+		return;
+
+	//make sure moved canvas items are flushed before drawing, even if they change after the last idle flush
+	MessageQueue::get_singleton()->push_call(this, "_canvas_xform_callback");
+	canvas_xform_flush_queued = true;
+}
+
+void SceneTree::_canvas_xform_callback() {
+
+	canvas_xform_flush_queued = false;
+	_flush_canvas_transforms();
+}
+
 void SceneTree::_flush_ugc() {
 
 	ugc_locked = true;
@@ -154,18 +246,116 @@ void SceneTree::_flush_ugc() {
 	ugc_locked = false;
 }
 
-void SceneTree::_update_group_order(Group &g) {
+struct _GroupEntry {
 
-	if (!g.changed)
-		return;
-	if (g.nodes.empty())
+	Node *node;
+	int *index;
+};
+
+struct _GroupEntryComparator {
+
+	_FORCE_INLINE_ bool operator()(const _GroupEntry &p_a, const _GroupEntry &p_b) const { return p_b.node->is_greater_than(p_a.node); }
+};
+
+void SceneTree::_sort_group(Group &g) {
+
+	g.ordered = true;
+
+	int count = g.nodes.size();
+	if (count == 0)
 		return;
 
-	Node **nodes = &g.nodes[0];
-	int node_count = g.nodes.size();
+	Node **nodes = g.nodes.ptr();
+	int **slots = g.index_slots.ptr();
+	int first_moved = count;
+
+	int sorted = g.changed ? 0 : g.sorted;
+
+	if (g.removed) {
+
+		//compact the gaps left by removed nodes, without changing the order
+		int to = 0;
+		for (int from = 0; from < count; from++) {
+
+			if (!nodes[from])
+				continue;
+			if (to != from) {
+				nodes[to] = nodes[from];
+				slots[to] = slots[from];
+				first_moved = MIN(first_moved, to);
+			}
+			to++;
+		}
+
+		//removed nodes leave gaps only in the sorted part
+		if (sorted)
+			sorted -= g.removed;
+		count = to;
+		g.removed = 0;
+	}
+
+	int added = count - sorted;
+
+	if (added) {
+
+		Vector<_GroupEntry> entry_buffer;
+		entry_buffer.resize(added);
+		_GroupEntry *entries = entry_buffer.ptr();
+
+		for (int i = 0; i < added; i++) {
+			entries[i].node = nodes[sorted + i];
+			entries[i].index = slots[sorted + i];
+		}
+
+		SortArray<_GroupEntry, _GroupEntryComparator> entry_sort;
+		entry_sort.sort(entries, added);
+
+		//merge from the back, finding where each new node goes with a binary search,
+		//so the sorted part only costs O(log n) comparisons per added node
+		int end = sorted; //nodes[0..end) still to be merged
+		int write = count;
+
+		for (int i = added - 1; i >= 0; i--) {
+
+			Node *n = entries[i].node;
+
+			int lo = 0;
+			int hi = end;
+			while (lo < hi) {
+				int mid = (lo + hi) / 2;
+				if (nodes[mid]->is_greater_than(n))
+					hi = mid;
+				else
+					lo = mid + 1;
+			}
+
+			int moving = end - lo;
+			write -= moving;
+			if (moving && write != lo) {
+				memmove(&nodes[write], &nodes[lo], sizeof(Node *) * moving);
+				memmove(&slots[write], &slots[lo], sizeof(int *) * moving);
+			}
+			end = lo;
+
+			write--;
+			nodes[write] = n;
+			slots[write] = entries[i].index;
+		}
 
-	SortArray<Node *, Node::Comparator> node_sort;
-	node_sort.sort(nodes, node_count);
+		first_moved = MIN(first_moved, write);
+	}
+
+	if (count != g.nodes.size()) {
+		g.nodes.resize(count);
+		g.index_slots.resize(count);
+		slots = g.index_slots.ptr();
+	}
+
+	for (int i = first_moved; i < count; i++) {
+		*slots[i] = i;
+	}
+
+	g.sorted = count;
 	g.changed = false;
 }
 
@@ -925,6 +1115,15 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 		call_skip.clear();
 }
 
+void SceneTree::_threaded_process_range(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to) {
+
+	ThreadedProcess *tp = (ThreadedProcess *)p_userdata;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		tp->nodes[i]->notification(tp->notification);
+	}
+}
+
 void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
 
 	Map<StringName, Group>::Element *E = group_map.find(p_group);
@@ -936,6 +1135,8 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 
 	_update_group_order(g);
 
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
 	//copy, so copy on write happens in case something is removed from process while being called
 	//performance is not lost because only if something is added/removed the vector is copied.
 	Vector<Node *> nodes_copy = g.nodes;
@@ -943,6 +1144,11 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 	int node_count = nodes_copy.size();
 	Node **nodes = &nodes_copy[0];
 
+	//only regular process callbacks may run threaded, internal ones belong to the engine
+	bool can_thread = p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_FIXED_PROCESS;
+	int threaded_count = 0;
+	int processed = 0;
+
 	call_lock++;
 
 	for (int i = 0; i < node_count; i++) {
@@ -954,13 +1160,92 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 		if (!n->can_process())
 			continue;
 
+		processed++;
+
+		if (can_thread && n->is_process_thread_safe()) {
+
+			if (threaded_count == threaded_node_capacity) {
+				threaded_node_capacity = threaded_node_capacity ? threaded_node_capacity * 2 : 64;
+				threaded_nodes = (Node **)memrealloc(threaded_nodes, threaded_node_capacity * sizeof(Node *));
+			}
+			threaded_nodes[threaded_count++] = n;
+			continue;
+		}
+
 		n->notification(p_notification);
 		//ERR_FAIL_COND(node_count != g.nodes.size());
 	}
 
+	uint64_t threaded_begin = OS::get_singleton()->get_ticks_usec();
+
+	if (threaded_count && call_skip.size()) {
+		//drop the nodes that left the tree during the serial pass
+		int valid = 0;
+		for (int i = 0; i < threaded_count; i++) {
+			if (!call_skip.has(threaded_nodes[i]))
+				threaded_nodes[valid++] = threaded_nodes[i];
+		}
+		threaded_count = valid;
+	}
+
+	if (threaded_count) {
+
+		if (!process_pool_initialized) {
+			process_work_pool.init(process_thread_count > 0 ? process_thread_count : -1);
+			process_pool_initialized = true;
+		}
+
+		//the tree can't change until the workers are done, nodes use call_deferred() for that
+		ThreadedProcess tp;
+		tp.nodes = threaded_nodes;
+		tp.notification = p_notification;
+
+		//also with a single thread, so the guards behave the same whatever the pool size
+		threaded_process_active = true;
+		process_work_pool.do_work(threaded_count, _threaded_process_range, &tp);
+		threaded_process_active = false;
+	}
+
 	call_lock--;
 	if (call_lock == 0)
 		call_skip.clear();
+
+	//the group is gone if every node left it while being processed
+	E = group_map.find(p_group);
+	if (!E)
+		return;
+
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+	E->get().process_usec = end - begin;
+	E->get().threaded_usec = threaded_count ? end - threaded_begin : 0;
+	E->get().processed = processed;
+	E->get().threaded = threaded_count;
+}
+
+Array SceneTree::get_process_group_stats() const {
+
+	static const char *process_groups[4] = { "idle_process", "idle_process_internal", "fixed_process", "fixed_process_internal" };
+
+	Array stats;
+
+	for (int i = 0; i < 4; i++) {
+
+		const Map<StringName, Group>::Element *E = group_map.find(process_groups[i]);
+		if (!E)
+			continue;
+
+		const Group &g = E->get();
+		Dictionary d;
+		d["group"] = process_groups[i];
+		d["nodes"] = g.size();
+		d["processed"] = g.processed;
+		d["threaded"] = g.threaded;
+		d["time"] = g.process_usec / 1000000.0;
+		d["threaded_time"] = g.threaded_usec / 1000000.0;
+		stats.push_back(d);
+	}
+
+	return stats;
 }
 
 /*
@@ -2203,6 +2488,7 @@ void SceneTree::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("reload_current_scene"), &SceneTree::reload_current_scene);
 
 	ClassDB::bind_method(D_METHOD("_change_scene"), &SceneTree::_change_scene);
+	ClassDB::bind_method(D_METHOD("_canvas_xform_callback"), &SceneTree::_canvas_xform_callback);
 
 	ClassDB::bind_method(D_METHOD("set_network_peer", "peer:NetworkedMultiplayerPeer"), &SceneTree::set_network_peer);
 	ClassDB::bind_method(D_METHOD("is_network_server"), &SceneTree::is_network_server);
@@ -2285,6 +2571,18 @@ SceneTree::SceneTree() {
 	idle_process_time = 1;
 	last_id = 1;
 	root = NULL;
+	transform_hierarchy = memnew(TransformHierarchy);
+	canvas_xform_flush_queued = false;
+	canvas_xform_rids = NULL;
+	canvas_xforms = NULL;
+	canvas_xform_capacity = 0;
+	process_thread_count = GLOBAL_DEF("application/run/process_thread_count", 0);
+	GlobalConfig::get_singleton()->set_custom_property_info("application/run/process_thread_count", PropertyInfo(Variant::INT, "application/run/process_thread_count", PROPERTY_HINT_RANGE, "0,64,1"));
+	process_pool_initialized = false;
+	threaded_process_active = false;
+	threaded_process_lock = Mutex::create();
+	threaded_nodes = NULL;
+	threaded_node_capacity = 0;
 	current_frame = 0;
 	tree_changed_name = "tree_changed";
 	node_removed_name = "node_removed";
@@ -2362,4 +2660,14 @@ SceneTree::SceneTree() {
 }
 
 SceneTree::~SceneTree() {
+
+	memdelete(transform_hierarchy);
+	if (canvas_xform_rids) {
+		memfree(canvas_xform_rids);
+		memfree(canvas_xforms);
+	}
+	process_work_pool.finish();
+	if (threaded_nodes)
+		memfree(threaded_nodes);
+	memdelete(threaded_process_lock);
 }
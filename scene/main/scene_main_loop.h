@@ -33,6 +33,7 @@
 #include "io/networked_multiplayer_peer.h"
 #include "os/main_loop.h"
 #include "os/thread_safe.h"
+#include "os/thread_work_pool.h"
 #include "scene/resources/world.h"
 #include "scene/resources/world_2d.h"
 #include "self_list.h"
@@ -47,6 +48,8 @@ class Node;
 class Viewport;
 class Material;
 class Mesh;
+class CanvasItem;
+class TransformHierarchy;
 
 class SceneTreeTimer : public Reference {
 	GDCLASS(SceneTreeTimer, Reference);
@@ -94,10 +97,38 @@ public:
 private:
 	struct Group {
 
+		//nodes know their position in here (through index_slots), so they are removed in O(1)
 		Vector<Node *> nodes;
+		Vector<int *> index_slots;
 		//uint64_t last_tree_version;
-		bool changed;
-		Group() { changed = false; };
+		bool changed; //order of nodes already sorted changed, needs a full sort
+
+		//groups are only kept in tree order once something iterates them. Until then,
+		//removal swaps the last node in. After that, nodes[0..sorted) is in tree order,
+		//nodes added later are merged into it and removed ones leave a NULL behind,
+		//which are compacted on the next iteration.
+		bool ordered;
+		int sorted;
+		int removed;
+
+		//timing of the last notification pass, for Performance
+		uint64_t process_usec;
+		uint64_t threaded_usec;
+		int processed;
+		int threaded;
+
+		_FORCE_INLINE_ int size() const { return nodes.size() - removed; }
+
+		Group() {
+			changed = false;
+			ordered = false;
+			sorted = 0;
+			removed = 0;
+			process_usec = 0;
+			threaded_usec = 0;
+			processed = 0;
+			threaded = 0;
+		};
 	};
 
 	Viewport *root;
@@ -157,8 +188,16 @@ private:
 	bool ugc_locked;
 	void _flush_ugc();
 	void _flush_transform_notifications();
-
-	_FORCE_INLINE_ void _update_group_order(Group &g);
+	void _flush_canvas_invalidation();
+	void _flush_canvas_transforms();
+	void _queue_canvas_xform_flush();
+	void _canvas_xform_callback();
+
+	void _sort_group(Group &g);
+	_FORCE_INLINE_ void _update_group_order(Group &g) {
+		if (g.changed || g.removed || g.sorted < g.nodes.size() || !g.ordered)
+			_sort_group(g);
+	}
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -233,10 +272,27 @@ private:
 	void tree_changed();
 	void node_removed(Node *p_node);
 
-	Group *add_to_group(const StringName &p_group, Node *p_node);
-	void remove_from_group(const StringName &p_group, Node *p_node);
+	//p_index is kept up to date with the position of the node in the group
+	Group *add_to_group(const StringName &p_group, Node *p_node, int *p_index);
+	void remove_from_group(const StringName &p_group, Node *p_node, int p_index);
 
 	void _notify_group_pause(const StringName &p_group, int p_notification);
+
+	//nodes flagged as thread-safe are processed in parallel, after the rest of the group
+	struct ThreadedProcess {
+		Node **nodes;
+		int notification;
+	};
+
+	ThreadWorkPool process_work_pool;
+	int process_thread_count;
+	bool process_pool_initialized;
+	bool threaded_process_active;
+	Mutex *threaded_process_lock;
+	Node **threaded_nodes;
+	int threaded_node_capacity;
+
+	static void _threaded_process_range(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
 	void _call_input_pause(const StringName &p_group, const StringName &p_method, const InputEvent &p_input);
 	Variant _call_group_flags(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	Variant _call_group(const Variant **p_args, int p_argcount, Variant::CallError &r_error);
@@ -249,6 +305,15 @@ private:
 	friend class Viewport;
 
 	SelfList<Node>::List xform_change_list;
+	TransformHierarchy *transform_hierarchy;
+
+	//canvas items moved since the last flush, their children are not invalidated yet
+	SelfList<CanvasItem>::List canvas_xform_dirty_list;
+	SelfList<CanvasItem>::List canvas_xform_server_list;
+	bool canvas_xform_flush_queued;
+	RID *canvas_xform_rids;
+	Transform2D *canvas_xforms;
+	int canvas_xform_capacity;
 
 #ifdef DEBUG_ENABLED
 
@@ -414,6 +479,12 @@ public:
 
 	int get_node_count() const;
 
+	_FORCE_INLINE_ bool _is_threaded_process_active() const { return threaded_process_active; }
+	//lock for shared scene state touched from thread-safe process callbacks, NULL when running serially
+	_FORCE_INLINE_ Mutex *_get_threaded_process_lock() const { return threaded_process_active ? threaded_process_lock : NULL; }
+
+	Array get_process_group_stats() const;
+
 	void queue_delete(Object *p_object);
 
 	void get_nodes_in_group(const StringName &p_group, List<Node *> *p_list);
@@ -627,6 +627,25 @@ void register_scene_types() {
 	resource_loader_text = memnew(ResourceFormatLoaderText);
 	ResourceLoader::add_resource_format_loader(resource_loader_text, true);
 
+	//these create server objects when built, threaded loads read and decode them on workers and only build them on the main thread
+	ResourceLoader::add_main_thread_load_type("Texture");
+	ResourceLoader::add_main_thread_load_type("CubeMap");
+	ResourceLoader::add_main_thread_load_type("Material");
+	ResourceLoader::add_main_thread_load_type("Shader");
+	ResourceLoader::add_main_thread_load_type("Mesh");
+	ResourceLoader::add_main_thread_load_type("MultiMesh");
+	ResourceLoader::add_main_thread_load_type("GIProbeData");
+	ResourceLoader::add_main_thread_load_type("Environment");
+	ResourceLoader::add_main_thread_load_type("World");
+	ResourceLoader::add_main_thread_load_type("World2D");
+	ResourceLoader::add_main_thread_load_type("SkyBox");
+	ResourceLoader::add_main_thread_load_type("RoomBounds");
+	ResourceLoader::add_main_thread_load_type("Canvas");
+	ResourceLoader::add_main_thread_load_type("Space2D");
+	ResourceLoader::add_main_thread_load_type("Shape");
+	ResourceLoader::add_main_thread_load_type("Shape2D");
+	ResourceLoader::add_main_thread_load_type("PackedScene");
+
 	for (int i = 0; i < 20; i++) {
 		GLOBAL_DEF("layer_names/2d_render/layer_" + itos(i + 1), "");
 		GLOBAL_DEF("layer_names/2d_physics/layer_" + itos(i + 1), "");
@@ -42,6 +42,70 @@ bool SceneState::can_instance() const {
 	return nodes.size() > 0;
 }
 
+void SceneState::_compile() const {
+
+	int nc = nodes.size();
+	compiled_nodes.resize(nc);
+	compiled_setters.clear();
+
+	for (int i = 0; i < nc; i++) {
+
+		const NodeData &n = nodes[i];
+		CompiledNode &cn = compiled_nodes[i];
+		cn.creation_func = NULL;
+		cn.first_setter = compiled_setters.size();
+
+		//only nodes created here have a known class, inherited and instanced ones come from other scenes
+		StringName type;
+		if (!(i == 0 && base_scene_idx >= 0) && n.instance < 0 && n.type != TYPE_INSTANCED) {
+
+			type = names[n.type];
+			if (ClassDB::is_parent_class(type, "Node"))
+				cn.creation_func = ClassDB::get_creation_func(type);
+		}
+
+		for (int j = 0; j < n.properties.size(); j++) {
+
+			MethodBind *setter = NULL;
+			StringName name = names[n.properties[j].name];
+			if (cn.creation_func && name != CoreStringNames::get_singleton()->_script)
+				setter = ClassDB::get_property_setter_method(type, name);
+			compiled_setters.push_back(setter);
+		}
+	}
+
+	reset_taken = false;
+	atomic_memory_barrier(); //the tables must be complete before the flag is seen without the lock
+	compiled = true;
+}
+
+void SceneState::_ensure_compiled() const {
+
+	if (compiled) {
+		atomic_memory_barrier(); //pairs with the one in _compile()
+		return;
+	}
+
+	MutexLock lock(compile_lock);
+	if (!compiled)
+		_compile();
+}
+
+void SceneState::_set_property(Node *p_node, int p_setter, const StringName &p_name, const Variant &p_value) const {
+
+	MethodBind *setter = compiled_setters.get(p_setter);
+
+	//scripts may override any property, so they always go through set()
+	if (setter && !p_node->get_script_instance()) {
+
+		const Variant *arg[1] = { &p_value };
+		Variant::CallError ce;
+		setter->call(p_node, arg, 1, ce);
+	} else {
+		p_node->set(p_name, p_value);
+	}
+}
+
 Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	// nodes where instancing failed (because something is missing)
@@ -80,6 +144,13 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
 
+	//editor instances go through Object::set() so they are marked as edited
+	const CompiledNode *cnodes = NULL;
+	if (p_edit_state == GEN_EDIT_STATE_DISABLED) {
+		_ensure_compiled();
+		cnodes = compiled_nodes.ptr();
+	}
+
 	for (int i = 0; i < nc; i++) {
 
 		const NodeData &n = nd[i];
@@ -147,6 +218,10 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 				}
 #endif
 			}
+		} else if (cnodes && cnodes[i].creation_func) {
+			//same as below, with the class resolved already
+			node = (Node *)cnodes[i].creation_func();
+
 		} else if (ClassDB::is_class_enabled(snames[n.type])) {
 			//print_line("created");
 			//node belongs to this scene and must be created
@@ -248,7 +323,10 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 								}
 							}
 						}
-						node->set(snames[nprops[j].name], value, &valid);
+						if (cnodes)
+							_set_property(node, cnodes[i].first_setter + j, snames[nprops[j].name], value);
+						else
+							node->set(snames[nprops[j].name], value, &valid);
 					}
 				}
 			}
@@ -338,6 +416,211 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 	return ret_nodes[0];
 }
 
+bool SceneState::_find_instance_nodes(Node *p_instance, Node **r_nodes) const {
+
+	int nc = nodes.size();
+	const NodeData *nd = nodes.ptr();
+	const StringName *snames = names.ptr();
+
+	r_nodes[0] = p_instance;
+
+	for (int i = 1; i < nc; i++) {
+
+		const NodeData &n = nd[i];
+
+		Node *parent = NULL;
+		if (n.parent & FLAG_ID_IS_PATH) {
+			parent = p_instance->_get_node(node_paths[n.parent & FLAG_MASK]);
+		} else if ((n.parent & FLAG_MASK) < i) {
+			parent = r_nodes[n.parent & FLAG_MASK];
+		}
+
+		r_nodes[i] = parent ? parent->_get_child_by_name(snames[n.name]) : NULL;
+		if (!r_nodes[i])
+			return false; //renamed or removed since instanced
+	}
+
+	return true;
+}
+
+int SceneState::_get_connection_count(const Node *p_node) {
+
+	List<Object::Connection> connections;
+	p_node->get_all_signal_connections(&connections);
+	p_node->get_signals_connected_to_this(&connections);
+	return connections.size();
+}
+
+void SceneState::_take_reset_snapshot() const {
+
+	reset_nodes.clear();
+	reset_values.clear();
+
+	Node *fresh = instance(GEN_EDIT_STATE_DISABLED);
+	if (!fresh) {
+		atomic_memory_barrier();
+		reset_taken = true;
+		return;
+	}
+
+	int nc = nodes.size();
+	Node **fresh_nodes = (Node **)alloca(sizeof(Node *) * nc);
+
+	if (_find_instance_nodes(fresh, fresh_nodes)) {
+
+		reset_nodes.resize(nc);
+
+		for (int i = 0; i < nc; i++) {
+
+			Node *node = fresh_nodes[i];
+			ResetNode &rn = reset_nodes[i];
+			rn.child_count = node->get_child_count();
+			rn.connection_count = _get_connection_count(node);
+			rn.first_value = reset_values.size();
+
+			List<Node::GroupInfo> groups;
+			node->get_groups(&groups);
+			for (List<Node::GroupInfo>::Element *E = groups.front(); E; E = E->next()) {
+				rn.groups.push_back(E->get().name);
+			}
+
+			//everything saved with a scene, including values left at their defaults there
+			List<PropertyInfo> plist;
+			node->get_property_list(&plist);
+			const StringName &class_name = node->get_class_name();
+
+			for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next()) {
+
+				if (!(E->get().usage & PROPERTY_USAGE_STORAGE))
+					continue;
+
+				StringName name = E->get().name;
+				if (name == CoreStringNames::get_singleton()->_script)
+					continue; //the script stays, its instance is created again
+
+				Variant value = node->get(name);
+				if (value.get_type() == Variant::OBJECT) {
+					//resources local to scene were duplicated for each instance, keep its copy
+					Ref<Resource> res = value;
+					if (res.is_valid() && res->is_local_to_scene())
+						continue;
+				}
+
+				ResetValue rv;
+				rv.name = name;
+				rv.getter = ClassDB::get_property_getter_method(class_name, name);
+				rv.setter = ClassDB::get_property_setter_method(class_name, name);
+				rv.value = value;
+				reset_values.push_back(rv);
+			}
+
+			rn.value_count = reset_values.size() - rn.first_value;
+		}
+	}
+
+	memdelete(fresh);
+	atomic_memory_barrier(); //same as compiled, the snapshot is read without the lock
+	reset_taken = true;
+}
+
+bool SceneState::reset_instance(Node *p_instance) const {
+
+	ERR_FAIL_NULL_V(p_instance, false);
+
+	int nc = nodes.size();
+	ERR_FAIL_COND_V(nc == 0, false);
+
+	_ensure_compiled();
+
+	if (!reset_taken) {
+		MutexLock lock(compile_lock);
+		if (!reset_taken)
+			_take_reset_snapshot();
+	} else {
+		atomic_memory_barrier();
+	}
+
+	if (reset_nodes.size() != nc)
+		return false; //this state can't be instanced
+
+	const NodeData *nd = nodes.ptr();
+	const Variant *props = variants.ptr();
+	const ResetNode *rnodes = reset_nodes.ptr();
+	const ResetValue *rvalues = reset_values.ptr();
+
+	Node **ret_nodes = (Node **)alloca(sizeof(Node *) * nc);
+	if (!_find_instance_nodes(p_instance, ret_nodes))
+		return false;
+
+	//nodes, groups and connections added at runtime can't be told apart from the saved ones, so don't reuse it
+	for (int i = 0; i < nc; i++) {
+
+		Node *node = ret_nodes[i];
+		const ResetNode &rn = rnodes[i];
+
+		if (node->get_child_count() != rn.child_count || _get_connection_count(node) != rn.connection_count)
+			return false;
+
+		List<Node::GroupInfo> groups;
+		node->get_groups(&groups);
+		if (groups.size() != rn.groups.size())
+			return false;
+		for (int j = 0; j < rn.groups.size(); j++) {
+			if (!node->is_in_group(rn.groups[j]))
+				return false;
+		}
+	}
+
+	for (int i = 0; i < nc; i++) {
+
+		const NodeData &n = nd[i];
+		const ResetNode &rn = rnodes[i];
+		Node *node = ret_nodes[i];
+
+		//nodes coming from other scenes are reset by them first
+		Ref<PackedScene> sdata;
+		if (i == 0 && base_scene_idx >= 0) {
+			sdata = props[base_scene_idx];
+		} else if (n.instance >= 0) {
+			if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER)
+				return false;
+			sdata = props[n.instance & FLAG_MASK];
+		}
+
+		if (sdata.is_valid()) {
+			if (!sdata->get_state()->reset_instance(node))
+				return false;
+		} else if (node->get_script_instance()) {
+			//start the script over, its members were changed at runtime too
+			RefPtr script = node->get_script();
+			node->set_script(RefPtr());
+			node->set_script(script);
+		}
+
+		bool scripted = node->get_script_instance() != NULL;
+
+		for (int j = 0; j < rn.value_count; j++) {
+
+			const ResetValue &rv = rvalues[rn.first_value + j];
+
+			//scripts may override any property, so they always go through get() and set()
+			Variant::CallError ce;
+			Variant current = (rv.getter && !scripted) ? rv.getter->call(node, NULL, 0, ce) : node->get(rv.name);
+			if (current == rv.value)
+				continue;
+
+			if (rv.setter && !scripted) {
+				const Variant *arg[1] = { &rv.value };
+				rv.setter->call(node, arg, 1, ce);
+			} else {
+				node->set(rv.name, rv.value);
+			}
+		}
+	}
+
+	return true;
+}
+
 static int _nm_get_string(const String &p_string, Map<StringName, int> &name_map) {
 
 	if (name_map.has(p_string))
@@ -348,17 +631,18 @@ static int _nm_get_string(const String &p_string, Map<StringName, int> &name_map
 	return idx;
 }
 
-static int _vm_get_variant(const Variant &p_variant, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map) {
+static int _vm_get_variant(const Variant &p_variant, OAHashMap<Variant, int, VariantHasher, VariantComparator> &variant_map) {
 
-	if (variant_map.has(p_variant))
-		return variant_map[p_variant];
+	const int *existing = variant_map.getptr(p_variant);
+	if (existing)
+		return *existing;
 
 	int idx = variant_map.size();
 	variant_map[p_variant] = idx;
 	return idx;
 }
 
-Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map) {
+Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, OAHashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map) {
 
 	// this function handles all the work related to properly packing scenes, be it
 	// instanced or inherited.
@@ -716,7 +1000,7 @@ Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map
 	return OK;
 }
 
-Error SceneState::_parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map) {
+Error SceneState::_parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, OAHashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map) {
 
 	if (p_node != p_owner && p_node->get_owner() && p_node->get_owner() != p_owner && !p_owner->is_editable_instance(p_node->get_owner()))
 		return OK;
@@ -904,7 +1188,7 @@ Error SceneState::pack(Node *p_scene) {
 	Node *scene = p_scene;
 
 	Map<StringName, int> name_map;
-	HashMap<Variant, int, VariantHasher, VariantComparator> variant_map;
+	OAHashMap<Variant, int, VariantHasher, VariantComparator> variant_map;
 	Map<Node *, int> node_map;
 	Map<Node *, int> nodepath_map;
 
@@ -975,6 +1259,7 @@ void SceneState::clear() {
 	node_paths.clear();
 	editable_instances.clear();
 	base_scene_idx = -1;
+	compiled = false;
 }
 
 Ref<SceneState> SceneState::_get_base_scene_state() const {
@@ -1143,6 +1428,8 @@ void SceneState::set_bundled_scene(const Dictionary &d) {
 		ERR_FAIL();
 	}
 
+	compiled = false;
+
 	PoolVector<String> snames = d["names"];
 	if (snames.size()) {
 
@@ -1583,6 +1870,12 @@ int SceneState::add_value(const Variant &p_value) {
 	return variants.size() - 1;
 }
 
+void SceneState::set_value(int p_idx, const Variant &p_value) {
+
+	ERR_FAIL_INDEX(p_idx, variants.size());
+	variants[p_idx] = p_value;
+}
+
 int SceneState::add_node_path(const NodePath &p_path) {
 
 	node_paths.push_back(p_path);
@@ -1598,6 +1891,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
 	nd.instance = p_instance;
 
 	nodes.push_back(nd);
+	compiled = false;
 
 	return nodes.size() - 1;
 }
@@ -1611,6 +1905,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	prop.name = p_name;
 	prop.value = p_value;
 	nodes[p_node].properties.push_back(prop);
+	compiled = false;
 }
 void SceneState::add_node_group(int p_node, int p_group) {
 
@@ -1689,6 +1984,14 @@ SceneState::SceneState() {
 
 	base_scene_idx = -1;
 	last_modified_time = 0;
+	compiled = false;
+	reset_taken = false;
+	compile_lock = Mutex::create();
+}
+
+SceneState::~SceneState() {
+
+	memdelete(compile_lock);
 }
 
 ////////////////
@@ -1705,11 +2008,13 @@ Dictionary PackedScene::_get_bundled_scene() const {
 
 Error PackedScene::pack(Node *p_scene) {
 
+	clear_pool();
 	return state->pack(p_scene);
 }
 
 void PackedScene::clear() {
 
+	clear_pool();
 	state->clear();
 }
 
@@ -1727,6 +2032,23 @@ Node *PackedScene::instance(GenEditState p_edit_state) const {
 	}
 #endif
 
+	if (p_edit_state == GEN_EDIT_STATE_DISABLED) {
+
+		Node *s = NULL;
+		{
+			MutexLock lock(pool_lock);
+			if (pool.size()) {
+				s = pool[pool.size() - 1];
+				pool.resize(pool.size() - 1);
+			}
+		}
+
+		if (s) {
+			s->notification(Node::NOTIFICATION_INSTANCED);
+			return s;
+		}
+	}
+
 	Node *s = state->instance((SceneState::GenEditState)p_edit_state);
 	if (!s)
 		return NULL;
@@ -1743,8 +2065,87 @@ Node *PackedScene::instance(GenEditState p_edit_state) const {
 	return s;
 }
 
+void PackedScene::set_pool_size(int p_size) {
+
+	ERR_FAIL_COND(p_size < 0);
+
+	Vector<Node *> extra;
+	{
+		MutexLock lock(pool_lock);
+		pool_size = p_size;
+		while (pool.size() > pool_size) {
+			extra.push_back(pool[pool.size() - 1]);
+			pool.resize(pool.size() - 1);
+		}
+	}
+
+	for (int i = 0; i < extra.size(); i++) {
+		memdelete(extra[i]);
+	}
+}
+
+int PackedScene::get_pool_size() const {
+
+	return pool_size;
+}
+
+bool PackedScene::recycle(Node *p_instance) {
+
+	ERR_FAIL_NULL_V(p_instance, false);
+	ERR_EXPLAIN("Only instances removed from their parent can be recycled.");
+	ERR_FAIL_COND_V(p_instance->get_parent() || p_instance->is_inside_tree(), false);
+
+	//from here on the instance is ours, anything that can't be pooled is freed
+	if (get_path() != "" && get_path().find("::") == -1 && p_instance->get_filename() != get_path()) {
+		ERR_PRINTS("Node is not an instance of this scene: " + p_instance->get_filename());
+		memdelete(p_instance);
+		return false;
+	}
+
+	bool full;
+	{
+		MutexLock lock(pool_lock);
+		full = pool.size() >= pool_size;
+	}
+
+	//resetting is the slow part, keep it out of the lock
+	if (full || !state->reset_instance(p_instance)) {
+		memdelete(p_instance);
+		return false;
+	}
+
+	{
+		MutexLock lock(pool_lock);
+		full = pool.size() >= pool_size; //others may have filled it meanwhile
+		if (!full)
+			pool.push_back(p_instance);
+	}
+
+	if (full) {
+		memdelete(p_instance);
+		return false;
+	}
+
+	return true;
+}
+
+void PackedScene::clear_pool() {
+
+	Vector<Node *> pooled;
+	{
+		MutexLock lock(pool_lock);
+		pooled = pool;
+		pool.clear();
+	}
+
+	for (int i = 0; i < pooled.size(); i++) {
+		memdelete(pooled[i]);
+	}
+}
+
 void PackedScene::replace_state(Ref<SceneState> p_by) {
 
+	clear_pool();
 	state = p_by;
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1754,6 +2155,7 @@ void PackedScene::replace_state(Ref<SceneState> p_by) {
 
 void PackedScene::recreate_state() {
 
+	clear_pool();
 	state = Ref<SceneState>(memnew(SceneState));
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1780,6 +2182,10 @@ void PackedScene::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_set_bundled_scene"), &PackedScene::_set_bundled_scene);
 	ClassDB::bind_method(D_METHOD("_get_bundled_scene"), &PackedScene::_get_bundled_scene);
 	ClassDB::bind_method(D_METHOD("get_state:SceneState"), &PackedScene::get_state);
+	ClassDB::bind_method(D_METHOD("set_pool_size", "size"), &PackedScene::set_pool_size);
+	ClassDB::bind_method(D_METHOD("get_pool_size"), &PackedScene::get_pool_size);
+	ClassDB::bind_method(D_METHOD("recycle", "instance:Node"), &PackedScene::recycle);
+	ClassDB::bind_method(D_METHOD("clear_pool"), &PackedScene::clear_pool);
 
 	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "_bundled"), "_set_bundled_scene", "_get_bundled_scene");
 
@@ -1791,4 +2197,12 @@ void PackedScene::_bind_methods() {
 PackedScene::PackedScene() {
 
 	state = Ref<SceneState>(memnew(SceneState));
+	pool_size = 0;
+	pool_lock = Mutex::create();
+}
+
+PackedScene::~PackedScene() {
+
+	clear_pool();
+	memdelete(pool_lock);
 }
@@ -88,8 +88,49 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
-	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
-	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
+	//instance() resolves class constructors and property setters on first use, and replays them afterwards
+	struct CompiledNode {
+
+		ClassDB::CreationFunc creation_func; //NULL when the node is not created by this state
+		int first_setter;
+	};
+
+	mutable Vector<CompiledNode> compiled_nodes;
+	mutable Vector<MethodBind *> compiled_setters; //one per node property, NULL to go through Object::set()
+	mutable bool compiled;
+	Mutex *compile_lock;
+
+	//reset_instance() compares with and restores what a fresh instance looked like, taken on first use
+	struct ResetValue {
+
+		StringName name;
+		MethodBind *getter; //NULL to go through Object::get()
+		MethodBind *setter; //NULL to go through Object::set()
+		Variant value;
+	};
+
+	struct ResetNode {
+
+		int child_count;
+		int connection_count;
+		Vector<StringName> groups;
+		int first_value;
+		int value_count;
+	};
+
+	mutable Vector<ResetNode> reset_nodes;
+	mutable Vector<ResetValue> reset_values;
+	mutable bool reset_taken;
+
+	void _compile() const;
+	_FORCE_INLINE_ void _ensure_compiled() const;
+	void _take_reset_snapshot() const;
+	bool _find_instance_nodes(Node *p_instance, Node **r_nodes) const;
+	static int _get_connection_count(const Node *p_node);
+	_FORCE_INLINE_ void _set_property(Node *p_node, int p_setter, const StringName &p_name, const Variant &p_value) const;
+
+	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, OAHashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
+	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, OAHashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
 	String path;
 
@@ -139,6 +180,8 @@ public:
 
 	bool can_instance() const;
 	Node *instance(GenEditState p_edit_state) const;
+	//brings an instance of this state back to how it was instanced, false if its nodes, groups or connections changed
+	bool reset_instance(Node *p_instance) const;
 
 	//unbuild API
 
@@ -173,6 +216,7 @@ public:
 	int add_name(const StringName &p_name);
 	int find_name(const StringName &p_name) const;
 	int add_value(const Variant &p_value);
+	void set_value(int p_idx, const Variant &p_value);
 	int add_node_path(const NodePath &p_path);
 	int add_node(int p_parent, int p_owner, int p_type, int p_name, int p_instance);
 	void add_node_property(int p_node, int p_name, int p_value);
@@ -185,6 +229,7 @@ public:
 	uint64_t get_last_modified_time() const { return last_modified_time; }
 
 	SceneState();
+	~SceneState();
 };
 
 VARIANT_ENUM_CAST(SceneState::GenEditState)
@@ -196,6 +241,11 @@ class PackedScene : public Resource {
 
 	Ref<SceneState> state;
 
+	//recycled instances, handed out again by instance()
+	mutable Vector<Node *> pool;
+	int pool_size;
+	Mutex *pool_lock;
+
 	void _set_bundled_scene(const Dictionary &p_scene);
 	Dictionary _get_bundled_scene() const;
 
@@ -217,6 +267,12 @@ public:
 	bool can_instance() const;
 	Node *instance(GenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
 
+	void set_pool_size(int p_size);
+	int get_pool_size() const;
+	//takes the instance unless it is still in a tree, it is freed when it can't be pooled
+	bool recycle(Node *p_instance);
+	void clear_pool();
+
 	void recreate_state();
 	void replace_state(Ref<SceneState> p_by);
 
@@ -228,6 +284,7 @@ public:
 	Ref<SceneState> get_state();
 
 	PackedScene();
+	~PackedScene();
 };
 
 VARIANT_ENUM_CAST(PackedScene::GenEditState)
@@ -68,12 +68,18 @@ Error ResourceInteractiveLoaderText::_parse_sub_resource(VariantParser::Stream *
 
 	if (!ignore_resource_parsing) {
 
-		if (!ResourceCache::has(path)) {
-			r_err_str = "Can't load cached sub-resource: " + path;
-			return ERR_PARSE_ERROR;
-		}
+		const Map<String, RES>::Element *P = placeholder_paths.find(path);
+		if (P) {
+			r_res = P->get(); //parsing ahead, replaced once built
+		} else {
 
-		r_res = RES(ResourceCache::get(path));
+			if (!ResourceCache::has(path)) {
+				r_err_str = "Can't load cached sub-resource: " + path;
+				return ERR_PARSE_ERROR;
+			}
+
+			r_res = RES(ResourceCache::get(path));
+		}
 	} else {
 		r_res = RES();
 	}
@@ -136,6 +142,9 @@ Error ResourceInteractiveLoaderText::poll() {
 	if (error != OK)
 		return error;
 
+	if (parsed_ahead)
+		return _build_parsed();
+
 	if (next_tag.name == "ext_resource") {
 
 		if (!next_tag.fields.has("path")) {
@@ -227,8 +236,17 @@ Error ResourceInteractiveLoaderText::poll() {
 		//bool exists=ResourceCache::has(path);
 
 		Ref<Resource> res;
+		ParsedResource *parsed = NULL;
 
-		if (!ResourceCache::has(path)) { //only if it doesn't exist
+		if (parsing_ahead) {
+
+			parsed = &parsed_resources.push_back(ParsedResource())->get();
+			parsed->type = type;
+			parsed->path = path;
+			parsed->placeholder.instance();
+			placeholder_paths[path] = parsed->placeholder;
+
+		} else if (!ResourceCache::has(path)) { //only if it doesn't exist
 
 			Object *obj = ClassDB::instance(type);
 			if (!obj) {
@@ -268,7 +286,9 @@ Error ResourceInteractiveLoaderText::poll() {
 			}
 
 			if (assign != String()) {
-				if (res.is_valid()) {
+				if (parsed) {
+					parsed->properties.push_back(Pair<StringName, Variant>(assign, value));
+				} else if (res.is_valid()) {
 					res->set(assign, value);
 				}
 				//it's assignment
@@ -296,25 +316,36 @@ Error ResourceInteractiveLoaderText::poll() {
 			return error;
 		}
 
-		Object *obj = ClassDB::instance(res_type);
-		if (!obj) {
+		ParsedResource *parsed = NULL;
 
-			error_text += "Can't create sub resource of type: " + res_type;
-			_printerr();
-			error = ERR_FILE_CORRUPT;
-			return error;
-		}
+		if (parsing_ahead) {
 
-		Resource *r = obj->cast_to<Resource>();
-		if (!r) {
+			parsed = &parsed_resources.push_back(ParsedResource())->get();
+			parsed->type = res_type;
+			parsed->path = res_path;
 
-			error_text += "Can't create sub resource of type, because not a resource: " + res_type;
-			_printerr();
-			error = ERR_FILE_CORRUPT;
-			return error;
-		}
+		} else {
+
+			Object *obj = ClassDB::instance(res_type);
+			if (!obj) {
+
+				error_text += "Can't create sub resource of type: " + res_type;
+				_printerr();
+				error = ERR_FILE_CORRUPT;
+				return error;
+			}
 
-		resource = Ref<Resource>(r);
+			Resource *r = obj->cast_to<Resource>();
+			if (!r) {
+
+				error_text += "Can't create sub resource of type, because not a resource: " + res_type;
+				_printerr();
+				error = ERR_FILE_CORRUPT;
+				return error;
+			}
+
+			resource = Ref<Resource>(r);
+		}
 
 		resource_current++;
 
@@ -328,7 +359,7 @@ Error ResourceInteractiveLoaderText::poll() {
 			if (error) {
 				if (error != ERR_FILE_EOF) {
 					_printerr();
-				} else {
+				} else if (!parsed) {
 					if (!ResourceCache::has(res_path)) {
 						resource->set_path(res_path);
 					}
@@ -337,7 +368,10 @@ Error ResourceInteractiveLoaderText::poll() {
 			}
 
 			if (assign != String()) {
-				resource->set(assign, value);
+				if (parsed)
+					parsed->properties.push_back(Pair<StringName, Variant>(assign, value));
+				else
+					resource->set(assign, value);
 				//it's assignment
 			} else if (next_tag.name != String()) {
 
@@ -401,7 +435,7 @@ Error ResourceInteractiveLoaderText::poll() {
 
 		if (next_tag.fields.has("instance")) {
 
-			instance = packed_scene->get_state()->add_value(next_tag.fields["instance"]);
+			instance = _add_scene_value(next_tag.fields["instance"]);
 
 			if (packed_scene->get_state()->get_node_count() == 0 && parent == -1) {
 				packed_scene->get_state()->set_base_scene(instance);
@@ -452,7 +486,7 @@ Error ResourceInteractiveLoaderText::poll() {
 			if (error) {
 				if (error != ERR_FILE_EOF) {
 					_printerr();
-				} else {
+				} else if (!parsing_ahead) {
 					resource = packed_scene;
 					if (!ResourceCache::has(res_path)) {
 						packed_scene->set_path(res_path);
@@ -463,7 +497,7 @@ Error ResourceInteractiveLoaderText::poll() {
 
 			if (assign != String()) {
 				int nameidx = packed_scene->get_state()->add_name(assign);
-				int valueidx = packed_scene->get_state()->add_value(value);
+				int valueidx = _add_scene_value(value);
 				packed_scene->get_state()->add_node_property(node_id, nameidx, valueidx);
 				//it's assignment
 			} else if (next_tag.name != String()) {
@@ -531,7 +565,7 @@ Error ResourceInteractiveLoaderText::poll() {
 
 		Vector<int> bind_ints;
 		for (int i = 0; i < binds.size(); i++) {
-			bind_ints.push_back(packed_scene->get_state()->add_value(binds[i]));
+			bind_ints.push_back(_add_scene_value(binds[i]));
 		}
 
 		packed_scene->get_state()->add_connection(
@@ -597,6 +631,119 @@ Error ResourceInteractiveLoaderText::poll() {
 	return OK;
 }
 
+int ResourceInteractiveLoaderText::_add_scene_value(const Variant &p_value) {
+
+	int index = packed_scene->get_state()->add_value(p_value);
+
+	if (parsing_ahead) {
+		//may hold placeholders, replaced once built
+		Variant::Type type = p_value.get_type();
+		if (type == Variant::OBJECT || type == Variant::ARRAY || type == Variant::DICTIONARY)
+			scene_values.push_back(Pair<int, Variant>(index, p_value));
+	}
+
+	return index;
+}
+
+Error ResourceInteractiveLoaderText::_build_parsed() {
+
+	if (parsed_resources.size()) {
+
+		ParsedResource parsed = parsed_resources.front()->get();
+		parsed_resources.pop_front();
+
+		bool main = parsed.placeholder.is_null(); //nothing refers to the main resource
+
+		if (!main && ResourceCache::has(parsed.path)) {
+			//loaded meanwhile, values parsed ahead get the cached one
+			_set_placeholder_resource(parsed.placeholder, RES(ResourceCache::get(parsed.path)));
+			return OK;
+		}
+
+		Object *obj = ClassDB::instance(parsed.type);
+		if (!obj) {
+
+			error_text += "Can't create sub resource of type: " + parsed.type;
+			_printerr();
+			error = ERR_FILE_CORRUPT;
+			return error;
+		}
+
+		Resource *r = obj->cast_to<Resource>();
+		if (!r) {
+
+			error_text += "Can't create sub resource of type, because not a resource: " + parsed.type;
+			_printerr();
+			memdelete(obj);
+			error = ERR_FILE_CORRUPT;
+			return error;
+		}
+
+		Ref<Resource> res = Ref<Resource>(r);
+
+		if (!main) {
+			resource_cache.push_back(res);
+			res->set_path(parsed.path);
+			_set_placeholder_resource(parsed.placeholder, res);
+		}
+
+		for (List<Pair<StringName, Variant> >::Element *E = parsed.properties.front(); E; E = E->next()) {
+			res->set(E->get().first, _replace_placeholders(E->get().second));
+		}
+
+		if (!main)
+			return OK;
+
+		resource = res;
+		if (!ResourceCache::has(res_path)) {
+			resource->set_path(res_path);
+		}
+
+		error = ERR_FILE_EOF;
+		return error;
+	}
+
+	if (is_scene) {
+
+		for (List<Pair<int, Variant> >::Element *E = scene_values.front(); E; E = E->next()) {
+			packed_scene->get_state()->set_value(E->get().first, _replace_placeholders(E->get().second));
+		}
+		scene_values.clear();
+
+		resource = packed_scene;
+		if (!ResourceCache::has(res_path)) {
+			packed_scene->set_path(res_path);
+		}
+	}
+
+	error = ERR_FILE_EOF;
+	return error;
+}
+
+Error ResourceInteractiveLoaderText::parse_ahead() {
+
+	parsing_ahead = true;
+
+	while (poll() == OK) {
+	}
+
+	parsing_ahead = false;
+	placeholder_paths.clear();
+
+	if (error != ERR_FILE_EOF) {
+		parsed_resources.clear();
+		scene_values.clear();
+		return error;
+	}
+
+	//only building is left, see _build_parsed()
+	error = OK;
+	resource = RES();
+	parsed_ahead = true;
+
+	return OK;
+}
+
 int ResourceInteractiveLoaderText::get_stage() const {
 
 	return resource_current;
@@ -770,6 +917,8 @@ void ResourceInteractiveLoaderText::open(FileAccess *p_f, bool p_skip_first_tag)
 	stream.f = f;
 	is_scene = false;
 	ignore_resource_parsing = false;
+	parsing_ahead = false;
+	parsed_ahead = false;
 	resource_current = 0;
 
 	VariantParser::Tag tag;
@@ -33,6 +33,7 @@
 #include "io/resource_loader.h"
 #include "io/resource_saver.h"
 #include "os/file_access.h"
+#include "pair.h"
 #include "scene/resources/packed_scene.h"
 #include "variant_parser.h"
 
@@ -88,12 +89,29 @@ class ResourceInteractiveLoaderText : public ResourceInteractiveLoader {
 
 	RES resource;
 
+	struct ParsedResource {
+		String type;
+		String path;
+		List<Pair<StringName, Variant> > properties;
+		RES placeholder; // stands in for it in values parsed ahead, none for the main resource
+	};
+
+	bool parsing_ahead;
+	bool parsed_ahead;
+	List<ParsedResource> parsed_resources;
+	Map<String, RES> placeholder_paths; // while parsing ahead
+	List<Pair<int, Variant> > scene_values; // scene values that may hold placeholders
+
+	int _add_scene_value(const Variant &p_value);
+	Error _build_parsed();
+
 public:
 	virtual void set_local_path(const String &p_local_path);
 	virtual Ref<Resource> get_resource();
 	virtual Error poll();
 	virtual int get_stage() const;
 	virtual int get_stage_count() const;
+	virtual Error parse_ahead();
 
 	void open(FileAccess *p_f, bool p_skip_first_tag = false);
 	String recognize(FileAccess *p_f);
@@ -106,6 +124,7 @@ public:
 class ResourceFormatLoaderText : public ResourceFormatLoader {
 public:
 	virtual Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, Error *r_error = NULL);
+	virtual bool can_parse_ahead() const { return true; }
 	virtual void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions) const;
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
 	virtual bool handles_type(const String &p_type) const;
@@ -442,7 +442,7 @@ Image::Format StreamTexture::get_format() const {
 	return format;
 }
 
-Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &flags, Image &image, int p_size_limit) {
+Error StreamTexture::_decode_data(const String &p_path, int &tw, int &th, int &flags, uint32_t &r_data_format, Image &image, int p_size_limit) {
 
 	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
 	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
@@ -458,28 +458,13 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &fla
 	th = f->get_32();
 	flags = f->get_32(); //texture flags!
 	uint32_t df = f->get_32(); //data format
+	r_data_format = df;
 
 	print_line("width: " + itos(tw));
 	print_line("height: " + itos(th));
 	print_line("flags: " + itos(flags));
 	print_line("df: " + itos(df));
 
-	if (request_3d_callback && df & FORMAT_BIT_DETECT_3D) {
-		print_line("request detect 3D at " + p_path);
-		VS::get_singleton()->texture_set_detect_3d_callback(texture, _requested_3d, this);
-	} else {
-		print_line("not requesting detect 3D at " + p_path);
-		VS::get_singleton()->texture_set_detect_3d_callback(texture, NULL, NULL);
-	}
-
-	if (request_srgb_callback && df & FORMAT_BIT_DETECT_SRGB) {
-		print_line("request detect srgb at " + p_path);
-		VS::get_singleton()->texture_set_detect_srgb_callback(texture, _requested_srgb, this);
-	} else {
-		VS::get_singleton()->texture_set_detect_srgb_callback(texture, NULL, NULL);
-		print_line("not requesting detect srgb at " + p_path);
-	}
-
 	if (!(df & FORMAT_BIT_STREAM)) {
 		p_size_limit = 0;
 	}
@@ -644,22 +629,44 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &fla
 	return ERR_BUG; //unreachable
 }
 
+void StreamTexture::_load_decoded(const String &p_path, int p_w, int p_h, int p_flags, uint32_t p_data_format, const Image &p_image) {
+
+	if (request_3d_callback && p_data_format & FORMAT_BIT_DETECT_3D) {
+		print_line("request detect 3D at " + p_path);
+		VS::get_singleton()->texture_set_detect_3d_callback(texture, _requested_3d, this);
+	} else {
+		print_line("not requesting detect 3D at " + p_path);
+		VS::get_singleton()->texture_set_detect_3d_callback(texture, NULL, NULL);
+	}
+
+	if (request_srgb_callback && p_data_format & FORMAT_BIT_DETECT_SRGB) {
+		print_line("request detect srgb at " + p_path);
+		VS::get_singleton()->texture_set_detect_srgb_callback(texture, _requested_srgb, this);
+	} else {
+		VS::get_singleton()->texture_set_detect_srgb_callback(texture, NULL, NULL);
+		print_line("not requesting detect srgb at " + p_path);
+	}
+
+	VS::get_singleton()->texture_allocate(texture, p_image.get_width(), p_image.get_height(), p_image.get_format(), p_flags);
+	VS::get_singleton()->texture_set_data(texture, p_image);
+
+	w = p_w;
+	h = p_h;
+	flags = p_flags;
+	path_to_file = p_path;
+	format = p_image.get_format();
+}
+
 Error StreamTexture::load(const String &p_path) {
 
 	int lw, lh, lflags;
+	uint32_t ldf;
 	Image image;
-	Error err = _load_data(p_path, lw, lh, lflags, image);
+	Error err = _decode_data(p_path, lw, lh, lflags, ldf, image);
 	if (err)
 		return err;
 
-	VS::get_singleton()->texture_allocate(texture, image.get_width(), image.get_height(), image.get_format(), lflags);
-	VS::get_singleton()->texture_set_data(texture, image);
-
-	w = lw;
-	h = lh;
-	flags = lflags;
-	path_to_file = p_path;
-	format = image.get_format();
+	_load_decoded(p_path, lw, lh, lflags, ldf, image);
 
 	return OK;
 }
@@ -760,6 +767,54 @@ RES ResourceFormatLoaderStreamTexture::load(const String &p_path, const String &
 	return st;
 }
 
+Error ResourceInteractiveLoaderStreamTexture::poll() {
+
+	if (error != OK)
+		return error;
+
+	if (!decoded) {
+		error = parse_ahead();
+		if (error != OK)
+			return error;
+	}
+
+	Ref<StreamTexture> st;
+	st.instance();
+	st->_load_decoded(path, width, height, flags, data_format, image);
+	image = Image();
+
+	resource = st;
+	error = ERR_FILE_EOF;
+	return error;
+}
+
+Error ResourceInteractiveLoaderStreamTexture::parse_ahead() {
+
+	//decoding needs no server, only the texture upload does
+	error = StreamTexture::_decode_data(path, width, height, flags, data_format, image);
+	decoded = error == OK;
+	return error;
+}
+
+ResourceInteractiveLoaderStreamTexture::ResourceInteractiveLoaderStreamTexture() {
+
+	width = 0;
+	height = 0;
+	flags = 0;
+	data_format = 0;
+	decoded = false;
+	error = OK;
+}
+
+Ref<ResourceInteractiveLoader> ResourceFormatLoaderStreamTexture::load_interactive(const String &p_path, Error *r_error) {
+
+	Ref<ResourceInteractiveLoaderStreamTexture> ril = memnew(ResourceInteractiveLoaderStreamTexture);
+	ril->path = p_path;
+	if (r_error)
+		*r_error = OK;
+	return ril;
+}
+
 void ResourceFormatLoaderStreamTexture::get_recognized_extensions(List<String> *p_extensions) const {
 
 	p_extensions->push_back("stex");
@@ -175,7 +175,10 @@ public:
 	};
 
 private:
-	Error _load_data(const String &p_path, int &tw, int &th, int &flags, Image &image, int p_size_limit = 0);
+	friend class ResourceInteractiveLoaderStreamTexture;
+
+	static Error _decode_data(const String &p_path, int &tw, int &th, int &flags, uint32_t &r_data_format, Image &image, int p_size_limit = 0);
+	void _load_decoded(const String &p_path, int p_w, int p_h, int p_flags, uint32_t p_data_format, const Image &p_image);
 	String path_to_file;
 	RID texture;
 	Image::Format format;
@@ -218,8 +221,34 @@ public:
 	~StreamTexture();
 };
 
+//decodes the image when parsed ahead, only the server texture is made when polled
+class ResourceInteractiveLoaderStreamTexture : public ResourceInteractiveLoader {
+
+	friend class ResourceFormatLoaderStreamTexture;
+
+	String path;
+	int width, height, flags;
+	uint32_t data_format;
+	Image image;
+	bool decoded;
+	Error error;
+	RES resource;
+
+public:
+	virtual void set_local_path(const String &p_local_path) {}
+	virtual Ref<Resource> get_resource() { return resource; }
+	virtual Error poll();
+	virtual int get_stage() const { return resource.is_valid() ? 1 : 0; }
+	virtual int get_stage_count() const { return 1; }
+	virtual Error parse_ahead();
+
+	ResourceInteractiveLoaderStreamTexture();
+};
+
 class ResourceFormatLoaderStreamTexture : public ResourceFormatLoader {
 public:
+	virtual Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, Error *r_error = NULL);
+	virtual bool can_parse_ahead() const { return true; }
 	virtual RES load(const String &p_path, const String &p_original_path = "", Error *r_error = NULL);
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
 	virtual bool handles_type(const String &p_type) const;
@@ -30,14 +30,32 @@
 #include "area_pair_sw.h"
 #include "collision_solver_sw.h"
 
+void AreaPairSW::narrowphase(real_t p_step) {
+
+	narrowphase_done = true;
+
+	if (!area->test_collision_mask(body)) {
+		narrowphase_result = false;
+		return;
+	}
+
+	narrowphase_result = CollisionSolverSW::solve_static(body->get_shape(body_shape), body->get_transform() * body->get_shape_transform(body_shape), area->get_shape(area_shape), area->get_transform() * area->get_shape_transform(area_shape), NULL, this);
+}
+
 bool AreaPairSW::setup(real_t p_step) {
 
+	if (!narrowphase_done) {
+		narrowphase(p_step);
+	}
+
+	narrowphase_done = false;
+
 	if (!area->test_collision_mask(body)) {
 		colliding = false;
 		return false;
 	}
 
-	bool result = CollisionSolverSW::solve_static(body->get_shape(body_shape), body->get_transform() * body->get_shape_transform(body_shape), area->get_shape(area_shape), area->get_transform() * area->get_shape_transform(area_shape), NULL, this);
+	bool result = narrowphase_result;
 
 	if (result != colliding) {
 
@@ -71,6 +89,8 @@ AreaPairSW::AreaPairSW(BodySW *p_body, int p_body_shape, AreaSW *p_area, int p_a
 	area = p_area;
 	body_shape = p_body_shape;
 	area_shape = p_area_shape;
+	narrowphase_result = false;
+	narrowphase_done = false;
 	colliding = false;
 	body->add_constraint(this, 0);
 	area->add_constraint(this);
@@ -93,15 +113,33 @@ AreaPairSW::~AreaPairSW() {
 
 ////////////////////////////////////////////////////
 
+void Area2PairSW::narrowphase(real_t p_step) {
+
+	narrowphase_done = true;
+
+	if (!area_a->test_collision_mask(area_b)) {
+		narrowphase_result = false;
+		return;
+	}
+
+	//bool result = area_a->test_collision_mask(area_b) && CollisionSolverSW::solve(area_a->get_shape(shape_a),area_a->get_transform() * area_a->get_shape_transform(shape_a),Vector2(),area_b->get_shape(shape_b),area_b->get_transform() * area_b->get_shape_transform(shape_b),Vector2(),NULL,this);
+	narrowphase_result = CollisionSolverSW::solve_static(area_a->get_shape(shape_a), area_a->get_transform() * area_a->get_shape_transform(shape_a), area_b->get_shape(shape_b), area_b->get_transform() * area_b->get_shape_transform(shape_b), NULL, this);
+}
+
 bool Area2PairSW::setup(real_t p_step) {
 
+	if (!narrowphase_done) {
+		narrowphase(p_step);
+	}
+
+	narrowphase_done = false;
+
 	if (!area_a->test_collision_mask(area_b)) {
 		colliding = false;
 		return false;
 	}
 
-	//bool result = area_a->test_collision_mask(area_b) && CollisionSolverSW::solve(area_a->get_shape(shape_a),area_a->get_transform() * area_a->get_shape_transform(shape_a),Vector2(),area_b->get_shape(shape_b),area_b->get_transform() * area_b->get_shape_transform(shape_b),Vector2(),NULL,this);
-	bool result = CollisionSolverSW::solve_static(area_a->get_shape(shape_a), area_a->get_transform() * area_a->get_shape_transform(shape_a), area_b->get_shape(shape_b), area_b->get_transform() * area_b->get_shape_transform(shape_b), NULL, this);
+	bool result = narrowphase_result;
 
 	if (result != colliding) {
 
@@ -138,6 +176,8 @@ Area2PairSW::Area2PairSW(AreaSW *p_area_a, int p_shape_a, AreaSW *p_area_b, int
 	shape_a = p_shape_a;
 	shape_b = p_shape_b;
 	colliding = false;
+	narrowphase_result = false;
+	narrowphase_done = false;
 	area_a->add_constraint(this);
 	area_b->add_constraint(this);
 }
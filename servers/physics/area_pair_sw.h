@@ -41,8 +41,11 @@ class AreaPairSW : public ConstraintSW {
 	int body_shape;
 	int area_shape;
 	bool colliding;
+	bool narrowphase_result;
+	bool narrowphase_done;
 
 public:
+	void narrowphase(real_t p_step);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -57,8 +60,11 @@ class Area2PairSW : public ConstraintSW {
 	int shape_a;
 	int shape_b;
 	bool colliding;
+	bool narrowphase_result;
+	bool narrowphase_done;
 
 public:
+	void narrowphase(real_t p_step);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
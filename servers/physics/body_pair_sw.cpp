@@ -206,14 +206,19 @@ bool BodyPairSW::_test_ccd(real_t p_step, BodySW *p_A, int p_shape_A, const Tran
 	return true;
 }
 
-bool BodyPairSW::setup(real_t p_step) {
+void BodyPairSW::narrowphase(real_t p_step) {
+
+	narrowphase_done = true;
 
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
+		can_collide = false;
 		collided = false;
-		return false;
+		return;
 	}
 
+	can_collide = true;
+
 	offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
 
 	validate_contacts();
@@ -226,12 +231,32 @@ bool BodyPairSW::setup(real_t p_step) {
 	xform_Bu.origin -= offset_A;
 	Transform xform_B = xform_Bu * B->get_shape_transform(shape_B);
 
+	collided = CollisionSolverSW::solve_static(A->get_shape(shape_A), xform_A, B->get_shape(shape_B), xform_B, _contact_added_callback, this, &sep_axis);
+}
+
+bool BodyPairSW::setup(real_t p_step) {
+
+	if (!narrowphase_done) {
+		narrowphase(p_step);
+	}
+
+	narrowphase_done = false;
+
+	if (!can_collide) {
+		return false;
+	}
+
+	Vector3 offset_A = A->get_transform().get_origin();
+	Transform xform_Au = Transform(A->get_transform().basis, Vector3());
+	Transform xform_A = xform_Au * A->get_shape_transform(shape_A);
+
+	Transform xform_Bu = B->get_transform();
+	xform_Bu.origin -= offset_A;
+	Transform xform_B = xform_Bu * B->get_shape_transform(shape_B);
+
 	ShapeSW *shape_A_ptr = A->get_shape(shape_A);
 	ShapeSW *shape_B_ptr = B->get_shape(shape_B);
 
-	bool collided = CollisionSolverSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
-	this->collided = collided;
-
 	if (!collided) {
 
 		//test ccd (currently just a raycast)
@@ -315,7 +340,6 @@ bool BodyPairSW::setup(real_t p_step) {
 
 		if (A->is_shape_set_as_trigger(shape_A) || B->is_shape_set_as_trigger(shape_B) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC)) {
 			c.active = false;
-			collided = false;
 			continue;
 		}
 
@@ -479,6 +503,8 @@ BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B)
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	can_collide = false;
+	narrowphase_done = false;
 }
 
 BodyPairSW::~BodyPairSW() {
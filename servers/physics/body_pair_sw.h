@@ -74,6 +74,8 @@ class BodyPairSW : public ConstraintSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool can_collide;
+	bool narrowphase_done;
 	int cc;
 
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
@@ -86,6 +88,7 @@ class BodyPairSW : public ConstraintSW {
 	SpaceSW *space;
 
 public:
+	void narrowphase(real_t p_step);
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
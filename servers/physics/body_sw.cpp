@@ -277,36 +277,40 @@ void BodySW::_shapes_changed() {
 	_update_inertia();
 }
 
+void BodySW::set_state_transform(const Transform &p_transform) {
+
+	if (mode == PhysicsServer::BODY_MODE_KINEMATIC) {
+		new_transform = p_transform;
+		//wakeup_neighbours();
+		set_active(true);
+		if (first_time_kinematic) {
+			_set_transform(p_transform);
+			_set_inv_transform(get_transform().affine_inverse());
+			first_time_kinematic = false;
+		}
+
+	} else if (mode == PhysicsServer::BODY_MODE_STATIC) {
+		_set_transform(p_transform);
+		_set_inv_transform(get_transform().affine_inverse());
+		wakeup_neighbours();
+	} else {
+		Transform t = p_transform;
+		t.orthonormalize();
+		new_transform = get_transform(); //used as old to compute motion
+		if (new_transform == t)
+			return;
+		_set_transform(t);
+		_set_inv_transform(get_transform().inverse());
+	}
+	wakeup();
+}
+
 void BodySW::set_state(PhysicsServer::BodyState p_state, const Variant &p_variant) {
 
 	switch (p_state) {
 		case PhysicsServer::BODY_STATE_TRANSFORM: {
 
-			if (mode == PhysicsServer::BODY_MODE_KINEMATIC) {
-				new_transform = p_variant;
-				//wakeup_neighbours();
-				set_active(true);
-				if (first_time_kinematic) {
-					_set_transform(p_variant);
-					_set_inv_transform(get_transform().affine_inverse());
-					first_time_kinematic = false;
-				}
-
-			} else if (mode == PhysicsServer::BODY_MODE_STATIC) {
-				_set_transform(p_variant);
-				_set_inv_transform(get_transform().affine_inverse());
-				wakeup_neighbours();
-			} else {
-				Transform t = p_variant;
-				t.orthonormalize();
-				new_transform = get_transform(); //used as old to compute motion
-				if (new_transform == t)
-					break;
-				_set_transform(t);
-				_set_inv_transform(get_transform().inverse());
-			}
-			wakeup();
-
+			set_state_transform(p_variant);
 		} break;
 		case PhysicsServer::BODY_STATE_LINEAR_VELOCITY: {
 
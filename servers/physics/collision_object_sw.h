@@ -43,6 +43,9 @@
 class SpaceSW;
 
 class CollisionObjectSW : public ShapeOwnerSW {
+
+	friend class SpaceSW;
+
 public:
 	enum Type {
 		TYPE_AREA,
@@ -70,6 +70,11 @@ public:
 	_FORCE_INLINE_ void set_priority(int p_priority) { priority = p_priority; }
 	_FORCE_INLINE_ int get_priority() const { return priority; }
 
+	// Collision detection part of setup(). StepSW may call it for all the
+	// constraints in parallel before setup(), so it must only write to the
+	// constraint itself. setup() runs it itself when it was not called.
+	virtual void narrowphase(real_t p_step) {}
+
 	virtual bool setup(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
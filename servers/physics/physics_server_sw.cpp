@@ -29,6 +29,7 @@
 /*************************************************************************/
 #include "physics_server_sw.h"
 #include "broad_phase_basic.h"
+#include "broad_phase_bvh.h"
 #include "broad_phase_octree.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
@@ -176,6 +177,23 @@ real_t PhysicsServerSW::space_get_param(RID p_space, SpaceParameter p_param) con
 	return space->get_param(p_param);
 }
 
+void PhysicsServerSW::space_set_broadphase(RID p_space, SpaceBroadphase p_broadphase) {
+
+	SpaceSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND(!space);
+	ERR_FAIL_INDEX(p_broadphase, 2);
+	ERR_FAIL_COND(space->is_locked());
+
+	space->set_broadphase(p_broadphase);
+}
+
+PhysicsServer::SpaceBroadphase PhysicsServerSW::space_get_broadphase(RID p_space) const {
+
+	const SpaceSW *space = space_owner.get(p_space);
+	ERR_FAIL_COND_V(!space, SPACE_BROADPHASE_OCTREE);
+	return space->get_broadphase_type();
+}
+
 PhysicsDirectSpaceState *PhysicsServerSW::space_get_direct_state(RID p_space) {
 
 	SpaceSW *space = space_owner.get(p_space);
@@ -643,7 +661,7 @@ uint32_t PhysicsServerSW::body_get_collision_mask(RID p_body, uint32_t p_mask) c
 	return body->get_collision_mask();
 }
 
-void PhysicsServerSW::body_attach_object_instance_ID(RID p_body, uint32_t p_ID) {
+void PhysicsServerSW::body_attach_object_instance_ID(RID p_body, ObjectID p_ID) {
 
 	BodySW *body = body_owner.get(p_body);
 	ERR_FAIL_COND(!body);
@@ -651,7 +669,7 @@ void PhysicsServerSW::body_attach_object_instance_ID(RID p_body, uint32_t p_ID)
 	body->set_instance_id(p_ID);
 };
 
-uint32_t PhysicsServerSW::body_get_object_instance_ID(RID p_body) const {
+ObjectID PhysicsServerSW::body_get_object_instance_ID(RID p_body) const {
 
 	BodySW *body = body_owner.get(p_body);
 	ERR_FAIL_COND_V(!body, 0);
@@ -697,6 +715,17 @@ void PhysicsServerSW::body_set_state(RID p_body, BodyState p_state, const Varian
 	body->set_state(p_state, p_variant);
 };
 
+void PhysicsServerSW::bodies_set_transform(const RID *p_bodies, const Transform *p_transforms, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		BodySW *body = body_owner.get(p_bodies[i]);
+		ERR_CONTINUE(!body);
+
+		body->set_state_transform(p_transforms[i]);
+	}
+}
+
 Variant PhysicsServerSW::body_get_state(RID p_body, BodyState p_state) const {
 
 	BodySW *body = body_owner.get(p_body);
@@ -1533,6 +1562,12 @@ void PhysicsServerSW::_shape_col_cbk(const Vector3 &p_point_A, const Vector3 &p_
 PhysicsServerSW::PhysicsServerSW() {
 
 	BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+
+	int broadphase = GLOBAL_DEF("physics/3d/broadphase", 0);
+	GlobalConfig::get_singleton()->set_custom_property_info("physics/3d/broadphase", PropertyInfo(Variant::INT, "physics/3d/broadphase", PROPERTY_HINT_ENUM, "Octree,Dynamic BVH"));
+	if (broadphase == SPACE_BROADPHASE_DYNAMIC_BVH) {
+		BroadPhaseSW::create_func = BroadPhaseBVH::_create;
+	}
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
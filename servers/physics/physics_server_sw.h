@@ -89,6 +89,9 @@ public:
 	virtual void space_set_param(RID p_space, SpaceParameter p_param, real_t p_value);
 	virtual real_t space_get_param(RID p_space, SpaceParameter p_param) const;
 
+	virtual void space_set_broadphase(RID p_space, SpaceBroadphase p_broadphase);
+	virtual SpaceBroadphase space_get_broadphase(RID p_space) const;
+
 	// this function only works on fixed process, errors and returns null otherwise
 	virtual PhysicsDirectSpaceState *space_get_direct_state(RID p_space);
 
@@ -162,8 +165,8 @@ public:
 	virtual void body_remove_shape(RID p_body, int p_shape_idx);
 	virtual void body_clear_shapes(RID p_body);
 
-	virtual void body_attach_object_instance_ID(RID p_body, uint32_t p_ID);
-	virtual uint32_t body_get_object_instance_ID(RID p_body) const;
+	virtual void body_attach_object_instance_ID(RID p_body, ObjectID p_ID);
+	virtual ObjectID body_get_object_instance_ID(RID p_body) const;
 
 	virtual void body_set_enable_continuous_collision_detection(RID p_body, bool p_enable);
 	virtual bool body_is_continuous_collision_detection_enabled(RID p_body) const;
@@ -182,6 +185,7 @@ public:
 
 	virtual void body_set_state(RID p_body, BodyState p_state, const Variant &p_variant);
 	virtual Variant body_get_state(RID p_body, BodyState p_state) const;
+	virtual void bodies_set_transform(const RID *p_bodies, const Transform *p_transforms, int p_count);
 
 	virtual void body_set_applied_force(RID p_body, const Vector3 &p_force);
 	virtual Vector3 body_get_applied_force(RID p_body) const;
@@ -28,6 +28,8 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "space_sw.h"
+#include "broad_phase_bvh.h"
+#include "broad_phase_octree.h"
 #include "collision_solver_sw.h"
 #include "global_config.h"
 #include "physics_server_sw.h"
@@ -509,6 +511,32 @@ BroadPhaseSW *SpaceSW::get_broadphase() {
 	return broadphase;
 }
 
+void SpaceSW::set_broadphase(PhysicsServer::SpaceBroadphase p_type) {
+
+	if (p_type == broadphase_type)
+		return;
+
+	// every shape has to leave the old broadphase first, pairs get undone through the unpair callback
+	for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+		E->get()->_unregister_shapes();
+	}
+
+	memdelete(broadphase);
+
+	broadphase_type = p_type;
+	if (p_type == PhysicsServer::SPACE_BROADPHASE_DYNAMIC_BVH) {
+		broadphase = BroadPhaseBVH::_create();
+	} else {
+		broadphase = BroadPhaseOctree::_create();
+	}
+	broadphase->set_pair_callback(_broadphase_pair, this);
+	broadphase->set_unpair_callback(_broadphase_unpair, this);
+
+	for (Set<CollisionObjectSW *>::Element *E = objects.front(); E; E = E->next()) {
+		E->get()->_update_shapes();
+	}
+}
+
 void SpaceSW::add_object(CollisionObjectSW *p_object) {
 
 	ERR_FAIL_COND(objects.has(p_object));
@@ -660,6 +688,7 @@ SpaceSW::SpaceSW() {
 	body_angular_velocity_damp_ratio = 10;
 
 	broadphase = BroadPhaseSW::create_func();
+	broadphase_type = BroadPhaseSW::create_func == BroadPhaseBVH::_create ? PhysicsServer::SPACE_BROADPHASE_DYNAMIC_BVH : PhysicsServer::SPACE_BROADPHASE_OCTREE;
 	broadphase->set_pair_callback(_broadphase_pair, this);
 	broadphase->set_unpair_callback(_broadphase_unpair, this);
 	area = NULL;
@@ -76,6 +76,7 @@ private:
 	RID self;
 
 	BroadPhaseSW *broadphase;
+	PhysicsServer::SpaceBroadphase broadphase_type;
 	SelfList<BodySW>::List active_list;
 	SelfList<BodySW>::List inertia_update_list;
 	SelfList<BodySW>::List state_query_list;
@@ -143,6 +144,8 @@ public:
 	const SelfList<AreaSW>::List &get_moved_area_list() const;
 
 	BroadPhaseSW *get_broadphase();
+	void set_broadphase(PhysicsServer::SpaceBroadphase p_type);
+	PhysicsServer::SpaceBroadphase get_broadphase_type() const { return broadphase_type; }
 
 	void add_object(CollisionObjectSW *p_object);
 	void remove_object(CollisionObjectSW *p_object);
@@ -30,6 +30,7 @@
 #include "step_sw.h"
 #include "joints_sw.h"
 
+#include "global_config.h"
 #include "os/os.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
@@ -106,6 +107,27 @@ void StepSW::_solve_island(ConstraintSW *p_island, int p_iterations, real_t p_de
 	}
 }
 
+void StepSW::_solve_islands_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to) {
+
+	StepSW *step = (StepSW *)p_userdata;
+	ConstraintSW *const *islands = step->constraint_islands.ptr();
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		//iterating each island separatedly improves cache efficiency
+		step->_solve_island(islands[i], step->solve_iterations, step->solve_delta);
+	}
+}
+
+void StepSW::_narrowphase_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to) {
+
+	StepSW *step = (StepSW *)p_userdata;
+	ConstraintSW *const *constraints = step->constraints.ptr();
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		constraints[i]->narrowphase(step->solve_delta);
+	}
+}
+
 void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
@@ -230,6 +252,35 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	//print_line("island count: "+itos(island_count)+" active count: "+itos(active_count));
 	/* SETUP CONSTRAINT ISLANDS */
 
+	if (work_pool.get_thread_count() > 1) {
+		// run collision detection for every pair first, in parallel. Each pair
+		// only writes its own contacts here, so setup() below (which touches
+		// bodies, areas and the space) is the only part that stays serial.
+
+		int constraint_count = 0;
+		for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			for (ConstraintSW *c = ci; c; c = c->get_island_next()) {
+				constraint_count++;
+			}
+		}
+
+		if (constraints.size() < constraint_count) {
+			constraints.resize(constraint_count);
+		}
+
+		ConstraintSW **cptr = constraints.ptr();
+		int idx = 0;
+		for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			for (ConstraintSW *c = ci; c; c = c->get_island_next()) {
+				cptr[idx++] = c;
+			}
+		}
+
+		solve_delta = p_delta;
+
+		work_pool.do_work(constraint_count, _narrowphase_thread, this);
+	}
+
 	{
 		ConstraintSW *ci = constraint_island_list;
 		while (ci) {
@@ -248,12 +299,31 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+		// islands share no dynamic bodies, which makes it safe to solve them in
+		// parallel. They can share static and kinematic bodies, so the impulse
+		// helpers of BodySW and Body2DSW return early for those modes and a shared
+		// body is only ever read here. Each island is still solved serially, so the
+		// result does not depend on how islands are distributed among threads.
+
+		int constraint_island_count = 0;
+		for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			constraint_island_count++;
+		}
+
+		if (constraint_islands.size() < constraint_island_count) {
+			constraint_islands.resize(constraint_island_count);
 		}
+
+		ConstraintSW **islands = constraint_islands.ptr();
+		int idx = 0;
+		for (ConstraintSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			islands[idx++] = ci;
+		}
+
+		solve_iterations = p_iterations;
+		solve_delta = p_delta;
+
+		work_pool.do_work(constraint_island_count, _solve_islands_thread, this);
 	}
 
 	{ //profile
@@ -296,4 +366,15 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	solve_iterations = 0;
+	solve_delta = 0;
+
+	int thread_count = GLOBAL_DEF("physics/3d/thread_count", 1);
+	GlobalConfig::get_singleton()->set_custom_property_info("physics/3d/thread_count", PropertyInfo(Variant::INT, "physics/3d/thread_count", PROPERTY_HINT_RANGE, "0,64,1"));
+	work_pool.init(thread_count > 0 ? thread_count : -1);
+}
+
+StepSW::~StepSW() {
+
+	work_pool.finish();
 }
@@ -30,12 +30,24 @@
 #ifndef STEP_SW_H
 #define STEP_SW_H
 
+#include "os/thread_work_pool.h"
 #include "space_sw.h"
 
 class StepSW {
 
 	uint64_t _step;
 
+	ThreadWorkPool work_pool;
+
+	//pairs run their narrowphase in parallel, and independent islands are solved in parallel
+	Vector<ConstraintSW *> constraints;
+	Vector<ConstraintSW *> constraint_islands;
+	int solve_iterations;
+	real_t solve_delta;
+
+	static void _narrowphase_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
+	static void _solve_islands_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
@@ -44,6 +56,7 @@ class StepSW {
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
 	StepSW();
+	~StepSW();
 };
 
 #endif // STEP__SW_H
@@ -170,8 +170,8 @@ public:
 	virtual void body_set_shape_as_trigger(RID p_body, int p_shape_idx, bool p_enable);
 	virtual bool body_is_shape_set_as_trigger(RID p_body, int p_shape_idx) const;
 
-	virtual void body_attach_object_instance_ID(RID p_body, uint32_t p_ID);
-	virtual uint32_t body_get_object_instance_ID(RID p_body) const;
+	virtual void body_attach_object_instance_ID(RID p_body, ObjectID p_ID);
+	virtual ObjectID body_get_object_instance_ID(RID p_body) const;
 
 	virtual void body_set_continuous_collision_detection_mode(RID p_body, CCDMode p_mode);
 	virtual CCDMode body_get_continuous_collision_detection_mode(RID p_body) const;
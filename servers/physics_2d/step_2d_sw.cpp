@@ -28,6 +28,8 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "step_2d_sw.h"
+
+#include "global_config.h"
 #include "os/os.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
@@ -93,6 +95,17 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
+void Step2DSW::_solve_islands_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to) {
+
+	Step2DSW *step = (Step2DSW *)p_userdata;
+	Constraint2DSW *const *islands = step->constraint_islands.ptr();
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		//iterating each island separatedly improves cache efficiency
+		step->_solve_island(islands[i], step->solve_iterations, step->solve_delta);
+	}
+}
+
 void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
@@ -265,12 +278,28 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
+		// islands share no dynamic bodies, and static and kinematic bodies ignore
+		// impulses, see StepSW::step
+
+		int constraint_island_count = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			constraint_island_count++;
 		}
+
+		if (constraint_islands.size() < constraint_island_count) {
+			constraint_islands.resize(constraint_island_count);
+		}
+
+		Constraint2DSW **islands = constraint_islands.ptr();
+		int idx = 0;
+		for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+			islands[idx++] = ci;
+		}
+
+		solve_iterations = p_iterations;
+		solve_delta = p_delta;
+
+		work_pool.do_work(constraint_island_count, _solve_islands_thread, this);
 	}
 
 	{ //profile
@@ -314,4 +343,15 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 Step2DSW::Step2DSW() {
 
 	_step = 1;
+	solve_iterations = 0;
+	solve_delta = 0;
+
+	int thread_count = GLOBAL_DEF("physics/2d/thread_count", 1);
+	GlobalConfig::get_singleton()->set_custom_property_info("physics/2d/thread_count", PropertyInfo(Variant::INT, "physics/2d/thread_count", PROPERTY_HINT_RANGE, "0,64,1"));
+	work_pool.init(thread_count > 0 ? thread_count : -1);
+}
+
+Step2DSW::~Step2DSW() {
+
+	work_pool.finish();
 }
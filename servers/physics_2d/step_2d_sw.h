@@ -30,12 +30,22 @@
 #ifndef STEP_2D_SW_H
 #define STEP_2D_SW_H
 
+#include "os/thread_work_pool.h"
 #include "space_2d_sw.h"
 
 class Step2DSW {
 
 	uint64_t _step;
 
+	ThreadWorkPool work_pool;
+
+	//islands are independent, so they are solved in parallel
+	Vector<Constraint2DSW *> constraint_islands;
+	int solve_iterations;
+	real_t solve_delta;
+
+	static void _solve_islands_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
 	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
@@ -44,6 +54,7 @@ class Step2DSW {
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
 	Step2DSW();
+	~Step2DSW();
 };
 
 #endif // STEP_2D_SW_H
@@ -405,6 +405,8 @@ void PhysicsServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("space_is_active", "space"), &PhysicsServer::space_is_active);
 	ClassDB::bind_method(D_METHOD("space_set_param", "space", "param", "value"), &PhysicsServer::space_set_param);
 	ClassDB::bind_method(D_METHOD("space_get_param", "space", "param"), &PhysicsServer::space_get_param);
+	ClassDB::bind_method(D_METHOD("space_set_broadphase", "space", "broadphase"), &PhysicsServer::space_set_broadphase);
+	ClassDB::bind_method(D_METHOD("space_get_broadphase", "space"), &PhysicsServer::space_get_broadphase);
 	ClassDB::bind_method(D_METHOD("space_get_direct_state:PhysicsDirectSpaceState", "space"), &PhysicsServer::space_get_direct_state);
 
 	ClassDB::bind_method(D_METHOD("area_create"), &PhysicsServer::area_create);
@@ -703,6 +705,9 @@ void PhysicsServer::_bind_methods() {
 	BIND_CONSTANT(INFO_ACTIVE_OBJECTS);
 	BIND_CONSTANT(INFO_COLLISION_PAIRS);
 	BIND_CONSTANT(INFO_ISLAND_COUNT);
+
+	BIND_CONSTANT(SPACE_BROADPHASE_OCTREE);
+	BIND_CONSTANT(SPACE_BROADPHASE_DYNAMIC_BVH);
 }
 
 PhysicsServer::PhysicsServer() {
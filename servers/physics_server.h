@@ -271,6 +271,14 @@ public:
 	virtual void space_set_param(RID p_space, SpaceParameter p_param, real_t p_value) = 0;
 	virtual real_t space_get_param(RID p_space, SpaceParameter p_param) const = 0;
 
+	enum SpaceBroadphase {
+		SPACE_BROADPHASE_OCTREE,
+		SPACE_BROADPHASE_DYNAMIC_BVH,
+	};
+
+	virtual void space_set_broadphase(RID p_space, SpaceBroadphase p_broadphase) = 0;
+	virtual SpaceBroadphase space_get_broadphase(RID p_space) const = 0;
+
 	// this function only works on fixed process, errors and returns null otherwise
 	virtual PhysicsDirectSpaceState *space_get_direct_state(RID p_space) = 0;
 
@@ -376,8 +384,8 @@ public:
 	virtual void body_remove_shape(RID p_body, int p_shape_idx) = 0;
 	virtual void body_clear_shapes(RID p_body) = 0;
 
-	virtual void body_attach_object_instance_ID(RID p_body, uint32_t p_ID) = 0;
-	virtual uint32_t body_get_object_instance_ID(RID p_body) const = 0;
+	virtual void body_attach_object_instance_ID(RID p_body, ObjectID p_ID) = 0;
+	virtual ObjectID body_get_object_instance_ID(RID p_body) const = 0;
 
 	virtual void body_set_enable_continuous_collision_detection(RID p_body, bool p_enable) = 0;
 	virtual bool body_is_continuous_collision_detection_enabled(RID p_body) const = 0;
@@ -416,6 +424,7 @@ public:
 
 	virtual void body_set_state(RID p_body, BodyState p_state, const Variant &p_variant) = 0;
 	virtual Variant body_get_state(RID p_body, BodyState p_state) const = 0;
+	virtual void bodies_set_transform(const RID *p_bodies, const Transform *p_transforms, int p_count) = 0; // same as setting BODY_STATE_TRANSFORM on each body
 
 	//do something about it
 	virtual void body_set_applied_force(RID p_body, const Vector3 &p_force) = 0;
@@ -665,6 +674,7 @@ public:
 
 VARIANT_ENUM_CAST(PhysicsServer::ShapeType);
 VARIANT_ENUM_CAST(PhysicsServer::SpaceParameter);
+VARIANT_ENUM_CAST(PhysicsServer::SpaceBroadphase);
 VARIANT_ENUM_CAST(PhysicsServer::AreaParameter);
 VARIANT_ENUM_CAST(PhysicsServer::AreaSpaceOverrideMode);
 VARIANT_ENUM_CAST(PhysicsServer::BodyMode);
@@ -336,6 +336,16 @@ void VisualServerCanvas::canvas_item_set_transform(RID p_item, const Transform2D
 
 	canvas_item->xform = p_transform;
 }
+void VisualServerCanvas::canvas_items_set_transform(const RID *p_items, const Transform2D *p_transforms, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		Item *canvas_item = canvas_item_owner.getornull(p_items[i]);
+		ERR_CONTINUE(!canvas_item);
+
+		canvas_item->xform = p_transforms[i];
+	}
+}
 void VisualServerCanvas::canvas_item_set_clip(RID p_item, bool p_clip) {
 
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
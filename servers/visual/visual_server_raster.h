@@ -960,6 +960,7 @@ public:
 	BIND2(scenario_set_environment, RID, RID)
 	BIND3(scenario_set_reflection_atlas_size, RID, int, int)
 	BIND2(scenario_set_fallback_environment, RID, RID)
+	BIND2(scenario_set_partitioning, RID, ScenarioPartitioning)
 
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
@@ -969,6 +970,7 @@ public:
 	BIND2(instance_set_scenario, RID, RID) // from can be mesh, light, poly, area and portal so far.
 	BIND2(instance_set_layer_mask, RID, uint32_t)
 	BIND2(instance_set_transform, RID, const Transform &)
+	BIND3(instances_set_transform, const RID *, const Transform *, int)
 	BIND2(instance_attach_object_instance_ID, RID, ObjectID)
 	BIND3(instance_set_blend_shape_weight, RID, int, float)
 	BIND3(instance_set_surface_material, RID, int, RID)
@@ -1009,6 +1011,7 @@ public:
 	BIND2(canvas_item_set_light_mask, RID, int)
 
 	BIND2(canvas_item_set_transform, RID, const Transform2D &)
+	BIND3(canvas_items_set_transform, const RID *, const Transform2D *, int)
 	BIND2(canvas_item_set_clip, RID, bool)
 	BIND2(canvas_item_set_distance_field_mode, RID, bool)
 	BIND3(canvas_item_set_custom_rect, RID, bool, const Rect2 &)
@@ -28,6 +28,7 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "visual_server_scene.h"
+#include "global_config.h"
 #include "os/os.h"
 #include "visual_server_global.h"
 #include "visual_server_raster.h"
@@ -329,8 +330,9 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->partition.set_mode(default_partitioning == VS::SCENARIO_PARTITIONING_DYNAMIC_BVH ? SpatialPartition<Instance, true>::MODE_DYNAMIC_BVH : SpatialPartition<Instance, true>::MODE_OCTREE);
+	scenario->partition.set_pair_callback(_instance_pair, this);
+	scenario->partition.set_unpair_callback(_instance_unpair, this);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -356,6 +358,34 @@ void VisualServerScene::scenario_set_environment(RID p_scenario, RID p_environme
 	scenario->environment = p_environment;
 }
 
+void VisualServerScene::scenario_set_partitioning(RID p_scenario, VS::ScenarioPartitioning p_partitioning) {
+
+	Scenario *scenario = scenario_owner.get(p_scenario);
+	ERR_FAIL_COND(!scenario);
+
+	SpatialPartition<Instance, true>::Mode mode = p_partitioning == VS::SCENARIO_PARTITIONING_DYNAMIC_BVH ? SpatialPartition<Instance, true>::MODE_DYNAMIC_BVH : SpatialPartition<Instance, true>::MODE_OCTREE;
+	if (scenario->partition.get_mode() == mode)
+		return;
+
+	// take everything out, pairs are undone through the unpair callback
+	for (SelfList<Instance> *E = scenario->instances.first(); E; E = E->next()) {
+
+		Instance *instance = E->self();
+		if (instance->octree_id) {
+			scenario->partition.erase(instance->octree_id);
+			instance->octree_id = 0;
+		}
+	}
+
+	scenario->partition.set_mode(mode);
+
+	// and put it back on next update
+	for (SelfList<Instance> *E = scenario->instances.first(); E; E = E->next()) {
+
+		_instance_queue_update(E->self(), true, false);
+	}
+}
+
 void VisualServerScene::scenario_set_fallback_environment(RID p_scenario, RID p_environment) {
 
 	Scenario *scenario = scenario_owner.get(p_scenario);
@@ -411,7 +441,7 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 		VSG::storage->instance_remove_dependency(instance->base, instance);
 
 		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
+			scenario->partition.erase(instance->octree_id); //make dependencies generated by the octree go away
 			instance->octree_id = 0;
 		}
 
@@ -528,7 +558,7 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 		}
 
 		if (instance->scenario && instance->octree_id) {
-			instance->scenario->octree.erase( instance->octree_id );
+			instance->scenario->partition.erase( instance->octree_id );
 			instance->octree_id=0;
 		}
 
@@ -716,7 +746,7 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 		instance->scenario->instances.remove(&instance->scenario_item);
 
 		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
+			instance->scenario->partition.erase(instance->octree_id); //make dependencies generated by the octree go away
 			instance->octree_id = 0;
 		}
 
@@ -797,6 +827,20 @@ void VisualServerScene::instance_set_transform(RID p_instance, const Transform &
 	instance->transform = p_transform;
 	_instance_queue_update(instance, true);
 }
+void VisualServerScene::instances_set_transform(const RID *p_instances, const Transform *p_transforms, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+
+		Instance *instance = instance_owner.get(p_instances[i]);
+		ERR_CONTINUE(!instance);
+
+		if (instance->transform == p_transforms[i])
+			continue;
+
+		instance->transform = p_transforms[i];
+		_instance_queue_update(instance, true);
+	}
+}
 void VisualServerScene::instance_attach_object_instance_ID(RID p_instance, ObjectID p_ID) {
 
 	Instance *instance = instance_owner.get(p_instance);
@@ -852,19 +896,19 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
 			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+				instance->scenario->partition.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
 			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+				instance->scenario->partition.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
 			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+				instance->scenario->partition.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
@@ -910,7 +954,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const Rect3 &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_AABB(p_aabb, cull, 1024);
+	culled = scenario->partition.cull_AABB(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -933,7 +977,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_to * 10000, cull, 1024);
+	culled = scenario->partition.cull_segment(p_from, p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -956,7 +1000,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->partition.cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -1014,6 +1058,14 @@ void VisualServerScene::instance_geometry_set_material_override(RID p_instance,
 }
 
 void VisualServerScene::instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) {
+
+	Instance *instance = instance_owner.get(p_instance);
+	ERR_FAIL_COND(!instance);
+
+	instance->lod_begin = p_min;
+	instance->lod_end = p_max;
+	instance->lod_begin_hysteresis = p_min_margin;
+	instance->lod_end_hysteresis = p_max_margin;
 }
 void VisualServerScene::instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) {
 }
@@ -1171,7 +1223,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 #endif
 
 		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		p_instance->octree_id = p_instance->scenario->partition.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -1180,7 +1232,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->partition.move(p_instance->octree_id, new_aabb);
 	}
 #if 0
 	if (p_instance->base_type==INSTANCE_PORTAL) {
@@ -1465,7 +1517,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 				light_frustum_planes[4] = Plane(z_vec, z_max + 1e6);
 				light_frustum_planes[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+				int cull_count = p_scenario->partition.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 				// a pre pass will need to be needed to determine the actual z-near to be used
 
@@ -1525,7 +1577,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 						planes[3] = p_instance->transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
 						planes[4] = p_instance->transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+						int cull_count = p_scenario->partition.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 						for (int j = 0; j < cull_count; j++) {
 
@@ -1572,7 +1624,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 						Vector<Plane> planes = cm.get_projection_planes(xform);
 
-						int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+						int cull_count = p_scenario->partition.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 						for (int j = 0; j < cull_count; j++) {
 
@@ -1604,7 +1656,7 @@ void VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
 			Vector<Plane> planes = cm.get_projection_planes(p_instance->transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			int cull_count = p_scenario->partition.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
 			for (int j = 0; j < cull_count; j++) {
 
@@ -1663,6 +1715,134 @@ void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_view
 	_render_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), -1);
 }
 
+void VisualServerScene::_cull_instances_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to) {
+
+	CullThreadParams *params = (CullThreadParams *)p_userdata;
+	CullThreadResult &result = params->results[p_thread];
+
+	result.from = p_from;
+	result.geometry_count = 0;
+	result.deferred_count = 0;
+
+	// both are compacted in place, writes never go past the element being read
+	Instance **geometry = &params->cull_result[p_from];
+	Instance **deferred = &params->deferred[p_from];
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+
+		Instance *ins = params->cull_result[i];
+
+		ins->last_render_pass = 0; // make invalid, unless kept
+
+		if ((params->camera_layer_mask & ins->layer_mask) == 0 || !ins->visible) {
+			continue;
+		}
+
+		if (ins->base_type == VS::INSTANCE_LIGHT || ins->base_type == VS::INSTANCE_REFLECTION_PROBE || ins->base_type == VS::INSTANCE_GI_PROBE) {
+			// touch shared lists, processed serially after the threads are done
+			deferred[result.deferred_count++] = ins;
+			continue;
+		}
+
+		if (!((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) || ins->cast_shadows == VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+			continue;
+		}
+
+		if (ins->lod_end > 0) {
+			//draw range
+			float d = params->camera_origin.distance_to(ins->transformed_aabb.pos + ins->transformed_aabb.size * 0.5);
+			if (d < ins->lod_begin || d >= ins->lod_end) {
+				continue;
+			}
+		}
+
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+
+		if (ins->base_type == VS::INSTANCE_PARTICLES) {
+			deferred[result.deferred_count++] = ins;
+		}
+
+		if (geom->lighting_dirty) {
+			int l = 0;
+			//only called when lights AABB enter/exit this geometry
+			ins->light_instances.resize(geom->lighting.size());
+
+			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+				ins->light_instances[l++] = light->instance;
+			}
+
+			geom->lighting_dirty = false;
+		}
+
+		if (geom->reflection_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+			for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+
+				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+				ins->reflection_probe_instances[l++] = reflection_probe->instance;
+			}
+
+			geom->reflection_dirty = false;
+		}
+
+		if (geom->gi_probes_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->gi_probe_instances.resize(geom->gi_probes.size());
+
+			for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+
+				ins->gi_probe_instances[l++] = gi_probe->probe_instance;
+			}
+
+			geom->gi_probes_dirty = false;
+		}
+
+		ins->depth = params->near_plane.distance_to(ins->transform.origin);
+		ins->depth_layer = CLAMP(int(ins->depth * 8 / params->z_far), 0, 7);
+		ins->last_render_pass = params->render_pass;
+
+		geometry[result.geometry_count++] = ins;
+	}
+}
+
+int VisualServerScene::_cull_instances(ThreadWorkPool &p_pool, int p_cull_count, CullThreadParams &p_params) {
+
+	uint32_t thread_count = p_pool.get_thread_count();
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		p_params.results[i].from = 0;
+		p_params.results[i].geometry_count = 0;
+		p_params.results[i].deferred_count = 0;
+	}
+
+	p_pool.do_work(p_cull_count, _cull_instances_thread, &p_params);
+
+	// merge in thread order, so the result is the same as culling on a single thread
+	int cull_count = 0;
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+
+		const CullThreadResult &result = p_params.results[i];
+
+		if (uint32_t(cull_count) != result.from && result.geometry_count) {
+			memmove(&p_params.cull_result[cull_count], &p_params.cull_result[result.from], result.geometry_count * sizeof(Instance *));
+		}
+		cull_count += result.geometry_count;
+	}
+
+	return cull_count;
+}
+
 void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
 
 	Scenario *scenario = scenario_owner.getornull(p_scenario);
@@ -1680,7 +1860,7 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	int cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	int cull_count = scenario->partition.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1688,9 +1868,9 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 //light_samplers_culled=0;
 
 /*	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
-	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
-	//print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
-	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
+	print_line("OTO: "+itos(p_scenario->partition.get_octant_count()));
+	//print_line("OTE: "+itos(p_scenario->partition.get_elem_count()));
+	print_line("OTP: "+itos(p_scenario->partition.get_pair_count()));
 */
 
 /* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
@@ -1717,7 +1897,7 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 
 		}
 
-		room_cull_count = p_scenario->octree.cull_point(camera->transform.origin,room_cull_result,MAX_ROOM_CULL,NULL,(1<<INSTANCE_ROOM)|(1<<INSTANCE_PORTAL));
+		room_cull_count = p_scenario->partition.cull_point(camera->transform.origin,room_cull_result,MAX_ROOM_CULL,NULL,(1<<INSTANCE_ROOM)|(1<<INSTANCE_PORTAL));
 
 
 		Set<Instance*> current_rooms;
@@ -1779,204 +1959,89 @@ void VisualServerScene::_render_scene(const Transform p_cam_transform, const Cam
 #endif
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
-	for (int i = 0; i < cull_count; i++) {
-
-		Instance *ins = instance_cull_result[i];
-
-		bool keep = false;
-
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
+	{
+		CullThreadParams params;
+		params.cull_result = instance_cull_result;
+		params.deferred = instance_cull_deferred;
+		params.results = cull_thread_results;
+		params.camera_layer_mask = camera_layer_mask;
+		params.render_pass = render_pass;
+		params.near_plane = near_plane;
+		params.camera_origin = p_cam_transform.origin;
+		params.z_far = z_far;
 
-			//failure
-		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
+		cull_count = _cull_instances(cull_work_pool, cull_count, params);
 
-			if (ins->visible && light_cull_count < MAX_LIGHTS_CULLED) {
+		uint32_t thread_count = cull_work_pool.get_thread_count();
 
-				InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
+		for (uint32_t i = 0; i < thread_count; i++) {
 
-				if (!light->geometries.empty()) {
-					//do not add this light if no geometry is affected by it..
-					light_cull_result[light_cull_count] = ins;
-					light_instance_cull_result[light_cull_count] = light->instance;
-					if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
-						VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
-					}
+			const CullThreadResult &result = cull_thread_results[i];
 
-					light_cull_count++;
-				}
-			}
-		} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE && ins->visible) {
+			for (uint32_t j = 0; j < result.deferred_count; j++) {
 
-			if (ins->visible && reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
+				Instance *ins = instance_cull_deferred[result.from + j];
 
-				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
+				if (ins->base_type == VS::INSTANCE_LIGHT) {
 
-				if (p_reflection_probe != reflection_probe->instance) {
-					//avoid entering The Matrix
+					if (light_cull_count < MAX_LIGHTS_CULLED) {
 
-					if (!reflection_probe->geometries.empty()) {
-						//do not add this light if no geometry is affected by it..
+						InstanceLightData *light = static_cast<InstanceLightData *>(ins->base_data);
 
-						if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
-							if (!reflection_probe->update_list.in_list()) {
-								reflection_probe->render_step = 0;
-								reflection_probe_render_list.add(&reflection_probe->update_list);
+						if (!light->geometries.empty()) {
+							//do not add this light if no geometry is affected by it..
+							light_cull_result[light_cull_count] = ins;
+							light_instance_cull_result[light_cull_count] = light->instance;
+							if (p_shadow_atlas.is_valid() && VSG::storage->light_has_shadow(ins->base)) {
+								VSG::scene_render->light_instance_mark_visible(light->instance); //mark it visible for shadow allocation later
 							}
 
-							reflection_probe->reflection_dirty = false;
-						}
-
-						if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
-							reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
-							reflection_probe_cull_count++;
+							light_cull_count++;
 						}
 					}
-				}
-			}
-
-		} else if (ins->base_type == VS::INSTANCE_GI_PROBE && ins->visible) {
-
-			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
-			if (!gi_probe->update_element.in_list()) {
-				gi_probe_update_list.add(&gi_probe->update_element);
-			}
-
-		} else if ((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-
-			keep = true;
-#if 0
-			bool discarded=false;
-
-			if (ins->draw_range_end>0) {
-
-				float d = cull_range.nearp.distance_to(ins->data.transform.origin);
-				if (d<0)
-					d=0;
-				discarded=(d<ins->draw_range_begin || d>=ins->draw_range_end);
-
+				} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE) {
 
-			}
-
-			if (!discarded) {
-
-				// test if this geometry should be visible
+					if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
 
-				if (room_cull_enabled) {
+						InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(ins->base_data);
 
+						if (p_reflection_probe != reflection_probe->instance) {
+							//avoid entering The Matrix
 
-					if (ins->visible_in_all_rooms) {
-						keep=true;
-					} else if (ins->room) {
+							if (!reflection_probe->geometries.empty()) {
+								//do not add this light if no geometry is affected by it..
 
-						if (ins->room->room_info->last_visited_pass==render_pass)
-							keep=true;
-					} else if (ins->auto_rooms.size()) {
+								if (reflection_probe->reflection_dirty || VSG::scene_render->reflection_probe_instance_needs_redraw(reflection_probe->instance)) {
+									if (!reflection_probe->update_list.in_list()) {
+										reflection_probe->render_step = 0;
+										reflection_probe_render_list.add(&reflection_probe->update_list);
+									}
 
+									reflection_probe->reflection_dirty = false;
+								}
 
-						for(Set<Instance*>::Element *E=ins->auto_rooms.front();E;E=E->next()) {
-
-							if (E->get()->room_info->last_visited_pass==render_pass) {
-								keep=true;
-								break;
+								if (VSG::scene_render->reflection_probe_instance_has_reflection(reflection_probe->instance)) {
+									reflection_probe_instance_cull_result[reflection_probe_cull_count] = reflection_probe->instance;
+									reflection_probe_cull_count++;
+								}
 							}
 						}
-					} else if(exterior_visited)
-						keep=true;
-				} else {
-
-					keep=true;
-				}
-
-
-			}
-
-
-			if (keep) {
-				// update cull range
-				float min,max;
-				ins->transformed_aabb.project_range_in_plane(cull_range.nearp,min,max);
-
-				if (min<cull_range.min)
-					cull_range.min=min;
-				if (max>cull_range.max)
-					cull_range.max=max;
-
-				if (ins->sampled_light && ins->sampled_light->gi_probe_sampler_info->last_pass!=render_pass) {
-					if (light_samplers_culled<MAX_LIGHT_SAMPLERS) {
-						light_sampler_cull_result[light_samplers_culled++]=ins->sampled_light;
-						ins->sampled_light->gi_probe_sampler_info->last_pass=render_pass;
 					}
-				}
-			}
-#endif
-
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
-
-			if (ins->base_type == VS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				VSG::storage->particles_request_process(ins->base);
-				//particles visible? request redraw
-				VisualServerRaster::redraw_request();
-			}
-
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
-
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
-
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
-
-					ins->light_instances[l++] = light->instance;
-				}
 
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
-
-					ins->reflection_probe_instances[l++] = reflection_probe->instance;
-				}
-
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
-
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+				} else if (ins->base_type == VS::INSTANCE_GI_PROBE) {
 
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
+					if (!gi_probe->update_element.in_list()) {
+						gi_probe_update_list.add(&gi_probe->update_element);
+					}
 
-					ins->gi_probe_instances[l++] = gi_probe->probe_instance;
+				} else if (ins->base_type == VS::INSTANCE_PARTICLES) {
+					//particles visible? process them
+					VSG::storage->particles_request_process(ins->base);
+					//particles visible? request redraw
+					VisualServerRaster::redraw_request();
 				}
-
-				geom->gi_probes_dirty = false;
 			}
-
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 8 / z_far), 0, 7);
-		}
-
-		if (!keep) {
-			// remove, no reason to keep
-			cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[cull_count]);
-			i--;
-			ins->last_render_pass = 0; // make invalid
-		} else {
-
-			ins->last_render_pass = render_pass;
 		}
 	}
 
@@ -3401,10 +3466,22 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	default_partitioning = VS::ScenarioPartitioning(int(GLOBAL_DEF("rendering/spatial_partitioning/scenario_mode", 0)));
+	GlobalConfig::get_singleton()->set_custom_property_info("rendering/spatial_partitioning/scenario_mode", PropertyInfo(Variant::INT, "rendering/spatial_partitioning/scenario_mode", PROPERTY_HINT_ENUM, "Octree,Dynamic BVH"));
+
+	int cull_threads = GLOBAL_DEF("rendering/threads/cull_thread_count", 1);
+	GlobalConfig::get_singleton()->set_custom_property_info("rendering/threads/cull_thread_count", PropertyInfo(Variant::INT, "rendering/threads/cull_thread_count", PROPERTY_HINT_RANGE, "0,64,1"));
+	// 0 means one cull thread per processor
+	cull_work_pool.init(cull_threads > 0 ? cull_threads : -1);
+	cull_thread_results = memnew_arr(CullThreadResult, cull_work_pool.get_thread_count());
 }
 
 VisualServerScene::~VisualServerScene() {
 
+	cull_work_pool.finish();
+	memdelete_arr(cull_thread_results);
+
 #ifndef NO_THREADS
 	probe_bake_thread_exit = true;
 	Thread::wait_to_finish(probe_bake_thread);
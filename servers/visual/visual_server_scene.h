@@ -38,6 +38,8 @@
 #include "os/semaphore.h"
 #include "os/semaphore.h"
 #include "os/thread.h"
+#include "os/thread_work_pool.h"
+#include "spatial_partition.h"
 #include "self_list.h"
 
 class VisualServerScene {
@@ -179,7 +181,7 @@ public:
 		RID self;
 		// well wtf, balloon allocator is slower?
 
-		Octree<Instance, true> octree;
+		SpatialPartition<Instance, true> partition;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -203,6 +205,9 @@ public:
 	virtual void scenario_set_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv);
+	virtual void scenario_set_partitioning(RID p_scenario, VS::ScenarioPartitioning p_partitioning);
+
+	VS::ScenarioPartitioning default_partitioning;
 
 	/* INSTANCING API */
 
@@ -480,6 +485,40 @@ public:
 	RID reflection_probe_instance_cull_result[MAX_REFLECTION_PROBES_CULLED];
 	int reflection_probe_cull_count;
 
+	/* CULL THREADS */
+
+	// Instances that need serial processing after the threaded cull pass
+	// (lights, probes, particles). Each cull thread only writes inside its
+	// own [from,to) range of this array and of instance_cull_result.
+	Instance *instance_cull_deferred[MAX_INSTANCE_CULL];
+
+	struct CullThreadResult {
+
+		uint32_t from;
+		uint32_t geometry_count;
+		uint32_t deferred_count;
+	};
+
+	struct CullThreadParams {
+
+		Instance **cull_result;
+		Instance **deferred;
+		CullThreadResult *results;
+		uint32_t camera_layer_mask;
+		uint64_t render_pass;
+		Plane near_plane;
+		Vector3 camera_origin;
+		float z_far;
+	};
+
+	ThreadWorkPool cull_work_pool;
+	CullThreadResult *cull_thread_results;
+
+	static void _cull_instances_thread(void *p_userdata, uint32_t p_thread, uint32_t p_from, uint32_t p_to);
+	// classifies the first p_cull_count instances of p_params.cull_result on p_pool and
+	// compacts the kept geometry in thread order, returns the number of kept instances
+	static int _cull_instances(ThreadWorkPool &p_pool, int p_cull_count, CullThreadParams &p_params);
+
 	RID_Owner<Instance> instance_owner;
 
 	// from can be mesh, light,  area and portal so far.
@@ -489,6 +528,7 @@ public:
 	virtual void instance_set_scenario(RID p_instance, RID p_scenario); // from can be mesh, light, poly, area and portal so far.
 	virtual void instance_set_layer_mask(RID p_instance, uint32_t p_mask);
 	virtual void instance_set_transform(RID p_instance, const Transform &p_transform);
+	virtual void instances_set_transform(const RID *p_instances, const Transform *p_transforms, int p_count);
 	virtual void instance_attach_object_instance_ID(RID p_instance, ObjectID p_ID);
 	virtual void instance_set_blend_shape_weight(RID p_instance, int p_shape, float p_weight);
 	virtual void instance_set_surface_material(RID p_instance, int p_surface, RID p_material);
@@ -653,6 +653,13 @@ public:
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv) = 0;
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment) = 0;
 
+	enum ScenarioPartitioning {
+		SCENARIO_PARTITIONING_OCTREE,
+		SCENARIO_PARTITIONING_DYNAMIC_BVH,
+	};
+
+	virtual void scenario_set_partitioning(RID p_scenario, ScenarioPartitioning p_partitioning) = 0;
+
 	/* INSTANCING API */
 
 	enum InstanceType {
@@ -682,6 +689,7 @@ public:
 	virtual void instance_set_scenario(RID p_instance, RID p_scenario) = 0; // from can be mesh, light, poly, area and portal so far.
 	virtual void instance_set_layer_mask(RID p_instance, uint32_t p_mask) = 0;
 	virtual void instance_set_transform(RID p_instance, const Transform &p_transform) = 0;
+	virtual void instances_set_transform(const RID *p_instances, const Transform *p_transforms, int p_count) = 0; // same as calling instance_set_transform() p_count times
 	virtual void instance_attach_object_instance_ID(RID p_instance, ObjectID p_ID) = 0;
 	virtual void instance_set_blend_shape_weight(RID p_instance, int p_shape, float p_weight) = 0;
 	virtual void instance_set_surface_material(RID p_instance, int p_surface, RID p_material) = 0;
@@ -732,6 +740,7 @@ public:
 	virtual void canvas_item_set_light_mask(RID p_item, int p_mask) = 0;
 
 	virtual void canvas_item_set_transform(RID p_item, const Transform2D &p_transform) = 0;
+	virtual void canvas_items_set_transform(const RID *p_items, const Transform2D *p_transforms, int p_count) = 0; // same as calling canvas_item_set_transform() p_count times
 	virtual void canvas_item_set_clip(RID p_item, bool p_clip) = 0;
 	virtual void canvas_item_set_distance_field_mode(RID p_item, bool p_enable) = 0;
 	virtual void canvas_item_set_custom_rect(RID p_item, bool p_custom_rect, const Rect2 &p_rect = Rect2()) = 0;